@@ -57,6 +57,7 @@
 #include "../../libs/gltfio/src/extended/AssetLoaderExtended.h"
 #include "../../libs/gltfio/src/FTrsTransformManager.h"
 #include "../../libs/gltfio/src/GltfEnums.h"
+#include "../../libs/gltfio/src/MaterialPackageCache.h"
 
 #include "../../filament/src/details/Engine.h"
 #include "../../filament/src/ResourceAllocator.h"
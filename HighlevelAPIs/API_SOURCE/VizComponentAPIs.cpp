@@ -219,9 +219,14 @@ namespace vzm
     {
         std::vector<VID> children;
         COMP_TRANSFORM(tc, ett, ins, children);
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
         for (auto it = tc.getChildrenBegin(ins); it != tc.getChildrenEnd(ins); it++)
         {
             utils::Entity ett_child = tc.getEntity(*it);
+            if (actor_res && actor_res->IsInternalEntity(ett_child))
+            {
+                continue;
+            }
             children.push_back(ett_child.getId());
         }
         return children;
@@ -160,6 +160,8 @@ namespace vzm
         FONT,
     };
 
+    class VzEngineApp;
+
     struct API_EXPORT VzBaseComp
     {
     private:
@@ -198,6 +200,7 @@ namespace vzm
         float scale_[3] = {1.0f, 1.0f, 1.0f};
         bool matrixAutoUpdate_ = false;
 
+        friend class VzEngineApp; // bulk transform updates write the cached TRS directly
         void setQuaternionFromEuler();
         void setEulerFromQuaternion();
     public:
@@ -21,6 +21,7 @@
 //#include "FIncludes.h"
 #include "backend/VzAssetLoader.h"
 #include "backend/VzAssetExporter.h"
+#include "backend/VzTextureStreamer.h"
 using namespace vzm;
 
 //////////////////////////////
@@ -102,6 +103,8 @@ enum MaterialSource {
 };
 
 gltfio::MaterialProvider* gMaterialProvider = nullptr;
+gltfio::MaterialPackageCache* gMaterialPackageCache = nullptr;
+vzm::VzTextureStreamer* gTextureStreamer = nullptr;
 std::vector<std::string> gMProp = {
             "baseColor",              //!< float4, all shading models
             "roughness",               //!< float,  lit shading models only
@@ -239,7 +242,15 @@ namespace vzm
 
         // optional... test later
         // createUbershaderProvider(gEngine, UBERARCHIVE_DEFAULT_DATA, UBERARCHIVE_DEFAULT_SIZE);
-        gMaterialProvider = createJitShaderProvider(gEngine, OPTIMIZE_MATERIALS);
+        // compiled material packages are kept on disk so that later sessions skip the shader compiler
+        std::string material_cache = arguments.GetParam("material-cache",
+            utils::Path::concat(utils::Path::getTemporaryDirectory(), "vzm_material_cache").getPath());
+        gMaterialPackageCache = new gltfio::MaterialPackageCache(material_cache);
+        gMaterialProvider = createJitShaderProvider(gEngine, OPTIMIZE_MATERIALS,
+            gMaterialPackageCache->isEnabled() ? material_cache.c_str() : nullptr);
+
+        const int texture_budget_mb = arguments.GetParam("texture-budget-mb", 1024);
+        gTextureStreamer = new VzTextureStreamer(*gEngine, size_t(std::max(texture_budget_mb, 0)) << 20);
 
         // default resources
         {
@@ -327,6 +338,10 @@ namespace vzm
 
         gEngineApp->Destroy();
 
+        // waits for the loads still running, the streamed textures have been destroyed with their components
+        delete gTextureStreamer;
+        gTextureStreamer = nullptr;
+
         if (gDummySwapChain) {
             gEngine->destroy(gDummySwapChain);
             gDummySwapChain = nullptr;
@@ -335,6 +350,8 @@ namespace vzm
         gMaterialProvider->destroyMaterials();
         delete gMaterialProvider;
         gMaterialProvider = nullptr;
+        delete gMaterialPackageCache;
+        gMaterialPackageCache = nullptr;
 
         delete& ncm;
 
@@ -528,6 +545,49 @@ namespace vzm
         return gEngineApp->GetVzComponentsByType(type, components);
     }
 
+    size_t SetSceneCompTransforms(const VID* vids, const size_t count, const float* s, const float* q, const float* t)
+    {
+        CHECK_API_VALIDITY(0);
+        return gEngineApp->SetSceneCompTransforms(vids, count, s, q, t);
+    }
+
+    size_t SetSceneCompMatrices(const VID* vids, const size_t count, const float* m, const bool additiveTransform, const bool rowMajor)
+    {
+        CHECK_API_VALIDITY(0);
+        return gEngineApp->SetSceneCompMatrices(vids, count, m, additiveTransform, rowMajor);
+    }
+
+    size_t SetMIParameters(const VID* vidMIs, const size_t count, const VzMI::ParamHandle& handle, const void* values, const size_t stride)
+    {
+        CHECK_API_VALIDITY(0);
+        if (vidMIs == nullptr || values == nullptr || !handle.IsValid())
+        {
+            return 0;
+        }
+        static constexpr size_t type_sizes[] = {
+            sizeof(bool), sizeof(math::bool2), sizeof(math::bool3), sizeof(math::bool4),
+            sizeof(float), sizeof(float2), sizeof(float3), sizeof(float4),
+            sizeof(int), sizeof(int2), sizeof(int3), sizeof(int4),
+            sizeof(uint), sizeof(uint2), sizeof(uint3), sizeof(uint4),
+            sizeof(mat3f), sizeof(mat4f),
+        };
+        if ((size_t)handle.type >= std::size(type_sizes))
+        {
+            return 0;
+        }
+        const size_t element_stride = stride > 0 ? stride : type_sizes[(size_t)handle.type];
+        size_t num_updated = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            VzMI* mi = gEngineApp->GetVzComponent<VzMI>(vidMIs[i]);
+            if (mi && mi->SetParameter(handle, (const uint8_t*)values + i * element_stride))
+            {
+                ++num_updated;
+            }
+        }
+        return num_updated;
+    }
+
     size_t GetSceneCompoenentVids(const SCENE_COMPONENT_TYPE compType, const VID sceneVid, std::vector<VID>& vids, const bool isRenderableOnly)
     {
         CHECK_API_VALIDITY(0);
@@ -608,13 +668,21 @@ namespace vzm
         return gEngineApp->CreateTestActor(modelName);
     }
 
-    VzActor* LoadModelFileIntoActors(const std::string& filename, std::vector<VzActor*>& actors)
+    VzActor* LoadModelFileIntoActors(const std::string& filename, std::vector<VzActor*>& actors,
+        const vzm::ParamMap<std::string>& options)
     {
         CHECK_API_VALIDITY(nullptr);
-        gEngineApp->LoadMeshFile(filename, actors);
+        gEngineApp->LoadMeshFile(filename, actors, options);
         return actors.size() > 0 ? actors[0] : nullptr;
     }
 
+    VzActor* LoadPointCloudIntoActor(const std::string& filename, const std::string& actorName,
+        const vzm::ParamMap<std::string>& options)
+    {
+        CHECK_API_VALIDITY(nullptr);
+        return gEngineApp->LoadPointCloud(filename, actorName, options);
+    }
+
     static std::ifstream::pos_type getFileSize(const char* filename) {
         std::ifstream in(filename, std::ifstream::ate | std::ifstream::binary);
         return in.tellg();
@@ -808,14 +876,31 @@ namespace vzm
         return v_asset;
     }
     
-    void ExportAssetToGlb(const VZ_NONNULL VzAsset* v_asset, const std::string& filename)
+    void ExportAssetToGlb(const VZ_NONNULL VzAsset* v_asset, const std::string& filename,
+        const vzm::ParamMap<std::string>& options)
     {
         CHECK_API_VALIDITY( );
         AssetVID vid_asset = v_asset->GetVID();
         VzAssetRes& asset_res = *gEngineApp->GetAssetRes(vid_asset);
 
         filament::gltfio::VzAssetExpoter* asset_exporter = gEngineApp->GetGltfAssetExpoter();
-        asset_exporter->ExportToGlb(v_asset, filename);
+        asset_exporter->ExportToGlb(v_asset, filename, options);
+    }
+
+    void SetTextureStreamingBudget(const size_t budgetMB)
+    {
+        CHECK_API_VALIDITY( );
+        gTextureStreamer->SetBudget(budgetMB << 20);
+    }
+
+    void GetTextureStreamingStats(size_t& residentBytes, size_t& budgetBytes, size_t& pendingLoads, size_t& textureCount)
+    {
+        CHECK_API_VALIDITY( );
+        VzTextureStreamer::Stats stats = gTextureStreamer->GetStats();
+        residentBytes = stats.residentBytes;
+        budgetBytes = stats.budgetBytes;
+        pendingLoads = stats.pendingLoads;
+        textureCount = stats.textureCount;
     }
 
     float GetAsyncLoadProgress()
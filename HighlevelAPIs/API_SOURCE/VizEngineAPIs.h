@@ -5,6 +5,9 @@ namespace vzm
 {
     // This must be called before using engine APIs
     //  - paired with DeinitEngineLib()
+    //  - arguments : "api" ("opengl"|"vulkan"), "vulkan-gpu-hint",
+    //                "material-cache" (folder for compiled material packages, "" disables, default is in the temp folder),
+    //                "texture-budget-mb" (int, memory for the streamed textures, default 1024)
     extern "C" API_EXPORT VZRESULT InitEngineLib(const vzm::ParamMap<std::string>& arguments = vzm::ParamMap<std::string>());
     extern "C" API_EXPORT VZRESULT DeinitEngineLib();
     extern "C" API_EXPORT VZRESULT ReleaseWindowHandlerTasks(void* window);
@@ -42,17 +45,53 @@ namespace vzm
     // Get Component IDs in a scene
     //  - return # of scene Components 
     extern "C" API_EXPORT size_t GetSceneCompoenentVids(const SCENE_COMPONENT_TYPE compType, const VID sceneVid, std::vector<VID>& vids, const bool isRenderableOnly = false);	// Get CameraParams and return its pointer registered in renderer
+    // Set local transforms of many scene components (actor, light, camera) at once
+    //  - s (float3), q (float4), t (float3) are packed arrays of count elements, nullptr keeps the current values
+    //  - the world transforms are updated once for the whole batch
+    //  - a component listed more than once takes its last entry
+    //  - return # of updated components
+    extern "C" API_EXPORT size_t SetSceneCompTransforms(const VID* vids, const size_t count,
+        const float* s = nullptr, const float* q = nullptr, const float* t = nullptr);
+    //  - m is a packed array of count 4x4 matrices (same conventions as VzSceneComp::SetMatrix)
+    extern "C" API_EXPORT size_t SetSceneCompMatrices(const VID* vids, const size_t count, const float* m,
+        const bool additiveTransform = false, const bool rowMajor = false);
+    // Write one parameter into many material instances, e.g., per-frame colors or clipping planes
+    //  - the handle comes from VzMI::GetParameterHandle and MIs of other materials are skipped
+    //  - values holds count elements of the handle's type, stride bytes apart (0 means tightly packed)
+    //  - return # of updated material instances
+    extern "C" API_EXPORT size_t SetMIParameters(const VID* vidMIs, const size_t count,
+        const VzMI::ParamHandle& handle, const void* values, const size_t stride = 0);
     // Load a system actor and return the actor
     //  - return zero in case of failure
     extern "C" API_EXPORT VzActor* LoadTestModelIntoActor(const std::string& modelName);
-    // Load a mesh file (obj and stl) into actors and return the first actor
+    // Load a mesh file (obj, stl and filamesh) into actors and return the first actor
+    //  - options : "optimize-mesh" (bool, default false), "lod-levels" (int, default 0),
+    //              "lod-reduction" (float, default 0.5), "lod-max-error" (float, relative to the mesh extent, default 0.05)
+    //  - filamesh files (and packs of them, one actor per mesh) are memory-mapped and uploaded without copies,
+    //    the options above are ignored since their processing happens offline in the filamesh tool
     //  - return zero in case of failure
-    extern "C" API_EXPORT VzActor* LoadModelFileIntoActors(const std::string& filename, std::vector<VzActor*>& actors);
+    extern "C" API_EXPORT VzActor* LoadModelFileIntoActors(const std::string& filename, std::vector<VzActor*>& actors,
+        const vzm::ParamMap<std::string>& options = vzm::ParamMap<std::string>());
+    // Load a large point cloud (ply, or xyz-like text files) into an actor drawn with an octree level of detail
+    //  - options : "point-budget" (int, max. points drawn per frame, default 10000000),
+    //              "pixel-error" (float, max. projected point spacing in pixels, default 2),
+    //              "point-size" (float, in pixels, default 2), "cache" (string, folder of the octree)
+    //  - the octree is built once and reused until the file changes, by default in the temp folder
+    //  - the actor is placed at the center of the points, the nodes are streamed while rendering
+    //  - return zero in case of failure
+    extern "C" API_EXPORT VzActor* LoadPointCloudIntoActor(const std::string& filename, const std::string& actorName,
+        const vzm::ParamMap<std::string>& options = vzm::ParamMap<std::string>());
     // Load gltf components into a new scene and return the asset ID
     //  - the lifespan of resComponents follows that of the associated asset (vidAsset) and cannot be deleted by the client
     //  - return zero in case of failure
     extern "C" API_EXPORT VzAsset* LoadFileIntoAsset(const std::string& filename, const std::string& assetName);
     extern "C" API_EXPORT float GetAsyncLoadProgress();
+    // Memory budget of the textures loaded with VzTexture::StreamImage
+    //  - the finest mips of the least visible textures are dropped until the resident ones fit
+    //  - the coarse mips (up to 128x128) of every streamed texture are always resident
+    extern "C" API_EXPORT void SetTextureStreamingBudget(const size_t budgetMB);
+    extern "C" API_EXPORT void GetTextureStreamingStats(size_t& residentBytes, size_t& budgetBytes,
+        size_t& pendingLoads, size_t& textureCount);
     // Get a graphics render target view 
     //  - Must belong to the internal scene
     extern "C" API_EXPORT void* GetGraphicsSharedRenderTarget();
@@ -63,5 +102,8 @@ namespace vzm
     //  - return canvas VID (use this as a camVid)
     extern "C" API_EXPORT VID DisplayEngineProfiling(const int w, const int h, const bool displayProfile = true, const bool displayEngineStates = true);
     
-    extern "C" API_EXPORT void ExportAssetToGlb(const VZ_NONNULL VzAsset* asset, const std::string& filename);
+    // Export the asset with its current transforms, material factors and morph weights into a GLB file
+    //  - options : "meshopt-compression" (bool, default false), "mesh-quantization" (bool, default false)
+    extern "C" API_EXPORT void ExportAssetToGlb(const VZ_NONNULL VzAsset* asset, const std::string& filename,
+        const vzm::ParamMap<std::string>& options = vzm::ParamMap<std::string>());
 }
@@ -3,17 +3,23 @@
 #include "backend/VzAssetLoader.h"
 #include "backend/VzAssetExporter.h"
 #include "backend/VzMeshAssimp.h"
+#include "backend/VzMeshFilamesh.h"
+#include "backend/VzPointCloud.h"
+#include "backend/VzTextureStreamer.h"
 #include "VzNameComponents.hpp"
 
 #include "FIncludes.h"
 
 #include <filesystem>
 #include <iostream>
+#include <unordered_set>
 
 extern Engine* gEngine;
 extern Material* gMaterialTransparent; // do not release
 extern vzm::VzEngineApp* gEngineApp;
 extern gltfio::MaterialProvider* gMaterialProvider;
+extern gltfio::MaterialPackageCache* gMaterialPackageCache;
+extern vzm::VzTextureStreamer* gTextureStreamer;
 
 namespace vzm
 {
@@ -42,6 +48,27 @@ namespace vzm
             getDescendants(ett_child.getId(), decendants);
         }
     }
+    Box instanceBounds(const Box& box, const math::mat4f* transforms, const size_t count)
+    {
+        math::float3 bmin(std::numeric_limits<float>::max());
+        math::float3 bmax(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Box b = Box::transform(transforms[i].upperLeft(), transforms[i][3].xyz, box);
+            bmin = min(bmin, b.getMin());
+            bmax = max(bmax, b.getMax());
+        }
+        return Box().set(bmin, bmax);
+    }
+    void destroyInstanceChunk(const utils::Entity ettChunk)
+    {
+        for (auto& it : *gEngineApp->GetScenes())
+        {
+            it.second->remove(ettChunk);
+        }
+        gEngine->destroy(ettChunk);
+        utils::EntityManager::get().destroy(ettChunk);
+    }
     void cubeToScene(const VID vidCubeRenderable, const VID vidCube)
     {
         const Entity ettCubeRenderable = Entity::import(vidCubeRenderable);
@@ -402,6 +429,11 @@ namespace vzm
     std::vector<std::vector<MInstanceVID>>& VzActorRes::GetMIVariants() { return vidMIVariants_; }
     VzActorRes::~VzActorRes()
     {
+        if (pointCloud)
+        {
+            pointCloud.reset();
+            gEngineApp->RemoveComponent(vidMIs_[0]);
+        }
         if (isSprite)
         {
             gEngineApp->RemoveComponent(vidMIs_[0]);
@@ -414,6 +446,30 @@ namespace vzm
         }
         assert(intrinsicVB == nullptr && intrinsicIB == nullptr && intrinsicTexture == nullptr);
 
+        // the renderables must go before the instance buffers they refer to
+        if (!instanceRenderables.empty())
+        {
+            gEngine->getRenderableManager().destroy(instanceRenderables[0]);
+            for (size_t i = 1, n = instanceRenderables.size(); i < n; ++i)
+            {
+                destroyInstanceChunk(instanceRenderables[i]);
+            }
+        }
+        for (InstanceBuffer* instance_buffer : instanceBuffers)
+        {
+            gEngine->destroy(instance_buffer);
+        }
+    }
+    bool VzActorRes::IsInternalEntity(const utils::Entity ett) const
+    {
+        for (size_t i = 1, n = instanceRenderables.size(); i < n; ++i)
+        {
+            if (instanceRenderables[i] == ett)
+            {
+                return true;
+            }
+        }
+        return pointCloud && pointCloud->IsNodeEntity(ett);
     }
 #pragma endregion
 
@@ -440,6 +496,13 @@ namespace vzm
                     gEngine->destroy(prim.morphTargetBuffer);
                     currentMTBs_.erase(prim.morphTargetBuffer);
                 }
+                for (IndexBuffer* lod : prim.lods)
+                {
+                    if (lod && currentIBs_.find(lod) != currentIBs_.end()) {
+                        gEngine->destroy(lod);
+                        currentIBs_.erase(lod);
+                    }
+                }
             }
         }
     }
@@ -451,6 +514,7 @@ namespace vzm
             currentVBs_.insert(prim.vertices);
             currentIBs_.insert(prim.indices);
             currentMTBs_.insert(prim.morphTargetBuffer);
+            currentIBs_.insert(prim.lods.begin(), prim.lods.end());
         }
     }
     std::vector<VzPrimitive>* VzGeometryRes::Get() { return &primitives_; }
@@ -633,7 +697,109 @@ namespace vzm
         }
     } vGltfIo;
 
+#pragma region // VzComponentIndex
+    void VzComponentIndex::Add(VzBaseComp* comp)
+    {
+        auto it = typeIds_.try_emplace(comp->GetType(), (TypeId)typeMembers_.size());
+        if (it.second)
+        {
+            typeMembers_.emplace_back();
+        }
+        // the slot may already hold the scene membership assigned before the component was created
+        Slot& slot = slots_[comp->GetVID()];
+        assert(slot.type == INVALID_TYPE);
+        std::vector<VzBaseComp*>& members = typeMembers_[it.first->second];
+        slot.type = it.first->second;
+        slot.typeIndex = (uint32_t)members.size();
+        members.push_back(comp);
+    }
+    void VzComponentIndex::Remove(const VID vid)
+    {
+        auto it = slots_.find(vid);
+        if (it == slots_.end())
+        {
+            return;
+        }
+        Slot& slot = it->second;
+        if (slot.type != INVALID_TYPE)
+        {
+            std::vector<VzBaseComp*>& members = typeMembers_[slot.type];
+            VzBaseComp* last = members.back();
+            members[slot.typeIndex] = last;
+            slots_[last->GetVID()].typeIndex = slot.typeIndex;
+            members.pop_back();
+        }
+        removeFromScene(vid, slot);
+        slots_.erase(it);
+    }
+    void VzComponentIndex::SetScene(const VID vid, const SceneVID vidScene)
+    {
+        Slot& slot = slots_[vid];
+        if (slot.inScene && slot.scene == vidScene)
+        {
+            return;
+        }
+        removeFromScene(vid, slot);
+        std::vector<VID>& members = sceneMembers_[vidScene];
+        slot.inScene = true;
+        slot.scene = vidScene;
+        slot.sceneIndex = (uint32_t)members.size();
+        members.push_back(vid);
+    }
+    void VzComponentIndex::removeFromScene(const VID vid, Slot& slot)
+    {
+        if (!slot.inScene)
+        {
+            return;
+        }
+        auto it = sceneMembers_.find(slot.scene);
+        assert(it != sceneMembers_.end());
+        std::vector<VID>& members = it->second;
+        VID last = members.back();
+        members[slot.sceneIndex] = last;
+        if (last != vid)
+        {
+            slots_[last].sceneIndex = slot.sceneIndex;
+        }
+        members.pop_back();
+        if (members.empty())
+        {
+            sceneMembers_.erase(it);
+        }
+        slot.inScene = false;
+    }
+    VzComponentIndex::TypeId VzComponentIndex::FindType(const std::string& type) const
+    {
+        auto it = typeIds_.find(type);
+        return it == typeIds_.end() ? INVALID_TYPE : it->second;
+    }
+    const std::vector<VzBaseComp*>* VzComponentIndex::GetComponents(const TypeId type) const
+    {
+        return type < typeMembers_.size() ? &typeMembers_[type] : nullptr;
+    }
+    const std::vector<VID>* VzComponentIndex::GetSceneMembers(const SceneVID vidScene) const
+    {
+        auto it = sceneMembers_.find(vidScene);
+        return it == sceneMembers_.end() ? nullptr : &it->second;
+    }
+#pragma endregion
+
 #pragma region // VzEngineApp
+    std::pair<std::unordered_map<VID, std::unique_ptr<VzBaseComp>>::iterator, bool> VzEngineApp::emplaceComponent(
+        const VID vid, std::unique_ptr<VzBaseComp>&& comp)
+    {
+        auto it = vzCompMap_.emplace(vid, std::move(comp));
+        if (it.second)
+        {
+            compIndex_.Add(it.first->second.get());
+        }
+        return it;
+    }
+    void VzEngineApp::setSceneOf(std::unordered_map<VID, SceneVID>::iterator it, const SceneVID vidScene)
+    {
+        it->second = vidScene;
+        compIndex_.SetScene(it->first, vidScene);
+    }
     bool VzEngineApp::removeScene(SceneVID vidScene)
     {
         Scene* scene = GetScene(vidScene);
@@ -652,7 +818,7 @@ namespace vzm
                 // there can be intrinsic entities in the scene
                 auto it = actorSceneMap_.find(vid);
                 if (it != actorSceneMap_.end()) {
-                    it->second = 0;
+                    setSceneOf(it, 0);
                     ++retired_ett_count;
                 }
             }
@@ -660,7 +826,7 @@ namespace vzm
             {
                 auto it = lightSceneMap_.find(vid);
                 if (it != lightSceneMap_.end()) {
-                    it->second = 0;
+                    setSceneOf(it, 0);
                     ++retired_ett_count;
                 }
             }
@@ -670,7 +836,7 @@ namespace vzm
                 auto it = camSceneMap_.find(vid);
                 if (it != camSceneMap_.end()) {
                     backlog::post("cam VID : " + std::to_string(ett.getId()), backlog::LogLevel::Default);
-                    it->second = 0;
+                    setSceneOf(it, 0);
                     ++retired_ett_count;
                 }
                 else
@@ -685,7 +851,7 @@ namespace vzm
                     else
                     {
                         backlog::post("entity VID : " + std::to_string(ett.getId()) + " (" + ncm.GetName(ett) + ") is a hierarchy actor (kind of node)", backlog::LogLevel::Default);
-                        it->second = 0;
+                        setSceneOf(it, 0);
                         ++retired_ett_count;
                     }
                 }
@@ -694,11 +860,11 @@ namespace vzm
         gEngine->destroy(scene);    // maybe.. all views are set to nullptr scenes
         scenes_.erase(vidScene);
 
-        for (auto& it_c : camSceneMap_)
+        for (auto it_c = camSceneMap_.begin(); it_c != camSceneMap_.end(); it_c++)
         {
-            if (it_c.second == vidScene)
+            if (it_c->second == vidScene)
             {
-                it_c.second = 0;
+                setSceneOf(it_c, 0);
                 ++retired_ett_count;
             }
         }
@@ -716,6 +882,7 @@ namespace vzm
         sceneResMap_.erase(it_srm); // calls destructor
 
         vzCompMap_.erase(vidScene);
+        compIndex_.Remove(vidScene);
         return true;
     }
 
@@ -728,7 +895,7 @@ namespace vzm
         scenes_[vid] = gEngine->createScene();
         sceneResMap_[vid] = std::make_unique<VzSceneRes>();
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzScene>(vid, "CreateScene"));
+        auto it = emplaceComponent(vid, std::make_unique<VzScene>(vid, "CreateScene"));
         VzNameCompManager& ncm = VzNameCompManager::Get();
         ncm.CreateNameComp(ett, name);
         return (VzScene*)it.first->second.get();
@@ -742,7 +909,7 @@ namespace vzm
         renderPathMap_[vid] = std::make_unique<VzRenderPath>();
         VzRenderPath* renderPath = renderPathMap_[vid].get();
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzRenderer>(vid, "CreateRenderPath"));
+        auto it = emplaceComponent(vid, std::make_unique<VzRenderer>(vid, "CreateRenderPath"));
         VzNameCompManager& ncm = VzNameCompManager::Get();
         ncm.CreateNameComp(ett, name);
         return (VzRenderer*)it.first->second.get();
@@ -756,7 +923,7 @@ namespace vzm
         assetResMap_[vid] = std::make_unique<VzAssetRes>();
         ncm.CreateNameComp(ett, name);
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzAsset>(vid, "CreateAsset"));
+        auto it = emplaceComponent(vid, std::make_unique<VzAsset>(vid, "CreateAsset"));
         return (VzAsset*)it.first->second.get();
     }
     VzSkeleton* VzEngineApp::CreateSkeleton(const std::string& name, const SkeletonVID vidExist)
@@ -772,7 +939,7 @@ namespace vzm
         skeletonResMap_[vid] = std::make_unique<VzSkeletonRes>();
         ncm.CreateNameComp(ett, name);
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzAsset>(vid, "CreateSkeleton"));
+        auto it = emplaceComponent(vid, std::make_unique<VzAsset>(vid, "CreateSkeleton"));
         return (VzSkeleton*)it.first->second.get();
     }
     size_t VzEngineApp::GetVidsByName(const std::string& name, std::vector<VID>& vids)
@@ -977,38 +1144,19 @@ namespace vzm
     size_t VzEngineApp::GetSceneCompChildren(const SceneVID vidScene, std::vector<VID>& vidChildren)
     {
         vidChildren.clear();
-        auto& tcm = gEngine->getTransformManager();
-        for (auto& it : actorSceneMap_)
-        {
-            if (it.second == vidScene)
-            {
-                auto ins = tcm.getInstance(Entity::import(it.first));
-                if (tcm.getParent(ins).isNull())
-                {
-                    vidChildren.push_back(it.first);
-                }
-            }
-        }
-        for (auto& it : lightSceneMap_)
+        const std::vector<VID>* members = compIndex_.GetSceneMembers(vidScene);
+        if (members == nullptr)
         {
-            if (it.second == vidScene)
-            {
-                auto ins = tcm.getInstance(Entity::import(it.first));
-                if (tcm.getParent(ins).isNull())
-                {
-                    vidChildren.push_back(it.first);
-                }
-            }
+            return 0;
         }
-        for (auto& it : camSceneMap_)
+        // parents are owned by the TransformManager, so the root test stays per query
+        auto& tcm = gEngine->getTransformManager();
+        for (VID vid : *members)
         {
-            if (it.second == vidScene)
+            auto ins = tcm.getInstance(Entity::import(vid));
+            if (tcm.getParent(ins).isNull())
             {
-                auto ins = tcm.getInstance(Entity::import(it.first));
-                if (tcm.getParent(ins).isNull())
-                {
-                    vidChildren.push_back(it.first);
-                }
+                vidChildren.push_back(vid);
             }
         }
         return vidChildren.size();
@@ -1142,11 +1290,11 @@ namespace vzm
             auto itl = lightSceneMap_.find(it.getId());
             auto itc = camSceneMap_.find(it.getId());
             if (itr != actorSceneMap_.end())
-                itr->second = 0;
+                setSceneOf(itr, 0);
             else if (itl != lightSceneMap_.end())
-                itl->second = 0;
+                setSceneOf(itl, 0);
             else if (itc != camSceneMap_.end())
-                itc->second = 0;
+                setSceneOf(itc, 0);
             if (scene_src)
             {
                 scene_src->remove(it);
@@ -1164,11 +1312,21 @@ namespace vzm
                 auto itl = lightSceneMap_.find(it.getId());
                 auto itc = camSceneMap_.find(it.getId());
                 if (itr != actorSceneMap_.end())
-                    itr->second = vid_scene_dst;
+                    setSceneOf(itr, vid_scene_dst);
                 if (itl != lightSceneMap_.end())
-                    itl->second = vid_scene_dst;
+                    setSceneOf(itl, vid_scene_dst);
                 if (itc != camSceneMap_.end())
-                    itc->second = vid_scene_dst;
+                    setSceneOf(itc, vid_scene_dst);
+            }
+        }
+
+        // point cloud nodes are added to the scene when loaded, so the loaded ones follow their actor here
+        for (auto& it : entities_moving)
+        {
+            auto it_res = actorResMap_.find(it.getId());
+            if (it_res != actorResMap_.end() && it_res->second->pointCloud)
+            {
+                it_res->second->pointCloud->SyncScene();
             }
         }
         return true;
@@ -1210,12 +1368,12 @@ namespace vzm
         case SCENE_COMPONENT_TYPE::SPRITE_ACTOR:
         case SCENE_COMPONENT_TYPE::TEXT_SPRITE_ACTOR:
         {
-            actorSceneMap_[vid] = 0; // first creation
+            setSceneOf(actorSceneMap_.insert_or_assign(vid, 0).first, 0); // first creation
             actorResMap_[vid] = std::make_unique<VzActorRes>();
 
             auto it = compType == SCENE_COMPONENT_TYPE::SPRITE_ACTOR?
-                vzCompMap_.emplace(vid, std::make_unique<VzSpriteActor>(vid, "CreateSceneComponent")) :
-                vzCompMap_.emplace(vid, std::make_unique<VzTextSpriteActor>(vid, "CreateSceneComponent"));
+                emplaceComponent(vid, std::make_unique<VzSpriteActor>(vid, "CreateSceneComponent")) :
+                emplaceComponent(vid, std::make_unique<VzTextSpriteActor>(vid, "CreateSceneComponent"));
             v_comp = (VzSceneComp*)it.first->second.get();
 
             VzActorRes* actor_res = actorResMap_[vid].get();
@@ -1283,11 +1441,17 @@ namespace vzm
                         builder.targetApi(MaterialBuilder::TargetApi::VULKAN);
                     }
                     builder.material(code);
-                    Package result = builder.build(gEngine->getJobSystem());
-                    assert(result.isValid());
-                    Material* material = Material::Builder()
-                        .package(result.getData(), result.getSize())
-                        .build(*gEngine);
+                    const uint64_t cache_key = MaterialPackageCache::computeKey(*gEngine, code, strlen(code));
+                    Material* material = gMaterialPackageCache->load(*gEngine, cache_key);
+                    if (material == nullptr)
+                    {
+                        Package result = builder.build(gEngine->getJobSystem());
+                        assert(result.isValid());
+                        material = Material::Builder()
+                            .package(result.getData(), result.getSize())
+                            .build(*gEngine);
+                        gMaterialPackageCache->store(cache_key, result.getData(), result.getSize());
+                    }
                     vid_m = gEngineApp->CreateMaterial("_BUILDER_TEXT_SPRITE_MATERIAL", material, nullptr, true)->GetVID();
                     std::vector<Material::ParameterInfo> params(material->getParameterCount());
                     material->getParameters(&params[0], params.size());
@@ -1315,10 +1479,10 @@ namespace vzm
         case SCENE_COMPONENT_TYPE::ACTOR:
         {
             // RenderableManager::Builder... with entity registers the entity in the renderableEntities
-            actorSceneMap_[vid] = 0; // first creation
+            setSceneOf(actorSceneMap_.insert_or_assign(vid, 0).first, 0); // first creation
             actorResMap_[vid] = std::make_unique<VzActorRes>();
 
-            auto it = vzCompMap_.emplace(vid, std::make_unique<VzActor>(vid, "CreateSceneComponent"));
+            auto it = emplaceComponent(vid, std::make_unique<VzActor>(vid, "CreateSceneComponent"));
             v_comp = (VzSceneComp*)it.first->second.get();
             break;
         }
@@ -1328,7 +1492,7 @@ namespace vzm
         case SCENE_COMPONENT_TYPE::LIGHT_FOCUSED_SPOT:
         case SCENE_COMPONENT_TYPE::LIGHT_SPOT:
         {
-            lightSceneMap_[vid] = 0; // first creation
+            setSceneOf(lightSceneMap_.insert_or_assign(vid, 0).first, 0); // first creation
             lightResMap_[vid] = std::make_unique<VzLightRes>();
 
 #define LIGHT_BUILDER(LTYPE, VZCOMP) { if (!is_alive) LightManager::Builder(LightManager::Type::LTYPE)\
@@ -1338,7 +1502,7 @@ namespace vzm
                 .sunAngularRadius(1.9f)\
                 .castShadows(false)\
                 .build(*gEngine, ett);\
-            vzCompMap_.emplace(vid, std::make_unique<VZCOMP>(vid, "CreateSceneComponent")); break; }
+            emplaceComponent(vid, std::make_unique<VZCOMP>(vid, "CreateSceneComponent")); break; }
 
             switch (compType)
             {
@@ -1367,12 +1531,12 @@ namespace vzm
             {
                 camera = gEngine->getCameraComponent(ett);
             }
-            camSceneMap_[vid] = 0;
+            setSceneOf(camSceneMap_.insert_or_assign(vid, 0).first, 0);
             camResMap_[vid] = std::make_unique<VzCameraRes>();
             VzCameraRes* cam_res = camResMap_[vid].get();
             cam_res->SetCamera(camera);
 
-            auto it = vzCompMap_.emplace(vid, std::make_unique<VzCamera>(vid, "CreateSceneComponent"));
+            auto it = emplaceComponent(vid, std::make_unique<VzCamera>(vid, "CreateSceneComponent"));
             v_comp = (VzSceneComp*)it.first->second.get();
             v_comp->SetMatrixAutoUpdate(false);
             break;
@@ -1435,7 +1599,7 @@ namespace vzm
         MeshReader::Mesh mesh = MeshReader::loadMeshFromBuffer(gEngine, MONKEY_SUZANNE_DATA, nullptr, nullptr, mi);
         ncm.CreateNameComp(mesh.renderable, modelName);
         VID vid = mesh.renderable.getId();
-        actorSceneMap_[vid] = 0;
+        setSceneOf(actorSceneMap_.insert_or_assign(vid, 0).first, 0);
         actorResMap_[vid] = std::make_unique<VzActorRes>();
 
         auto& rcm = gEngine->getRenderableManager();
@@ -1451,7 +1615,7 @@ namespace vzm
         actor_res.SetGeometry(geo->GetVID());
         actor_res.SetMIs({ vid_mi });
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzActor>(vid, "CreateTestActor"));
+        auto it = emplaceComponent(vid, std::make_unique<VzActor>(vid, "CreateTestActor"));
         VzActor* v_actor = (VzActor*)it.first->second.get();
         return v_actor;
     }
@@ -1479,7 +1643,7 @@ namespace vzm
             geo_res.aabb.max = max(prim.aabb.max, geo_res.aabb.max);
         }
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzGeometry>(vid, "CreateGeometry"));
+        auto it = emplaceComponent(vid, std::make_unique<VzGeometry>(vid, "CreateGeometry"));
         return (VzGeometry*)it.first->second.get();;
     }
     VzMaterial* VzEngineApp::CreateMaterial(const std::string& name,
@@ -1520,7 +1684,7 @@ namespace vzm
                 m_res.allowedParamters[param.name] = param;
             }
         }
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzMaterial>(vid, "CreateMaterial"));
+        auto it = emplaceComponent(vid, std::make_unique<VzMaterial>(vid, "CreateMaterial"));
         return (VzMaterial*)it.first->second.get();
     }
     VzMI* VzEngineApp::CreateMaterialInstance(const std::string& name,
@@ -1554,7 +1718,7 @@ namespace vzm
         mi_res.assetOwner = (filament::gltfio::FilamentAsset*)assetOwner;
         mi_res.isSystem = isSystem;
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzMI>(vid, "CreateMaterialInstance"));
+        auto it = emplaceComponent(vid, std::make_unique<VzMI>(vid, "CreateMaterialInstance"));
         return (VzMI*)it.first->second.get();
     }
     VzTexture* VzEngineApp::CreateTexture(const std::string& name,
@@ -1578,7 +1742,7 @@ namespace vzm
         tex_res.sampler.setMinFilter(TextureSampler::MinFilter::LINEAR_MIPMAP_LINEAR);
         tex_res.sampler.setWrapModeS(TextureSampler::WrapMode::REPEAT);
         tex_res.sampler.setWrapModeT(TextureSampler::WrapMode::REPEAT);
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzTexture>(vid, "CreateTexture"));
+        auto it = emplaceComponent(vid, std::make_unique<VzTexture>(vid, "CreateTexture"));
         return (VzTexture*)it.first->second.get();
     }
     VzFont* VzEngineApp::CreateFont(const std::string& name)
@@ -1592,7 +1756,7 @@ namespace vzm
         VID vid = ett.getId();
         fontResMap_[vid] = std::make_unique<VzFontRes>();
 
-        auto it = vzCompMap_.emplace(vid, std::make_unique<VzFont>(vid, "CreateFont"));
+        auto it = emplaceComponent(vid, std::make_unique<VzFont>(vid, "CreateFont"));
         return (VzFont*)it.first->second.get();
     }
 
@@ -1626,20 +1790,34 @@ namespace vzm
             mis.push_back(GetMIRes(it_mi)->mi);
         }
 
-        RenderableManager::Builder builder(primitives.size());
-
-        for (size_t index = 0, n = primitives.size(); index < n; ++index)
-        {
-            VzPrimitive* primitive = &primitives[index];
-            MaterialInstance* mi = mis.size() > index ? mis[index] : nullptr;
-            RenderableManager::PrimitiveType prim_type = (RenderableManager::PrimitiveType)primitive->ptype;
-            builder.material(index, mi);
-            builder.geometry(index, prim_type, primitive->vertices, primitive->indices);
-            if (primitive->morphTargetBuffer)
+        // every instance chunk needs its own builder
+        auto setup_builder = [&](RenderableManager::Builder& builder)
             {
-                builder.morphing(primitive->morphTargetBuffer);
-            }
-        }
+                for (size_t index = 0, n = primitives.size(); index < n; ++index)
+                {
+                    VzPrimitive* primitive = &primitives[index];
+                    MaterialInstance* mi = mis.size() > index ? mis[index] : nullptr;
+                    RenderableManager::PrimitiveType prim_type = (RenderableManager::PrimitiveType)primitive->ptype;
+                    builder.material(index, mi);
+                    if (primitive->indexCount > 0)
+                    {
+                        builder.geometry(index, prim_type, primitive->vertices, primitive->indices,
+                            primitive->indexOffset, primitive->indexCount);
+                    }
+                    else
+                    {
+                        builder.geometry(index, prim_type, primitive->vertices, primitive->indices);
+                    }
+                    if (primitive->morphTargetBuffer)
+                    {
+                        builder.morphing(primitive->morphTargetBuffer);
+                    }
+                }
+                builder
+                    .culling(actor_res->culling)
+                    .castShadows(actor_res->castShadow)
+                    .receiveShadows(actor_res->receiveShadow);
+            };
 
         utils::Entity ett_actor = utils::Entity::import(vid);
 
@@ -1650,12 +1828,318 @@ namespace vzm
             box = Box().set(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
         }
 
-        builder
-            .boundingBox(box)
-            .culling(actor_res->culling)
-            .castShadows(actor_res->castShadow)
-            .receiveShadows(actor_res->receiveShadow)
-            .build(*gEngine, ett_actor);
+        // the renderables of the previous instance chunks go first, their buffers once they're replaced
+        std::vector<InstanceBuffer*> stale_buffers = std::move(actor_res->instanceBuffers);
+        actor_res->instanceBuffers.clear();
+        for (size_t i = 1, n = actor_res->instanceRenderables.size(); i < n; ++i)
+        {
+            destroyInstanceChunk(actor_res->instanceRenderables[i]);
+        }
+        actor_res->instanceRenderables.clear();
+
+        const size_t instance_count = actor_res->instanceTransforms.size();
+        if (instance_count == 0)
+        {
+            RenderableManager::Builder builder(primitives.size());
+            setup_builder(builder);
+            builder
+                .boundingBox(box)
+                .build(*gEngine, ett_actor);
+        }
+        else
+        {
+            auto& rcm = gEngine->getRenderableManager();
+            auto& tcm = gEngine->getTransformManager();
+            const size_t chunk_size = gEngine->getMaxAutomaticInstances();
+            const math::mat4f* transforms = actor_res->instanceTransforms.data();
+            actor_res->instanceBox = box;
+            SceneVID vid_scene = GetSceneVidBelongTo(vid);
+            Scene* scene = GetScene(vid_scene);
+            for (size_t offset = 0; offset < instance_count; offset += chunk_size)
+            {
+                const size_t count = std::min(chunk_size, instance_count - offset);
+                InstanceBuffer* instance_buffer = InstanceBuffer::Builder(count)
+                    .localTransforms(transforms + offset)
+                    .build(*gEngine);
+
+                utils::Entity ett_chunk = ett_actor;
+                if (offset > 0)
+                {
+                    // follows the actor transform and scene, like a child component would
+                    ett_chunk = utils::EntityManager::get().create();
+                    tcm.create(ett_chunk, tcm.getInstance(ett_actor), math::mat4f());
+                    if (scene)
+                    {
+                        scene->addEntity(ett_chunk);
+                    }
+                }
+
+                RenderableManager::Builder chunk_builder(primitives.size());
+                setup_builder(chunk_builder);
+                chunk_builder
+                    .boundingBox(instanceBounds(box, transforms + offset, count))
+                    .instances(count, instance_buffer)
+                    .build(*gEngine, ett_chunk);
+
+                actor_res->instanceBuffers.push_back(instance_buffer);
+                actor_res->instanceRenderables.push_back(ett_chunk);
+            }
+
+            auto ins_actor = rcm.getInstance(ett_actor);
+            for (size_t i = 1, n = actor_res->instanceRenderables.size(); i < n; ++i)
+            {
+                auto ins = rcm.getInstance(actor_res->instanceRenderables[i]);
+                rcm.setLayerMask(ins, 0xff, rcm.getLayerMask(ins_actor));
+                rcm.setPriority(ins, actor_res->priority);
+            }
+        }
+
+        for (InstanceBuffer* instance_buffer : stale_buffers)
+        {
+            gEngine->destroy(instance_buffer);
+        }
+
+        // left empty without LODs, the renderer skips such actors
+        const bool has_lods = std::any_of(primitives.begin(), primitives.end(),
+            [](const VzPrimitive& prim) { return !prim.lods.empty(); });
+        actor_res->lodLevels.assign(has_lods ? primitives.size() : 0, 0);
+    }
+    void VzEngineApp::UpdateInstances(const ActorVID vid, const size_t offset, const size_t count)
+    {
+        VzActorRes* actor_res = GetActorRes(vid);
+        if (actor_res == nullptr || count == 0 || actor_res->instanceBuffers.empty())
+        {
+            return;
+        }
+        assert(offset + count <= actor_res->instanceTransforms.size());
+
+        auto& rcm = gEngine->getRenderableManager();
+        const size_t chunk_size = gEngine->getMaxAutomaticInstances();
+        const size_t instance_count = actor_res->instanceTransforms.size();
+        const math::mat4f* transforms = actor_res->instanceTransforms.data();
+        for (size_t chunk = offset / chunk_size, last = (offset + count - 1) / chunk_size; chunk <= last; ++chunk)
+        {
+            const size_t chunk_offset = chunk * chunk_size;
+            const size_t chunk_count = std::min(chunk_size, instance_count - chunk_offset);
+            const size_t first = std::max(offset, chunk_offset);
+            const size_t end = std::min(offset + count, chunk_offset + chunk_count);
+            actor_res->instanceBuffers[chunk]->setLocalTransforms(transforms + first, end - first, first - chunk_offset);
+
+            // the whole chunk is refit, the untouched instances may have been bounding it
+            auto ins = rcm.getInstance(actor_res->instanceRenderables[chunk]);
+            rcm.setAxisAlignedBoundingBox(ins, instanceBounds(actor_res->instanceBox, transforms + chunk_offset, chunk_count));
+        }
+    }
+
+    template <typename COMPOSE>
+    size_t VzEngineApp::applyTransforms(const VID* vids, const size_t count, COMPOSE compose)
+    {
+        if (vids == nullptr || count == 0)
+        {
+            return 0;
+        }
+        auto& tcm = gEngine->getTransformManager();
+        std::vector<TransformUpdate> updates(count);
+
+        // a component listed more than once takes its last entry, as if the entries were applied in order,
+        // the others are skipped so that no two workers write the same component
+        size_t num_duplicates = 0;
+        {
+            std::unordered_set<VID> listed;
+            listed.reserve(count);
+            for (size_t i = count; i-- > 0;)
+            {
+                if (!listed.insert(vids[i]).second)
+                {
+                    updates[i].duplicate = true;
+                    ++num_duplicates;
+                }
+            }
+        }
+
+        // only lookups and per-component writes happen here, so the batch can be split across workers
+        auto resolve = [&](uint32_t start, uint32_t n)
+            {
+                for (uint32_t i = start, end = start + n; i < end; ++i)
+                {
+                    TransformUpdate& update = updates[i];
+                    const VID vid = vids[i];
+                    update.comp = nullptr;
+                    if (update.duplicate)
+                    {
+                        continue;
+                    }
+                    if (!actorSceneMap_.contains(vid) && !lightSceneMap_.contains(vid) && !camSceneMap_.contains(vid))
+                    {
+                        continue;
+                    }
+                    update.ins = tcm.getInstance(utils::Entity::import(vid));
+                    if (!update.ins.isValid())
+                    {
+                        continue;
+                    }
+                    update.comp = GetVzComponent<VzSceneComp>(vid);
+                    if (update.comp)
+                    {
+                        compose(i, update);
+                    }
+                }
+            };
+        static constexpr uint32_t PARALLEL_BATCH = 1024;
+        if (count < PARALLEL_BATCH * 2)
+        {
+            resolve(0, (uint32_t)count);
+        }
+        else
+        {
+            JobSystem& js = gEngine->getJobSystem();
+            auto* job = jobs::parallel_for(js, nullptr, 0u, (uint32_t)count,
+                std::cref(resolve), jobs::CountSplitter<PARALLEL_BATCH>());
+            js.runAndWait(job);
+        }
+
+        // a single hierarchy update instead of one per setTransform
+        size_t num_updated = 0;
+        tcm.openLocalTransformTransaction();
+        for (const TransformUpdate& update : updates)
+        {
+            if (update.comp)
+            {
+                tcm.setTransform(update.ins, update.local);
+                ++num_updated;
+            }
+        }
+        tcm.commitLocalTransformTransaction();
+        if (num_updated + num_duplicates != count)
+        {
+            backlog::post(std::to_string(count - num_duplicates - num_updated) + " of " + std::to_string(count - num_duplicates)
+                + " components have no transform", backlog::LogLevel::Warning);
+        }
+        return num_updated;
+    }
+    size_t VzEngineApp::SetSceneCompTransforms(const VID* vids, const size_t count,
+        const float* s, const float* q, const float* t)
+    {
+        return applyTransforms(vids, count, [s, q, t](const size_t i, TransformUpdate& update)
+            {
+                VzSceneComp* comp = update.comp;
+                if (s)
+                {
+                    *(float3*)comp->scale_ = ((const float3*)s)[i];
+                }
+                if (q)
+                {
+                    *(quatf*)comp->quaternion_ = ((const quatf*)q)[i];
+                    comp->setEulerFromQuaternion();
+                }
+                if (t)
+                {
+                    *(float3*)comp->position_ = ((const float3*)t)[i];
+                }
+                update.local = composeMatrix(*(float3*)comp->position_, *(quatf*)comp->quaternion_, *(float3*)comp->scale_);
+                comp->UpdateTimeStamp();
+            });
+    }
+    size_t VzEngineApp::SetSceneCompMatrices(const VID* vids, const size_t count,
+        const float* m, const bool additiveTransform, const bool rowMajor)
+    {
+        if (m == nullptr)
+        {
+            return 0;
+        }
+        auto& tcm = gEngine->getTransformManager();
+        return applyTransforms(vids, count, [&tcm, m, additiveTransform, rowMajor](const size_t i, TransformUpdate& update)
+            {
+                const mat4f& value = ((const mat4f*)m)[i];
+                const mat4f mat = rowMajor ? transpose(value) : value;
+                update.local = additiveTransform ? mat * tcm.getTransform(update.ins) : mat;
+                update.comp->UpdateTimeStamp();
+            });
+    }
+    void VzEngineApp::UpdateActorLOD(const ActorVID vid, const Camera& camera, const uint32_t viewportHeight)
+    {
+        VzActorRes* actor_res = GetActorRes(vid);
+        if (actor_res == nullptr || viewportHeight == 0)
+        {
+            return;
+        }
+        VzGeometryRes* geo_res = GetGeometryRes(actor_res->GetGeometryVid());
+        if (geo_res == nullptr)
+        {
+            return;
+        }
+        std::vector<VzPrimitive>& primitives = *geo_res->Get();
+        if (actor_res->lodLevels.size() != primitives.size())
+        {
+            return;
+        }
+
+        auto& rcm = gEngine->getRenderableManager();
+        auto& tcm = gEngine->getTransformManager();
+        utils::Entity ett_actor = utils::Entity::import(vid);
+        auto ins = rcm.getInstance(ett_actor);
+        if (!ins.isValid())
+        {
+            return;
+        }
+
+        // pixels covered by one world unit at unit distance (or at any distance for ortho)
+        const mat4 proj = camera.getProjectionMatrix();
+        const bool is_ortho = proj[3][3] == 1.0;
+        const double pixels_per_unit = std::abs(proj[1][1]) * 0.5 * viewportHeight;
+
+        const mat4f os2ws = tcm.getWorldTransform(tcm.getInstance(ett_actor));
+        const float ws_scale = std::sqrt(std::max({
+            length2(os2ws[0].xyz), length2(os2ws[1].xyz), length2(os2ws[2].xyz) }));
+        const Box box = rcm.getAxisAlignedBoundingBox(ins);
+        const double3 center_ws = ((mat4)os2ws * double4(box.center, 1.0)).xyz;
+        const double radius_ws = length(box.halfExtent) * ws_scale;
+        double distance = 1.0;
+        if (!is_ortho)
+        {
+            // nearest point of the bounding sphere, so nothing pops when the camera is inside it
+            distance = std::max(length(center_ws - camera.getPosition()) - radius_ws, camera.getNear());
+        }
+        const double pixels_per_os_unit = pixels_per_unit * ws_scale / distance;
+
+        const bool enabled = actor_res->lodEnabled;
+        for (size_t index = 0, n = primitives.size(); index < n; ++index)
+        {
+            VzPrimitive& prim = primitives[index];
+            if (prim.lods.empty())
+            {
+                continue;
+            }
+            int level = 0;
+            if (enabled)
+            {
+                for (size_t i = 0, m = prim.lods.size(); i < m; ++i)
+                {
+                    if (prim.lodErrors[i] * pixels_per_os_unit > actor_res->lodPixelError)
+                    {
+                        break;
+                    }
+                    level = (int)i + 1;
+                }
+            }
+            if (level == actor_res->lodLevels[index])
+            {
+                continue;
+            }
+            IndexBuffer* indices = level == 0 ? prim.indices : prim.lods[level - 1];
+            const bool ranged = level == 0 && prim.indexCount > 0;
+            rcm.setGeometryAt(ins, index, (RenderableManager::PrimitiveType)prim.ptype,
+                prim.vertices, indices, ranged ? prim.indexOffset : 0,
+                ranged ? prim.indexCount : indices->getIndexCount());
+            // instance chunks share the level of the actor
+            for (size_t i = 1, m = actor_res->instanceRenderables.size(); i < m; ++i)
+            {
+                rcm.setGeometryAt(rcm.getInstance(actor_res->instanceRenderables[i]), index,
+                    (RenderableManager::PrimitiveType)prim.ptype, prim.vertices, indices,
+                    ranged ? prim.indexOffset : 0, ranged ? prim.indexCount : indices->getIndexCount());
+            }
+            actor_res->lodLevels[index] = level;
+        }
     }
 
     VzGeometryRes* VzEngineApp::GetGeometryRes(const GeometryVID vidGeo)
@@ -1738,14 +2222,34 @@ namespace vzm
         return it->second.get();
     }
 
-    size_t VzEngineApp::LoadMeshFile(const std::string& filename, std::vector<VzActor*>& actors)
+    size_t VzEngineApp::LoadMeshFile(const std::string& filename, std::vector<VzActor*>& actors,
+        const vzm::ParamMap<std::string>& options)
     {
-        // Add geometry into the scene.
-        assimp::VzMeshAssimp* meshes = new assimp::VzMeshAssimp(*gEngine);
-        
         std::vector<ActorVID> loaded_actors;
-        meshes->addFromFile(filename, loaded_actors);
         actors.clear();
+
+        // filamesh files are mapped and uploaded in place, the rest goes through assimp
+        if (meshio::VzMeshFilamesh::IsFilamesh(filename))
+        {
+            meshio::VzMeshFilamesh filamesh(*gEngine);
+            filamesh.addFromFile(filename, loaded_actors);
+            for (size_t i = 0, n = loaded_actors.size(); i < n; ++i)
+            {
+                actors.push_back(gEngineApp->GetVzComponent<VzActor>(loaded_actors[i]));
+            }
+            return loaded_actors.size();
+        }
+
+        // Add geometry into the scene.
+        assimp::VzMeshAssimp* meshes = new assimp::VzMeshAssimp(*gEngine);
+
+        assimp::VzMeshAssimp::LodOptions lod_options;
+        lod_options.levels = options.GetParam("lod-levels", lod_options.levels);
+        lod_options.reduction = options.GetParam("lod-reduction", lod_options.reduction);
+        lod_options.maxError = options.GetParam("lod-max-error", lod_options.maxError);
+        lod_options.optimize = options.GetParam("optimize-mesh", lod_options.optimize);
+
+        meshes->addFromFile(filename, loaded_actors, lod_options);
         for (size_t i = 0, n = loaded_actors.size(); i < n; ++i)
         {
             actors.push_back(gEngineApp->GetVzComponent<VzActor>(loaded_actors[i]));
@@ -1754,6 +2258,85 @@ namespace vzm
         return loaded_actors.size();
     }
 
+    VzActor* VzEngineApp::LoadPointCloud(const std::string& filename, const std::string& name,
+        const vzm::ParamMap<std::string>& options)
+    {
+        VzPointCloud::Options cloud_options;
+        cloud_options.pointBudget = (size_t)options.GetParam("point-budget", (int)cloud_options.pointBudget);
+        cloud_options.pixelError = options.GetParam("pixel-error", cloud_options.pixelError);
+        cloud_options.pointSize = options.GetParam("point-size", cloud_options.pointSize);
+        cloud_options.cacheFolder = options.GetParam("cache", cloud_options.cacheFolder);
+
+        std::unique_ptr<VzPointCloud> cloud = VzPointCloud::Open(filename, cloud_options);
+        if (!cloud)
+        {
+            return nullptr;
+        }
+
+        MaterialVID vid_m = GetFirstVidByName("_BUILDER_POINT_CLOUD_MATERIAL");
+        if (vid_m == INVALID_VID) {
+            MaterialBuilder::init();
+            const char* vertex_code = R"(
+                void materialVertex(inout MaterialVertexInputs material) {
+                    gl_PointSize = materialParams.pointSize;
+                }
+            )";
+            const char* code = R"(
+                void material(inout MaterialInputs material) {
+                    prepareMaterial(material);
+                    material.baseColor = getColor();
+                }
+            )";
+            MaterialBuilder builder;
+            builder
+                .name("PointCloudMaterial")
+                .shading(Shading::UNLIT)
+                .parameter("pointSize",
+                           (MaterialBuilder::UniformType) UniformType::FLOAT,
+                           (MaterialBuilder::Precision) Precision::MEDIUM)
+                .require(MaterialBuilder::VertexAttribute::COLOR)
+#ifdef __ANDROID__
+                .platform(MaterialBuilder::Platform::MOBILE)
+#endif
+                .optimization(MaterialBuilder::Optimization::NONE);
+
+            if (gEngine->getBackend() == filament::backend::Backend::VULKAN)
+            {
+                builder.targetApi(MaterialBuilder::TargetApi::VULKAN);
+            }
+            builder.materialVertex(vertex_code);
+            builder.material(code);
+            const std::string shader_code = std::string(vertex_code) + code;
+            const uint64_t cache_key = MaterialPackageCache::computeKey(*gEngine, shader_code.c_str(), shader_code.size());
+            Material* material = gMaterialPackageCache->load(*gEngine, cache_key);
+            if (material == nullptr)
+            {
+                Package result = builder.build(gEngine->getJobSystem());
+                assert(result.isValid());
+                material = Material::Builder()
+                    .package(result.getData(), result.getSize())
+                    .build(*gEngine);
+                gMaterialPackageCache->store(cache_key, result.getData(), result.getSize());
+            }
+            vid_m = CreateMaterial("_BUILDER_POINT_CLOUD_MATERIAL", material, nullptr, true)->GetVID();
+        }
+
+        Material* m = materialResMap_[vid_m]->material;
+        MaterialInstance* mi = m->createInstance();
+        mi->setParameter("pointSize", cloud_options.pointSize);
+
+        VzActor* actor = (VzActor*)CreateSceneComponent(SCENE_COMPONENT_TYPE::ACTOR, name);
+        VzMI* v_mi = CreateMaterialInstance(name + "_mi", vid_m, mi);
+        VzActorRes* actor_res = GetActorRes(actor->GetVID());
+        actor_res->SetMIs({ v_mi->GetVID() });
+        actor_res->castShadow = false;
+        actor_res->receiveShadow = false;
+
+        cloud->Attach(actor->GetVID(), mi);
+        actor_res->pointCloud = std::move(cloud);
+        return actor;
+    }
+
     VzAssetLoader* VzEngineApp::GetGltfAssetLoader()
     {
         return vGltfIo.assetLoader;
@@ -1838,6 +2421,7 @@ namespace vzm
                         }
                     }
 
+                    gTextureStreamer->Remove(it_tx->first);
                     textureResMap_.erase(it_tx); // call destructor...
                     isRenderableResource = true;
                     backlog::post("Texture (" + name + ") has been removed", backlog::LogLevel::Default);
@@ -2035,6 +2619,7 @@ namespace vzm
             // the remaining etts (not engine-destory group)
 
             vzCompMap_.erase(vid);
+            compIndex_.Remove(vid);
 
             actorSceneMap_.erase(vid);
             actorResMap_.erase(vid);
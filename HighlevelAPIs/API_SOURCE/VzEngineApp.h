@@ -5,6 +5,8 @@
 #include "filament/VertexBuffer.h"
 #include "filament/IndexBuffer.h"
 #include "filament/MorphTargetBuffer.h"
+#include "filament/InstanceBuffer.h"
+#include "filament/TransformManager.h"
 
 #include "camutils/Manipulator.h"
 #include "filament/Box.h"
@@ -88,6 +90,16 @@ namespace vzm
         std::vector<int> slotIndices;
 
         PrimitiveType ptype = PrimitiveType::TRIANGLES;
+
+        // simplified index buffers over the same vertices, coarser with each level
+        //  - lodErrors[i] is the object-space geometric deviation of lods[i]
+        std::vector<IndexBuffer*> lods;
+        std::vector<float> lodErrors;
+
+        // range of the index buffer drawn by this primitive, zero indexCount draws the whole buffer
+        //  - used when several primitives share the buffers, e.g., the parts of a filamesh
+        uint32_t indexOffset = 0;
+        uint32_t indexCount = 0;
     };
 
     struct VzTextFormat {
@@ -160,6 +172,7 @@ namespace vzm
         CameraManipulator* GetCameraManipulator();
         void UpdateCameraWithCM(float deltaTime);
     };
+    class VzPointCloud;
     struct VzActorRes
     {
     private:
@@ -175,6 +188,19 @@ namespace vzm
         bool receiveShadow = true;
         uint8_t priority = 0x4;
 
+        // runtime LOD selection (geometries with simplified index buffers only)
+        bool lodEnabled = true;
+        float lodPixelError = 1.f; // max. projected simplification error in pixels
+        std::vector<int> lodLevels; // current level per primitive, 0 is the full-detail mesh, empty without LODs
+
+        // hardware instancing (see VzActor::SetInstances)
+        //  - instances are split into chunks of at most Engine::getMaxAutomaticInstances(), one renderable each
+        //  - instanceRenderables[0] is the actor itself, the others are transform children of it
+        std::vector<math::mat4f> instanceTransforms;
+        std::vector<InstanceBuffer*> instanceBuffers;
+        std::vector<utils::Entity> instanceRenderables;
+        Box instanceBox; // object-space box of the geometry, shared by all instances
+
         void SetGeometry(const GeometryVID vid);
         void SetMIs(const std::vector<MInstanceVID>& vidMIs);
         bool SetMI(const MInstanceVID vid, const int slot);
@@ -199,6 +225,12 @@ namespace vzm
         Texture* intrinsicTexture = nullptr;
         std::vector<char> intrinsicCache;
 
+        // for point clouds (see VzEngineApp::LoadPointCloud), the renderable of the actor is the root of the octree
+        std::unique_ptr<VzPointCloud> pointCloud;
+
+        // entities the actor renders with besides its own (instance chunks, point cloud nodes), hidden from the scene tree
+        bool IsInternalEntity(const utils::Entity ett) const;
+
         ~VzActorRes();
     };
     struct VzLightRes
@@ -325,6 +357,40 @@ namespace vzm
 
     class VzRenderPath;
 
+    // Membership indices over the VzEngineApp component maps
+    //  - component types are interned once, each type and each scene keeps a dense member array
+    //  - members are removed with swap-and-pop, so the arrays have no particular order
+    class VzComponentIndex
+    {
+    public:
+        using TypeId = uint32_t;
+        static constexpr TypeId INVALID_TYPE = ~0u;
+
+        void Add(VzBaseComp* comp);
+        void Remove(const VID vid);
+        void SetScene(const VID vid, const SceneVID vidScene);
+
+        TypeId FindType(const std::string& type) const;
+        const std::vector<VzBaseComp*>* GetComponents(const TypeId type) const;
+        const std::vector<VID>* GetSceneMembers(const SceneVID vidScene) const;
+
+    private:
+        struct Slot
+        {
+            TypeId type = INVALID_TYPE;
+            uint32_t typeIndex = 0;
+            bool inScene = false;
+            SceneVID scene = INVALID_VID;
+            uint32_t sceneIndex = 0;
+        };
+        void removeFromScene(const VID vid, Slot& slot);
+
+        std::unordered_map<std::string, TypeId> typeIds_;
+        std::vector<std::vector<VzBaseComp*>> typeMembers_; // indexed by TypeId
+        std::unordered_map<SceneVID, std::vector<VID>> sceneMembers_;
+        std::unordered_map<VID, Slot> slots_;
+    };
+
     class VzEngineApp
     {
     private:
@@ -353,8 +419,24 @@ namespace vzm
         std::unordered_map<SkeletonVID, std::unique_ptr<VzSkeletonRes>> skeletonResMap_;
 
         std::unordered_map<VID, std::unique_ptr<VzBaseComp>> vzCompMap_;
+        VzComponentIndex compIndex_;
 
         bool removeScene(SceneVID vidScene);
+        // vzCompMap_.emplace that also registers the component type
+        std::pair<std::unordered_map<VID, std::unique_ptr<VzBaseComp>>::iterator, bool> emplaceComponent(
+            const VID vid, std::unique_ptr<VzBaseComp>&& comp);
+        // assigns the scene of an actor, light or camera (0 when it does not belong to a scene)
+        void setSceneOf(std::unordered_map<VID, SceneVID>::iterator it, const SceneVID vidScene);
+        struct TransformUpdate
+        {
+            VzSceneComp* comp = nullptr;
+            TransformManager::Instance ins;
+            math::mat4f local;
+            bool duplicate = false;  // the component is listed again later in the batch
+        };
+        // resolves vids and composes the local matrices (in parallel for large batches) then commits them
+        template <typename COMPOSE>
+        size_t applyTransforms(const VID* vids, const size_t count, COMPOSE compose);
 
     public:
         // Runtime can create a new entity with this
@@ -417,7 +499,21 @@ namespace vzm
             const bool isSystem = false);
         VzFont* CreateFont(const std::string& name);
 
+        // Applies local transforms to many actors, lights and cameras inside one local transform transaction
+        //  - s, q, t are packed (float3, float4, float3) arrays of count elements, nullptr keeps the current values
+        //  - m is a packed array of count 4x4 matrices
+        //  - a component listed more than once takes its last entry
+        //  - return # of updated components
+        size_t SetSceneCompTransforms(const VID* vids, const size_t count,
+            const float* s, const float* q, const float* t);
+        size_t SetSceneCompMatrices(const VID* vids, const size_t count,
+            const float* m, const bool additiveTransform, const bool rowMajor);
+
         void BuildRenderable(const ActorVID vid);
+        // Uploads instanceTransforms[offset, offset + count) of the actor and refits the bounds of the chunks involved
+        void UpdateInstances(const ActorVID vid, const size_t offset, const size_t count);
+        // Picks the coarsest LOD whose projected error stays under the actor's pixel tolerance
+        void UpdateActorLOD(const ActorVID vid, const Camera& camera, const uint32_t viewportHeight);
 
         VzGeometryRes* GetGeometryRes(const GeometryVID vidGeo);
         VzMaterialRes* GetMaterialRes(const MaterialVID vidMaterial);
@@ -443,18 +539,20 @@ namespace vzm
         }
         size_t GetVzComponentsByType(const std::string& type, std::vector<VzBaseComp*>& components)
         {
-            components.clear();
-            for (auto& it : vzCompMap_)
+            const std::vector<VzBaseComp*>* members = compIndex_.GetComponents(compIndex_.FindType(type));
+            if (members == nullptr)
             {
-                if (it.second->GetType() == type)
-                {
-                    components.push_back(it.second.get());
-                }
+                components.clear();
+                return 0;
             }
+            components.assign(members->begin(), members->end());
             return components.size();
         }
 
-        size_t LoadMeshFile(const std::string& filename, std::vector<VzActor*>& actors);
+        size_t LoadMeshFile(const std::string& filename, std::vector<VzActor*>& actors,
+            const vzm::ParamMap<std::string>& options = vzm::ParamMap<std::string>());
+        VzActor* LoadPointCloud(const std::string& filename, const std::string& name,
+            const vzm::ParamMap<std::string>& options = vzm::ParamMap<std::string>());
 
         gltfio::VzAssetLoader* GetGltfAssetLoader();
         gltfio::VzAssetExpoter* GetGltfAssetExpoter();
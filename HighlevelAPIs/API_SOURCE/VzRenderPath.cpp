@@ -7,6 +7,281 @@ extern VzEngineApp* gEngineApp;
 
 namespace vzm
 {
+    bool GenericToneMapperSettings::operator==(const GenericToneMapperSettings& rhs) const
+    {
+        static_assert(sizeof(GenericToneMapperSettings) == 16, "Please update VzRenderPath.cpp");
+        return contrast == rhs.contrast &&
+            midGrayIn == rhs.midGrayIn &&
+            midGrayOut == rhs.midGrayOut &&
+            hdrMax == rhs.hdrMax;
+    }
+
+    bool AgxToneMapperSettings::operator==(const AgxToneMapperSettings& rhs) const
+    {
+        static_assert(sizeof(AgxToneMapperSettings) == 1, "Please update VzRenderPath.cpp");
+        return look == rhs.look;
+    }
+
+    bool ColorGradingSettings::operator==(const ColorGradingSettings& rhs) const
+    {
+        // If you had to fix the following codeline, then you likely also need to update the
+        // implementation of operator== and hashColorGrading().
+        static_assert(sizeof(ColorGradingSettings) == 312, "Please update VzRenderPath.cpp");
+        return enabled == rhs.enabled &&
+            colorspace == rhs.colorspace &&
+            quality == rhs.quality &&
+            toneMapping == rhs.toneMapping &&
+            genericToneMapper == rhs.genericToneMapper &&
+            agxToneMapper == rhs.agxToneMapper &&
+            luminanceScaling == rhs.luminanceScaling &&
+            gamutMapping == rhs.gamutMapping &&
+            exposure == rhs.exposure &&
+            nightAdaptation == rhs.nightAdaptation &&
+            temperature == rhs.temperature &&
+            tint == rhs.tint &&
+            outRed == rhs.outRed &&
+            outGreen == rhs.outGreen &&
+            outBlue == rhs.outBlue &&
+            shadows == rhs.shadows &&
+            midtones == rhs.midtones &&
+            highlights == rhs.highlights &&
+            ranges == rhs.ranges &&
+            contrast == rhs.contrast &&
+            vibrance == rhs.vibrance &&
+            saturation == rhs.saturation &&
+            slope == rhs.slope &&
+            offset == rhs.offset &&
+            power == rhs.power &&
+            gamma == rhs.gamma &&
+            midPoint == rhs.midPoint &&
+            linkedCurves == rhs.linkedCurves &&
+            scale == rhs.scale;
+    }
+
+    // the color space is left out on purpose, the cache compares the full settings on a hit
+    static size_t hashColorGrading(const ColorGradingSettings& settings)
+    {
+        size_t seed = 0;
+        auto combine3 = [&seed](const math::float3& v)
+            {
+                utils::hash::combine(seed, v.x);
+                utils::hash::combine(seed, v.y);
+                utils::hash::combine(seed, v.z);
+            };
+        auto combine4 = [&seed, &combine3](const math::float4& v)
+            {
+                combine3(v.xyz);
+                utils::hash::combine(seed, v.w);
+            };
+        utils::hash::combine(seed, (uint32_t)settings.quality);
+        utils::hash::combine(seed, (uint32_t)settings.toneMapping);
+        utils::hash::combine(seed, (uint32_t)settings.agxToneMapper.look);
+        utils::hash::combine(seed, (uint32_t)settings.luminanceScaling
+            | (uint32_t)settings.gamutMapping << 1 | (uint32_t)settings.linkedCurves << 2);
+        utils::hash::combine(seed, settings.genericToneMapper.contrast);
+        utils::hash::combine(seed, settings.genericToneMapper.midGrayIn);
+        utils::hash::combine(seed, settings.genericToneMapper.midGrayOut);
+        utils::hash::combine(seed, settings.genericToneMapper.hdrMax);
+        combine4(settings.shadows);
+        combine4(settings.midtones);
+        combine4(settings.highlights);
+        combine4(settings.ranges);
+        combine3(settings.outRed);
+        combine3(settings.outGreen);
+        combine3(settings.outBlue);
+        combine3(settings.slope);
+        combine3(settings.offset);
+        combine3(settings.power);
+        combine3(settings.gamma);
+        combine3(settings.midPoint);
+        combine3(settings.scale);
+        utils::hash::combine(seed, settings.exposure);
+        utils::hash::combine(seed, settings.nightAdaptation);
+        utils::hash::combine(seed, settings.temperature);
+        utils::hash::combine(seed, settings.tint);
+        utils::hash::combine(seed, settings.contrast);
+        utils::hash::combine(seed, settings.vibrance);
+        utils::hash::combine(seed, settings.saturation);
+        return seed;
+    }
+
+    static ToneMapper* createToneMapper(const ColorGradingSettings& settings)
+    {
+        switch (settings.toneMapping) {
+        case ToneMapping::LINEAR: return new LinearToneMapper;
+        case ToneMapping::ACES_LEGACY: return new ACESLegacyToneMapper;
+        case ToneMapping::ACES: return new ACESToneMapper;
+        case ToneMapping::FILMIC: return new FilmicToneMapper;
+        case ToneMapping::AGX: return new AgxToneMapper(settings.agxToneMapper.look);
+        case ToneMapping::GENERIC: return new GenericToneMapper(
+            settings.genericToneMapper.contrast,
+            settings.genericToneMapper.midGrayIn,
+            settings.genericToneMapper.midGrayOut,
+            settings.genericToneMapper.hdrMax
+        );
+        case ToneMapping::PBR_NEUTRAL: return new PBRNeutralToneMapper;
+        case ToneMapping::DISPLAY_RANGE: return new DisplayRangeToneMapper;
+        }
+        return new ACESLegacyToneMapper;
+    }
+
+    size_t VzColorGradingCache::find(const size_t hash, const ColorGradingSettings& settings)
+    {
+        for (size_t i = 0, n = entries_.size(); i < n; ++i)
+        {
+            if (entries_[i].hash == hash && entries_[i].settings == settings)
+                return i;
+        }
+        return SIZE_MAX;
+    }
+
+    bool VzColorGradingCache::evict()
+    {
+        // least recently used LUT that is neither bound to the view nor in flight
+        size_t victim = SIZE_MAX;
+        for (size_t i = 0, n = entries_.size(); i < n; ++i)
+        {
+            const Entry& e = entries_[i];
+            if (i == building_ || e.colorGrading == bound_)
+                continue;
+            if (victim == SIZE_MAX || e.lastUsed < entries_[victim].lastUsed)
+                victim = i;
+        }
+        if (victim == SIZE_MAX)
+            return false;
+
+        Entry& e = entries_[victim];
+        gEngine->destroy(e.colorGrading);
+        delete e.toneMapper;
+        if (building_ == entries_.size() - 1)
+            building_ = victim;
+        e = std::move(entries_.back());
+        entries_.pop_back();
+        return true;
+    }
+
+    size_t VzColorGradingCache::build(const size_t hash, const ColorGradingSettings& settings)
+    {
+        // the cache never grows past its size, the LUT isn't built when nothing can be evicted
+        while (entries_.size() >= MAX_CACHED_LUTS)
+        {
+            if (!evict())
+                return SIZE_MAX;
+        }
+
+        Entry e;
+        e.hash = hash;
+        e.settings = settings;
+        e.lastUsed = frame_;
+        e.toneMapper = createToneMapper(settings);
+        e.colorGrading = ColorGrading::Builder()
+            .quality(settings.quality)
+            .exposure(settings.exposure)
+            .nightAdaptation(settings.nightAdaptation)
+            .whiteBalance(settings.temperature, settings.tint)
+            .channelMixer(settings.outRed, settings.outGreen, settings.outBlue)
+            .shadowsMidtonesHighlights(
+                Color::toLinear(settings.shadows),
+                Color::toLinear(settings.midtones),
+                Color::toLinear(settings.highlights),
+                settings.ranges
+            )
+            .slopeOffsetPower(settings.slope, settings.offset, settings.power)
+            .contrast(settings.contrast)
+            .vibrance(settings.vibrance)
+            .saturation(settings.saturation)
+            .curves(settings.gamma, settings.midPoint, settings.scale)
+            .toneMapper(e.toneMapper)
+            .luminanceScaling(settings.luminanceScaling)
+            .gamutMapping(settings.gamutMapping)
+            .outputColorSpace(settings.colorspace)
+            .asynchronous(true)
+            .build(*gEngine);
+        entries_.push_back(std::move(e));
+        return entries_.size() - 1;
+    }
+
+    void VzColorGradingCache::Request(const ColorGradingSettings& settings)
+    {
+        if (hasRequest_ && requested_ == settings)
+            return;
+        requested_ = settings;
+        hasRequest_ = true;
+        requestChanged_ = true;
+    }
+
+    void VzColorGradingCache::Update(filament::View* view)
+    {
+        frame_++;
+
+        if (building_ != SIZE_MAX && entries_[building_].colorGrading->isReady())
+        {
+            Entry& e = entries_[building_];
+            delete e.toneMapper;
+            e.toneMapper = nullptr;
+            building_ = SIZE_MAX;
+        }
+
+        if (!hasRequest_)
+            return;
+
+        // the engine's default color grading is used when the settings are the defaults
+        if (!requested_.enabled || requested_ == ColorGradingSettings{})
+        {
+            view->setColorGrading(nullptr);
+            bound_ = nullptr;
+            hasRequest_ = false;
+            return;
+        }
+
+        // while the settings keep changing (e.g., a slider is scrubbed), a LUT of the lowest
+        // dimension is previewed, the requested quality is built once the settings settle
+        ColorGradingSettings target = requested_;
+        if (requestChanged_ && bound_ != nullptr)
+            target.quality = ColorGrading::QualityLevel::LOW;
+        requestChanged_ = false;
+
+        const size_t hash = hashColorGrading(target);
+        size_t index = find(hash, target);
+        if (index == SIZE_MAX)
+        {
+            // a single LUT is generated at a time, intermediate settings are skipped
+            if (building_ != SIZE_MAX)
+                return;
+            index = build(hash, target);
+            if (index == SIZE_MAX)
+                return;
+            building_ = index;
+        }
+
+        Entry& e = entries_[index];
+        e.lastUsed = frame_;
+        if (index == building_)
+            return;
+
+        if (e.colorGrading != bound_)
+        {
+            view->setColorGrading(e.colorGrading);
+            bound_ = e.colorGrading;
+        }
+        if (target.quality == requested_.quality)
+            hasRequest_ = false;
+    }
+
+    void VzColorGradingCache::Clear()
+    {
+        // destroying a LUT that is still in flight waits for its generation
+        for (Entry& e : entries_)
+        {
+            gEngine->destroy(e.colorGrading);
+            delete e.toneMapper;
+        }
+        entries_.clear();
+        building_ = SIZE_MAX;
+        bound_ = nullptr;
+        hasRequest_ = false;
+    }
+
     VzRenderPath::VzRenderPath()
     {
         assert(gEngine && "native engine is not initialized!");
@@ -28,6 +303,7 @@ namespace vzm
                 gEngine->destroy(view_);
             if (swapChain_)
                 gEngine->destroy(swapChain_);
+            colorGradingCache_.Clear();
         }
     }
 
@@ -177,6 +453,12 @@ namespace vzm
         if (any(dirtyFlags & DirtyFlags::POST_PROCESSING_ENABLED))
             view_->setPostProcessingEnabled(viewSettings.postProcessingEnabled);
 
+        if (any(dirtyFlags & DirtyFlags::COLOR_GRADING))
+            colorGradingCache_.Request(viewSettings.colorGrading);
+
         dirtyFlags = DirtyFlags::NONE;
+
+        // LUT builds complete asynchronously, so this is polled every frame
+        colorGradingCache_.Update(view_);
     }
 }
@@ -111,6 +111,45 @@ namespace vzm
         FogSettings fogSettings;
     };
 
+    // keeps a few built color grading LUTs of a view, keyed by a hash of ColorGradingSettings.
+    // LUTs are generated asynchronously on the JobSystem and swapped in once they are ready,
+    // the previously bound LUT stays in use meanwhile.
+    class VzColorGradingCache
+    {
+    private:
+        struct Entry {
+            size_t hash = 0;
+            ColorGradingSettings settings;
+            filament::ColorGrading* colorGrading = nullptr;
+            filament::ToneMapper* toneMapper = nullptr; // must outlive the asynchronous build
+            uint64_t lastUsed = 0;
+        };
+        std::vector<Entry> entries_;
+        size_t building_ = SIZE_MAX; // index of the entry whose LUT is in flight
+
+        ColorGradingSettings requested_;
+        bool hasRequest_ = false;
+        bool requestChanged_ = false; // the settings changed since the last Update()
+
+        filament::ColorGrading* bound_ = nullptr;
+        uint64_t frame_ = 0;
+
+        size_t find(const size_t hash, const ColorGradingSettings& settings);
+        size_t build(const size_t hash, const ColorGradingSettings& settings);
+        bool evict();
+    public:
+        static constexpr size_t MAX_CACHED_LUTS = 4;
+        static_assert(MAX_CACHED_LUTS > 2, "the bound and the in-flight LUTs are never evicted");
+
+        VzColorGradingCache() = default;
+        ~VzColorGradingCache() = default;
+
+        void Request(const ColorGradingSettings& settings);
+        // polls the in-flight build and binds the LUT matching the latest request when ready
+        void Update(filament::View* view);
+        void Clear();
+    };
+
     struct VzCanvas
     {
     protected:
@@ -150,6 +189,8 @@ namespace vzm
         filament::SwapChain* swapChain_ = nullptr;
         filament::Renderer* renderer_ = nullptr;
 
+        VzColorGradingCache colorGradingCache_;
+
         void resize();
 
     public:
@@ -192,6 +233,7 @@ namespace vzm
             GUARD_BAND                  = 1 << 16,
             STEREOSCOPIC_OPTIONS        = 1 << 17,
             POST_PROCESSING_ENABLED     = 1 << 18,
+            COLOR_GRADING               = 1 << 19,
             ALL                         = 0xFFFFFFFF
         } dirtyFlags = DirtyFlags::ALL;
 
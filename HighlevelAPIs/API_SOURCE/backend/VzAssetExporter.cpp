@@ -2,21 +2,427 @@
 #include "../VzEngineApp.h"
 #include "VzAssetExporter.h"
 
+#include <cstring>
 #include <fstream>
 
 #define CGLTF_WRITE_IMPLEMENTATION
 #include <cgltf_write.h>
-#include <viewer/Settings.h>
+#include <gltfio/math.h>
+#include <meshoptimizer.h>
 
+#include "../../../libs/gltfio/src/FFilamentInstance.h"
+
+extern filament::Engine* gEngine;
 extern vzm::VzEngineApp* gEngineApp;
 
 namespace filament::gltfio {
 
-using Settings = filament::viewer::Settings;
-using JsonSerializer = filament::viewer::JsonSerializer;
+using namespace filament::math;
+using utils::JobSystem;
+
+namespace {
+
+constexpr uint32_t kGlbMagic = 0x46546C67;  // "glTF"
+constexpr uint32_t kJsonMagic = 0x4E4F534A;  // "JSON"
+constexpr uint32_t kBinMagic = 0x004E4942;   // "BIN\0"
+
+enum class MeshoptMode : uint8_t { NONE, ATTRIBUTES, TRIANGLES };
+
+// Describes where the bytes of one output bufferView come from.
+struct ViewPayload {
+  const uint8_t* source = nullptr;  // live cgltf data, never copied
+  size_t size = 0;
+  std::vector<uint8_t> owned;  // quantized or meshopt-encoded bytes
+
+  cgltf_accessor* quantized = nullptr;  // sole accessor to requantize
+  cgltf_attribute_type semantic = cgltf_attribute_type_invalid;
+
+  MeshoptMode mode = MeshoptMode::NONE;
+  size_t stride = 0;
+  size_t count = 0;
+  size_t encodedSize = 0;  // 0 when the stream did not compress
+
+  size_t binOffset = 0;
+
+  const uint8_t* bytes() const {
+    return owned.empty() ? source : owned.data();
+  }
+  size_t byteCount() const { return encodedSize ? encodedSize : size; }
+};
+
+// The export edits cgltf_data in place (live state, new buffer layout) and
+// puts the source back once the JSON has been generated.
+struct SourceSnapshot {
+  explicit SourceSnapshot(cgltf_data* data)
+      : data(data),
+        nodes(data->nodes, data->nodes + data->nodes_count),
+        materials(data->materials, data->materials + data->materials_count),
+        accessors(data->accessors, data->accessors + data->accessors_count),
+        views(data->buffer_views,
+              data->buffer_views + data->buffer_views_count),
+        buffers(data->buffers),
+        buffersCount(data->buffers_count),
+        extensionsUsed(data->extensions_used),
+        extensionsUsedCount(data->extensions_used_count),
+        extensionsRequired(data->extensions_required),
+        extensionsRequiredCount(data->extensions_required_count) {}
+
+  ~SourceSnapshot() {
+    std::copy(nodes.begin(), nodes.end(), data->nodes);
+    std::copy(materials.begin(), materials.end(), data->materials);
+    std::copy(accessors.begin(), accessors.end(), data->accessors);
+    std::copy(views.begin(), views.end(), data->buffer_views);
+    data->buffers = buffers;
+    data->buffers_count = buffersCount;
+    data->extensions_used = extensionsUsed;
+    data->extensions_used_count = extensionsUsedCount;
+    data->extensions_required = extensionsRequired;
+    data->extensions_required_count = extensionsRequiredCount;
+  }
+
+  cgltf_data* data;
+  std::vector<cgltf_node> nodes;
+  std::vector<cgltf_material> materials;
+  std::vector<cgltf_accessor> accessors;
+  std::vector<cgltf_buffer_view> views;
+  cgltf_buffer* buffers;
+  cgltf_size buffersCount;
+  char** extensionsUsed;
+  cgltf_size extensionsUsedCount;
+  char** extensionsRequired;
+  cgltf_size extensionsRequiredCount;
+};
+
+const uint8_t* viewSource(const cgltf_data* data,
+                          const cgltf_buffer_view* view) {
+  // meshopt-compressed inputs have been decoded by the ResourceLoader
+  if (view->data) {
+    return (const uint8_t*)view->data;
+  }
+  const void* base = view->buffer->data;
+  if (base == nullptr && view->buffer == data->buffers) {
+    base = data->bin;
+  }
+  return base ? (const uint8_t*)base + view->offset : nullptr;
+}
+
+void bakeMaterial(const MaterialInstance* mi, cgltf_material* material) {
+  const Material* ma = mi->getMaterial();
+  if (material->has_pbr_metallic_roughness) {
+    auto& pbr = material->pbr_metallic_roughness;
+    if (ma->hasParameter("baseColorFactor")) {
+      const float4 color = mi->getParameter<float4>("baseColorFactor");
+      std::copy(color.v, color.v + 4, pbr.base_color_factor);
+    }
+    if (ma->hasParameter("metallicFactor")) {
+      pbr.metallic_factor = mi->getParameter<float>("metallicFactor");
+    }
+    if (ma->hasParameter("roughnessFactor")) {
+      pbr.roughness_factor = mi->getParameter<float>("roughnessFactor");
+    }
+  }
+  if (ma->hasParameter("emissiveFactor")) {
+    const float3 emissive = mi->getParameter<float3>("emissiveFactor");
+    std::copy(emissive.v, emissive.v + 3, material->emissive_factor);
+  }
+}
+
+// Transforms, material factors and morph weights come from the engine, not
+// from the file the asset was loaded from.
+void bakeLiveState(cgltf_data* data, const FFilamentInstance* instance,
+                   std::vector<std::vector<float>>& weightStorage) {
+  auto& tcm = gEngine->getTransformManager();
+  auto& rcm = gEngine->getRenderableManager();
+  weightStorage.reserve(data->nodes_count);
+
+  for (cgltf_size i = 0; i < data->nodes_count; ++i) {
+    cgltf_node& node = data->nodes[i];
+    const utils::Entity entity = instance->mNodeMap[i];
+    if (entity.isNull()) {
+      continue;
+    }
+
+    auto ti = tcm.getInstance(entity);
+    if (ti.isValid()) {
+      float3 translation, scale;
+      quatf rotation;
+      decomposeMatrix(tcm.getTransform(ti), &translation, &rotation, &scale);
+      // TRS rather than a matrix: animated nodes must not carry a matrix
+      node.has_matrix = false;
+      node.has_translation = node.has_rotation = node.has_scale = true;
+      std::copy(translation.v, translation.v + 3, node.translation);
+      std::copy(rotation.xyzw.v, rotation.xyzw.v + 4, node.rotation);
+      std::copy(scale.v, scale.v + 3, node.scale);
+    }
+
+    auto ri = rcm.getInstance(entity);
+    if (node.mesh == nullptr || !ri.isValid()) {
+      continue;
+    }
+    if (rcm.getPrimitiveCount(ri) == node.mesh->primitives_count) {
+      for (cgltf_size p = 0; p < node.mesh->primitives_count; ++p) {
+        cgltf_material* material = node.mesh->primitives[p].material;
+        const MaterialInstance* mi = rcm.getMaterialInstanceAt(ri, p);
+        if (material && mi) {
+          bakeMaterial(mi, material);
+        }
+      }
+    }
+
+    vzm::VzActorRes* actor_res = gEngineApp->GetActorRes(entity.getId());
+    vzm::VzGeometryRes* geo_res =
+        actor_res ? gEngineApp->GetGeometryRes(actor_res->GetGeometryVid())
+                  : nullptr;
+    const cgltf_size targets = node.mesh->primitives_count > 0
+        ? node.mesh->primitives[0].targets_count : 0;
+    if (geo_res && targets > 0 && geo_res->morphWeights.size() == targets) {
+      weightStorage.push_back(geo_res->morphWeights);
+      node.weights = weightStorage.back().data();
+      node.weights_count = targets;
+    }
+  }
+}
+
+// Only float normals, tangents and [0, 1] texture coordinates that own their
+// bufferView are requantized; positions stay float so node transforms remain
+// untouched.
+bool canQuantize(const cgltf_accessor* accessor, cgltf_attribute_type semantic) {
+  if (accessor->is_sparse || accessor->offset != 0 ||
+      accessor->component_type != cgltf_component_type_r_32f) {
+    return false;
+  }
+  switch (semantic) {
+    case cgltf_attribute_type_normal:
+      return accessor->type == cgltf_type_vec3;
+    case cgltf_attribute_type_tangent:
+      return accessor->type == cgltf_type_vec4;
+    case cgltf_attribute_type_texcoord:
+      // the [0, 1] range is checked against the data when quantizing
+      return accessor->type == cgltf_type_vec2;
+    default:
+      return false;
+  }
+}
+
+void quantize(ViewPayload& payload) {
+  cgltf_accessor* accessor = payload.quantized;
+  const size_t srcStride = accessor->stride;
+  const size_t count = accessor->count;
+  auto read = [&payload, srcStride](size_t i) {
+    return (const float*)(payload.source + i * srcStride);
+  };
+
+  if (payload.semantic == cgltf_attribute_type_texcoord) {
+    for (size_t i = 0; i < count; ++i) {
+      const float* uv = read(i);
+      if (uv[0] < 0.f || uv[0] > 1.f || uv[1] < 0.f || uv[1] > 1.f) {
+        // wrapping coordinates would need KHR_texture_transform
+        payload.quantized = nullptr;
+        return;
+      }
+    }
+    std::vector<uint8_t> out(count * sizeof(ushort2));
+    ushort2* dst = (ushort2*)out.data();
+    for (size_t i = 0; i < count; ++i) {
+      const float* uv = read(i);
+      dst[i] = ushort2(std::round(uv[0] * 65535.f),
+                       std::round(uv[1] * 65535.f));
+    }
+    payload.owned = std::move(out);
+    payload.stride = sizeof(ushort2);
+    accessor->component_type = cgltf_component_type_r_16u;
+  } else {
+    // vertex attributes are 4-byte aligned, normals get a padding component
+    const size_t components = payload.semantic == cgltf_attribute_type_normal
+        ? 3 : 4;
+    std::vector<uint8_t> out(count * sizeof(short4));
+    short4* dst = (short4*)out.data();
+    for (size_t i = 0; i < count; ++i) {
+      const float* v = read(i);
+      short4 q(0);
+      for (size_t c = 0; c < components; ++c) {
+        q[c] = int16_t(std::round(clamp(v[c], -1.f, 1.f) * 32767.f));
+      }
+      dst[i] = q;
+    }
+    payload.owned = std::move(out);
+    payload.stride = sizeof(short4);
+    accessor->component_type = cgltf_component_type_r_16;
+  }
+  accessor->normalized = true;
+  accessor->stride = payload.stride;
+  // min / max are only mandatory for positions
+  accessor->has_min = accessor->has_max = false;
+  payload.size = payload.owned.size();
+}
+
+template <typename T>
+size_t encodeIndices(std::vector<uint8_t>& out, const uint8_t* src,
+                     size_t count) {
+  const T* indices = (const T*)src;
+  size_t vertexCount = 0;
+  for (size_t i = 0; i < count; ++i) {
+    vertexCount = std::max(vertexCount, size_t(indices[i]) + 1);
+  }
+  out.resize(meshopt_encodeIndexBufferBound(count, vertexCount));
+  return meshopt_encodeIndexBuffer(out.data(), out.size(), indices, count);
+}
+
+void encode(ViewPayload& payload) {
+  std::vector<uint8_t> out;
+  size_t size = 0;
+  const uint8_t* src = payload.bytes();
+  if (payload.mode == MeshoptMode::ATTRIBUTES) {
+    out.resize(meshopt_encodeVertexBufferBound(payload.count, payload.stride));
+    size = meshopt_encodeVertexBuffer(out.data(), out.size(), src,
+                                      payload.count, payload.stride);
+  } else if (payload.stride == sizeof(uint16_t)) {
+    size = encodeIndices<uint16_t>(out, src, payload.count);
+  } else {
+    size = encodeIndices<uint32_t>(out, src, payload.count);
+  }
+  // keep the plain stream when encoding does not pay off
+  if (size == 0 || size >= payload.size) {
+    payload.mode = MeshoptMode::NONE;
+    return;
+  }
+  // the decoder locates the vertex tail from the end, so no padding here
+  out.resize(size);
+  payload.owned = std::move(out);
+  payload.encodedSize = size;
+}
+
+// Classifies every bufferView and sets up the quantization and compression
+// work. Views shared with anything else than mesh attributes or indices are
+// copied verbatim.
+void planViews(cgltf_data* data, std::vector<ViewPayload>& payloads,
+               bool compress, bool quantizeAttributes) {
+  enum : uint8_t { VERTEX = 1, INDEX = 2, OTHER = 4 };
+  const cgltf_size viewCount = data->buffer_views_count;
+  std::vector<uint8_t> usage(viewCount, 0);
+  std::vector<uint32_t> accessorsPerView(viewCount, 0);
+  std::vector<uint8_t> accessorUsage(data->accessors_count, 0);
+  std::vector<cgltf_attribute_type> semantics(data->accessors_count,
+                                              cgltf_attribute_type_invalid);
+  auto viewIndex = [data](const cgltf_buffer_view* view) {
+    return size_t(view - data->buffer_views);
+  };
+  auto accessorIndex = [data](const cgltf_accessor* accessor) {
+    return size_t(accessor - data->accessors);
+  };
+
+  for (cgltf_size m = 0; m < data->meshes_count; ++m) {
+    const cgltf_mesh& mesh = data->meshes[m];
+    for (cgltf_size p = 0; p < mesh.primitives_count; ++p) {
+      const cgltf_primitive& prim = mesh.primitives[p];
+      if (prim.indices) {
+        const bool triangles = prim.type == cgltf_primitive_type_triangles;
+        accessorUsage[accessorIndex(prim.indices)] |= triangles ? INDEX : OTHER;
+      }
+      for (cgltf_size a = 0; a < prim.attributes_count; ++a) {
+        const cgltf_attribute& attr = prim.attributes[a];
+        const size_t index = accessorIndex(attr.data);
+        if (semantics[index] != cgltf_attribute_type_invalid &&
+            semantics[index] != attr.type) {
+          accessorUsage[index] |= OTHER;
+        }
+        semantics[index] = attr.type;
+        accessorUsage[index] |= VERTEX;
+      }
+      for (cgltf_size t = 0; t < prim.targets_count; ++t) {
+        const cgltf_morph_target& target = prim.targets[t];
+        for (cgltf_size a = 0; a < target.attributes_count; ++a) {
+          // deltas may leave [-1, 1], they are compressed but not quantized
+          const size_t index = accessorIndex(target.attributes[a].data);
+          accessorUsage[index] |= VERTEX;
+          semantics[index] = cgltf_attribute_type_custom;
+        }
+      }
+    }
+  }
+
+  for (cgltf_size i = 0; i < data->accessors_count; ++i) {
+    const cgltf_accessor& accessor = data->accessors[i];
+    const uint8_t use = accessorUsage[i] ? accessorUsage[i] : OTHER;
+    if (accessor.buffer_view) {
+      usage[viewIndex(accessor.buffer_view)] |= use;
+      accessorsPerView[viewIndex(accessor.buffer_view)]++;
+    }
+    if (accessor.is_sparse) {
+      usage[viewIndex(accessor.sparse.indices_buffer_view)] |= OTHER;
+      usage[viewIndex(accessor.sparse.values_buffer_view)] |= OTHER;
+    }
+  }
+  for (cgltf_size i = 0; i < data->images_count; ++i) {
+    if (data->images[i].buffer_view) {
+      usage[viewIndex(data->images[i].buffer_view)] |= OTHER;
+    }
+  }
+
+  // per-view element layout, from the accessors that live in it
+  std::vector<size_t> strides(viewCount, 0);
+  std::vector<bool> uniform(viewCount, true);
+  for (cgltf_size i = 0; i < data->accessors_count; ++i) {
+    cgltf_accessor& accessor = data->accessors[i];
+    if (accessor.buffer_view == nullptr) {
+      continue;
+    }
+    const size_t v = viewIndex(accessor.buffer_view);
+    const bool isIndex = usage[v] == INDEX;
+    const size_t stride = isIndex
+        ? cgltf_component_size(accessor.component_type) : accessor.stride;
+    if (strides[v] != 0 && strides[v] != stride) {
+      uniform[v] = false;
+    }
+    strides[v] = stride;
+    if (isIndex && accessor.offset % (3 * stride) != 0) {
+      uniform[v] = false;
+    }
+    if (quantizeAttributes && usage[v] == VERTEX &&
+        accessorsPerView[v] == 1 && canQuantize(&accessor, semantics[i])) {
+      payloads[v].quantized = &accessor;
+      payloads[v].semantic = semantics[i];
+    }
+  }
+
+  for (cgltf_size v = 0; v < viewCount; ++v) {
+    ViewPayload& payload = payloads[v];
+    payload.stride = data->buffer_views[v].stride ? data->buffer_views[v].stride
+                                                  : strides[v];
+    if (!compress || !uniform[v] || payload.stride == 0) {
+      continue;
+    }
+    if (usage[v] == VERTEX && payload.stride % 4 == 0 &&
+        payload.stride <= 256 && payload.size % payload.stride == 0) {
+      payload.mode = MeshoptMode::ATTRIBUTES;
+    } else if (usage[v] == INDEX &&
+               (payload.stride == 2 || payload.stride == 4) &&
+               payload.size % (3 * payload.stride) == 0) {
+      payload.mode = MeshoptMode::TRIANGLES;
+    }
+  }
+}
+
+bool listsExtension(const cgltf_data* data, const char* name) {
+  for (cgltf_size i = 0; i < data->extensions_used_count; ++i) {
+    if (strcmp(data->extensions_used[i], name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void writePadding(std::ofstream& file, size_t count, char value) {
+  static const char kPadding[4] = {};
+  const char spaces[4] = { ' ', ' ', ' ', ' ' };
+  file.write(value == ' ' ? spaces : kPadding, count);
+}
+
+}  // namespace
 
 void VzAssetExpoter::ExportToGlb(const vzm::VzAsset* v_asset,
-                                 const std::string path) {
+                                 const std::string path,
+                                 const vzm::ParamMap<std::string>& options) {
   if (v_asset == nullptr) {
     return;
   }
@@ -25,37 +431,174 @@ void VzAssetExpoter::ExportToGlb(const vzm::VzAsset* v_asset,
 
   FFilamentAsset* fasset = downcast(asset_res.asset);
   cgltf_data* data = (cgltf_data*)fasset->getSourceAsset();
-  std::string output;
-  cgltf_options options{};
-  cgltf_size buffer_size = cgltf_write(&options, nullptr, 0, data);
-  output.resize(buffer_size);
-
-  cgltf_write(&options, output.data(), buffer_size, data);
+  if (data == nullptr || fasset->mInstances.empty()) {
+    vzm::backlog::post("the source data of the asset has been released",
+                       vzm::backlog::LogLevel::Error);
+    return;
+  }
+  const bool compress = options.GetParam("meshopt-compression", false);
+  const bool quantize_attributes = options.GetParam("mesh-quantization", false);
 
-  std::ofstream file(path.c_str(), std::ios::binary);
-  if (file) {
-    int version_num = 2;
-    int align = 4 - (output.length() - 1) % 4;
-    int size = output.length() + 27 + data->bin_size + align;
-    int bin_magic = 0x004E4942;
+  const cgltf_size view_count = data->buffer_views_count;
+  std::vector<ViewPayload> payloads(view_count);
+  for (cgltf_size v = 0; v < view_count; ++v) {
+    payloads[v].source = viewSource(data, data->buffer_views + v);
+    payloads[v].size = data->buffer_views[v].size;
+    if (payloads[v].source == nullptr) {
+      vzm::backlog::post("buffer data is not resident, unable to export " + path,
+                         vzm::backlog::LogLevel::Error);
+      return;
+    }
+  }
 
-    file.write("glTF", 4);
-    file.write(reinterpret_cast<char*>(&version_num), 4);
-    file.write(reinterpret_cast<char*>(&size), 4);
+  SourceSnapshot snapshot(data);
+  std::vector<std::vector<float>> weight_storage;
+  bakeLiveState(data, fasset->mInstances[0], weight_storage);
+  planViews(data, payloads, compress, quantize_attributes);
 
-    size = output.length() - 1 + align;
-    file.write(reinterpret_cast<char*>(&size), 4);
-    file.write("JSON", 4);
-    file.write(output.c_str(), output.length() - 1);
+  // quantization and encoding are independent per view
+  JobSystem& js = gEngine->getJobSystem();
+  JobSystem::Job* parent = js.createJob();
+  for (ViewPayload& payload : payloads) {
+    if (payload.quantized == nullptr && payload.mode == MeshoptMode::NONE) {
+      continue;
+    }
+    ViewPayload* p = &payload;
+    js.run(js.createJob(parent, [p](JobSystem&, JobSystem::Job*) {
+      if (p->quantized) {
+        quantize(*p);
+      }
+      if (p->mode != MeshoptMode::NONE) {
+        p->count = p->size / p->stride;
+        encode(*p);
+      }
+    }));
+  }
+  js.runAndWait(parent);
 
-    for (int k = 0; k < align; k++) {
-      file.write(" ", 1);
+  // one GLB-stored buffer, plus a data-less fallback for compressed views
+  std::vector<cgltf_buffer> buffers(2, cgltf_buffer{});
+  cgltf_buffer& bin = buffers[0];
+  cgltf_buffer& fallback = buffers[1];
+  size_t bin_size = 0;
+  size_t fallback_size = 0;
+  bool quantized = false;
+  for (cgltf_size v = 0; v < view_count; ++v) {
+    ViewPayload& payload = payloads[v];
+    cgltf_buffer_view& view = data->buffer_views[v];
+    payload.binOffset = bin_size;
+    bin_size = (bin_size + payload.byteCount() + 3) & ~size_t(3);
+    view.size = payload.size;
+    view.data = nullptr;
+    view.has_meshopt_compression = false;
+    // the source extensions describe the source layout
+    view.extensions = nullptr;
+    view.extensions_count = 0;
+    if (payload.quantized) {
+      // the accessor was rewritten by the quantization job
+      view.stride = payload.stride;
+      quantized = true;
+    }
+    if (payload.mode == MeshoptMode::NONE) {
+      view.buffer = &bin;
+      view.offset = payload.binOffset;
+      continue;
     }
+    view.buffer = &fallback;
+    view.offset = fallback_size;
+    fallback_size = (fallback_size + payload.size + 3) & ~size_t(3);
+    view.has_meshopt_compression = true;
+    view.meshopt_compression = {};
+    view.meshopt_compression.buffer = &bin;
+    view.meshopt_compression.offset = payload.binOffset;
+    view.meshopt_compression.size = payload.encodedSize;
+    view.meshopt_compression.stride = payload.stride;
+    view.meshopt_compression.count = payload.count;
+    view.meshopt_compression.mode =
+        payload.mode == MeshoptMode::ATTRIBUTES
+            ? cgltf_meshopt_compression_mode_attributes
+            : cgltf_meshopt_compression_mode_triangles;
+  }
+  bin.size = bin_size;
+  char meshopt_name[] = "EXT_meshopt_compression";
+  char quantization_name[] = "KHR_mesh_quantization";
+  char fallback_json[] = "{ \"fallback\": true }";
+  cgltf_extension fallback_extension{ meshopt_name, fallback_json };
+  if (fallback_size > 0) {
+    fallback.size = fallback_size;
+    fallback.extensions = &fallback_extension;
+    fallback.extensions_count = 1;
+  }
+  data->buffers = buffers.data();
+  data->buffers_count = fallback_size > 0 ? 2 : 1;
+
+  // the fallback buffer has no data, and quantized accessors can't be read
+  // without the extension, so both are required once used. Source accessors
+  // stay quantized when the source requires it, meshopt views are decoded.
+  std::vector<char*> extensions;
+  if (fallback_size > 0) {
+    extensions.push_back(meshopt_name);
+  }
+  if (quantized || listsExtension(data, quantization_name)) {
+    extensions.push_back(quantization_name);
+  }
+  data->extensions_used = extensions.data();
+  data->extensions_used_count = extensions.size();
+  data->extensions_required = extensions.data();
+  data->extensions_required_count = extensions.size();
 
-    file.write(reinterpret_cast<char*>(&data->bin_size), 4);
-    file.write(reinterpret_cast<char*>(&bin_magic), 4);
-    file.write(reinterpret_cast<const char*>(data->bin), data->bin_size);
-    file.close();
+  std::string json;
+  {
+    cgltf_options write_options{};
+    const cgltf_size json_size = cgltf_write(&write_options, nullptr, 0, data);
+    json.resize(json_size);
+    cgltf_write(&write_options, json.data(), json_size, data);
+    json.resize(json_size - 1);  // drop the null terminator
+  }
+
+  const size_t json_padding = (4 - json.size() % 4) % 4;
+  const size_t json_chunk = json.size() + json_padding;
+  const size_t total = 12 + 8 + json_chunk + (bin_size ? 8 + bin_size : 0);
+  if (total > std::numeric_limits<uint32_t>::max()) {
+    vzm::backlog::post("GLB files are limited to 4 GB, unable to export " + path,
+                       vzm::backlog::LogLevel::Error);
+    return;
+  }
+
+  std::ofstream file(path.c_str(), std::ios::binary);
+  if (!file) {
+    vzm::backlog::post("unable to open " + path, vzm::backlog::LogLevel::Error);
+    return;
+  }
+  auto write_u32 = [&file](uint32_t value) {
+    file.write(reinterpret_cast<const char*>(&value), 4);
+  };
+  write_u32(kGlbMagic);
+  write_u32(2);
+  write_u32(uint32_t(total));
+
+  write_u32(uint32_t(json_chunk));
+  write_u32(kJsonMagic);
+  file.write(json.data(), json.size());
+  writePadding(file, json_padding, ' ');
+
+  if (bin_size == 0) {
+    return;
+  }
+  // the binary chunk goes out view by view, straight from the source buffers
+  write_u32(uint32_t(bin_size));
+  write_u32(kBinMagic);
+  size_t written = 0;
+  for (ViewPayload& payload : payloads) {
+    writePadding(file, payload.binOffset - written, 0);
+    file.write(reinterpret_cast<const char*>(payload.bytes()),
+               payload.byteCount());
+    written = payload.binOffset + payload.byteCount();
+    std::vector<uint8_t>().swap(payload.owned);
+  }
+  writePadding(file, bin_size - written, 0);
+  if (!file) {
+    vzm::backlog::post("failed writing " + path, vzm::backlog::LogLevel::Error);
   }
 }
 
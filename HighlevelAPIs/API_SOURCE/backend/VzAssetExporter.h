@@ -1,5 +1,6 @@
 #pragma once
 #include "../FIncludes.h"
+#include "../VizComponentAPIs.h"
 
 namespace vzm {
 
@@ -11,9 +12,15 @@ namespace filament::gltfio {
 
 struct VzAssetExpoter {
 
-  void ExportToGlb(const vzm::VzAsset* v_asset, const std::string path);
+  // Writes the asset with its current transforms, material factors and morph
+  // weights. The binary chunk is streamed to disk view by view.
+  //  - "meshopt-compression" (bool) : EXT_meshopt_compression for vertex and
+  //    index streams
+  //  - "mesh-quantization" (bool) : KHR_mesh_quantization for normals,
+  //    tangents and texture coordinates
+  void ExportToGlb(const vzm::VzAsset* v_asset, const std::string path,
+                   const vzm::ParamMap<std::string>& options);
 
 };
 
 }
-
@@ -29,6 +29,7 @@
 
 #include <stb_image.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Path.h>
 
 #include <fstream>
@@ -272,37 +273,53 @@ bool VzIBL::loadCubemapLevel(
         Texture::Format::RGB, Texture::Type::UINT_10F_11F_11F_REV,
         (Texture::PixelBufferDescriptor::Callback)&free);
 
-    bool success = true;
     uint8_t* p = static_cast<uint8_t*>(buffer.buffer);
 
+    // decode the faces in the background, so that they don't compete with the frame's jobs,
+    // this thread helps while it waits. The first face that fails cancels the others.
+    JobSystem& js = mEngine.getJobSystem();
+    CancellationToken failed;
+    JobSystem::Job* parent = js.createJob();
     for (size_t j = 0; j < 6; j++) {
-        std::string faceName = levelPrefix + faceSuffix[j] + ".rgb32f";
-        Path facePath(Path::concat(path, faceName));
-        if (!facePath.exists()) {
-            std::cerr << "The face " << faceName << " does not exist" << std::endl;
-            success = false;
-            break;
-        }
-
-        int w, h, n;
-        unsigned char* data = stbi_load(facePath.getAbsolutePath().c_str(), &w, &h, &n, 4);
-        if (w != h || w != size) {
-            std::cerr << "Face " << faceName << "has a wrong size " << w << " x " << h <<
-                ", instead of " << size << " x " << size << std::endl;
-            success = false;
-            break;
-        }
-
-        if (data == nullptr || n != 4) {
-            std::cerr << "Could not decode face " << faceName << std::endl;
-            success = false;
-            break;
-        }
-
-        memcpy(p + faceSize * j, data, w * h * sizeof(uint32_t));
-
-        stbi_image_free(data);
+        js.run(jobs::createJob(js, parent, [&, j] {
+            if (failed.isCancelled()) {
+                return;
+            }
+
+            std::string faceName = levelPrefix + faceSuffix[j] + ".rgb32f";
+            Path facePath(Path::concat(path, faceName));
+            if (!facePath.exists()) {
+                std::cerr << "The face " << faceName << " does not exist" << std::endl;
+                failed.cancel();
+                return;
+            }
+
+            int w, h, n;
+            unsigned char* data = stbi_load(facePath.getAbsolutePath().c_str(), &w, &h, &n, 4);
+            if (data == nullptr || n != 4) {
+                std::cerr << "Could not decode face " << faceName << std::endl;
+                stbi_image_free(data);
+                failed.cancel();
+                return;
+            }
+
+            if (w != h || w != size) {
+                std::cerr << "Face " << faceName << "has a wrong size " << w << " x " << h <<
+                    ", instead of " << size << " x " << size << std::endl;
+                stbi_image_free(data);
+                failed.cancel();
+                return;
+            }
+
+            memcpy(p + faceSize * j, data, w * h * sizeof(uint32_t));
+
+            stbi_image_free(data);
+        }), JobSystem::JobPriority::BACKGROUND);
     }
+    parent = js.runAndRetain(parent, JobSystem::JobPriority::BACKGROUND);
+    js.waitAndRelease(parent);
+
+    bool const success = !failed.isCancelled();
 
     if (!success) return false;
 
@@ -50,6 +50,8 @@
 #include <math/vec3.h>
 #include <math/TVecHelpers.h>
 
+#include <geometry/TangentSpaceMesh.h>
+
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/cimport.h>
@@ -58,6 +60,8 @@
 
 #include <stb_image.h>
 
+#include <meshoptimizer.h>
+
 #include <backend/DriverEnums.h>
 
 #include "resource_internal.h"
@@ -539,7 +543,64 @@ namespace filament::assimp {
         return Box().set(bmin, bmax);
     }
 
-    void VzMeshAssimp::addFromFile(const Path& path, std::vector<ActorVID>& loadedActors) {
+    void VzMeshAssimp::optimizePart(std::vector<half4>& positions, std::vector<short4>& tangents,
+        std::vector<ushort2>& texCoords0, std::vector<ushort2>& texCoords1,
+        std::vector<uint32_t>& indices) {
+        const size_t vertexCount = positions.size();
+        meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertexCount);
+
+        // the remap also drops the vertices no triangle refers to
+        std::vector<uint32_t> remap(vertexCount);
+        const size_t uniqueCount = meshopt_optimizeVertexFetchRemap(remap.data(),
+            indices.data(), indices.size(), vertexCount);
+        meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+
+        auto remapStream = [&remap, vertexCount, uniqueCount](auto& stream) {
+            meshopt_remapVertexBuffer(stream.data(), stream.data(), vertexCount,
+                sizeof(stream[0]), remap.data());
+            stream.erase(stream.begin() + uniqueCount, stream.end());
+        };
+        remapStream(positions);
+        remapStream(tangents);
+        remapStream(texCoords0);
+        remapStream(texCoords1);
+    }
+
+    void VzMeshAssimp::simplifyPart(const std::vector<half4>& positions,
+        const std::vector<uint32_t>& indices, const LodOptions& lodOptions,
+        std::vector<std::vector<uint32_t>>& outLods, std::vector<float>& outErrors) {
+        std::vector<float3> points(positions.size());
+        for (size_t i = 0, n = positions.size(); i < n; ++i) {
+            points[i] = float3(positions[i].xyz);
+        }
+        // meshopt errors are relative to the mesh extent
+        const float scale = meshopt_simplifyScale(&points[0].x, points.size(), sizeof(float3));
+
+        // keep the source pointer valid while levels are appended
+        outLods.reserve(lodOptions.levels);
+        const std::vector<uint32_t>* source = &indices;
+        for (int level = 0; level < lodOptions.levels; ++level) {
+            const size_t target = size_t(float(source->size() / 3) * lodOptions.reduction) * 3;
+            std::vector<uint32_t> lod(source->size());
+            float error = 0.f;
+            lod.resize(meshopt_simplify(lod.data(), source->data(), source->size(),
+                &points[0].x, points.size(), sizeof(float3), target, lodOptions.maxError,
+                0, &error));
+            // stop once the simplifier is stuck (error bound hit) or nothing is left to draw
+            if (lod.empty() || lod.size() >= source->size() * 0.95f) {
+                break;
+            }
+            meshopt_optimizeVertexCache(lod.data(), lod.data(), lod.size(), points.size());
+            // errors of successive levels are measured against their source level
+            const float previous = outErrors.empty() ? 0.f : outErrors.back();
+            outErrors.push_back(previous + error * scale);
+            outLods.push_back(std::move(lod));
+            source = &outLods.back();
+        }
+    }
+
+    void VzMeshAssimp::addFromFile(const Path& path, std::vector<ActorVID>& loadedActors,
+        const LodOptions& lodOptions) {
 
         Asset asset;
         asset.file = path;
@@ -597,8 +658,29 @@ namespace filament::assimp {
                         VzPrimitive& prim = prims[i];
                         Part& part = mesh.parts[i];
 
+                        std::vector<half4> positions(asset.positions.begin() + part.vb_offset,
+                            asset.positions.begin() + part.vb_offset + part.vb_count);
+                        std::vector<short4> tangents(asset.tangents.begin() + part.vb_offset,
+                            asset.tangents.begin() + part.vb_offset + part.vb_count);
+                        std::vector<ushort2> texCoords0(asset.texCoords0.begin() + part.vb_offset,
+                            asset.texCoords0.begin() + part.vb_offset + part.vb_count);
+                        std::vector<ushort2> texCoords1(asset.texCoords1.begin() + part.vb_offset,
+                            asset.texCoords1.begin() + part.vb_offset + part.vb_count);
+                        std::vector<uint32_t> indices(asset.indices.begin() + part.offset,
+                            asset.indices.begin() + part.offset + part.count);
+
+                        std::vector<std::vector<uint32_t>> lods;
+                        if (!indices.empty() && (lodOptions.optimize || lodOptions.levels > 0))
+                        {
+                            optimizePart(positions, tangents, texCoords0, texCoords1, indices);
+                        }
+                        if (!indices.empty() && lodOptions.levels > 0)
+                        {
+                            simplifyPart(positions, indices, lodOptions, lods, prim.lodErrors);
+                        }
+
                         VertexBuffer::Builder vertexBufferBuilder = VertexBuffer::Builder()
-                            .vertexCount((uint32_t)part.vb_count)
+                            .vertexCount((uint32_t)positions.size())
                             .bufferCount(4)
                             .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::HALF4)
                             .attribute(VertexAttribute::TANGENTS, 1, VertexBuffer::AttributeType::SHORT4)
@@ -624,15 +706,6 @@ namespace filament::assimp {
 
                         //vertex_offset += mesh.vb_count;
 
-                        std::vector<half4> positions(asset.positions.begin() + part.vb_offset,
-                            asset.positions.begin() + part.vb_offset + part.vb_count);
-                        std::vector<short4> tangents(asset.tangents.begin() + part.vb_offset,
-                            asset.tangents.begin() + part.vb_offset + part.vb_count);
-                        std::vector<ushort2> texCoords0(asset.texCoords0.begin() + part.vb_offset,
-                            asset.texCoords0.begin() + part.vb_offset + part.vb_count);
-                        std::vector<ushort2> texCoords1(asset.texCoords1.begin() + part.vb_offset,
-                            asset.texCoords1.begin() + part.vb_offset + part.vb_count);
-
                         auto ps = new State<half4>(std::move(positions));
                         auto ns = new State<short4>(std::move(tangents));
                         auto t0s = new State<ushort2>(std::move(texCoords0));
@@ -650,8 +723,6 @@ namespace filament::assimp {
                         prim.vertices->setBufferAt(mEngine, 3,
                             VertexBuffer::BufferDescriptor(t1s->data(), t1s->size(), State<ushort2>::free, t1s));
 
-                        std::vector<uint32_t> indices(asset.indices.begin() + part.offset,
-                            asset.indices.begin() + part.offset + part.count);
                         auto is = new State<uint32_t>(std::move(indices));
 
 
@@ -659,6 +730,15 @@ namespace filament::assimp {
                         prim.indices->setBuffer(mEngine,
                             IndexBuffer::BufferDescriptor(is->data(), is->size(), State<uint32_t>::free, is));
 
+                        for (std::vector<uint32_t>& lod : lods)
+                        {
+                            auto ls = new State<uint32_t>(std::move(lod));
+                            IndexBuffer* lod_indices = IndexBuffer::Builder().indexCount(uint32_t(ls->size())).build(mEngine);
+                            lod_indices->setBuffer(mEngine,
+                                IndexBuffer::BufferDescriptor(ls->data(), ls->size(), State<uint32_t>::free, ls));
+                            prim.lods.push_back(lod_indices);
+                        }
+
                         prim.aabb.min = mesh.aabb.getMin();
                         prim.aabb.max = mesh.aabb.getMax();
                         prim.ptype = PrimitiveType::TRIANGLES;
@@ -936,28 +1016,41 @@ namespace filament::assimp {
                 if (numFaces > 0) {
                     size_t indicesOffset = asset.positions.size();
 
-                    for (size_t j = 0; j < numVertices; j++) {
-                        float3 normal = normals[j];
-                        float3 tangent;
-                        float3 bitangent;
+                    // If the tangent and bitangent don't exist, make arbitrary ones. This only
+                    // occurs when the mesh is missing texture coordinates, because assimp
+                    // computes tangents for us. (search up for aiProcess_CalcTangentSpace)
+                    // The frames are packed on the job system, this dominates the loading time
+                    // of large meshes.
+                    std::vector<float4> tangentsAndSigns;
+                    geometry::TangentSpaceMesh::Builder tsmBuilder;
+                    tsmBuilder.vertexCount(numVertices)
+                        .normals(normals)
+                        .jobSystem(&mEngine.getJobSystem())
+                        .jobPriority(utils::JobSystem::JobPriority::BACKGROUND);
+                    if (!tangents) {
+                        tsmBuilder.algorithm(geometry::TangentSpaceMesh::Algorithm::FRISVAD);
+                    }
+                    else {
+                        // the sign tells whether the bitangent is flipped, i.e. the frame reflected
+                        tangentsAndSigns.resize(numVertices);
+                        for (size_t j = 0; j < numVertices; j++) {
+                            float const w =
+                                dot(cross(tangents[j], normals[j]), bitangents[j]) < 0.0f ? -1.0f : 1.0f;
+                            tangentsAndSigns[j] = float4{ tangents[j], w };
+                        }
+                        tsmBuilder.tangents(tangentsAndSigns.data());
+                    }
+                    geometry::TangentSpaceMesh* tsm = tsmBuilder.build();
+                    size_t const tangentsOffset = asset.tangents.size();
+                    asset.tangents.resize(tangentsOffset + numVertices);
+                    tsm->getQuats(asset.tangents.data() + tangentsOffset);
+                    geometry::TangentSpaceMesh::destroy(tsm);
 
+                    for (size_t j = 0; j < numVertices; j++) {
                         // Assimp always returns 3D tex coords but we only support 2D tex coords.
                         float2 texCoord0 = texCoords0 ? texCoords0[j].xy : float2{ 0.0 };
                         float2 texCoord1 = texCoords1 ? texCoords1[j].xy : float2{ 0.0 };
-                        // If the tangent and bitangent don't exist, make arbitrary ones. This only
-                        // occurs when the mesh is missing texture coordinates, because assimp
-                        // computes tangents for us. (search up for aiProcess_CalcTangentSpace)
-                        if (!tangents) {
-                            bitangent = normalize(cross(normal, float3{ 1.0, 0.0, 0.0 }));
-                            tangent = normalize(cross(normal, bitangent));
-                        }
-                        else {
-                            tangent = tangents[j];
-                            bitangent = bitangents[j];
-                        }
 
-                        quatf q = filament::math::details::TMat33<float>::packTangentFrame({ tangent, bitangent, normal });
-                        asset.tangents.push_back(packSnorm16(q.xyzw));
                         asset.texCoords0.emplace_back(convertUV<SNORMUV0>(texCoord0));
                         asset.texCoords1.emplace_back(convertUV<SNORMUV1>(texCoord1));
 
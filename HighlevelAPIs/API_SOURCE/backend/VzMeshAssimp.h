@@ -57,7 +57,21 @@ namespace filament::assimp {
         explicit VzMeshAssimp(filament::Engine& engine);
         ~VzMeshAssimp();
 
-        void addFromFile(const utils::Path& path, std::vector<ActorVID>& loadedActors);
+        // Import-time mesh processing
+        //  - optimize : reorders indices for the post-transform cache and vertices for fetch locality, off by default
+        //               so that imports keep their vertex order, always done when LODs are generated
+        //  - levels : number of simplified index buffers generated per part (0 disables LODs)
+        //  - reduction : target index count ratio between two consecutive levels
+        //  - maxError : max. deviation relative to the part extent; simplification stops beyond it
+        struct LodOptions {
+            bool optimize = false;
+            int levels = 0;
+            float reduction = 0.5f;
+            float maxError = 0.05f;
+        };
+
+        void addFromFile(const utils::Path& path, std::vector<ActorVID>& loadedActors,
+            const LodOptions& lodOptions);
 
         //For use with normalizing coordinates
         filament::math::float3 minBound = filament::math::float3(1.0f);
@@ -105,6 +119,13 @@ namespace filament::assimp {
 
         bool setFromFile(Asset& asset, std::map<std::string, filament::MaterialInstance*>& outMaterials);
 
+        static void optimizePart(std::vector<half4>& positions, std::vector<short4>& tangents,
+            std::vector<ushort2>& texCoords0, std::vector<ushort2>& texCoords1,
+            std::vector<uint32_t>& indices);
+        static void simplifyPart(const std::vector<half4>& positions,
+            const std::vector<uint32_t>& indices, const LodOptions& lodOptions,
+            std::vector<std::vector<uint32_t>>& outLods, std::vector<float>& outErrors);
+
         //void processGLTFMaterial(const aiScene* scene, const aiMaterial* material,
         //    const std::string& materialName, const std::string& dirName,
         //    std::map<std::string, filament::MaterialInstance*>& outMaterials) const;
@@ -0,0 +1,478 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../VzEngineApp.h"
+#include "VzMeshFilamesh.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/Material.h>
+#include <filament/MaterialInstance.h>
+#include <filament/TransformManager.h>
+#include <filament/VertexBuffer.h>
+
+#include <filameshio/filamesh.h>
+
+#include <meshoptimizer.h>
+
+#include <utils/Log.h>
+
+#include "resource_internal.h"
+
+#if defined(WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+extern vzm::VzEngineApp* gEngineApp;
+
+namespace filament::meshio {
+    // Read-only mapping of a whole file, shared by all the buffer descriptors pointing into it.
+    // The loader holds one reference and each in-place buffer one more, the last release (possibly
+    // from the driver thread) unmaps the file.
+    struct VzMeshFilamesh::MappedFile {
+        std::atomic<uint32_t> refs{ 1 };
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+
+        static MappedFile* open(const std::string& filename)
+        {
+            MappedFile* file = new MappedFile();
+#if defined(WIN32)
+            HANDLE handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (handle != INVALID_HANDLE_VALUE)
+            {
+                LARGE_INTEGER size;
+                if (GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+                {
+                    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                    if (mapping)
+                    {
+                        // the view keeps the mapping alive
+                        file->data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                        file->size = file->data ? (size_t)size.QuadPart : 0;
+                        CloseHandle(mapping);
+                    }
+                }
+                CloseHandle(handle);
+            }
+#else
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd >= 0)
+            {
+                struct stat st;
+                if (fstat(fd, &st) == 0 && st.st_size > 0)
+                {
+                    void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (data != MAP_FAILED)
+                    {
+                        file->data = (const uint8_t*)data;
+                        file->size = (size_t)st.st_size;
+                    }
+                }
+                close(fd);
+            }
+#endif
+            if (file->data == nullptr)
+            {
+                delete file;
+                return nullptr;
+            }
+            return file;
+        }
+
+        ~MappedFile()
+        {
+#if defined(WIN32)
+            UnmapViewOfFile(data);
+#else
+            munmap((void*)data, size);
+#endif
+        }
+
+        void acquire()
+        {
+            refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void release()
+        {
+            if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete this;
+            }
+        }
+
+        // BufferDescriptor callback of the in-place buffers
+        static void free(void* buffer, size_t size, void* user)
+        {
+            static_cast<MappedFile*>(user)->release();
+        }
+    };
+
+    static void freeDecoded(void* buffer, size_t size, void* user)
+    {
+        ::free(buffer);
+    }
+
+    static MaterialVID vidMat = 0;
+
+    VzMeshFilamesh::VzMeshFilamesh(Engine& engine) : mEngine(engine)
+    {
+        VzMaterialRes* mat_res = gEngineApp->GetMaterialRes(vidMat);
+        if (mat_res == nullptr)
+        {
+            mDefaultColorMaterial = Material::Builder()
+                .package(FILAMENTAPP_AIDEFAULTMAT_DATA, FILAMENTAPP_AIDEFAULTMAT_SIZE)
+                .build(mEngine);
+
+            mDefaultColorMaterial->setDefaultParameter("baseColor", RgbType::LINEAR, float3{ 0.8 });
+            mDefaultColorMaterial->setDefaultParameter("metallic", 0.0f);
+            mDefaultColorMaterial->setDefaultParameter("roughness", 0.4f);
+            mDefaultColorMaterial->setDefaultParameter("reflectance", 0.5f);
+
+            vidMat = gEngineApp->CreateMaterial("Filamesh Default Material", mDefaultColorMaterial, nullptr, false)->GetVID();
+        }
+        else
+        {
+            mDefaultColorMaterial = mat_res->material;
+        }
+    }
+
+    VzMeshFilamesh::~VzMeshFilamesh()
+    {
+    }
+
+    bool VzMeshFilamesh::IsFilamesh(const std::string& filename)
+    {
+        char magic[8] = {};
+        std::ifstream in(filename, std::ios::binary);
+        if (!in.read(magic, sizeof(magic)))
+        {
+            return false;
+        }
+        return !strncmp(magic, filamesh::MAGICID, sizeof(magic)) ||
+            !strncmp(magic, filamesh::PACK_MAGICID, sizeof(magic));
+    }
+
+    bool VzMeshFilamesh::addFromFile(const std::string& filename, std::vector<ActorVID>& loadedActors)
+    {
+        MappedFile* file = MappedFile::open(filename);
+        if (file == nullptr)
+        {
+            utils::slog.e << "Unable to map " << filename.c_str() << utils::io::endl;
+            return false;
+        }
+
+        std::string model_name = std::filesystem::path(filename).filename().string();
+
+        bool succeeded = false;
+        const uint8_t* data = file->data;
+        const size_t size = file->size;
+        if (size >= sizeof(filamesh::MAGICID) && !strncmp((const char*)data, filamesh::MAGICID, sizeof(filamesh::MAGICID)))
+        {
+            succeeded = addMesh(file, data, size, model_name, loadedActors);
+        }
+        else if (size >= sizeof(filamesh::PACK_MAGICID) + sizeof(filamesh::PackHeader) &&
+            !strncmp((const char*)data, filamesh::PACK_MAGICID, sizeof(filamesh::PACK_MAGICID)))
+        {
+            filamesh::PackHeader header;
+            memcpy(&header, data + sizeof(filamesh::PACK_MAGICID), sizeof(header));
+
+            const size_t entries_offset = sizeof(filamesh::PACK_MAGICID) + sizeof(header);
+            std::vector<filamesh::PackEntry> entries(header.meshes);
+            succeeded = header.version == filamesh::PACK_VERSION && header.meshes > 0 &&
+                (size - entries_offset) / sizeof(filamesh::PackEntry) >= header.meshes;
+            if (succeeded)
+            {
+                memcpy(entries.data(), data + entries_offset, header.meshes * sizeof(filamesh::PackEntry));
+            }
+
+            // names follow the entry table
+            size_t p = entries_offset + header.meshes * sizeof(filamesh::PackEntry);
+            for (uint32_t i = 0; succeeded && i < header.meshes; ++i)
+            {
+                uint32_t name_length = 0;
+                if (size - p < sizeof(uint32_t))
+                {
+                    succeeded = false;
+                    break;
+                }
+                memcpy(&name_length, data + p, sizeof(uint32_t));
+                p += sizeof(uint32_t);
+                if (size - p <= name_length)
+                {
+                    succeeded = false;
+                    break;
+                }
+                std::string name((const char*)data + p, name_length);
+                p += name_length + 1; // null terminated
+
+                const filamesh::PackEntry& entry = entries[i];
+                if (entry.offset > size || entry.size > size - entry.offset)
+                {
+                    succeeded = false;
+                    break;
+                }
+                succeeded = addMesh(file, data + entry.offset, (size_t)entry.size,
+                    name.empty() ? model_name + " [" + std::to_string(i) + "]" : name, loadedActors);
+            }
+        }
+
+        if (!succeeded)
+        {
+            utils::slog.e << filename.c_str() << " is not a valid filamesh file" << utils::io::endl;
+        }
+
+        // the buffers still in flight keep the file mapped
+        file->release();
+        return succeeded;
+    }
+
+    bool VzMeshFilamesh::addMesh(MappedFile* file, const uint8_t* data, size_t size, const std::string& name,
+        std::vector<ActorVID>& loadedActors)
+    {
+        using namespace filamesh;
+
+        if (size < sizeof(MAGICID) + sizeof(Header) || strncmp((const char*)data, MAGICID, sizeof(MAGICID)))
+        {
+            return false;
+        }
+
+        Header header;
+        memcpy(&header, data + sizeof(MAGICID), sizeof(header));
+        size_t p = sizeof(MAGICID) + sizeof(header);
+
+        if (header.version != VERSION || header.parts == 0 ||
+            size - p < (size_t)header.vertexSize + header.indexSize)
+        {
+            return false;
+        }
+        const uint8_t* vertex_data = data + p;
+        p += header.vertexSize;
+        const uint8_t* index_data = data + p;
+        p += header.indexSize;
+
+        if ((size - p) / sizeof(Part) < header.parts)
+        {
+            return false;
+        }
+        std::vector<Part> parts(header.parts);
+        memcpy(parts.data(), data + p, header.parts * sizeof(Part));
+        p += header.parts * sizeof(Part);
+
+        std::vector<std::string> part_materials;
+        uint32_t material_count = 0;
+        if (size - p >= sizeof(uint32_t))
+        {
+            memcpy(&material_count, data + p, sizeof(uint32_t));
+            p += sizeof(uint32_t);
+        }
+        for (uint32_t i = 0; i < material_count && size - p > sizeof(uint32_t); ++i)
+        {
+            uint32_t name_length = 0;
+            memcpy(&name_length, data + p, sizeof(uint32_t));
+            p += sizeof(uint32_t);
+            if (size - p <= name_length)
+            {
+                break;
+            }
+            part_materials.emplace_back((const char*)data + p, name_length);
+            p += name_length + 1; // null terminated
+        }
+
+        const bool compressed = header.flags & COMPRESSION;
+        const bool snorm_uvs = header.flags & TEXCOORD_SNORM16;
+        constexpr uint32_t uintmax = std::numeric_limits<uint32_t>::max();
+        const bool has_uv1 = header.offsetUV1 != uintmax && header.strideUV1 != uintmax;
+
+        // decode the compressed streams first, so a corrupted file doesn't leave half-built buffers
+        void* indices = (void*)index_data;
+        size_t indices_size = header.indexSize;
+        void* vertices = (void*)vertex_data;
+        size_t vertices_size = header.vertexSize;
+        if (compressed)
+        {
+            // the stream sizes are read from the file, check them against the data they index into
+            if (header.vertexSize < sizeof(CompressionHeader))
+            {
+                return false;
+            }
+            if (!(header.flags & INTERLEAVED))
+            {
+                CompressionHeader sizes;
+                memcpy(&sizes, vertex_data, sizeof(sizes));
+                const uint64_t streams_size = (uint64_t)sizes.positions + sizes.tangents + sizes.colors +
+                    sizes.uv0 + (has_uv1 ? sizes.uv1 : 0);
+                if (streams_size > header.vertexSize - sizeof(CompressionHeader))
+                {
+                    return false;
+                }
+            }
+
+            const size_t index_size = header.indexType == UI16 ? sizeof(uint16_t) : sizeof(uint32_t);
+            indices_size = index_size * header.indexCount;
+            indices = malloc(indices_size);
+            int err = meshopt_decodeIndexBuffer(indices, header.indexCount, index_size,
+                index_data, header.indexSize);
+
+            const size_t vertex_size = sizeof(half4) + sizeof(short4) + sizeof(ubyte4) + sizeof(ushort2) +
+                (has_uv1 ? sizeof(ushort2) : 0);
+            vertices_size = vertex_size * header.vertexCount;
+            vertices = malloc(vertices_size);
+            const uint8_t* src = vertex_data + sizeof(CompressionHeader);
+            const size_t src_size = header.vertexSize - sizeof(CompressionHeader);
+            if (header.flags & INTERLEAVED)
+            {
+                err |= meshopt_decodeVertexBuffer(vertices, header.vertexCount, vertex_size, src, src_size);
+            }
+            else
+            {
+                CompressionHeader sizes;
+                memcpy(&sizes, vertex_data, sizeof(sizes));
+                uint8_t* dst = (uint8_t*)vertices;
+                const std::pair<size_t, uint32_t> streams[] = {
+                    { sizeof(half4), sizes.positions },
+                    { sizeof(short4), sizes.tangents },
+                    { sizeof(ubyte4), sizes.colors },
+                    { sizeof(ushort2), sizes.uv0 },
+                    { sizeof(ushort2), has_uv1 ? sizes.uv1 : 0 },
+                };
+                for (const auto& stream : streams)
+                {
+                    if (stream.second == 0)
+                    {
+                        continue;
+                    }
+                    err |= meshopt_decodeVertexBuffer(dst, header.vertexCount, stream.first, src, stream.second);
+                    src += stream.second;
+                    dst += stream.first * header.vertexCount;
+                }
+            }
+
+            if (err)
+            {
+                ::free(indices);
+                ::free(vertices);
+                utils::slog.e << "Unable to decode " << name.c_str() << utils::io::endl;
+                return false;
+            }
+        }
+
+        IndexBuffer* ib = IndexBuffer::Builder()
+            .indexCount(header.indexCount)
+            .bufferType(header.indexType == UI16 ? IndexBuffer::IndexType::USHORT : IndexBuffer::IndexType::UINT)
+            .build(mEngine);
+
+        const VertexBuffer::AttributeType uv_type = snorm_uvs ?
+            VertexBuffer::AttributeType::SHORT2 : VertexBuffer::AttributeType::HALF2;
+        VertexBuffer::Builder vbb = VertexBuffer::Builder()
+            .vertexCount(header.vertexCount)
+            .bufferCount(1)
+            .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::HALF4,
+                header.offsetPosition, uint8_t(header.stridePosition))
+            .attribute(VertexAttribute::TANGENTS, 0, VertexBuffer::AttributeType::SHORT4,
+                header.offsetTangents, uint8_t(header.strideTangents))
+            .normalized(VertexAttribute::TANGENTS)
+            .attribute(VertexAttribute::COLOR, 0, VertexBuffer::AttributeType::UBYTE4,
+                header.offsetColor, uint8_t(header.strideColor))
+            .normalized(VertexAttribute::COLOR)
+            .attribute(VertexAttribute::UV0, 0, uv_type, header.offsetUV0, uint8_t(header.strideUV0))
+            .normalized(VertexAttribute::UV0, snorm_uvs);
+        if (has_uv1)
+        {
+            vbb.attribute(VertexAttribute::UV1, 0, uv_type, header.offsetUV1, uint8_t(header.strideUV1))
+                .normalized(VertexAttribute::UV1, snorm_uvs);
+        }
+        VertexBuffer* vb = vbb.build(mEngine);
+
+        // uncompressed streams go to the driver straight from the mapping, each holding a reference
+        if (compressed)
+        {
+            ib->setBuffer(mEngine, IndexBuffer::BufferDescriptor(indices, indices_size, freeDecoded, nullptr));
+            vb->setBufferAt(mEngine, 0, VertexBuffer::BufferDescriptor(vertices, vertices_size, freeDecoded, nullptr));
+        }
+        else
+        {
+            file->acquire();
+            ib->setBuffer(mEngine, IndexBuffer::BufferDescriptor(indices, indices_size, MappedFile::free, file));
+            file->acquire();
+            vb->setBufferAt(mEngine, 0, VertexBuffer::BufferDescriptor(vertices, vertices_size, MappedFile::free, file));
+        }
+
+        ActorVID vid_actor = gEngineApp->CreateSceneComponent(SCENE_COMPONENT_TYPE::ACTOR, name)->GetVID();
+        loadedActors.push_back(vid_actor);
+
+        std::vector<VzPrimitive> empty_prims;
+        GeometryVID vid_geo = gEngineApp->CreateGeometry(name + " (Geometry)", empty_prims)->GetVID();
+        VzActorRes* actor_res = gEngineApp->GetActorRes(vid_actor);
+
+        std::vector<VzPrimitive> prims(parts.size());
+        std::vector<MInstanceVID> mis(parts.size());
+        for (size_t i = 0, n = parts.size(); i < n; ++i)
+        {
+            VzPrimitive& prim = prims[i];
+            const Part& part = parts[i];
+
+            prim.vertices = vb;
+            prim.indices = ib;
+            prim.indexOffset = part.offset;
+            prim.indexCount = part.indexCount;
+            prim.aabb.min = part.aabb.getMin();
+            prim.aabb.max = part.aabb.getMax();
+            prim.ptype = PrimitiveType::TRIANGLES;
+
+            std::string name_mi = n == 1 ? name + " (MI)" : name + " Part[" + std::to_string(i) + "] (MI)";
+            if (part.material < part_materials.size())
+            {
+                name_mi = name + " " + part_materials[part.material] + " (MI)";
+            }
+            MaterialInstance* mi = mDefaultColorMaterial->createInstance(name_mi.c_str());
+            mis[i] = gEngineApp->CreateMaterialInstance(name_mi, vidMat, mi)->GetVID();
+        }
+
+        VzGeometryRes* geo_res = gEngineApp->GetGeometryRes(vid_geo);
+        geo_res->Set(prims);
+        actor_res->SetGeometry(vid_geo);
+        actor_res->SetMIs(mis);
+
+        gEngineApp->BuildRenderable(vid_actor);
+        return true;
+    }
+}
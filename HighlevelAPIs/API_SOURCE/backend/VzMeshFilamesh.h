@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VZ_MESH_FILAMESH_H
+#define VZ_MESH_FILAMESH_H
+
+namespace filament {
+    class Engine;
+    class Material;
+}
+
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament::meshio {
+    // Loads filamesh files and packs of them (see tools/filamesh) into actors
+    //  - the file is memory-mapped and its vertex and index streams are handed to the engine in place,
+    //    the mapping is released once the driver has consumed the last of them
+    //  - compressed streams cannot be used in place and are decoded into temporary buffers
+    //  - each mesh becomes an actor with one primitive per part, all parts share the mesh buffers
+    class VzMeshFilamesh {
+    public:
+        explicit VzMeshFilamesh(filament::Engine& engine);
+        ~VzMeshFilamesh();
+
+        // whether the file starts with the filamesh or the pack magic identifier
+        static bool IsFilamesh(const std::string& filename);
+
+        // return false if the file cannot be mapped or is not a valid filamesh or pack
+        bool addFromFile(const std::string& filename, std::vector<ActorVID>& loadedActors);
+
+    private:
+        struct MappedFile;
+
+        bool addMesh(MappedFile* file, const uint8_t* data, size_t size, const std::string& name,
+            std::vector<ActorVID>& loadedActors);
+
+        filament::Engine& mEngine;
+        filament::Material* mDefaultColorMaterial = nullptr;
+    };
+}
+
+#endif // VZ_MESH_FILAMESH_H
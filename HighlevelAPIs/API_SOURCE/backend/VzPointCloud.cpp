@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VzPointCloud.h"
+#include "VzPointCloudOctree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <queue>
+
+#include <filament/Box.h>
+#include <filament/Camera.h>
+#include <filament/Engine.h>
+#include <filament/Frustum.h>
+#include <filament/IndexBuffer.h>
+#include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
+#include <filament/Scene.h>
+#include <filament/TransformManager.h>
+#include <filament/VertexBuffer.h>
+
+#include <utils/EntityManager.h>
+#include <utils/JobSystem.h>
+
+#include "../../../filament/src/Culler.h"
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+extern Engine* gEngine;
+extern vzm::VzEngineApp* gEngineApp;
+
+namespace vzm
+{
+    namespace
+    {
+        using Point = VzPointCloudOctree::Point;
+    }
+
+    // Reads the points of a node, in a background job
+    struct VzPointCloud::Load
+    {
+        std::string fileName;
+        uint64_t offset = 0;
+        uint32_t count = 0;
+        std::vector<Point> points;
+        bool failed = false;
+        CancellationToken cancelled;
+        std::atomic<bool> done{ false };
+        JobSystem::Job* job = nullptr;
+
+        void run()
+        {
+            if (cancelled.isCancelled())
+            {
+                failed = true;
+                return;
+            }
+            std::ifstream in(fileName, std::ios::binary);
+            in.seekg(std::streamoff(offset));
+            points.resize(count);
+            failed = !in.read((char*)points.data(), std::streamsize(count) * sizeof(Point));
+        }
+    };
+
+    std::unique_ptr<VzPointCloud> VzPointCloud::Open(const std::string& filename, const Options& options)
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(filename, ec))
+        {
+            backlog::post("Point cloud file not found: " + filename, backlog::LogLevel::Error);
+            return nullptr;
+        }
+        std::filesystem::path folder = options.cacheFolder;
+        if (folder.empty())
+        {
+            const std::string path = std::filesystem::absolute(filename, ec).string();
+            folder = std::filesystem::temp_directory_path(ec) / ("vzm_pointcloud_" + std::to_string(std::hash<std::string>{}(path)));
+        }
+        std::filesystem::create_directories(folder, ec);
+
+        std::unique_ptr<VzPointCloud> cloud(new VzPointCloud());
+        cloud->options_ = options;
+        cloud->nodeFile_ = (folder / "octree.bin").string();
+        if (!VzPointCloudOctree::IsCached(filename, folder.string()))
+        {
+            backlog::post("Building the point cloud octree of " + filename + " in " + folder.string(), backlog::LogLevel::Default);
+            if (!VzPointCloudOctree::Build(filename, folder.string()))
+            {
+                backlog::post("Point cloud cannot be built from " + filename, backlog::LogLevel::Error);
+                return nullptr;
+            }
+        }
+        VzPointCloudOctree octree;
+        if (!octree.Read(folder.string()))
+        {
+            backlog::post("Point cloud index is corrupted: " + (folder / "index.bin").string(), backlog::LogLevel::Error);
+            return nullptr;
+        }
+        cloud->center_ = octree.center;
+        cloud->pointCount_ = octree.pointCount;
+        cloud->nodes_.resize(octree.nodes.size());
+        for (size_t i = 0, n = octree.nodes.size(); i < n; ++i)
+        {
+            static_cast<VzPointCloudOctree::Node&>(cloud->nodes_[i]) = octree.nodes[i];
+        }
+        return cloud;
+    }
+
+    VzPointCloud::~VzPointCloud()
+    {
+        JobSystem& js = gEngine->getJobSystem();
+        for (Node& node : nodes_)
+        {
+            if (node.load)
+            {
+                node.load->cancelled.cancel();
+                js.waitAndRelease(node.load->job);
+                node.load.reset();
+            }
+        }
+        for (uint32_t i = 1, n = (uint32_t)nodes_.size(); i < n; ++i)
+        {
+            release(i);
+        }
+        // the root is the renderable of the actor, it goes before its buffer
+        if (!nodes_.empty() && nodes_[0].vertices)
+        {
+            gEngine->getRenderableManager().destroy(Entity::import(vidActor_));
+            gEngine->destroy(nodes_[0].vertices);
+        }
+        if (indices_)
+        {
+            gEngine->destroy(indices_);
+        }
+    }
+
+    void VzPointCloud::Attach(const ActorVID vid, MaterialInstance* mi)
+    {
+        assert(vidActor_ == INVALID_VID);
+        vidActor_ = vid;
+        mi_ = mi;
+
+        uint32_t max_count = 0;
+        for (const Node& node : nodes_)
+        {
+            max_count = std::max(max_count, node.pointCount);
+        }
+        auto* indices = new std::vector<uint32_t>(max_count);
+        for (uint32_t i = 0; i < max_count; ++i)
+        {
+            (*indices)[i] = i;
+        }
+        indices_ = IndexBuffer::Builder()
+            .indexCount(max_count)
+            .bufferType(IndexBuffer::IndexType::UINT)
+            .build(*gEngine);
+        indices_->setBuffer(*gEngine, IndexBuffer::BufferDescriptor(indices->data(), indices->size() * sizeof(uint32_t),
+            [](void*, size_t, void* user) { delete static_cast<std::vector<uint32_t>*>(user); }, indices));
+
+        // the points are relative to their center, which is large for geo-referenced scans
+        VzSceneComp* comp = gEngineApp->GetVzComponent<VzSceneComp>(vid);
+        const float position[3] = { float(center_.x), float(center_.y), float(center_.z) };
+        comp->SetPosition(position);
+
+        // the root is always drawn, it is read now
+        nodes_[0].load = std::make_unique<Load>();
+        nodes_[0].load->fileName = nodeFile_;
+        nodes_[0].load->offset = nodes_[0].offset;
+        nodes_[0].load->count = nodes_[0].pointCount;
+        nodes_[0].load->run();
+        finishLoad(0);
+    }
+
+    void VzPointCloud::Update(const Camera& camera, const uint32_t viewportHeight)
+    {
+        frame_++;
+        JobSystem& js = gEngine->getJobSystem();
+        size_t pending_loads = 0;
+        for (uint32_t i = 0, n = (uint32_t)nodes_.size(); i < n; ++i)
+        {
+            Load* load = nodes_[i].load.get();
+            if (load && load->done.load(std::memory_order_acquire))
+            {
+                js.waitAndRelease(load->job);
+                finishLoad(i);
+            }
+            pending_loads += nodes_[i].load ? 1 : 0;
+        }
+
+        auto& rcm = gEngine->getRenderableManager();
+        auto& tcm = gEngine->getTransformManager();
+        const Entity ett_actor = Entity::import(vidActor_);
+        const auto ins_actor = rcm.getInstance(ett_actor);
+        if (viewportHeight == 0 || !ins_actor.isValid())
+        {
+            return;
+        }
+        const uint8_t actor_layer_mask = rcm.getLayerMask(ins_actor);
+        const mat4f os2ws = tcm.getWorldTransform(tcm.getInstance(ett_actor));
+        const float ws_scale = std::sqrt(std::max({
+            length2(os2ws[0].xyz), length2(os2ws[1].xyz), length2(os2ws[2].xyz) }));
+
+        // world-space bounds of every node, culled in one batch
+        const size_t node_count = nodes_.size();
+        centers_.resize(Culler::round(node_count));
+        extents_.resize(Culler::round(node_count));
+        visibility_.assign(Culler::round(node_count), 0);
+        for (size_t i = 0; i < node_count; ++i)
+        {
+            const Box box = rigidTransform(Box{ nodes_[i].center, float3(nodes_[i].halfSize) }, os2ws);
+            centers_[i] = box.center;
+            extents_[i] = box.halfExtent;
+        }
+        Culler::intersects(visibility_.data(), camera.getFrustum(), centers_.data(), extents_.data(), node_count, 0);
+
+        // same projection as the LOD selection (see VzEngineApp::UpdateActorLOD)
+        const mat4 proj = camera.getProjectionMatrix();
+        const bool is_ortho = proj[3][3] == 1.0;
+        const double pixels_per_unit = std::abs(proj[1][1]) * 0.5 * viewportHeight;
+        const double3 eye = camera.getPosition();
+        auto get_distance = [&](const size_t i) {
+            if (is_ortho)
+            {
+                return 1.0;
+            }
+            const double radius = double(nodes_[i].halfSize) * ws_scale * std::sqrt(3.0);
+            return std::max(length(double3(centers_[i]) - eye) - radius, camera.getNear());
+            };
+
+        // the largest nodes on screen first, a node is refined while its points are further apart than pixelError
+        std::priority_queue<std::pair<double, uint32_t>> queue;
+        queue.emplace(0.0, 0);
+        size_t visible_points = 0;
+        size_t selected_points = 0; // the visible ones and the ones being loaded to be drawn
+        requests_.clear();
+        while (!queue.empty())
+        {
+            const uint32_t i = queue.top().second;
+            queue.pop();
+            Node& node = nodes_[i];
+            // checked before loading, a node over the budget would be released as soon as loaded, then requested again
+            if (i != 0 && selected_points + node.pointCount > options_.pointBudget)
+            {
+                continue;
+            }
+            selected_points += node.pointCount;
+            if (node.vertices == nullptr)
+            {
+                if (!node.load && node.pointCount > 0)
+                {
+                    requests_.push_back(i);
+                }
+                continue;
+            }
+            visible_points += node.pointCount;
+            node.lastSelected = frame_;
+
+            const double distance = get_distance(i);
+            const double spacing = 2.0 * node.halfSize * ws_scale / GRID * pixels_per_unit / distance;
+            if (spacing <= options_.pixelError)
+            {
+                continue;
+            }
+            for (int32_t child : node.children)
+            {
+                if (child >= 0 && (visibility_[child] & 1))
+                {
+                    queue.emplace(nodes_[child].halfSize * ws_scale / get_distance(child), uint32_t(child));
+                }
+            }
+        }
+        visiblePoints_ = visible_points;
+
+        for (uint32_t i : requests_)
+        {
+            if (pending_loads >= MAX_PENDING_LOADS)
+            {
+                break;
+            }
+            startLoad(i);
+            pending_loads++;
+        }
+
+        // the root follows the actor's layer mask, set by the client
+        resident_.clear();
+        for (uint32_t i = 1, n = (uint32_t)node_count; i < n; ++i)
+        {
+            Node& node = nodes_[i];
+            if (node.vertices == nullptr)
+            {
+                continue;
+            }
+            const uint8_t layer_mask = node.lastSelected == frame_ ? actor_layer_mask : 0;
+            if (node.layerMask != layer_mask)
+            {
+                rcm.setLayerMask(rcm.getInstance(node.entity), 0xff, layer_mask);
+                node.layerMask = layer_mask;
+            }
+            if (node.lastSelected != frame_)
+            {
+                resident_.push_back(i);
+            }
+        }
+
+        // least recently drawn nodes first
+        if (residentPoints_ > 2 * options_.pointBudget)
+        {
+            std::sort(resident_.begin(), resident_.end(), [this](const uint32_t a, const uint32_t b) {
+                return nodes_[a].lastSelected < nodes_[b].lastSelected;
+                });
+            for (size_t k = 0, n = resident_.size(); k < n && residentPoints_ > 2 * options_.pointBudget; ++k)
+            {
+                release(resident_[k]);
+            }
+        }
+    }
+
+    void VzPointCloud::SyncScene()
+    {
+        Scene* scene = gEngineApp->GetScene(gEngineApp->GetSceneVidBelongTo(vidActor_));
+        for (uint32_t i = 1, n = (uint32_t)nodes_.size(); i < n; ++i)
+        {
+            Node& node = nodes_[i];
+            if (node.vertices == nullptr)
+            {
+                continue;
+            }
+            for (auto& it : *gEngineApp->GetScenes())
+            {
+                if (it.second != scene)
+                {
+                    it.second->remove(node.entity);
+                }
+            }
+            if (scene && !scene->hasEntity(node.entity))
+            {
+                scene->addEntity(node.entity);
+            }
+        }
+    }
+
+    bool VzPointCloud::IsNodeEntity(const Entity ett) const
+    {
+        if (ett.isNull())
+        {
+            return false;
+        }
+        for (size_t i = 1, n = nodes_.size(); i < n; ++i)
+        {
+            if (nodes_[i].entity == ett)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void VzPointCloud::startLoad(const uint32_t index)
+    {
+        Node& node = nodes_[index];
+        assert(!node.load && node.vertices == nullptr);
+        node.load = std::make_unique<Load>();
+        Load* load = node.load.get();
+        load->fileName = nodeFile_;
+        load->offset = node.offset;
+        load->count = node.pointCount;
+
+        // retained so that Update() and the destructor can release it, it's done by then
+        JobSystem& js = gEngine->getJobSystem();
+        load->job = js.runAndRetain(jobs::createJob(js, nullptr, [load] {
+            load->run();
+            load->done.store(true, std::memory_order_release);
+            }), JobSystem::JobPriority::BACKGROUND);
+    }
+
+    void VzPointCloud::finishLoad(const uint32_t index)
+    {
+        Node& node = nodes_[index];
+        std::unique_ptr<Load> load = std::move(node.load);
+        if (load->failed)
+        {
+            // the node stays unloaded, its parent keeps standing for it
+            backlog::post("Point cloud node cannot be read from " + nodeFile_, backlog::LogLevel::Error);
+            node.pointCount = 0;
+            return;
+        }
+
+        node.vertices = VertexBuffer::Builder()
+            .vertexCount(node.pointCount)
+            .bufferCount(1)
+            .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT3, offsetof(Point, position), sizeof(Point))
+            .attribute(VertexAttribute::COLOR, 0, VertexBuffer::AttributeType::UBYTE4, offsetof(Point, color), sizeof(Point))
+            .normalized(VertexAttribute::COLOR)
+            .build(*gEngine);
+        auto* points = new std::vector<Point>(std::move(load->points));
+        node.vertices->setBufferAt(*gEngine, 0, VertexBuffer::BufferDescriptor(points->data(), points->size() * sizeof(Point),
+            [](void*, size_t, void* user) { delete static_cast<std::vector<Point>*>(user); }, points));
+        residentPoints_ += node.pointCount;
+
+        const Entity ett_actor = Entity::import(vidActor_);
+        if (index == 0)
+        {
+            node.entity = ett_actor;
+        }
+        else
+        {
+            // follows the actor transform and scene, like a child component would
+            auto& tcm = gEngine->getTransformManager();
+            node.entity = EntityManager::get().create();
+            tcm.create(node.entity, tcm.getInstance(ett_actor), mat4f());
+            Scene* scene = gEngineApp->GetScene(gEngineApp->GetSceneVidBelongTo(vidActor_));
+            if (scene)
+            {
+                scene->addEntity(node.entity);
+            }
+        }
+        RenderableManager::Builder(1)
+            .boundingBox(Box{ node.center, float3(node.halfSize) })
+            .material(0, mi_)
+            .geometry(0, RenderableManager::PrimitiveType::POINTS, node.vertices, indices_, 0, node.pointCount)
+            .culling(true)
+            .castShadows(false)
+            .receiveShadows(false)
+            .build(*gEngine, node.entity);
+        if (index != 0)
+        {
+            // drawn once selected by the next Update()
+            auto& rcm = gEngine->getRenderableManager();
+            rcm.setLayerMask(rcm.getInstance(node.entity), 0xff, 0);
+            node.layerMask = 0;
+        }
+    }
+
+    void VzPointCloud::release(const uint32_t index)
+    {
+        Node& node = nodes_[index];
+        if (node.vertices == nullptr)
+        {
+            return;
+        }
+        for (auto& it : *gEngineApp->GetScenes())
+        {
+            it.second->remove(node.entity);
+        }
+        gEngine->destroy(node.entity);
+        EntityManager::get().destroy(node.entity);
+        node.entity = {};
+        gEngine->destroy(node.vertices);
+        node.vertices = nullptr;
+        residentPoints_ -= node.pointCount;
+    }
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VZ_POINT_CLOUD_H
+#define VZ_POINT_CLOUD_H
+
+#include "../VzEngineApp.h"
+#include "VzPointCloudOctree.h"
+
+#include <math/vec3.h>
+
+#include <utils/Entity.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+    class Camera;
+    class IndexBuffer;
+    class MaterialInstance;
+    class VertexBuffer;
+}
+
+namespace vzm
+{
+    // Octree of a large point file (binary or ascii PLY, or xyz-like text), rendered with a point budget
+    //  - the octree is built out-of-core once and kept in a cache folder next to nothing but its source,
+    //    it is rebuilt when the source file changes
+    //  - every node keeps at most one point per cell of a GRID^3 grid over its bounds (its spacing), the rest go to
+    //    its children, so a node and its ancestors make a uniform subsample of the points inside it
+    //  - each frame the nodes are culled in one batch with the engine's Culler, then refined by decreasing
+    //    on-screen size while their projected spacing exceeds the pixel error and the point budget allows
+    //  - node points are read in background jobs, each node is a renderable under the actor (the root is the actor),
+    //    least recently used nodes are released when the resident points exceed twice the budget
+    class VzPointCloud
+    {
+    public:
+        static constexpr uint32_t GRID = VzPointCloudOctree::GRID;
+        static constexpr size_t MAX_PENDING_LOADS = 4;
+
+        struct Options
+        {
+            size_t pointBudget = 10'000'000;
+            float pixelError = 2.f;     // max. projected spacing of the drawn points
+            float pointSize = 2.f;      // in pixels
+            std::string cacheFolder;    // empty means a folder in the temp folder, named after the file
+        };
+
+        // Builds the octree or reuses the cached one, then reads its root
+        //  - return nullptr if the file cannot be read
+        static std::unique_ptr<VzPointCloud> Open(const std::string& filename, const Options& options);
+        ~VzPointCloud();
+
+        // Gives the root node to the actor entity and moves the actor to the center of the points
+        void Attach(const ActorVID vid, filament::MaterialInstance* mi);
+
+        // Selects, loads and releases the nodes for this view
+        void Update(const filament::Camera& camera, const uint32_t viewportHeight);
+
+        // Moves the loaded nodes to the scene the actor belongs to, out of every scene if it has none
+        void SyncScene();
+        // Whether the entity is the renderable of a loaded node other than the root
+        bool IsNodeEntity(const utils::Entity ett) const;
+
+        void SetPointBudget(const size_t pointBudget) { options_.pointBudget = pointBudget; }
+        size_t GetPointBudget() const { return options_.pointBudget; }
+        void SetPixelError(const float pixelError) { options_.pixelError = pixelError; }
+        float GetPixelError() const { return options_.pixelError; }
+        size_t GetPointCount() const { return pointCount_; }
+        size_t GetVisiblePointCount() const { return visiblePoints_; }
+
+    private:
+        struct Load;
+        struct Node : VzPointCloudOctree::Node
+        {
+            utils::Entity entity;
+            filament::VertexBuffer* vertices = nullptr;
+            std::unique_ptr<Load> load;
+            uint32_t lastSelected = 0;
+            uint8_t layerMask = 0;
+        };
+
+        VzPointCloud() = default;
+        void startLoad(const uint32_t index);
+        void finishLoad(const uint32_t index);
+        void release(const uint32_t index);
+
+        Options options_;
+        std::string nodeFile_;
+        filament::math::double3 center_;
+        size_t pointCount_ = 0;
+        std::vector<Node> nodes_; // nodes_[0] is the root
+
+        ActorVID vidActor_ = INVALID_VID;
+        filament::MaterialInstance* mi_ = nullptr;
+        filament::IndexBuffer* indices_ = nullptr; // 0, 1, 2, ... shared by all the nodes
+        uint32_t frame_ = 0;
+        size_t residentPoints_ = 0;
+        size_t visiblePoints_ = 0;
+
+        // per frame scratch
+        std::vector<filament::math::float3> centers_;
+        std::vector<filament::math::float3> extents_;
+        std::vector<uint8_t> visibility_;
+        std::vector<uint32_t> requests_;
+        std::vector<uint32_t> resident_;
+    };
+}
+
+#endif // VZ_POINT_CLOUD_H
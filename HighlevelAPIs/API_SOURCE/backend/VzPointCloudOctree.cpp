@@ -0,0 +1,789 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VzPointCloudOctree.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace filament::math;
+
+namespace vzm
+{
+    namespace
+    {
+        constexpr char INDEX_MAGIC[8] = { 'V', 'Z', 'P', 'C', 'L', 'O', 'U', 'D' };
+        constexpr uint32_t INDEX_VERSION = 1;
+        constexpr uint32_t GRID_WORDS = VzPointCloudOctree::GRID * VzPointCloudOctree::GRID * VzPointCloudOctree::GRID / 64;
+        constexpr size_t MAX_LEAF_POINTS = 32768;   // nodes with fewer points are not split
+        constexpr uint32_t MAX_DEPTH = 24;          // for duplicated points
+        constexpr size_t CHUNK_POINTS = 8'000'000;  // larger point sets are split through temporary files
+        constexpr uint32_t STREAM_LEVELS = 2;       // levels sampled while splitting a point set, 8^STREAM_LEVELS chunks
+        constexpr size_t CHUNK_FLUSH_POINTS = 16384;
+
+        using Point = VzPointCloudOctree::Point;
+        static_assert(sizeof(Point) == 16, "Point is the vertex layout");
+
+        struct NodeRecord
+        {
+            std::string name; // octant digits from the root, the root is ""
+            uint64_t offset = 0;
+            uint32_t count = 0;
+        };
+
+        uint32_t packColor(const double r, const double g, const double b)
+        {
+            auto to_byte = [](const double v) { return uint32_t(std::min(std::max(v, 0.0), 255.0) + 0.5); };
+            return to_byte(r) | (to_byte(g) << 8) | (to_byte(b) << 16) | 0xff000000u;
+        }
+
+        bool hasExtension(const std::string& filename, const char* extension)
+        {
+            std::string ext = std::filesystem::path(filename).extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+            return ext == extension;
+        }
+
+#pragma region // point files
+        enum class PlyType : uint8_t { NONE, INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64 };
+
+        PlyType parsePlyType(const std::string& name)
+        {
+            if (name == "char" || name == "int8") return PlyType::INT8;
+            if (name == "uchar" || name == "uint8") return PlyType::UINT8;
+            if (name == "short" || name == "int16") return PlyType::INT16;
+            if (name == "ushort" || name == "uint16") return PlyType::UINT16;
+            if (name == "int" || name == "int32") return PlyType::INT32;
+            if (name == "uint" || name == "uint32") return PlyType::UINT32;
+            if (name == "float" || name == "float32") return PlyType::FLOAT32;
+            if (name == "double" || name == "float64") return PlyType::FLOAT64;
+            return PlyType::NONE;
+        }
+
+        size_t getPlyTypeSize(const PlyType type)
+        {
+            switch (type)
+            {
+            case PlyType::INT8: case PlyType::UINT8: return 1;
+            case PlyType::INT16: case PlyType::UINT16: return 2;
+            case PlyType::INT32: case PlyType::UINT32: case PlyType::FLOAT32: return 4;
+            case PlyType::FLOAT64: return 8;
+            default: return 0;
+            }
+        }
+
+        template <typename T>
+        double readAs(const uint8_t* p)
+        {
+            T v;
+            memcpy(&v, p, sizeof(T));
+            return double(v);
+        }
+
+        double readPlyValue(const uint8_t* p, const PlyType type)
+        {
+            switch (type)
+            {
+            case PlyType::INT8: return readAs<int8_t>(p);
+            case PlyType::UINT8: return readAs<uint8_t>(p);
+            case PlyType::INT16: return readAs<int16_t>(p);
+            case PlyType::UINT16: return readAs<uint16_t>(p);
+            case PlyType::INT32: return readAs<int32_t>(p);
+            case PlyType::UINT32: return readAs<uint32_t>(p);
+            case PlyType::FLOAT32: return readAs<float>(p);
+            case PlyType::FLOAT64: return readAs<double>(p);
+            default: return 0.0;
+            }
+        }
+
+        // colors of any type to [0, 255]
+        double toColorRange(const double v, const PlyType type)
+        {
+            switch (type)
+            {
+            case PlyType::INT16: case PlyType::UINT16: return v / 257.0;
+            case PlyType::FLOAT32: case PlyType::FLOAT64: return v * 255.0;
+            default: return v;
+            }
+        }
+
+        // Calls fn(double3 position, uint32_t color) for every vertex of a PLY file
+        //  - binary_little_endian and ascii formats, the vertex element must come first
+        //  - x, y, z and optional red, green, blue properties, the others are skipped
+        template <typename FN>
+        bool forEachPlyPoint(const std::string& filename, FN fn)
+        {
+            FILE* file = fopen(filename.c_str(), "rb");
+            if (file == nullptr)
+            {
+                return false;
+            }
+            struct Property
+            {
+                PlyType type = PlyType::NONE;
+                size_t offset = 0;
+            };
+            Property props[6]; // x, y, z, red, green, blue
+            std::vector<PlyType> types;
+            size_t stride = 0;
+            size_t vertex_count = 0;
+            bool binary = false;
+            bool in_vertex = false;
+            bool valid = true;
+
+            char line[1024];
+            if (fgets(line, sizeof(line), file) == nullptr || strncmp(line, "ply", 3) != 0)
+            {
+                fclose(file);
+                return false;
+            }
+            while (valid && fgets(line, sizeof(line), file) != nullptr)
+            {
+                char word[3][256] = {};
+                const int n = sscanf(line, "%255s %255s %255s", word[0], word[1], word[2]);
+                if (n <= 0)
+                {
+                    continue;
+                }
+                const std::string keyword = word[0];
+                if (keyword == "end_header")
+                {
+                    break;
+                }
+                if (keyword == "format" && n >= 2)
+                {
+                    const std::string format = word[1];
+                    binary = format == "binary_little_endian";
+                    valid = binary || format == "ascii";
+                }
+                else if (keyword == "element" && n >= 3)
+                {
+                    const bool is_vertex = std::string(word[1]) == "vertex";
+                    // the vertex element must be the first one
+                    valid = is_vertex ? vertex_count == 0 && types.empty() : vertex_count > 0;
+                    in_vertex = is_vertex;
+                    if (is_vertex)
+                    {
+                        vertex_count = size_t(strtoull(word[2], nullptr, 10));
+                    }
+                }
+                else if (keyword == "property" && in_vertex && n >= 3)
+                {
+                    const PlyType type = parsePlyType(word[1]);
+                    valid = type != PlyType::NONE; // no list in the vertex element
+                    const std::string name = word[2];
+                    static const char* names[6] = { "x", "y", "z", "red", "green", "blue" };
+                    for (int i = 0; i < 6; ++i)
+                    {
+                        if (name == names[i])
+                        {
+                            props[i].type = type;
+                            props[i].offset = stride;
+                        }
+                    }
+                    types.push_back(type);
+                    stride += getPlyTypeSize(type);
+                }
+            }
+            valid = valid && vertex_count > 0
+                && props[0].type != PlyType::NONE && props[1].type != PlyType::NONE && props[2].type != PlyType::NONE;
+            if (!valid)
+            {
+                fclose(file);
+                return false;
+            }
+            const bool has_color = props[3].type != PlyType::NONE && props[4].type != PlyType::NONE && props[5].type != PlyType::NONE;
+
+            auto emit = [&](const uint8_t* record) {
+                const double3 p(readPlyValue(record + props[0].offset, props[0].type),
+                    readPlyValue(record + props[1].offset, props[1].type),
+                    readPlyValue(record + props[2].offset, props[2].type));
+                uint32_t color = 0xffffffffu;
+                if (has_color)
+                {
+                    color = packColor(toColorRange(readPlyValue(record + props[3].offset, props[3].type), props[3].type),
+                        toColorRange(readPlyValue(record + props[4].offset, props[4].type), props[4].type),
+                        toColorRange(readPlyValue(record + props[5].offset, props[5].type), props[5].type));
+                }
+                fn(p, color);
+                };
+
+            size_t read_count = 0;
+            if (binary)
+            {
+                const size_t batch = 65536;
+                std::vector<uint8_t> records(batch * stride);
+                while (read_count < vertex_count)
+                {
+                    const size_t count = fread(records.data(), stride, std::min(batch, vertex_count - read_count), file);
+                    if (count == 0)
+                    {
+                        break;
+                    }
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        emit(records.data() + i * stride);
+                    }
+                    read_count += count;
+                }
+            }
+            else
+            {
+                // values are converted back to their binary layout, so that both formats share emit()
+                std::vector<uint8_t> record(stride);
+                std::vector<char> text(4096);
+                while (read_count < vertex_count && fgets(text.data(), int(text.size()), file) != nullptr)
+                {
+                    const char* s = text.data();
+                    size_t offset = 0;
+                    bool complete = true;
+                    for (PlyType type : types)
+                    {
+                        char* end = nullptr;
+                        const double v = strtod(s, &end);
+                        if (end == s)
+                        {
+                            complete = false;
+                            break;
+                        }
+                        s = end;
+                        switch (type)
+                        {
+                        case PlyType::INT8: { int8_t t = int8_t(v); memcpy(&record[offset], &t, 1); break; }
+                        case PlyType::UINT8: { uint8_t t = uint8_t(v); memcpy(&record[offset], &t, 1); break; }
+                        case PlyType::INT16: { int16_t t = int16_t(v); memcpy(&record[offset], &t, 2); break; }
+                        case PlyType::UINT16: { uint16_t t = uint16_t(v); memcpy(&record[offset], &t, 2); break; }
+                        case PlyType::INT32: { int32_t t = int32_t(v); memcpy(&record[offset], &t, 4); break; }
+                        case PlyType::UINT32: { uint32_t t = uint32_t(v); memcpy(&record[offset], &t, 4); break; }
+                        case PlyType::FLOAT32: { float t = float(v); memcpy(&record[offset], &t, 4); break; }
+                        case PlyType::FLOAT64: memcpy(&record[offset], &v, 8); break;
+                        default: break;
+                        }
+                        offset += getPlyTypeSize(type);
+                    }
+                    if (complete)
+                    {
+                        emit(record.data());
+                        read_count++;
+                    }
+                }
+            }
+            fclose(file);
+            return read_count == vertex_count;
+        }
+
+        // Calls fn(double3 position, uint32_t color) for every line of a text point file (xyz, pts, txt, csv)
+        //  - "x y z", "x y z r g b" or "x y z intensity r g b", separated by spaces, tabs or commas
+        //  - colors are in [0, 255], lines with less than 3 numbers (headers, counts, comments) are skipped
+        template <typename FN>
+        bool forEachTextPoint(const std::string& filename, FN fn)
+        {
+            FILE* file = fopen(filename.c_str(), "rb");
+            if (file == nullptr)
+            {
+                return false;
+            }
+            char line[1024];
+            while (fgets(line, sizeof(line), file) != nullptr)
+            {
+                double v[7];
+                int n = 0;
+                const char* s = line;
+                while (n < 7)
+                {
+                    while (*s == ' ' || *s == '\t' || *s == ',' || *s == ';')
+                    {
+                        s++;
+                    }
+                    char* end = nullptr;
+                    v[n] = strtod(s, &end);
+                    if (end == s)
+                    {
+                        break;
+                    }
+                    s = end;
+                    n++;
+                }
+                if (n < 3)
+                {
+                    continue;
+                }
+                uint32_t color = 0xffffffffu;
+                if (n >= 7)
+                {
+                    color = packColor(v[4], v[5], v[6]);
+                }
+                else if (n >= 6)
+                {
+                    color = packColor(v[3], v[4], v[5]);
+                }
+                fn(double3(v[0], v[1], v[2]), color);
+            }
+            fclose(file);
+            return true;
+        }
+
+        template <typename FN>
+        bool forEachFilePoint(const std::string& filename, FN fn)
+        {
+            return hasExtension(filename, ".ply") ? forEachPlyPoint(filename, fn) : forEachTextPoint(filename, fn);
+        }
+#pragma endregion
+
+#pragma region // octree build
+        uint32_t getOctant(const float3& p, const float3& center)
+        {
+            return (p.x >= center.x ? 1u : 0u) | (p.y >= center.y ? 2u : 0u) | (p.z >= center.z ? 4u : 0u);
+        }
+
+        // childHalfSize is half of the parent's
+        float3 getChildCenter(const float3& center, const float childHalfSize, const uint32_t octant)
+        {
+            return center + float3(octant & 1 ? childHalfSize : -childHalfSize,
+                octant & 2 ? childHalfSize : -childHalfSize,
+                octant & 4 ? childHalfSize : -childHalfSize);
+        }
+
+        // returns true if the cell of p was free, and takes it
+        bool takeCell(std::vector<uint64_t>& grid, const float3& p, const float3& center, const float halfSize)
+        {
+            const float3 t = (p - (center - halfSize)) * (float(VzPointCloudOctree::GRID) / (2.f * halfSize));
+            auto cell = [](const float v) {
+                return std::min(uint32_t(std::max(v, 0.f)), VzPointCloudOctree::GRID - 1);
+                };
+            const uint32_t index = (cell(t.z) * VzPointCloudOctree::GRID + cell(t.y)) * VzPointCloudOctree::GRID + cell(t.x);
+            const uint64_t bit = uint64_t(1) << (index & 63);
+            if (grid[index >> 6] & bit)
+            {
+                return false;
+            }
+            grid[index >> 6] |= bit;
+            return true;
+        }
+
+        // Appends the points of every node to a single file
+        class NodeWriter
+        {
+        public:
+            explicit NodeWriter(const std::filesystem::path& path)
+            {
+                file_ = fopen(path.string().c_str(), "wb");
+            }
+            ~NodeWriter()
+            {
+                if (file_)
+                {
+                    fclose(file_);
+                }
+            }
+            bool IsValid() const { return file_ != nullptr && valid_; }
+            void Write(const std::string& name, const Point* points, const size_t count)
+            {
+                if (count == 0 || !IsValid())
+                {
+                    return;
+                }
+                valid_ = fwrite(points, sizeof(Point), count, file_) == count;
+                records.push_back({ name, offset_, uint32_t(count) });
+                offset_ += count * sizeof(Point);
+            }
+
+            std::vector<NodeRecord> records;
+
+        private:
+            FILE* file_ = nullptr;
+            uint64_t offset_ = 0;
+            bool valid_ = true;
+        };
+
+        // Every node keeps one point per grid cell, in the order they come, the rest are split among its children
+        void indexPoints(NodeWriter& writer, Point* first, Point* last, const std::string& name,
+            const float3& center, const float halfSize, const uint32_t depth)
+        {
+            const size_t count = size_t(last - first);
+            if (count <= MAX_LEAF_POINTS || depth >= MAX_DEPTH)
+            {
+                writer.Write(name, first, count);
+                return;
+            }
+
+            std::vector<uint64_t> grid(GRID_WORDS, 0);
+            Point* kept = first;
+            for (Point* p = first; p != last; ++p)
+            {
+                if (takeCell(grid, p->position, center, halfSize))
+                {
+                    std::swap(*p, *kept++);
+                }
+            }
+            writer.Write(name, first, size_t(kept - first));
+
+            // by z, then y, then x, so that octant i is the i-th range
+            auto below = [](const int axis, const float c) {
+                return [axis, c](const Point& p) { return p.position[axis] < c; };
+                };
+            Point* split_z = std::partition(kept, last, below(2, center.z));
+            Point* split_y0 = std::partition(kept, split_z, below(1, center.y));
+            Point* split_y1 = std::partition(split_z, last, below(1, center.y));
+            Point* bounds[9] = { kept, nullptr, split_y0, nullptr, split_z, nullptr, split_y1, nullptr, last };
+            bounds[1] = std::partition(kept, split_y0, below(0, center.x));
+            bounds[3] = std::partition(split_y0, split_z, below(0, center.x));
+            bounds[5] = std::partition(split_z, split_y1, below(0, center.x));
+            bounds[7] = std::partition(split_y1, last, below(0, center.x));
+
+            const float child_half_size = halfSize * 0.5f;
+            for (uint32_t octant = 0; octant < 8; ++octant)
+            {
+                if (bounds[octant] != bounds[octant + 1])
+                {
+                    indexPoints(writer, bounds[octant], bounds[octant + 1], name + char('0' + octant),
+                        getChildCenter(center, child_half_size, octant), child_half_size, depth + 1);
+                }
+            }
+        }
+
+        // Points of a temporary file written by streamPoints()
+        struct ChunkSource
+        {
+            std::filesystem::path path;
+
+            template <typename FN>
+            bool operator()(FN fn) const
+            {
+                FILE* file = fopen(path.string().c_str(), "rb");
+                if (file == nullptr)
+                {
+                    return false;
+                }
+                std::vector<Point> points(CHUNK_FLUSH_POINTS);
+                size_t n;
+                while ((n = fread(points.data(), sizeof(Point), points.size(), file)) > 0)
+                {
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        fn(points[i]);
+                    }
+                }
+                fclose(file);
+                return true;
+            }
+        };
+
+        // Builds the nodes of a point set too large for the memory, source(fn) calls fn(const Point&) for each point
+        //  - the first STREAM_LEVELS levels are sampled while the points are read, the others are written to
+        //    one temporary file per node of the next level, which is built the same way
+        template <typename SOURCE>
+        bool streamPoints(NodeWriter& writer, const std::filesystem::path& folder, SOURCE source, const size_t count,
+            const std::string& name, const float3& center, const float halfSize, const uint32_t depth)
+        {
+            if (count <= CHUNK_POINTS || depth + STREAM_LEVELS >= MAX_DEPTH)
+            {
+                std::vector<Point> points;
+                points.reserve(count);
+                if (!source([&points](const Point& p) { points.push_back(p); }))
+                {
+                    return false;
+                }
+                indexPoints(writer, points.data(), points.data() + points.size(), name, center, halfSize, depth);
+                return true;
+            }
+
+            // nodes of level l under this one are at [(8^l - 1) / 7, (8^(l+1) - 1) / 7)
+            struct Sampled
+            {
+                std::vector<uint64_t> grid;
+                std::vector<Point> points;
+            };
+            auto level_offset = [](const uint32_t level) { return ((1u << (3 * level)) - 1) / 7; };
+            std::vector<Sampled> sampled(level_offset(STREAM_LEVELS));
+            const uint32_t chunk_count = 1u << (3 * STREAM_LEVELS);
+            std::vector<std::vector<Point>> buffers(chunk_count);
+            std::vector<size_t> chunk_sizes(chunk_count, 0);
+
+            auto digits = [](uint32_t code, const uint32_t level) {
+                std::string s(level, '0');
+                for (uint32_t i = level; i > 0; --i, code >>= 3)
+                {
+                    s[i - 1] = char('0' + (code & 7));
+                }
+                return s;
+                };
+            auto chunk_path = [&](const uint32_t code) {
+                return folder / ("chunk_" + name + digits(code, STREAM_LEVELS) + ".tmp");
+                };
+            bool valid = true;
+            auto flush = [&](const uint32_t code) {
+                std::vector<Point>& buffer = buffers[code];
+                if (buffer.empty())
+                {
+                    return;
+                }
+                // truncated on first use, a previous build may have been interrupted before removing it
+                FILE* file = fopen(chunk_path(code).string().c_str(), chunk_sizes[code] == 0 ? "wb" : "ab");
+                valid = valid && file != nullptr && fwrite(buffer.data(), sizeof(Point), buffer.size(), file) == buffer.size();
+                if (file)
+                {
+                    fclose(file);
+                }
+                chunk_sizes[code] += buffer.size();
+                buffer.clear();
+                };
+
+            const bool read = source([&](const Point& p) {
+                float3 c = center;
+                float h = halfSize;
+                uint32_t code = 0;
+                for (uint32_t level = 0; level < STREAM_LEVELS; ++level)
+                {
+                    Sampled& node = sampled[level_offset(level) + code];
+                    if (node.grid.empty())
+                    {
+                        node.grid.assign(GRID_WORDS, 0);
+                    }
+                    if (takeCell(node.grid, p.position, c, h))
+                    {
+                        node.points.push_back(p);
+                        return;
+                    }
+                    const uint32_t octant = getOctant(p.position, c);
+                    h *= 0.5f;
+                    c = getChildCenter(c, h, octant);
+                    code = code * 8 + octant;
+                }
+                buffers[code].push_back(p);
+                if (buffers[code].size() >= CHUNK_FLUSH_POINTS)
+                {
+                    flush(code);
+                }
+                });
+            for (uint32_t code = 0; code < chunk_count; ++code)
+            {
+                flush(code);
+            }
+
+            for (uint32_t level = 0; level < STREAM_LEVELS; ++level)
+            {
+                for (uint32_t code = 0, n = 1u << (3 * level); code < n; ++code)
+                {
+                    std::vector<Point>& points = sampled[level_offset(level) + code].points;
+                    writer.Write(name + digits(code, level), points.data(), points.size());
+                    std::vector<Point>().swap(points);
+                }
+            }
+
+            for (uint32_t code = 0; code < chunk_count; ++code)
+            {
+                if (chunk_sizes[code] == 0)
+                {
+                    continue;
+                }
+                const std::filesystem::path path = chunk_path(code);
+                if (read && valid)
+                {
+                    float3 c = center;
+                    float h = halfSize;
+                    for (uint32_t level = 0; level < STREAM_LEVELS; ++level)
+                    {
+                        h *= 0.5f;
+                        c = getChildCenter(c, h, (code >> (3 * (STREAM_LEVELS - 1 - level))) & 7);
+                    }
+                    valid = streamPoints(writer, folder, ChunkSource{ path }, chunk_sizes[code],
+                        name + digits(code, STREAM_LEVELS), c, h, depth + STREAM_LEVELS);
+                }
+                std::error_code ec;
+                std::filesystem::remove(path, ec);
+            }
+            return read && valid;
+        }
+
+        template <typename T>
+        void writeValue(std::ofstream& out, const T& v)
+        {
+            out.write((const char*)&v, sizeof(T));
+        }
+
+        template <typename T>
+        bool readValue(std::ifstream& in, T& v)
+        {
+            return (bool)in.read((char*)&v, sizeof(T));
+        }
+
+        struct SourceStamp
+        {
+            uint64_t size = 0;
+            int64_t time = 0;
+        };
+
+        SourceStamp getSourceStamp(const std::string& filename)
+        {
+            std::error_code ec;
+            SourceStamp stamp;
+            stamp.size = std::filesystem::file_size(filename, ec);
+            stamp.time = (int64_t)std::filesystem::last_write_time(filename, ec).time_since_epoch().count();
+            return stamp;
+        }
+
+        // Builds the node file and the index of the points of filename into folder
+        bool buildOctree(const std::string& filename, const std::filesystem::path& folder)
+        {
+            double3 bmin(std::numeric_limits<double>::max());
+            double3 bmax(std::numeric_limits<double>::lowest());
+            size_t count = 0;
+            if (!forEachFilePoint(filename, [&](const double3& p, uint32_t) {
+                    bmin = min(bmin, p);
+                    bmax = max(bmax, p);
+                    count++;
+                }) || count == 0)
+            {
+                return false;
+            }
+
+            // a cube, slightly larger so that no point lies on its border
+            const double3 center = (bmin + bmax) * 0.5;
+            const double3 half_extent = (bmax - bmin) * 0.5;
+            const float half_size = float(std::max({ half_extent.x, half_extent.y, half_extent.z, 1e-3 }) * 1.001);
+
+            NodeWriter writer(folder / "octree.bin");
+            if (!writer.IsValid())
+            {
+                return false;
+            }
+            auto file_source = [&filename, &center](auto fn) {
+                return forEachFilePoint(filename, [&](const double3& p, const uint32_t color) {
+                    fn(Point{ float3(p - center), color });
+                    });
+                };
+            if (!streamPoints(writer, folder, file_source, count, "", float3(0.f), half_size, 0) || !writer.IsValid())
+            {
+                return false;
+            }
+
+            const SourceStamp stamp = getSourceStamp(filename);
+            std::ofstream out(folder / "index.bin", std::ios::binary);
+            out.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+            writeValue(out, INDEX_VERSION);
+            writeValue(out, stamp.size);
+            writeValue(out, stamp.time);
+            writeValue(out, center);
+            writeValue(out, half_size);
+            writeValue(out, uint64_t(count));
+            writeValue(out, uint32_t(writer.records.size()));
+            for (const NodeRecord& record : writer.records)
+            {
+                writeValue(out, uint8_t(record.name.size()));
+                out.write(record.name.data(), record.name.size());
+                writeValue(out, record.offset);
+                writeValue(out, record.count);
+            }
+            return (bool)out;
+        }
+#pragma endregion
+    }
+
+    bool VzPointCloudOctree::IsCached(const std::string& filename, const std::string& folder)
+    {
+        const SourceStamp stamp = getSourceStamp(filename);
+        std::ifstream in(std::filesystem::path(folder) / "index.bin", std::ios::binary);
+        char magic[sizeof(INDEX_MAGIC)] = {};
+        uint32_t version = 0;
+        SourceStamp cached_stamp;
+        return in.read(magic, sizeof(magic)) && memcmp(magic, INDEX_MAGIC, sizeof(magic)) == 0
+            && readValue(in, version) && version == INDEX_VERSION
+            && readValue(in, cached_stamp.size) && readValue(in, cached_stamp.time)
+            && cached_stamp.size == stamp.size && cached_stamp.time == stamp.time;
+    }
+
+    bool VzPointCloudOctree::Build(const std::string& filename, const std::string& folder)
+    {
+        return buildOctree(filename, folder);
+    }
+
+    bool VzPointCloudOctree::Read(const std::string& folder)
+    {
+        std::ifstream in(std::filesystem::path(folder) / "index.bin", std::ios::binary);
+        in.seekg(sizeof(INDEX_MAGIC) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(int64_t));
+        float half_size = 0.f;
+        uint64_t point_count = 0;
+        uint32_t node_count = 0;
+        if (!readValue(in, center) || !readValue(in, half_size) || !readValue(in, point_count)
+            || !readValue(in, node_count) || node_count == 0)
+        {
+            return false;
+        }
+        std::vector<NodeRecord> records(node_count);
+        for (NodeRecord& record : records)
+        {
+            uint8_t length = 0;
+            if (!readValue(in, length))
+            {
+                return false;
+            }
+            record.name.resize(length);
+            if (!in.read(record.name.data(), length) || !readValue(in, record.offset) || !readValue(in, record.count))
+            {
+                return false;
+            }
+        }
+
+        // parents first, the root is ""
+        std::sort(records.begin(), records.end(), [](const NodeRecord& a, const NodeRecord& b) {
+            return a.name.size() != b.name.size() ? a.name.size() < b.name.size() : a.name < b.name;
+            });
+        if (!records[0].name.empty())
+        {
+            return false;
+        }
+        std::unordered_map<std::string, uint32_t> lookup;
+        nodes.assign(node_count, Node());
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            const NodeRecord& record = records[i];
+            Node& node = nodes[i];
+            node.offset = record.offset;
+            node.pointCount = record.count;
+            if (i == 0)
+            {
+                node.center = float3(0.f);
+                node.halfSize = half_size;
+            }
+            else
+            {
+                auto it = lookup.find(record.name.substr(0, record.name.size() - 1));
+                const uint32_t octant = uint32_t(record.name.back() - '0');
+                if (it == lookup.end() || octant > 7)
+                {
+                    return false;
+                }
+                Node& parent = nodes[it->second];
+                parent.children[octant] = int32_t(i);
+                node.halfSize = parent.halfSize * 0.5f;
+                node.center = getChildCenter(parent.center, node.halfSize, octant);
+            }
+            lookup[record.name] = i;
+        }
+        pointCount = size_t(point_count);
+        return nodes[0].pointCount > 0;
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VZ_POINT_CLOUD_OCTREE_H
+#define VZ_POINT_CLOUD_OCTREE_H
+
+#include <math/vec3.h>
+
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace vzm
+{
+    // The cache files of a VzPointCloud, independent of the engine
+    //  - octree.bin holds the points of every node, one range per node
+    //  - index.bin holds the stamp of the source file, the center of the points and the node ranges
+    struct VzPointCloudOctree
+    {
+        static constexpr uint32_t GRID = 64;
+
+        // position relative to the center of the points, 16 bytes as in the vertex buffers
+        struct Point
+        {
+            filament::math::float3 position;
+            uint32_t color;
+        };
+
+        struct Node
+        {
+            filament::math::float3 center; // relative to the center of the points
+            float halfSize = 0.f;
+            uint64_t offset = 0;            // in octree.bin
+            uint32_t pointCount = 0;
+            int32_t children[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+        };
+
+        // return true if index.bin in folder was built from the current version of filename
+        static bool IsCached(const std::string& filename, const std::string& folder);
+        // Builds octree.bin and index.bin of the points of filename (binary or ascii PLY, or xyz-like text) into folder
+        static bool Build(const std::string& filename, const std::string& folder);
+
+        // Reads index.bin of folder, nodes[0] is the root and parents come before their children
+        bool Read(const std::string& folder);
+
+        filament::math::double3 center;
+        size_t pointCount = 0;
+        std::vector<Node> nodes;
+    };
+}
+
+#endif // VZ_POINT_CLOUD_OCTREE_H
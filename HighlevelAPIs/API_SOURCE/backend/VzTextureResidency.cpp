@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VzTextureResidency.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vzm
+{
+    void VzTextureResidency::Init(Texture& texture, const uint32_t w, const uint32_t h)
+    {
+        texture.width = w;
+        texture.height = h;
+        texture.levelCount = uint8_t(std::ilogb(std::max(w, h)) + 1);
+        uint8_t tail_count = 1;
+        while ((1u << tail_count) <= MIN_RESIDENT_SIZE)
+        {
+            tail_count++;
+        }
+        texture.tailLevel = texture.levelCount > tail_count ? uint8_t(texture.levelCount - tail_count) : 0;
+        texture.residentLevel = texture.levelCount;
+        texture.targetLevel = texture.levelCount;
+    }
+
+    size_t VzTextureResidency::GetChainSize(const Texture& texture, const uint8_t baseLevel)
+    {
+        size_t size = 0;
+        for (uint8_t level = baseLevel; level < texture.levelCount; ++level)
+        {
+            size += size_t(std::max(1u, texture.width >> level)) * size_t(std::max(1u, texture.height >> level)) * 4;
+        }
+        return size;
+    }
+
+    size_t VzTextureResidency::GetDecodeSize(const Texture& texture, const uint8_t baseLevel)
+    {
+        // the decoded file and the levels being built from it are less than a full chain, then the kept levels
+        return GetChainSize(texture, 0) + GetChainSize(texture, baseLevel);
+    }
+
+    uint8_t VzTextureResidency::GetDesiredLevel(const Texture& texture)
+    {
+        const float pixels = std::max(texture.pixels, texture.lastPixels);
+        const float texels = float(std::max(texture.width, texture.height));
+        if (pixels <= 0.f)
+        {
+            return texture.tailLevel;
+        }
+        if (pixels >= texels)
+        {
+            return 0;
+        }
+        const int level = int(std::floor(std::log2(texels / pixels)));
+        return uint8_t(std::min(level, int(texture.tailLevel)));
+    }
+
+    void VzTextureResidency::Plan(std::vector<Texture*>& textures, const size_t budgetBytes, const size_t residentBytes,
+        size_t decodingBytes, size_t pendingLoads, std::vector<std::pair<Texture*, uint8_t>>& loads)
+    {
+        loads.clear();
+        if (textures.empty())
+        {
+            return;
+        }
+        std::sort(textures.begin(), textures.end(), [](const Texture* a, const Texture* b) {
+            return std::max(a->pixels, a->lastPixels) > std::max(b->pixels, b->lastPixels);
+            });
+
+        // the coarse tails are always resident, the rest of the budget goes to the most covered textures first
+        size_t available = budgetBytes;
+        for (Texture* texture : textures)
+        {
+            available -= std::min(available, GetChainSize(*texture, texture->tailLevel));
+        }
+        size_t growth = 0;     // of all the planned refinements
+        size_t in_flight = 0;  // of the refinements being loaded
+        for (Texture* texture : textures)
+        {
+            const size_t tail_size = GetChainSize(*texture, texture->tailLevel);
+            uint8_t level = GetDesiredLevel(*texture);
+            while (level < texture->tailLevel && GetChainSize(*texture, level) - tail_size > available)
+            {
+                level++;
+            }
+            available -= GetChainSize(*texture, level) - tail_size;
+            texture->targetLevel = level;
+
+            const size_t target_size = GetChainSize(*texture, level);
+            growth += target_size > texture->residentBytes ? target_size - texture->residentBytes : 0;
+            if (texture->loading)
+            {
+                const size_t load_size = GetChainSize(*texture, texture->loadLevel);
+                in_flight += load_size > texture->residentBytes ? load_size - texture->residentBytes : 0;
+            }
+        }
+
+        auto can_start = [&](const Texture& texture, const uint8_t baseLevel) {
+            return pendingLoads < MAX_PENDING_LOADS
+                && (decodingBytes == 0 || decodingBytes + GetDecodeSize(texture, baseLevel) <= budgetBytes);
+            };
+        auto start = [&](Texture& texture, const uint8_t baseLevel) {
+            decodingBytes += GetDecodeSize(texture, baseLevel);
+            pendingLoads++;
+            texture.loading = true;
+            texture.loadLevel = baseLevel;
+            loads.emplace_back(&texture, baseLevel);
+            };
+
+        // 1. the coarse tails of new textures
+        for (Texture* texture : textures)
+        {
+            if (!texture->loading && texture->residentLevel == texture->levelCount && can_start(*texture, texture->tailLevel))
+            {
+                in_flight += GetChainSize(*texture, texture->tailLevel);
+                start(*texture, texture->tailLevel);
+            }
+        }
+
+        // 2. coarser levels for the least covered textures, when the refinements don't fit otherwise
+        if (residentBytes + growth > budgetBytes)
+        {
+            for (auto it = textures.rbegin(); it != textures.rend() && pendingLoads < MAX_PENDING_LOADS; ++it)
+            {
+                Texture& texture = **it;
+                if (!texture.loading && texture.residentLevel < texture.levelCount && texture.targetLevel > texture.residentLevel
+                    && can_start(texture, texture.targetLevel))
+                {
+                    start(texture, texture.targetLevel);
+                }
+            }
+        }
+
+        // 3. finer levels for the most covered textures, as long as the budget allows
+        for (Texture* texture : textures)
+        {
+            if (pendingLoads >= MAX_PENDING_LOADS)
+            {
+                break;
+            }
+            if (texture->loading || texture->residentLevel == texture->levelCount || texture->targetLevel >= texture->residentLevel)
+            {
+                continue;
+            }
+            const size_t refinement = GetChainSize(*texture, texture->targetLevel) - texture->residentBytes;
+            if (residentBytes + in_flight + refinement <= budgetBytes && can_start(*texture, texture->targetLevel))
+            {
+                in_flight += refinement;
+                start(*texture, texture->targetLevel);
+            }
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VZ_TEXTURE_RESIDENCY_H
+#define VZ_TEXTURE_RESIDENCY_H
+
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace vzm
+{
+    // The residency planning of a VzTextureStreamer, independent of the engine
+    //  - sizes are those of RGBA8 mip chains
+    //  - a load decodes the full file, so it holds level 0 and the levels built from it on the CPU while it runs,
+    //    the loads in flight are bounded by the budget too (a single load larger than the budget runs alone)
+    struct VzTextureResidency
+    {
+        static constexpr uint32_t MIN_RESIDENT_SIZE = 128;
+        static constexpr size_t MAX_PENDING_LOADS = 4;
+
+        struct Texture
+        {
+            uint32_t width = 0;         // of level 0
+            uint32_t height = 0;
+            uint8_t levelCount = 0;     // of the full mip chain
+            uint8_t tailLevel = 0;      // the coarse levels that are always resident start there
+            uint8_t residentLevel = 0;  // base level of the current texture, levelCount for the placeholder
+            uint8_t targetLevel = 0;
+            size_t residentBytes = 0;
+            float pixels = 0.f;         // largest on-screen size since the last plan
+            float lastPixels = 0.f;     // the same, before the last plan
+            bool loading = false;
+            uint8_t loadLevel = 0;      // base level of the load in flight
+        };
+
+        // Sets the mip chain of a texture of w x h texels, with only the placeholder resident
+        static void Init(Texture& texture, const uint32_t w, const uint32_t h);
+        // Bytes of the levels [baseLevel, levelCount)
+        static size_t GetChainSize(const Texture& texture, const uint8_t baseLevel);
+        // CPU bytes held by a load of the levels [baseLevel, levelCount) until it is finished
+        static size_t GetDecodeSize(const Texture& texture, const uint8_t baseLevel);
+        // Finest level worth its on-screen size, never coarser than the tail
+        static uint8_t GetDesiredLevel(const Texture& texture);
+
+        // Plans the target level of every texture and the loads to start this frame
+        //  - textures are sorted by decreasing on-screen size
+        //  - residentBytes and decodingBytes are the totals of all the textures, including the ones not planned
+        //  - the loads are marked on the textures and returned with their base level
+        static void Plan(std::vector<Texture*>& textures, const size_t budgetBytes, const size_t residentBytes,
+            size_t decodingBytes, size_t pendingLoads, std::vector<std::pair<Texture*, uint8_t>>& loads);
+    };
+}
+
+#endif // VZ_TEXTURE_RESIDENCY_H
@@ -0,0 +1,424 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VzTextureStreamer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include <filament/Camera.h>
+#include <filament/Engine.h>
+#include <filament/Frustum.h>
+#include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
+#include <filament/Texture.h>
+#include <filament/TransformManager.h>
+
+#include <utils/JobSystem.h>
+
+#include <stb_image.h>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+extern vzm::VzEngineApp* gEngineApp;
+
+namespace vzm
+{
+    // Decodes the file and builds the levels [baseLevel, levelCount) of its mip chain, in a background job
+    struct VzTextureStreamer::Load
+    {
+        std::string fileName;
+        uint32_t width = 0;     // expected size of level 0
+        uint32_t height = 0;
+        uint8_t levelCount = 0;
+        uint8_t baseLevel = 0;
+        std::vector<std::vector<uint8_t>> levels; // RGBA8, levels[0] is baseLevel
+        size_t decodeBytes = 0;                   // counted by the streamer until the load is collected
+        bool failed = false;
+        CancellationToken cancelled;
+        std::atomic<bool> done{ false };
+        JobSystem::Job* job = nullptr;
+
+        void run();
+    };
+
+    namespace
+    {
+        // 2x2 box filter, the last row or column is repeated for odd sizes
+        std::vector<uint8_t> downsample(const uint8_t* src, const uint32_t w, const uint32_t h)
+        {
+            const uint32_t dw = std::max(1u, w >> 1);
+            const uint32_t dh = std::max(1u, h >> 1);
+            std::vector<uint8_t> dst(size_t(dw) * dh * 4);
+            for (uint32_t y = 0; y < dh; ++y)
+            {
+                const uint8_t* row0 = src + size_t(std::min(2 * y, h - 1)) * w * 4;
+                const uint8_t* row1 = src + size_t(std::min(2 * y + 1, h - 1)) * w * 4;
+                uint8_t* out = dst.data() + size_t(y) * dw * 4;
+                for (uint32_t x = 0; x < dw; ++x)
+                {
+                    const size_t x0 = size_t(std::min(2 * x, w - 1)) * 4;
+                    const size_t x1 = size_t(std::min(2 * x + 1, w - 1)) * 4;
+                    for (size_t c = 0; c < 4; ++c)
+                    {
+                        out[x * 4 + c] = uint8_t((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+                    }
+                }
+            }
+            return dst;
+        }
+    }
+
+    void VzTextureStreamer::Load::run()
+    {
+        if (cancelled.isCancelled())
+        {
+            failed = true;
+            return;
+        }
+
+        int w, h, n;
+        stbi_uc* data = stbi_load(fileName.c_str(), &w, &h, &n, 4);
+        if (data == nullptr || uint32_t(w) != width || uint32_t(h) != height)
+        {
+            // the file has been changed or removed since it has been added
+            stbi_image_free(data);
+            failed = true;
+            return;
+        }
+
+        // level 0 is read from the decoded pixels, which are freed as soon as level 1 is built
+        std::vector<uint8_t> level;
+        const uint8_t* src = data;
+        uint32_t lw = width, lh = height;
+        for (uint8_t i = 0; i < levelCount; ++i)
+        {
+            if (cancelled.isCancelled())
+            {
+                failed = true;
+                break;
+            }
+            if (i >= baseLevel)
+            {
+                levels.push_back(i == 0 ? std::vector<uint8_t>(data, data + size_t(lw) * lh * 4) : std::move(level));
+                src = levels.back().data();
+            }
+            if (i + 1 < levelCount)
+            {
+                level = downsample(src, lw, lh);
+                src = level.data();
+                lw = std::max(1u, lw >> 1);
+                lh = std::max(1u, lh >> 1);
+            }
+            if (i == 0)
+            {
+                stbi_image_free(data);
+                data = nullptr;
+            }
+        }
+        stbi_image_free(data);
+    }
+
+    VzTextureStreamer::VzTextureStreamer(filament::Engine& engine, const size_t budgetBytes)
+        : engine_(engine), budgetBytes_(budgetBytes)
+    {
+    }
+
+    VzTextureStreamer::~VzTextureStreamer()
+    {
+        for (auto& it : records_)
+        {
+            if (it.second.load)
+            {
+                it.second.load->cancelled.cancel();
+                orphans_.push_back(std::move(it.second.load));
+            }
+        }
+        records_.clear();
+        collectOrphans(true);
+    }
+
+    bool VzTextureStreamer::Add(const TextureVID vid, const std::string& fileName)
+    {
+        VzTextureRes* tex_res = gEngineApp->GetTextureRes(vid);
+        int w, h, n;
+        if (tex_res == nullptr || !stbi_info(fileName.c_str(), &w, &h, &n) || w <= 0 || h <= 0)
+        {
+            return false;
+        }
+        Remove(vid);
+
+        Record& record = records_[vid];
+        record.fileName = fileName;
+        VzTextureResidency::Init(record, uint32_t(w), uint32_t(h));
+
+        // neutral grey until the coarse levels arrive
+        static const uint8_t placeholder_texel[4] = { 128, 128, 128, 255 };
+        Texture* placeholder = Texture::Builder()
+            .width(1)
+            .height(1)
+            .levels(1)
+            .format(Texture::InternalFormat::RGBA8)
+            .sampler(Texture::Sampler::SAMPLER_2D)
+            .build(engine_);
+        placeholder->setImage(engine_, 0, Texture::PixelBufferDescriptor(
+            placeholder_texel, sizeof(placeholder_texel), Texture::Format::RGBA, Texture::Type::UBYTE));
+        record.residentBytes = sizeof(placeholder_texel);
+        residentBytes_ += record.residentBytes;
+
+        // the same defaults as VzTexture::ReadImage, the levels are always mipmapped
+        tex_res->fileName = fileName;
+        tex_res->sampler.setMagFilter(TextureSampler::MagFilter::LINEAR);
+        tex_res->sampler.setMinFilter(TextureSampler::MinFilter::LINEAR_MIPMAP_LINEAR);
+        tex_res->sampler.setWrapModeS(TextureSampler::WrapMode::REPEAT);
+        tex_res->sampler.setWrapModeT(TextureSampler::WrapMode::REPEAT);
+        setTexture(vid, placeholder);
+        return true;
+    }
+
+    void VzTextureStreamer::Remove(const TextureVID vid)
+    {
+        auto it = records_.find(vid);
+        if (it == records_.end())
+        {
+            return;
+        }
+        if (it->second.load)
+        {
+            it->second.load->cancelled.cancel();
+            orphans_.push_back(std::move(it->second.load));
+        }
+        residentBytes_ -= it->second.residentBytes;
+        records_.erase(it);
+    }
+
+    VzTextureStreamer::Stats VzTextureStreamer::GetStats() const
+    {
+        Stats stats;
+        stats.residentBytes = residentBytes_;
+        stats.budgetBytes = budgetBytes_;
+        stats.decodingBytes = decodingBytes_;
+        stats.textureCount = records_.size();
+        for (auto& it : records_)
+        {
+            stats.pendingLoads += it.second.load ? 1 : 0;
+        }
+        return stats;
+    }
+
+    void VzTextureStreamer::AccumulateActor(const ActorVID vid, const Camera& camera, const uint32_t viewportHeight)
+    {
+        if (records_.empty() || viewportHeight == 0)
+        {
+            return;
+        }
+        VzActorRes* actor_res = gEngineApp->GetActorRes(vid);
+        if (actor_res == nullptr)
+        {
+            return;
+        }
+        auto& rcm = engine_.getRenderableManager();
+        auto& tcm = engine_.getTransformManager();
+        utils::Entity ett_actor = utils::Entity::import(vid);
+        auto ins = rcm.getInstance(ett_actor);
+        if (!ins.isValid())
+        {
+            return;
+        }
+
+        // same projection as the LOD selection (see VzEngineApp::UpdateActorLOD)
+        const mat4 proj = camera.getProjectionMatrix();
+        const bool is_ortho = proj[3][3] == 1.0;
+        const double pixels_per_unit = std::abs(proj[1][1]) * 0.5 * viewportHeight;
+
+        const mat4f os2ws = tcm.getWorldTransform(tcm.getInstance(ett_actor));
+        const float ws_scale = std::sqrt(std::max({
+            length2(os2ws[0].xyz), length2(os2ws[1].xyz), length2(os2ws[2].xyz) }));
+        const Box box = rcm.getAxisAlignedBoundingBox(ins);
+        const double3 center_ws = ((mat4)os2ws * double4(box.center, 1.0)).xyz;
+        const double radius_ws = length(box.halfExtent) * ws_scale;
+        if (!camera.getFrustum().intersects(float4(float3(center_ws), float(radius_ws))))
+        {
+            return;
+        }
+        double distance = 1.0;
+        if (!is_ortho)
+        {
+            distance = std::max(length(center_ws - camera.getPosition()) - radius_ws, camera.getNear());
+        }
+        // a texture mapped once over the actor needs about as many texels as its projected diameter
+        const float pixels = float(2.0 * radius_ws * pixels_per_unit / distance);
+
+        for (MInstanceVID vid_mi : actor_res->GetMIVids())
+        {
+            VzMIRes* mi_res = gEngineApp->GetMIRes(vid_mi);
+            if (mi_res == nullptr)
+            {
+                continue;
+            }
+            for (auto& tex_map_kv : mi_res->texMap)
+            {
+                auto it = records_.find(tex_map_kv.second);
+                if (it != records_.end())
+                {
+                    it->second.pixels = std::max(it->second.pixels, pixels);
+                }
+            }
+        }
+    }
+
+    void VzTextureStreamer::Update()
+    {
+        collectOrphans(false);
+
+        planned_.clear();
+        size_t pending_loads = 0;
+        for (auto& it : records_)
+        {
+            Record& record = it.second;
+            if (record.load && record.load->done.load(std::memory_order_acquire))
+            {
+                finishLoad(it.first, record);
+            }
+            pending_loads += record.load ? 1 : 0;
+            if (!record.failed)
+            {
+                planned_.push_back(&record);
+            }
+        }
+
+        VzTextureResidency::Plan(planned_, budgetBytes_, residentBytes_, decodingBytes_, pending_loads, loads_);
+        for (auto& it : loads_)
+        {
+            startLoad(*static_cast<Record*>(it.first));
+        }
+
+        for (auto& it : records_)
+        {
+            it.second.lastPixels = it.second.pixels;
+            it.second.pixels = 0.f;
+        }
+    }
+
+    void VzTextureStreamer::startLoad(Record& record)
+    {
+        assert(!record.load && record.loading);
+        record.load = std::make_unique<Load>();
+        Load* load = record.load.get();
+        load->fileName = record.fileName;
+        load->width = record.width;
+        load->height = record.height;
+        load->levelCount = record.levelCount;
+        load->baseLevel = record.loadLevel;
+        load->decodeBytes = VzTextureResidency::GetDecodeSize(record, record.loadLevel);
+        decodingBytes_ += load->decodeBytes;
+
+        // retained so that finishLoad() and the destructor can release it, it's done by then
+        JobSystem& js = engine_.getJobSystem();
+        load->job = js.runAndRetain(jobs::createJob(js, nullptr, [load] {
+            load->run();
+            load->done.store(true, std::memory_order_release);
+            }), JobSystem::JobPriority::BACKGROUND);
+    }
+
+    void VzTextureStreamer::finishLoad(const TextureVID vid, Record& record)
+    {
+        std::unique_ptr<Load> load = std::move(record.load);
+        engine_.getJobSystem().waitAndRelease(load->job);
+        decodingBytes_ -= load->decodeBytes;
+        record.loading = false;
+        if (load->failed)
+        {
+            // don't retry every frame, the texture keeps its current levels
+            record.failed = true;
+            backlog::post("Texture streaming cannot decode " + record.fileName, backlog::LogLevel::Error);
+            return;
+        }
+
+        const uint32_t w = std::max(1u, record.width >> load->baseLevel);
+        const uint32_t h = std::max(1u, record.height >> load->baseLevel);
+        Texture* texture = Texture::Builder()
+            .width(w)
+            .height(h)
+            .levels(uint8_t(load->levels.size()))
+            .format(Texture::InternalFormat::RGBA8)
+            .sampler(Texture::Sampler::SAMPLER_2D)
+            .build(engine_);
+        for (size_t i = 0, n = load->levels.size(); i < n; ++i)
+        {
+            // the level is released once the driver has consumed it
+            auto* pixels = new std::vector<uint8_t>(std::move(load->levels[i]));
+            texture->setImage(engine_, i, Texture::PixelBufferDescriptor(
+                pixels->data(), pixels->size(), Texture::Format::RGBA, Texture::Type::UBYTE,
+                [](void*, size_t, void* user) { delete static_cast<std::vector<uint8_t>*>(user); }, pixels));
+        }
+
+        residentBytes_ -= record.residentBytes;
+        record.residentBytes = VzTextureResidency::GetChainSize(record, load->baseLevel);
+        record.residentLevel = load->baseLevel;
+        residentBytes_ += record.residentBytes;
+        setTexture(vid, texture);
+    }
+
+    void VzTextureStreamer::setTexture(const TextureVID vid, Texture* texture)
+    {
+        VzTextureRes* tex_res = gEngineApp->GetTextureRes(vid);
+        assert(tex_res);
+        Texture* prev_texture = tex_res->texture;
+        tex_res->texture = texture;
+        for (MInstanceVID vid_mi : tex_res->assignedMIs)
+        {
+            VzMIRes* mi_res = gEngineApp->GetMIRes(vid_mi);
+            if (mi_res == nullptr)
+            {
+                continue;
+            }
+            for (auto& tex_map_kv : mi_res->texMap)
+            {
+                if (tex_map_kv.second == vid)
+                {
+                    mi_res->mi->setParameter(tex_map_kv.first.c_str(), texture, tex_res->sampler);
+                }
+            }
+        }
+        if (prev_texture)
+        {
+            engine_.destroy(prev_texture);
+        }
+    }
+
+    void VzTextureStreamer::collectOrphans(const bool wait)
+    {
+        JobSystem& js = engine_.getJobSystem();
+        for (size_t i = 0; i < orphans_.size();)
+        {
+            if (wait || orphans_[i]->done.load(std::memory_order_acquire))
+            {
+                js.waitAndRelease(orphans_[i]->job);
+                decodingBytes_ -= orphans_[i]->decodeBytes;
+                orphans_[i] = std::move(orphans_.back());
+                orphans_.pop_back();
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+}
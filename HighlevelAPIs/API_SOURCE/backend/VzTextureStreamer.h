@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VZ_TEXTURE_STREAMER_H
+#define VZ_TEXTURE_STREAMER_H
+
+#include "../VzEngineApp.h"
+#include "VzTextureResidency.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+    class Camera;
+    class Engine;
+    class Texture;
+}
+
+namespace vzm
+{
+    // Keeps the textures loaded with VzTexture::StreamImage under a memory budget
+    //  - a streamed texture starts with a 1x1 placeholder, then its coarsest levels (at most MIN_RESIDENT_SIZE texels wide)
+    //    are loaded, finer levels follow the on-screen size of the visible actors using it
+    //  - under memory pressure, the textures with the smallest on-screen size fall back to coarser levels first
+    //  - files are decoded and their mip chains built in background jobs, at most MAX_PENDING_LOADS at a time and
+    //    within the budget (see VzTextureResidency), the engine textures are created and swapped into the material
+    //    instances by Update()
+    //  - a filament::Texture cannot change its size, so every residency change replaces the texture
+    class VzTextureStreamer
+    {
+    public:
+        static constexpr uint32_t MIN_RESIDENT_SIZE = VzTextureResidency::MIN_RESIDENT_SIZE;
+        static constexpr size_t MAX_PENDING_LOADS = VzTextureResidency::MAX_PENDING_LOADS;
+
+        struct Stats
+        {
+            size_t residentBytes = 0;   // all the levels currently uploaded
+            size_t budgetBytes = 0;
+            size_t pendingLoads = 0;
+            size_t decodingBytes = 0;   // CPU memory of the loads in flight
+            size_t textureCount = 0;
+        };
+
+        VzTextureStreamer(filament::Engine& engine, const size_t budgetBytes);
+        ~VzTextureStreamer();
+
+        // return false if the file does not exist or is not an image stb can decode
+        bool Add(const TextureVID vid, const std::string& fileName);
+        // stops streaming, the current texture stays with the VzTextureRes
+        void Remove(const TextureVID vid);
+        bool IsStreamed(const TextureVID vid) const { return records_.find(vid) != records_.end(); }
+
+        void SetBudget(const size_t budgetBytes) { budgetBytes_ = budgetBytes; }
+        Stats GetStats() const;
+
+        // Records the on-screen size of the actor for the streamed textures of its material instances
+        //  - to be called for the actors of each view before Update()
+        void AccumulateActor(const ActorVID vid, const filament::Camera& camera, const uint32_t viewportHeight);
+        // Applies the finished loads, then plans the residency of every streamed texture and starts new loads
+        void Update();
+
+    private:
+        struct Load;
+        struct Record : VzTextureResidency::Texture
+        {
+            std::string fileName;
+            bool failed = false;        // the file cannot be decoded anymore, the current levels are kept
+            std::unique_ptr<Load> load;
+        };
+
+        void startLoad(Record& record);
+        void finishLoad(const TextureVID vid, Record& record);
+        void setTexture(const TextureVID vid, filament::Texture* texture);
+        void collectOrphans(const bool wait);
+
+        filament::Engine& engine_;
+        size_t budgetBytes_ = 0;
+        size_t residentBytes_ = 0;
+        size_t decodingBytes_ = 0;  // of the loads in flight, orphans included
+        std::unordered_map<TextureVID, Record> records_;
+        std::vector<std::unique_ptr<Load>> orphans_; // loads of removed records, still running
+        // per update scratch
+        std::vector<VzTextureResidency::Texture*> planned_;
+        std::vector<std::pair<VzTextureResidency::Texture*, uint8_t>> loads_;
+    };
+}
+
+#endif // VZ_TEXTURE_STREAMER_H
@@ -1,5 +1,6 @@
 #include "VzActor.h"
 #include "../VzEngineApp.h"
+#include "../backend/VzPointCloud.h"
 #include "../FIncludes.h"
 
 extern Engine* gEngine;
@@ -7,6 +8,22 @@ extern vzm::VzEngineApp* gEngineApp;
 
 namespace vzm
 {
+    // Applies fn to the renderables of the instance chunks other than the actor itself
+    template <typename FN>
+    void forEachInstanceChunk(const VID vid, FN fn)
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(vid);
+        if (actor_res == nullptr)
+        {
+            return;
+        }
+        auto& rcm = gEngine->getRenderableManager();
+        for (size_t i = 1, n = actor_res->instanceRenderables.size(); i < n; ++i)
+        {
+            fn(rcm, rcm.getInstance(actor_res->instanceRenderables[i]));
+        }
+    }
+
     uint8_t VzBaseActor::GetVisibleLayerMask() const
     {
         COMP_ACTOR(rcm, ett, ins, 0);
@@ -16,6 +33,9 @@ void VzBaseActor::SetVisibleLayerMask(const uint8_t layerBits, const uint8_t mas
     {
         COMP_ACTOR(rcm, ett, ins, );
         rcm.setLayerMask(ins, layerBits, maskBits);
+        forEachInstanceChunk(GetVID(), [&](RenderableManager& rm, RenderableManager::Instance chunk) {
+            rm.setLayerMask(chunk, layerBits, maskBits);
+            });
         UpdateTimeStamp();
     }
     uint8_t VzBaseActor::GetPriority() const
@@ -27,6 +47,9 @@ void VzBaseActor::SetVisibleLayerMask(const uint8_t layerBits, const uint8_t mas
     {
         COMP_ACTOR(rcm, ett, ins, );
         rcm.setPriority(ins, priority);
+        forEachInstanceChunk(GetVID(), [&](RenderableManager& rm, RenderableManager::Instance chunk) {
+            rm.setPriority(chunk, priority);
+            });
         VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
         actor_res->priority = priority;
         UpdateTimeStamp();
@@ -65,22 +88,34 @@ namespace vzm
         utils::Entity ett_actor = utils::Entity::import(GetVID());
         auto ins = rcm.getInstance(ett_actor);
         rcm.setMaterialInstanceAt(ins, slot, mi_res->mi);
+        forEachInstanceChunk(GetVID(), [&](RenderableManager& rm, RenderableManager::Instance chunk) {
+            rm.setMaterialInstanceAt(chunk, slot, mi_res->mi);
+            });
         UpdateTimeStamp();
     }
     void VzActor::SetCastShadows(const bool enabled)
     {
         COMP_ACTOR(rcm, ett, ins, );
         rcm.setCastShadows(ins, enabled);
+        forEachInstanceChunk(GetVID(), [&](RenderableManager& rm, RenderableManager::Instance chunk) {
+            rm.setCastShadows(chunk, enabled);
+            });
     }
     void VzActor::SetReceiveShadows(const bool enabled)
     {
         COMP_ACTOR(rcm, ett, ins, );
         rcm.setReceiveShadows(ins, enabled);
+        forEachInstanceChunk(GetVID(), [&](RenderableManager& rm, RenderableManager::Instance chunk) {
+            rm.setReceiveShadows(chunk, enabled);
+            });
     }
     void VzActor::SetScreenSpaceContactShadows(const bool enabled)
     {
         COMP_ACTOR(rcm, ett, ins, );
         rcm.setScreenSpaceContactShadows(ins, enabled);
+        forEachInstanceChunk(GetVID(), [&](RenderableManager& rm, RenderableManager::Instance chunk) {
+            rm.setScreenSpaceContactShadows(chunk, enabled);
+            });
     }
     void VzActor::SetRenderableRes(const VID vidGeo, const std::vector<VID>& vidMIs)
     {
@@ -147,6 +182,149 @@ namespace vzm
         COMP_ACTOR(rcm, ett, ins, 0);
         return (int)rcm.getMorphTargetCount(ins);
     }
+    void VzActor::SetLODEnabled(const bool enabled)
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res == nullptr)
+        {
+            return;
+        }
+        actor_res->lodEnabled = enabled;
+        UpdateTimeStamp();
+    }
+    bool VzActor::IsLODEnabled()
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res == nullptr)
+        {
+            return false;
+        }
+        return actor_res->lodEnabled;
+    }
+    void VzActor::SetLODPixelError(const float pixelError)
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res == nullptr)
+        {
+            return;
+        }
+        actor_res->lodPixelError = std::max(pixelError, 0.f);
+        UpdateTimeStamp();
+    }
+    float VzActor::GetLODPixelError()
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res == nullptr)
+        {
+            return 0.f;
+        }
+        return actor_res->lodPixelError;
+    }
+    int VzActor::GetLODLevel(const int primitive)
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res == nullptr || primitive < 0 || primitive >= (int)actor_res->lodLevels.size())
+        {
+            return 0;
+        }
+        return actor_res->lodLevels[primitive];
+    }
+    int VzActor::GetLODCount(const int primitive)
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res == nullptr)
+        {
+            return 0;
+        }
+        VzGeometryRes* geo_res = gEngineApp->GetGeometryRes(actor_res->GetGeometryVid());
+        if (geo_res == nullptr || primitive < 0 || primitive >= (int)geo_res->Get()->size())
+        {
+            return 0;
+        }
+        return (int)(*geo_res->Get())[primitive].lods.size() + 1;
+    }
+    void VzActor::SetInstances(const float* transforms, const size_t count, const bool rowMajor)
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res == nullptr)
+        {
+            return;
+        }
+        if (count > 0 && transforms == nullptr)
+        {
+            backlog::post("invalid instance transforms!", backlog::LogLevel::Error);
+            return;
+        }
+        const size_t prev_count = actor_res->instanceTransforms.size();
+        actor_res->instanceTransforms.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const mat4f& m = ((const mat4f*)transforms)[i];
+            actor_res->instanceTransforms[i] = rowMajor ? transpose(m) : m;
+        }
+        if (count == prev_count && count > 0 && !actor_res->instanceBuffers.empty())
+        {
+            gEngineApp->UpdateInstances(GetVID(), 0, count);
+        }
+        else if (actor_res->GetGeometryVid() != INVALID_VID)
+        {
+            gEngineApp->BuildRenderable(GetVID());
+        }
+        UpdateTimeStamp();
+    }
+    bool VzActor::UpdateInstances(const float* transforms, const size_t offset, const size_t count, const bool rowMajor)
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res == nullptr)
+        {
+            return false;
+        }
+        if (transforms == nullptr || offset + count > actor_res->instanceTransforms.size())
+        {
+            backlog::post("instance range out of bounds!", backlog::LogLevel::Error);
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            const mat4f& m = ((const mat4f*)transforms)[i];
+            actor_res->instanceTransforms[offset + i] = rowMajor ? transpose(m) : m;
+        }
+        gEngineApp->UpdateInstances(GetVID(), offset, count);
+        UpdateTimeStamp();
+        return true;
+    }
+    size_t VzActor::GetInstanceCount()
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res == nullptr)
+        {
+            return 0;
+        }
+        return actor_res->instanceTransforms.size();
+    }
+    void VzActor::SetPointBudget(const size_t pointBudget)
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res->pointCloud)
+        {
+            actor_res->pointCloud->SetPointBudget(pointBudget);
+            UpdateTimeStamp();
+        }
+    }
+    void VzActor::SetPointPixelError(const float pixelError)
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        if (actor_res->pointCloud)
+        {
+            actor_res->pointCloud->SetPixelError(std::max(pixelError, 0.f));
+            UpdateTimeStamp();
+        }
+    }
+    size_t VzActor::GetVisiblePointCount()
+    {
+        VzActorRes* actor_res = gEngineApp->GetActorRes(GetVID());
+        return actor_res->pointCloud ? actor_res->pointCloud->GetVisiblePointCount() : 0;
+    }
 }
 
 
@@ -35,6 +35,36 @@ namespace vzm
         size_t GetMorphWeights(std::vector<float>& weights);
         void SetMorphWeights(const float* weights, const int count);
         int GetMorphTargetCount();
+
+        // Level-of-detail selection for geometries imported with simplified levels ("lod-levels")
+        //  - every frame, the coarsest level whose projected simplification error stays under pixelError is drawn
+        //  - disabling forces the full-detail mesh
+        void SetLODEnabled(const bool enabled);
+        bool IsLODEnabled();
+        void SetLODPixelError(const float pixelError = 1.f);
+        float GetLODPixelError();
+        // current level of the primitive (0 is the full-detail mesh)
+        int GetLODLevel(const int primitive = 0);
+        int GetLODCount(const int primitive = 0);
+
+        // Hardware instancing: the geometry is drawn once per local transform, relative to the actor transform
+        //  - transforms holds count 4x4 matrices (column-major unless rowMajor), count 0 turns instancing off
+        //  - instances are split into renderables of Engine::getMaxAutomaticInstances() (64 on most platforms),
+        //    each culled with the union of the bounds of its instances
+        //  - changing the count rebuilds the renderables, use UpdateInstances for per-frame changes
+        void SetInstances(const float* transforms, const size_t count, const bool rowMajor = false);
+        // Overwrites the transforms of instances [offset, offset + count), the number of instances is unchanged
+        //  - return false if the range is out of bounds
+        bool UpdateInstances(const float* transforms, const size_t offset, const size_t count, const bool rowMajor = false);
+        size_t GetInstanceCount();
+
+        // Point clouds loaded with LoadPointCloudIntoActor (ignored by other actors)
+        //  - octree nodes are refined until their projected point spacing is under pixelError,
+        //    as long as the drawn points stay within pointBudget
+        void SetPointBudget(const size_t pointBudget);
+        void SetPointPixelError(const float pixelError = 2.f);
+        // points drawn in the last frame, 0 for other actors
+        size_t GetVisiblePointCount();
     };
 
     struct API_EXPORT VzBaseSprite
@@ -45,6 +45,7 @@ namespace vzm
             } vsm;
             float shadowBulbRadius = 0.02f;
             float transform[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            bool cached = false;
         };
         void SetShadowOptions(ShadowOptions const& options);
         ShadowOptions const* GetShadowOptions() const;
@@ -84,6 +84,59 @@ namespace vzm
         return true;
     }
 
+    VzMI::ParamHandle VzMI::GetParameterHandle(const std::string& name, const vzm::UniformType vType)
+    {
+        ParamHandle handle;
+        SET_PARAM_COMP(mi, mi_res, m_res, handle);
+        const Material::ParameterInfo& info = m_res->allowedParamters[name];
+        if (info.isSampler || info.isSubpass || (vzm::UniformType)info.type != vType || vType == vzm::UniformType::STRUCT)
+        {
+            backlog::post("parameter (" + name + ") is not a uniform of the requested type", backlog::LogLevel::Error);
+            return handle;
+        }
+        handle.material = mi->getMaterial();
+        handle.offset = mi->getParameterOffset(name.c_str());
+        handle.type = vType;
+        return handle;
+    }
+
+    bool VzMI::SetParameter(const ParamHandle& handle, const void* v)
+    {
+        COMP_MI(mi, mi_res, false);
+        // offsets are only meaningful for the material they were resolved against
+        if (!handle.IsValid() || handle.material != mi->getMaterial())
+        {
+            return false;
+        }
+        const int32_t offset = handle.offset;
+        switch (handle.type)
+        {
+        case vzm::UniformType::BOOL: mi->setParameterAt(offset, *(bool*)v); break;
+        case vzm::UniformType::BOOL2: mi->setParameterAt(offset, *(math::bool2*)v); break;
+        case vzm::UniformType::BOOL3: mi->setParameterAt(offset, *(math::bool3*)v); break;
+        case vzm::UniformType::BOOL4: mi->setParameterAt(offset, *(math::bool4*)v); break;
+        case vzm::UniformType::FLOAT: mi->setParameterAt(offset, *(float*)v); break;
+        case vzm::UniformType::FLOAT2: mi->setParameterAt(offset, *(math::float2*)v); break;
+        case vzm::UniformType::FLOAT3: mi->setParameterAt(offset, *(math::float3*)v); break;
+        case vzm::UniformType::FLOAT4: mi->setParameterAt(offset, *(math::float4*)v); break;
+        case vzm::UniformType::INT: mi->setParameterAt(offset, *(int*)v); break;
+        case vzm::UniformType::INT2: mi->setParameterAt(offset, *(math::int2*)v); break;
+        case vzm::UniformType::INT3: mi->setParameterAt(offset, *(math::int3*)v); break;
+        case vzm::UniformType::INT4: mi->setParameterAt(offset, *(math::int4*)v); break;
+        case vzm::UniformType::UINT: mi->setParameterAt(offset, *(uint*)v); break;
+        case vzm::UniformType::UINT2: mi->setParameterAt(offset, *(math::uint2*)v); break;
+        case vzm::UniformType::UINT3: mi->setParameterAt(offset, *(math::uint3*)v); break;
+        case vzm::UniformType::UINT4: mi->setParameterAt(offset, *(math::uint4*)v); break;
+        case vzm::UniformType::MAT3: mi->setParameterAt(offset, *(math::mat3f*)v); break;
+        case vzm::UniformType::MAT4: mi->setParameterAt(offset, *(math::mat4f*)v); break;
+        case vzm::UniformType::STRUCT:
+        default:
+            return false;
+        }
+        UpdateTimeStamp();
+        return true;
+    }
+
     bool VzMI::GetParameter(const std::string& name, const vzm::UniformType vType, const void* v)
     {
         SET_PARAM_COMP(mi, mi_res, m_res, false);
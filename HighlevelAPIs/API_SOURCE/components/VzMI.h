@@ -23,6 +23,20 @@ namespace vzm
         bool SetParameter(const std::string& name, const vzm::RgbType vType, const float* v);
         bool SetParameter(const std::string& name, const vzm::RgbaType vType, const float* v);
         bool GetParameter(const std::string& name, const vzm::UniformType vType, const void* v);
+
+        // A uniform parameter resolved once, valid for every MI of the same material
+        struct ParamHandle
+        {
+            const void* material = nullptr; // the material the offset was resolved against
+            int32_t offset = -1;
+            vzm::UniformType type = vzm::UniformType::STRUCT;
+            bool IsValid() const { return offset >= 0; }
+        };
+        // Resolves a (non-sampler) parameter so that writes skip the name lookups
+        //  - return an invalid handle if the parameter is not allowed or its type differs from vType
+        ParamHandle GetParameterHandle(const std::string& name, const vzm::UniformType vType);
+        // v must hold a value of the handle's type (colors are linear)
+        bool SetParameter(const ParamHandle& handle, const void* v);
         VID GetTexture(const std::string& name);
         bool SetTexture(const std::string& name, const VID vidTexture,
                   const bool retainSampler = true);
@@ -3,9 +3,12 @@
 #include "../VzEngineApp.h"
 #include "VzAsset.h"
 #include "../FIncludes.h"
+#include "../backend/VzTextureStreamer.h"
+#include "../backend/VzPointCloud.h"
 
 extern Engine* gEngine;
 extern vzm::VzEngineApp* gEngineApp;
+extern vzm::VzTextureStreamer* gTextureStreamer;
 
 namespace vzm
 {
@@ -1148,6 +1151,143 @@ namespace vzm
     }
 #pragma endregion
 
+#pragma region Color Grading
+    void VzRenderer::SetColorGradingEnabled(bool enabled)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.enabled = enabled;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    bool VzRenderer::IsColorGradingEnabled()
+    {
+        COMP_RENDERPATH(render_path, true);
+        return render_path->viewSettings.colorGrading.enabled;
+    }
+    void VzRenderer::SetColorGradingQuality(ColorGradingQuality quality)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.quality = (filament::ColorGrading::QualityLevel) quality;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    VzRenderer::ColorGradingQuality VzRenderer::GetColorGradingQuality()
+    {
+        COMP_RENDERPATH(render_path, ColorGradingQuality::MEDIUM);
+        return (ColorGradingQuality) render_path->viewSettings.colorGrading.quality;
+    }
+    void VzRenderer::SetToneMapping(ToneMapping toneMapping)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.toneMapping = (vzm::ToneMapping) toneMapping;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    VzRenderer::ToneMapping VzRenderer::GetToneMapping()
+    {
+        COMP_RENDERPATH(render_path, ToneMapping::ACES_LEGACY);
+        return (ToneMapping) render_path->viewSettings.colorGrading.toneMapping;
+    }
+    void VzRenderer::SetExposure(float exposure)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.exposure = exposure;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    float VzRenderer::GetExposure()
+    {
+        COMP_RENDERPATH(render_path, 0.f);
+        return render_path->viewSettings.colorGrading.exposure;
+    }
+    void VzRenderer::SetNightAdaptation(float nightAdaptation)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.nightAdaptation = nightAdaptation;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    float VzRenderer::GetNightAdaptation()
+    {
+        COMP_RENDERPATH(render_path, 0.f);
+        return render_path->viewSettings.colorGrading.nightAdaptation;
+    }
+    void VzRenderer::SetWhiteBalance(float temperature, float tint)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.temperature = temperature;
+        render_path->viewSettings.colorGrading.tint = tint;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    void VzRenderer::GetWhiteBalance(float* temperature, float* tint)
+    {
+        COMP_RENDERPATH(render_path, );
+        if (temperature) *temperature = render_path->viewSettings.colorGrading.temperature;
+        if (tint) *tint = render_path->viewSettings.colorGrading.tint;
+    }
+    void VzRenderer::SetContrast(float contrast)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.contrast = contrast;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    float VzRenderer::GetContrast()
+    {
+        COMP_RENDERPATH(render_path, 1.f);
+        return render_path->viewSettings.colorGrading.contrast;
+    }
+    void VzRenderer::SetVibrance(float vibrance)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.vibrance = vibrance;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    float VzRenderer::GetVibrance()
+    {
+        COMP_RENDERPATH(render_path, 1.f);
+        return render_path->viewSettings.colorGrading.vibrance;
+    }
+    void VzRenderer::SetSaturation(float saturation)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.saturation = saturation;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    float VzRenderer::GetSaturation()
+    {
+        COMP_RENDERPATH(render_path, 1.f);
+        return render_path->viewSettings.colorGrading.saturation;
+    }
+    void VzRenderer::SetLuminanceScaling(bool luminanceScaling)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.luminanceScaling = luminanceScaling;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    bool VzRenderer::IsLuminanceScaling()
+    {
+        COMP_RENDERPATH(render_path, false);
+        return render_path->viewSettings.colorGrading.luminanceScaling;
+    }
+    void VzRenderer::SetGamutMapping(bool gamutMapping)
+    {
+        COMP_RENDERPATH(render_path, );
+        render_path->viewSettings.colorGrading.gamutMapping = gamutMapping;
+        render_path->dirtyFlags |= VzRenderPath::DirtyFlags::COLOR_GRADING;
+        UpdateTimeStamp();
+    }
+    bool VzRenderer::IsGamutMapping()
+    {
+        COMP_RENDERPATH(render_path, false);
+        return render_path->viewSettings.colorGrading.gamutMapping;
+    }
+#pragma endregion
+
     void VzRenderer::SetClearOptions(const ClearOptions& clearOptions)
     {
         COMP_RENDERPATH(render_path, );
@@ -1285,8 +1425,11 @@ namespace vzm
         //    backlog::post("up   : " + ToString(u), backlog::LogLevel::Default);
         //}
 
+        const uint32_t viewport_height = view->getViewport().height;
+
         std::map<Entity, mat4f> restore_billboard_tr;
-        scene->forEach([&tcm, &restore_billboard_tr, &u, &v](Entity ett) {
+        std::vector<VzActorRes*> point_clouds; // updated after the iteration, they add and remove node entities
+        scene->forEach([&tcm, &restore_billboard_tr, &point_clouds, &u, &v, camera, viewport_height](Entity ett) {
             VID vid = ett.getId();
 
             VzSceneComp* comp = gEngineApp->GetVzComponent<VzSceneComp>(vid);
@@ -1312,7 +1455,24 @@ namespace vzm
 
                 tcm.setTransform(ti, os2parent_new);
             }
+            else if (actor_res && !actor_res->lodLevels.empty())
+            {
+                gEngineApp->UpdateActorLOD(vid, *camera, viewport_height);
+            }
+            if (actor_res)
+            {
+                gTextureStreamer->AccumulateActor(vid, *camera, viewport_height);
+                if (actor_res->pointCloud)
+                {
+                    point_clouds.push_back(actor_res);
+                }
+            }
             });
+        gTextureStreamer->Update();
+        for (VzActorRes* actor_res : point_clouds)
+        {
+            actor_res->pointCloud->Update(*camera, viewport_height);
+        }
 
         filament::Texture* fogColorTexture = gEngineApp->GetSceneRes(vidScene)->GetIBL()->getFogTexture();
         render_path->viewSettings.fog.skyColor = fogColorTexture;
@@ -303,6 +303,57 @@ namespace vzm
         void SetVignetteColor(const float color[3]);
         void GetVignetteColor(float color[3]);
 
+        // color grading LUTs are cached per settings and built asynchronously,
+        // the previous LUT stays in use until the new one is ready
+        void SetColorGradingEnabled(bool enabled);
+        bool IsColorGradingEnabled();
+
+        enum class ColorGradingQuality : uint8_t {
+            LOW,        //!< 16x16x16 10 bits LUT
+            MEDIUM,     //!< 32x32x32 10 bits LUT
+            HIGH,       //!< 32x32x32 16 bits LUT
+            ULTRA       //!< 64x64x64 16 bits LUT
+        };
+        void SetColorGradingQuality(ColorGradingQuality quality);
+        ColorGradingQuality GetColorGradingQuality();
+
+        enum class ToneMapping : uint8_t {
+            LINEAR = 0,
+            ACES_LEGACY = 1,
+            ACES = 2,
+            FILMIC = 3,
+            AGX = 4,
+            GENERIC = 5,
+            PBR_NEUTRAL = 6,
+            DISPLAY_RANGE = 7,
+        };
+        void SetToneMapping(ToneMapping toneMapping);
+        ToneMapping GetToneMapping();
+
+        void SetExposure(float exposure);
+        float GetExposure();
+
+        void SetNightAdaptation(float nightAdaptation);
+        float GetNightAdaptation();
+
+        void SetWhiteBalance(float temperature, float tint);
+        void GetWhiteBalance(float* temperature, float* tint);
+
+        void SetContrast(float contrast);
+        float GetContrast();
+
+        void SetVibrance(float vibrance);
+        float GetVibrance();
+
+        void SetSaturation(float saturation);
+        float GetSaturation();
+
+        void SetLuminanceScaling(bool luminanceScaling);
+        bool IsLuminanceScaling();
+
+        void SetGamutMapping(bool gamutMapping);
+        bool IsGamutMapping();
+
         struct ClearOptions {
             float clearColor[4] = {};
             uint8_t clearStencil = 0u;
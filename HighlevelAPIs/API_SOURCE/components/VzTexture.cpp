@@ -1,6 +1,7 @@
 #include "VzTexture.h"
 #include "../VzEngineApp.h"
 #include "../FIncludes.h"
+#include "../backend/VzTextureStreamer.h"
 
 #include "../../libs/imageio/include/imageio/ImageDecoder.h"
 
@@ -10,6 +11,7 @@
 
 extern Engine* gEngine;
 extern vzm::VzEngineApp* gEngineApp;
+extern vzm::VzTextureStreamer* gTextureStreamer;
 
 using namespace image;
 namespace vzm
@@ -23,6 +25,8 @@ namespace vzm
         VzTextureRes* tex_res = gEngineApp->GetTextureRes(GetVID());
         ASYNCCHECK;
 
+        gTextureStreamer->Remove(GetVID());
+
         bool isNew = false;
         if (tex_res->texture) {
             isNew = true;
@@ -142,6 +146,20 @@ namespace vzm
         return true;
     }
 
+    bool VzTexture::StreamImage(const std::string& fileName)
+    {
+        VzTextureRes* tex_res = gEngineApp->GetTextureRes(GetVID());
+        ASYNCCHECK;
+
+        if (!gTextureStreamer->Add(GetVID(), fileName)) {
+            backlog::post("The input image cannot be streamed: " + fileName, backlog::LogLevel::Error);
+            return false;
+        }
+
+        UpdateTimeStamp();
+        return true;
+    }
+
     std::string VzTexture::GetImageFileName()
     {
         VzTextureRes* tex_res = gEngineApp->GetTextureRes(GetVID());
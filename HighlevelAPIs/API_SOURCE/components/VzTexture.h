@@ -8,6 +8,12 @@ namespace vzm
         VzTexture(const VID vid, const std::string& originFrom)
             : VzResource(vid, originFrom, "VzTexture", RES_COMPONENT_TYPE::TEXTURE) {}
         bool ReadImage(const std::string& fileName, const bool generateMIPs = true);
+        // Stream the image (RGBA8, any format stb decodes) under the texture budget (see vzm::SetTextureStreamingBudget)
+        //  - returns immediately with a placeholder, the coarse mips are loaded first in the background
+        //  - finer mips follow the on-screen size of the visible actors using the texture, and are
+        //    dropped again for the least visible textures when the budget is exceeded
+        //  - ReadImage stops streaming
+        bool StreamImage(const std::string& fileName);
         std::string GetImageFileName();
 
         // sampler
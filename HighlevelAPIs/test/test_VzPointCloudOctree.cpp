@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "backend/VzPointCloudOctree.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace vzm;
+using namespace filament::math;
+
+namespace {
+
+class PointCloudOctreeTest : public testing::Test {
+protected:
+    void SetUp() override {
+        folder = std::filesystem::temp_directory_path() /
+                ("vzm_test_pointcloud_" + std::to_string(std::random_device{}()));
+        std::filesystem::create_directories(folder);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(folder, ec);
+    }
+
+    // points in a [-10, 10] box, dense enough around the origin for the root to be split
+    static std::vector<double3> makePoints(size_t count) {
+        std::mt19937 rng(42);
+        std::normal_distribution<double> dist(0.0, 2.0);
+        std::vector<double3> points(count);
+        for (auto& p : points) {
+            p = clamp(double3(dist(rng), dist(rng), dist(rng)), -10.0, 10.0) + double3(1000.0, 0.0, -50.0);
+        }
+        return points;
+    }
+
+    std::string writePly(std::vector<double3> const& points) const {
+        std::string const filename = (folder / "points.ply").string();
+        std::ofstream out(filename);
+        out << "ply\nformat ascii 1.0\nelement vertex " << points.size() << "\n"
+            << "property float x\nproperty float y\nproperty float z\n"
+            << "property uchar red\nproperty uchar green\nproperty uchar blue\nend_header\n";
+        for (auto const& p : points) {
+            out << p.x << " " << p.y << " " << p.z << " 255 128 0\n";
+        }
+        return filename;
+    }
+
+    std::string writeXyz(std::vector<double3> const& points) const {
+        std::string const filename = (folder / "points.xyz").string();
+        std::ofstream out(filename);
+        out << "// x y z\n";
+        for (auto const& p : points) {
+            out << p.x << " " << p.y << " " << p.z << "\n";
+        }
+        return filename;
+    }
+
+    // every node must hold pointCount points, all of them inside its box
+    static void checkNodes(VzPointCloudOctree const& octree, std::string const& cache) {
+        std::ifstream in(std::filesystem::path(cache) / "octree.bin", std::ios::binary);
+        ASSERT_TRUE(in.good());
+        size_t total = 0;
+        for (auto const& node : octree.nodes) {
+            total += node.pointCount;
+            std::vector<VzPointCloudOctree::Point> points(node.pointCount);
+            in.seekg(std::streamoff(node.offset));
+            ASSERT_TRUE(in.read((char*)points.data(),
+                    std::streamsize(points.size() * sizeof(VzPointCloudOctree::Point))));
+            float const tolerance = node.halfSize * 1e-4f;
+            for (auto const& p : points) {
+                float3 const d = abs(p.position - node.center);
+                EXPECT_LE(max(d), node.halfSize + tolerance);
+            }
+        }
+        EXPECT_EQ(octree.pointCount, total);
+    }
+
+    std::filesystem::path folder;
+};
+
+TEST_F(PointCloudOctreeTest, BuildAndReadPly) {
+    auto const points = makePoints(100000);
+    std::string const filename = writePly(points);
+    std::string const cache = (folder / "ply_cache").string();
+    std::filesystem::create_directories(cache);
+
+    EXPECT_FALSE(VzPointCloudOctree::IsCached(filename, cache));
+    ASSERT_TRUE(VzPointCloudOctree::Build(filename, cache));
+    EXPECT_TRUE(VzPointCloudOctree::IsCached(filename, cache));
+
+    VzPointCloudOctree octree;
+    ASSERT_TRUE(octree.Read(cache));
+    EXPECT_EQ(points.size(), octree.pointCount);
+    EXPECT_NEAR(1000.0, octree.center.x, 1.0);
+    ASSERT_GT(octree.nodes.size(), 1u);
+
+    // children are half the size of their parent, in the octant of their index
+    for (size_t i = 0; i < octree.nodes.size(); i++) {
+        auto const& parent = octree.nodes[i];
+        for (int octant = 0; octant < 8; octant++) {
+            int32_t const child = parent.children[octant];
+            if (child < 0) {
+                continue;
+            }
+            ASSERT_GT(size_t(child), i);
+            auto const& node = octree.nodes[child];
+            EXPECT_FLOAT_EQ(parent.halfSize * 0.5f, node.halfSize);
+            EXPECT_EQ((octant & 1) != 0, node.center.x > parent.center.x);
+            EXPECT_EQ((octant & 2) != 0, node.center.y > parent.center.y);
+            EXPECT_EQ((octant & 4) != 0, node.center.z > parent.center.z);
+        }
+    }
+    checkNodes(octree, cache);
+}
+
+TEST_F(PointCloudOctreeTest, BuildAndReadXyz) {
+    auto const points = makePoints(50000);
+    std::string const filename = writeXyz(points);
+    std::string const cache = (folder / "xyz_cache").string();
+    std::filesystem::create_directories(cache);
+
+    ASSERT_TRUE(VzPointCloudOctree::Build(filename, cache));
+    VzPointCloudOctree octree;
+    ASSERT_TRUE(octree.Read(cache));
+    EXPECT_EQ(points.size(), octree.pointCount);
+    checkNodes(octree, cache);
+}
+
+TEST_F(PointCloudOctreeTest, SourceChangeForcesRebuild) {
+    auto points = makePoints(1000);
+    std::string const filename = writeXyz(points);
+    std::string const cache = (folder / "stamp_cache").string();
+    std::filesystem::create_directories(cache);
+
+    ASSERT_TRUE(VzPointCloudOctree::Build(filename, cache));
+    EXPECT_TRUE(VzPointCloudOctree::IsCached(filename, cache));
+
+    // a different size, and a later modification time
+    points.resize(1500, double3(1000.0, 1.0, -50.0));
+    writeXyz(points);
+    std::filesystem::last_write_time(filename,
+            std::filesystem::last_write_time(filename) + std::chrono::seconds(10));
+    EXPECT_FALSE(VzPointCloudOctree::IsCached(filename, cache));
+
+    ASSERT_TRUE(VzPointCloudOctree::Build(filename, cache));
+    EXPECT_TRUE(VzPointCloudOctree::IsCached(filename, cache));
+    VzPointCloudOctree octree;
+    ASSERT_TRUE(octree.Read(cache));
+    EXPECT_EQ(1500u, octree.pointCount);
+    checkNodes(octree, cache);
+}
+
+} // namespace
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "backend/VzTextureResidency.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace vzm;
+
+namespace {
+
+using Texture = VzTextureResidency::Texture;
+using Loads = std::vector<std::pair<Texture*, uint8_t>>;
+
+// a texture whose levels from baseLevel are resident
+Texture makeResident(uint32_t size, uint8_t baseLevel, float pixels) {
+    Texture texture;
+    VzTextureResidency::Init(texture, size, size);
+    texture.residentLevel = baseLevel;
+    texture.residentBytes = VzTextureResidency::GetChainSize(texture, baseLevel);
+    texture.pixels = pixels;
+    return texture;
+}
+
+size_t residentBytesOf(std::vector<Texture*> const& textures) {
+    size_t bytes = 0;
+    for (Texture const* texture : textures) {
+        bytes += texture->residentBytes;
+    }
+    return bytes;
+}
+
+TEST(TextureResidencyTest, MipChain) {
+    Texture texture;
+    VzTextureResidency::Init(texture, 1024, 512);
+    EXPECT_EQ(11, texture.levelCount);
+    EXPECT_EQ(3, texture.tailLevel); // 128 x 64
+    EXPECT_EQ(texture.levelCount, texture.residentLevel);
+    EXPECT_EQ(4u, VzTextureResidency::GetChainSize(texture, 10));
+    EXPECT_EQ(12u, VzTextureResidency::GetChainSize(texture, 9));
+    EXPECT_EQ(0u, VzTextureResidency::GetChainSize(texture, texture.levelCount));
+
+    size_t full = 0;
+    for (uint32_t w = 1024, h = 512; w > 0; w >>= 1, h >>= 1) {
+        full += size_t(w) * std::max(1u, h) * 4;
+    }
+    EXPECT_EQ(full, VzTextureResidency::GetChainSize(texture, 0));
+    EXPECT_EQ(2 * full, VzTextureResidency::GetDecodeSize(texture, 0));
+
+    Texture small;
+    VzTextureResidency::Init(small, 64, 64);
+    EXPECT_EQ(7, small.levelCount);
+    EXPECT_EQ(0, small.tailLevel);
+}
+
+TEST(TextureResidencyTest, DesiredLevel) {
+    Texture texture;
+    VzTextureResidency::Init(texture, 1024, 1024);
+    EXPECT_EQ(texture.tailLevel, VzTextureResidency::GetDesiredLevel(texture));
+    texture.pixels = 2048.f;
+    EXPECT_EQ(0, VzTextureResidency::GetDesiredLevel(texture));
+    texture.pixels = 256.f;
+    EXPECT_EQ(2, VzTextureResidency::GetDesiredLevel(texture));
+    texture.pixels = 10.f;
+    EXPECT_EQ(texture.tailLevel, VzTextureResidency::GetDesiredLevel(texture));
+
+    // the size of the previous plan holds, so that a texture doesn't drop on the first frame it's not drawn
+    texture.pixels = 0.f;
+    texture.lastPixels = 512.f;
+    EXPECT_EQ(1, VzTextureResidency::GetDesiredLevel(texture));
+}
+
+TEST(TextureResidencyTest, NewTexturesLoadTheirTailsFirst) {
+    std::vector<Texture> storage(6);
+    std::vector<Texture*> textures;
+    for (size_t i = 0; i < storage.size(); i++) {
+        VzTextureResidency::Init(storage[i], 256, 256);
+        storage[i].pixels = float(i) * 100.f;
+        textures.push_back(&storage[i]);
+    }
+
+    Loads loads;
+    VzTextureResidency::Plan(textures, 1u << 30, 0, 0, 0, loads);
+    ASSERT_EQ(VzTextureResidency::MAX_PENDING_LOADS, loads.size());
+    for (auto const& load : loads) {
+        EXPECT_TRUE(load.first->loading);
+        EXPECT_EQ(load.first->tailLevel, load.second);
+        EXPECT_EQ(load.second, load.first->loadLevel);
+    }
+    // the most covered first
+    EXPECT_EQ(&storage[5], loads[0].first);
+
+    // the rest wait for the loads in flight
+    VzTextureResidency::Plan(textures, 1u << 30, 0, 0, VzTextureResidency::MAX_PENDING_LOADS, loads);
+    EXPECT_TRUE(loads.empty());
+}
+
+TEST(TextureResidencyTest, BudgetGoesToTheMostCovered) {
+    Texture a = makeResident(1024, 3, 1024.f);
+    Texture b = makeResident(1024, 3, 256.f);
+    std::vector<Texture*> textures = { &b, &a };
+    const size_t budget = VzTextureResidency::GetChainSize(a, 0) + VzTextureResidency::GetChainSize(b, 3);
+
+    Loads loads;
+    VzTextureResidency::Plan(textures, budget, residentBytesOf(textures), 0, 0, loads);
+    EXPECT_EQ(0, a.targetLevel);
+    EXPECT_EQ(3, b.targetLevel);
+    ASSERT_EQ(1u, loads.size());
+    EXPECT_EQ(&a, loads[0].first);
+    EXPECT_EQ(0, loads[0].second);
+    EXPECT_FALSE(b.loading);
+}
+
+TEST(TextureResidencyTest, LeastCoveredIsCoarsenedUnderPressure) {
+    Texture a = makeResident(1024, 0, 1024.f);
+    Texture b = makeResident(1024, 0, 0.f);
+    std::vector<Texture*> textures = { &a, &b };
+    const size_t budget = VzTextureResidency::GetChainSize(a, 0) + VzTextureResidency::GetChainSize(b, 3) + 1024;
+
+    Loads loads;
+    VzTextureResidency::Plan(textures, budget, residentBytesOf(textures), 0, 0, loads);
+    EXPECT_EQ(0, a.targetLevel);
+    EXPECT_EQ(b.tailLevel, b.targetLevel);
+    ASSERT_EQ(1u, loads.size());
+    EXPECT_EQ(&b, loads[0].first);
+    EXPECT_EQ(b.tailLevel, loads[0].second);
+}
+
+TEST(TextureResidencyTest, DecodesInFlightCountAgainstBudget) {
+    Texture a = makeResident(1024, 3, 1024.f);
+    Texture b = makeResident(1024, 3, 1000.f);
+    Texture c = makeResident(1024, 3, 900.f);
+    c.loading = true;
+    c.loadLevel = 0;
+    std::vector<Texture*> textures = { &a, &b, &c };
+    const size_t full = VzTextureResidency::GetChainSize(a, 0);
+    const size_t decoding = VzTextureResidency::GetDecodeSize(c, 0);
+
+    // the refinements of all three fit, the decodes of two of them only
+    const size_t budget = 4 * full;
+    Loads loads;
+    VzTextureResidency::Plan(textures, budget, residentBytesOf(textures), decoding, 1, loads);
+    EXPECT_EQ(0, a.targetLevel);
+    EXPECT_EQ(0, b.targetLevel);
+    ASSERT_EQ(1u, loads.size());
+    EXPECT_EQ(&a, loads[0].first);
+    EXPECT_FALSE(b.loading);
+
+    // b follows once the decodes are done
+    for (Texture* texture : { &a, &c }) {
+        texture->loading = false;
+        texture->residentLevel = 0;
+        texture->residentBytes = full;
+    }
+    VzTextureResidency::Plan(textures, budget, residentBytesOf(textures), 0, 0, loads);
+    ASSERT_EQ(1u, loads.size());
+    EXPECT_EQ(&b, loads[0].first);
+}
+
+TEST(TextureResidencyTest, OversizedDecodeRunsAlone) {
+    Texture a = makeResident(1024, 3, 1024.f);
+    std::vector<Texture*> textures = { &a };
+    const size_t budget = VzTextureResidency::GetChainSize(a, 0);
+    ASSERT_GT(VzTextureResidency::GetDecodeSize(a, 0), budget);
+
+    Loads loads;
+    VzTextureResidency::Plan(textures, budget, a.residentBytes, 1, 1, loads);
+    EXPECT_TRUE(loads.empty());
+
+    VzTextureResidency::Plan(textures, budget, a.residentBytes, 0, 0, loads);
+    ASSERT_EQ(1u, loads.size());
+    EXPECT_EQ(0, loads[0].second);
+}
+
+} // namespace
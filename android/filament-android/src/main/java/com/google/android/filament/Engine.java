@@ -420,9 +420,13 @@ public class Engine {
         public long stereoscopicEyeCount = 2;
 
         /*
-         * @Deprecated This value is no longer used.
+         * Size in MiB above which the textures cached for reuse by the frame graph are evicted,
+         * oldest first. This is a soft limit: textures released during the last frame are
+         * always kept, because the next frame is likely to need them.
+         * 0 means no size limit, the cache is then only trimmed by age.
+         * The default is 0.
          */
-        public long resourceAllocatorCacheSizeMB = 64;
+        public long resourceAllocatorCacheSizeMB = 0;
 
         /*
          * This value determines how many frames texture entries are kept for in the cache. This
@@ -17,7 +17,9 @@
 #ifndef TNT_FILAMENT_BACKEND_PRIVATE_CIRCULARBUFFER_H
 #define TNT_FILAMENT_BACKEND_PRIVATE_CIRCULARBUFFER_H
 
+#include <utils/compiler.h>
 #include <utils/debug.h>
+#include <utils/Mutex.h>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -45,35 +47,73 @@ public:
     // Total size of circular buffer. This is a constant.
     size_t size() const noexcept { return mSize; }
 
-    // Allocates `s` bytes in the circular buffer and returns a pointer to the memory. All
-    // allocations must not exceed size() bytes.
+    // Space reserved at the end of every segment for the NoopCommand that either jumps to the
+    // next segment or terminates the stream.
+    static constexpr size_t LINK_SIZE = 16;
+
+    // Heap block chained after the circular buffer when a recording exceeds its budget.
+    struct Block;
+
+    // Allocates `s` bytes in the circular buffer and returns a pointer to the memory. When the
+    // budget is exhausted, the recording continues in an overflow block which is linked from
+    // the circular buffer with a NoopCommand, so `s` is only limited by available memory.
     inline void* allocate(size_t s) noexcept {
-        // We can never allocate more that size().
-        assert_invariant(getUsed() + s <= size());
         char* const cur = static_cast<char*>(mHead);
+        if (UTILS_UNLIKELY(cur + s > mLimit)) {
+            return allocateSlow(s);
+        }
         mHead = cur + s;
         return cur;
     }
 
+    // Allocates the terminating NoopCommand, this always succeeds because LINK_SIZE bytes are
+    // kept in reserve at the end of the current segment.
+    void* allocateLink() noexcept {
+        char* const cur = static_cast<char*>(mHead);
+        assert_invariant(cur <= mLimit);
+        mHead = cur + LINK_SIZE;
+        return cur;
+    }
+
+    // Sets how many bytes can be written in the circular buffer after the last call to
+    // getBuffer() without overwriting commands that have not been executed yet. Allocations
+    // beyond this go to overflow blocks.
+    void setBudget(size_t budget) noexcept;
+
     // Returns true if the buffer is empty, i.e.: no allocations were made since
     // calling getBuffer();
     bool empty() const noexcept { return mTail == mHead; }
 
-    // Returns the size used since the last call to getBuffer()
-    size_t getUsed() const noexcept { return intptr_t(mHead) - intptr_t(mTail); }
+    // Returns the size used since the last call to getBuffer(), including overflow blocks
+    size_t getUsed() const noexcept {
+        return intptr_t(mHead) - intptr_t(mSegment) + mSpilled;
+    }
 
     // Retrieves the current allocated range and frees it. It is the responsibility of the caller
     // to make sure the returned range is no longer in use by the time allocate() allocates
-    // (size() - getUsed()) bytes.
+    // the budget set by setBudget(). `head` is the end of the circular part of the range,
+    // `overflow` the chain of blocks holding the rest of it (if any), which must be returned
+    // with recycle() once executed.
     struct Range {
         void* tail;
         void* head;
+        Block* overflow;
     };
     Range getBuffer() noexcept;
 
+    // Returns a chain of overflow blocks, may be called from any thread.
+    void recycle(Block* blocks) noexcept;
+
+    // Number of recordings that needed overflow blocks and the largest spill so far.
+    uint32_t getOverflowCount() const noexcept { return mOverflowCount; }
+    size_t getOverflowHighWatermark() const noexcept { return mOverflowHighWatermark; }
+
 private:
     void* alloc(size_t size) noexcept;
     void dealloc() noexcept;
+    void* allocateSlow(size_t s) noexcept;
+    Block* acquireBlock(size_t capacity) noexcept;
+    static void freeBlocks(Block* blocks) noexcept;
 
     // pointer to the beginning of the circular buffer (constant)
     void* mData = nullptr;
@@ -88,6 +128,30 @@ private:
     // pointer to the next available command
     void* mHead = nullptr;
 
+    // end of the writable part of the current segment (circular buffer or overflow block)
+    char* mLimit = nullptr;
+
+    // start of the current segment and bytes recorded in the previous segments
+    void* mSegment = nullptr;
+    size_t mSpilled = 0;
+
+    // bytes writable in the circular buffer after mTail
+    size_t mBudget;
+
+    // end of the circular part of the current recording when it continues in overflow blocks
+    void* mCircularHead = nullptr;
+    Block* mFirstBlock = nullptr;
+    Block* mLastBlock = nullptr;
+
+    // overflow blocks are sized after the largest spill seen so far and kept around until
+    // enough recordings fit in the circular buffer again
+    size_t mBlockCapacity;
+    uint32_t mIdleRecordings = 0;
+    uint32_t mOverflowCount = 0;
+    size_t mOverflowHighWatermark = 0;
+    utils::Mutex mPoolLock;
+    Block* mPool = nullptr;
+
     // system page size
     static size_t sPageSize;
 };
@@ -36,6 +36,7 @@ class CommandBufferQueue {
     struct Range {
         void* begin;
         void* end;
+        CircularBuffer::Block* overflow;
     };
 
     const size_t mRequiredSize;
@@ -49,12 +50,24 @@ class CommandBufferQueue {
     mutable std::vector<Range> mCommandBuffersToExecute;
     size_t mFreeSpace = 0;
     size_t mHighWatermark = 0;
+    uint32_t mStallCount = 0;
     uint32_t mExitRequested = 0;
     bool mPaused = false;
 
     static constexpr uint32_t EXIT_REQUESTED = 0x31415926;
 
 public:
+    struct Metrics {
+        size_t capacity;                // space guaranteed after flush()
+        size_t bufferSize;              // size of the circular buffer
+        size_t used;                    // bytes of the circular buffer waiting to be executed
+        size_t highWatermark;           // largest value of `used` so far
+        size_t overflowHighWatermark;   // largest recording spilled into overflow blocks
+        uint32_t pendingBuffers;        // buffers flushed but not picked up by the driver yet
+        uint32_t overflowCount;         // recordings that needed overflow blocks
+        uint32_t stallCount;            // flush() calls that blocked waiting for space
+    };
+
     // requiredSize: guaranteed available space after flush()
     CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused);
     ~CommandBufferQueue();
@@ -66,6 +79,9 @@ public:
 
     size_t getHighWatermark() const noexcept { return mHighWatermark; }
 
+    // must be called from the thread recording commands
+    Metrics getMetrics() const noexcept;
+
     // wait for commands to be available and returns an array containing these commands
     std::vector<Range> waitForCommands() const;
 
@@ -75,7 +91,8 @@ public:
     void releaseBuffer(Range const& buffer);
 
     // all commands buffers (Slices) written to this point are returned by waitForCommand(). This
-    // call blocks until the CircularBuffer has at least mRequiredSize bytes available.
+    // call blocks until the CircularBuffer has at least mRequiredSize bytes available, unless
+    // the queue is paused, in which case the next commands go to overflow blocks.
     void flush() noexcept;
 
     // returns from waitForCommands() immediately.
@@ -18,6 +18,7 @@
 #define TNT_FILAMENT_BACKEND_PRIVATE_COMMANDSTREAM_H
 
 #include "private/backend/CircularBuffer.h"
+#include "private/backend/CommandStreamRecorder.h"
 #include "private/backend/Dispatcher.h"
 #include "private/backend/Driver.h"
 
@@ -219,6 +220,9 @@ public:
 #define DECL_DRIVER_API(methodName, paramsDecl, params)                                         \
     inline void methodName(paramsDecl) {                                                        \
         DEBUG_COMMAND_BEGIN(methodName, false, params);                                         \
+        if (UTILS_UNLIKELY(mRecorder)) {                                                        \
+            mRecorder->record(CapturedCommand::methodName, params);                             \
+        }                                                                                       \
         using Cmd = COMMAND_TYPE(methodName);                                                   \
         void* const p = allocateCommand(CommandBase::align(sizeof(Cmd)));                       \
         new(p) Cmd(mDispatcher.methodName##_, APPLY(std::move, params));                        \
@@ -238,6 +242,9 @@ public:
     inline RetType methodName(paramsDecl) {                                                     \
         DEBUG_COMMAND_BEGIN(methodName, false, params);                                         \
         RetType result = mDriver.methodName##S();                                               \
+        if (UTILS_UNLIKELY(mRecorder)) {                                                        \
+            mRecorder->record(CapturedCommand::methodName, result, params);                     \
+        }                                                                                       \
         using Cmd = COMMAND_TYPE(methodName##R);                                                \
         void* const p = allocateCommand(CommandBase::align(sizeof(Cmd)));                       \
         new(p) Cmd(mDispatcher.methodName##_, RetType(result), APPLY(std::move, params));       \
@@ -259,6 +266,10 @@ public:
 
     void execute(void* buffer);
 
+    // Serializes all asynchronous commands to `recorder` before they're queued, or stops
+    // doing so if null. The recorder must outlive the CommandStream or be removed first.
+    void setRecorder(CommandStreamRecorder* recorder) noexcept { mRecorder = recorder; }
+
     /*
      * queueCommand() allows to queue a lambda function as a command.
      * This is much less efficient than using the Driver* API.
@@ -291,6 +302,7 @@ private:
     Driver& UTILS_RESTRICT mDriver;
     CircularBuffer& UTILS_RESTRICT mCurrentBuffer;
     Dispatcher mDispatcher;
+    CommandStreamRecorder* mRecorder = nullptr;
 
 #ifndef NDEBUG
     // just for debugging...
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_BACKEND_PRIVATE_COMMANDSTREAMRECORDER_H
+#define TNT_FILAMENT_BACKEND_PRIVATE_COMMANDSTREAMRECORDER_H
+
+#include <backend/BufferDescriptor.h>
+#include <backend/CallbackHandler.h>
+#include <backend/DriverEnums.h>
+#include <backend/Handle.h>
+#include <backend/PixelBufferDescriptor.h>
+#include <backend/Program.h>
+
+#include <utils/CString.h>
+#include <utils/compiler.h>
+#include <utils/Invocable.h>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace filament::backend {
+
+/*
+ * Identifies a DriverApi command in a capture. Synchronous calls are not captured, they are
+ * executed right away on the calling thread and never go through the command stream.
+ */
+enum class CapturedCommand : uint16_t {
+#define DECL_DRIVER_API(methodName, paramsDecl, params) methodName,
+#define DECL_DRIVER_API_RETURN(RetType, methodName, paramsDecl, params) methodName,
+#define DECL_DRIVER_API_SYNCHRONOUS(RetType, methodName, paramsDecl, params)
+#include "private/backend/DriverAPI.inc"
+    COUNT
+};
+
+const char* getCapturedCommandName(CapturedCommand command) noexcept;
+
+/*
+ * Serializes the commands recorded by a CommandStream to a file, so they can be replayed
+ * later with CommandStreamReplay, e.g. on the noop backend.
+ *
+ * The file starts with a Header, followed by one record per command: a RecordHeader and the
+ * command's parameters, in declaration order. Commands returning a handle store it first.
+ * Buffer payloads are stored inline and 8-bytes aligned, so they can be used in place once
+ * the file is loaded. Native pointers and callbacks are not portable and are dropped.
+ *
+ * Commands are buffered and written at the end of each frame; recording stops after
+ * `frameCount` calls to endFrame(), or when the recorder is destroyed.
+ */
+class CommandStreamRecorder {
+public:
+    static constexpr uint32_t MAGIC = 0x50414346; // "FCAP"
+    static constexpr uint32_t VERSION = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t backend;
+        uint32_t frameCount;
+    };
+
+    struct RecordHeader {
+        CapturedCommand command;
+        uint16_t reserved;
+        uint32_t size;      // size of the parameters, a multiple of 8 bytes
+    };
+
+    CommandStreamRecorder(const char* path, Backend backend, uint32_t frameCount) noexcept;
+
+    CommandStreamRecorder(CommandStreamRecorder const& rhs) = delete;
+    CommandStreamRecorder& operator=(CommandStreamRecorder const& rhs) = delete;
+
+    ~CommandStreamRecorder() noexcept;
+
+    bool isRecording() const noexcept { return mFile != nullptr; }
+
+    template<typename ... ARGS>
+    void record(CapturedCommand command, ARGS const& ... args) {
+        if (UTILS_UNLIKELY(!mFile)) {
+            return;
+        }
+        size_t const start = beginRecord(command);
+        (write(args), ...);
+        endRecord(start, command);
+    }
+
+private:
+    size_t beginRecord(CapturedCommand command);
+    void endRecord(size_t start, CapturedCommand command);
+    void finish() noexcept;
+
+    void writeBytes(void const* data, size_t size);
+    void writeBlob(void const* data, size_t size);
+    void writeString(const char* string, size_t length);
+
+    void write(BufferDescriptor const& data);
+    void write(PixelBufferDescriptor const& data);
+    void write(Program const& program);
+    void write(utils::CString const& string);
+
+    template<typename T>
+    void write(T const& value) {
+        if constexpr (std::is_same_v<T, const char*>) {
+            writeString(value, value ? strlen(value) : 0);
+        } else if constexpr (std::is_pointer_v<T> ||
+                std::is_same_v<T, FrameScheduledCallback> ||
+                std::is_same_v<T, utils::Invocable<void(void)>>) {
+            // native objects and callbacks have no meaning outside this process
+        } else {
+            static_assert(std::is_trivially_destructible_v<T>,
+                    "this type needs its own serialization");
+            writeBytes(&value, sizeof(T));
+        }
+    }
+
+    std::string mPath;
+    FILE* mFile = nullptr;
+    std::vector<uint8_t> mData;
+    Backend mBackend;
+    uint32_t mFrameCount;
+    uint32_t mFramesRecorded = 0;
+};
+
+} // namespace filament::backend
+
+#endif // TNT_FILAMENT_BACKEND_PRIVATE_COMMANDSTREAMRECORDER_H
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_BACKEND_PRIVATE_COMMANDSTREAMREPLAY_H
+#define TNT_FILAMENT_BACKEND_PRIVATE_COMMANDSTREAMREPLAY_H
+
+#include "private/backend/CircularBuffer.h"
+#include "private/backend/CommandStream.h"
+#include "private/backend/CommandStreamRecorder.h"
+
+#include <backend/DriverEnums.h>
+#include <backend/Handle.h>
+
+#include <tsl/robin_map.h>
+
+#include <array>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament::backend {
+
+class Driver;
+
+/*
+ * Replays a capture written by CommandStreamRecorder through a CommandStream, i.e. the same
+ * dispatch path as the engine, into any Driver.
+ *
+ * Handles are remapped to the ones created by the replay. Swap chains are replayed headless
+ * since the captured native windows don't exist anymore, and callbacks are not invoked.
+ * Commands are executed at the end of each frame, like the engine does, or one at a time
+ * when per-command timings are requested.
+ */
+class CommandStreamReplay {
+public:
+    struct CommandStats {
+        uint32_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+    };
+
+    struct Stats {
+        // per-command timings are only measured in `perCommand` mode
+        std::array<CommandStats, size_t(CapturedCommand::COUNT)> commands{};
+        std::vector<uint64_t> frameNs;
+        uint64_t totalNs = 0;
+    };
+
+    explicit CommandStreamReplay(Driver& driver);
+
+    CommandStreamReplay(CommandStreamReplay const& rhs) = delete;
+    CommandStreamReplay& operator=(CommandStreamReplay const& rhs) = delete;
+
+    ~CommandStreamReplay() noexcept;
+
+    // Loads a capture, returns false if the file can't be read or is not a valid capture.
+    bool load(const char* path);
+
+    uint32_t getFrameCount() const noexcept { return mFrameCount; }
+    Backend getCapturedBackend() const noexcept { return mCapturedBackend; }
+
+    void setSwapChainSize(uint32_t width, uint32_t height) noexcept {
+        mSwapChainWidth = width;
+        mSwapChainHeight = height;
+    }
+
+    // Replays the whole capture once. This can be called several times, each replay creates
+    // its own set of driver objects.
+    Stats replay(bool perCommand);
+
+private:
+    class Reader;
+
+    void dispatch(CapturedCommand command, Reader& reader);
+    void execute();
+
+    template<typename ... ARGS>
+    void replayCommand(Reader& reader, void (CommandStream::*method)(ARGS...));
+
+    template<typename R, typename ... ARGS>
+    void replayCreate(Reader& reader, R (CommandStream::*method)(ARGS...));
+
+    template<typename T>
+    void remap(T&) noexcept { }
+    template<typename T>
+    void remap(Handle<T>& handle) noexcept;
+    void remap(PipelineState& state) noexcept;
+    void remap(TargetBufferInfo& info) noexcept;
+    void remap(MRT& mrt) noexcept;
+
+    Driver& mDriver;
+    CircularBuffer mBuffer;
+    CommandStream mStream;
+    std::vector<uint8_t> mData;
+    tsl::robin_map<HandleBase::HandleId, HandleBase::HandleId> mHandles;
+    Backend mCapturedBackend = Backend::NOOP;
+    uint32_t mFrameCount = 0;
+    uint32_t mSwapChainWidth = 1280;
+    uint32_t mSwapChainHeight = 720;
+};
+
+} // namespace filament::backend
+
+#endif // TNT_FILAMENT_BACKEND_PRIVATE_COMMANDSTREAMREPLAY_H
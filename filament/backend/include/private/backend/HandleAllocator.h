@@ -21,6 +21,8 @@
 
 #include <utils/Allocator.h>
 #include <utils/Log.h>
+#include <utils/MagazineCache.h>
+#include <utils/Mutex.h>
 #include <utils/compiler.h>
 #include <utils/debug.h>
 #include <utils/ostream.h>
@@ -30,6 +32,7 @@
 
 #include <cstddef>
 #include <exception>
+#include <mutex>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -223,58 +226,80 @@ private:
         Pool<P1> mPool1;
         Pool<P2> mPool2;
         UTILS_UNUSED_IN_RELEASE const utils::AreaPolicy::HeapArea& mArea;
-        bool mUseAfterFreeCheckDisabled;
     public:
         explicit Allocator(const utils::AreaPolicy::HeapArea& area, bool disableUseAfterFreeCheck);
 
         static constexpr size_t getAlignment() noexcept { return MIN_ALIGNMENT; }
 
         // this is in fact always called with a constexpr size argument
-        [[nodiscard]] inline void* alloc(size_t size, size_t, size_t, uint8_t* outAge) noexcept {
-            void* p = nullptr;
-            if      (size <= mPool0.getSize()) p = mPool0.alloc(size);
-            else if (size <= mPool1.getSize()) p = mPool1.alloc(size);
-            else if (size <= mPool2.getSize()) p = mPool2.alloc(size);
-            if (UTILS_LIKELY(p)) {
-                Node const* const pNode = static_cast<Node const*>(p);
-                // we are guaranteed to have at least sizeof<Node> bytes of extra storage before
-                // the allocation address.
-                *outAge = pNode[-1].age;
-            }
-            return p;
+        [[nodiscard]] inline void* alloc(size_t size, size_t, size_t) noexcept {
+            if (size <= mPool0.getSize()) return mPool0.alloc(size);
+            if (size <= mPool1.getSize()) return mPool1.alloc(size);
+            if (size <= mPool2.getSize()) return mPool2.alloc(size);
+            return nullptr;
         }
 
         // this is in fact always called with a constexpr size argument
-        inline void free(void* p, size_t size, uint8_t age) noexcept {
+        inline void free(void* p, size_t size) noexcept {
             assert_invariant(p >= mArea.begin() && (char*)p + size <= (char*)mArea.end());
-
-            // check for double-free
-            Node* const pNode = static_cast<Node*>(p);
-            uint8_t& expectedAge = pNode[-1].age;
-            if (UTILS_UNLIKELY(!mUseAfterFreeCheckDisabled)) {
-                FILAMENT_CHECK_POSTCONDITION(expectedAge == age) <<
-                        "double-free of Handle of size " << size << " at " << p;
-            }
-            expectedAge = (expectedAge + 1) & 0xF; // fixme
-
             if (size <= mPool0.getSize()) { mPool0.free(p); return; }
             if (size <= mPool1.getSize()) { mPool1.free(p); return; }
             if (size <= mPool2.getSize()) { mPool2.free(p); return; }
         }
+
+        // we are guaranteed to have at least sizeof<Node> bytes of extra storage before
+        // the allocation address.
+        static uint8_t& age(void* p) noexcept {
+            return static_cast<Node*>(p)[-1].age;
+        }
     };
 
-// FIXME: We should be using a Spinlock here, at least on platforms where mutexes are not
-//        efficient (i.e. non-Linux). However, we've seen some hangs on that spinlock, which
-//        we don't understand well (b/308029108).
+    // The arena is only accessed in batches, under mArenaLock. Handles are allocated and freed
+    // through per-thread caches (one per pool), which pass batches of free handles between
+    // threads without locking. This also replaces the Spinlock we couldn't use here because of
+    // hangs we didn't understand well (b/308029108).
 #ifndef NDEBUG
     using HandleArena = utils::Arena<Allocator,
-            utils::LockingPolicy::Mutex,
+            utils::LockingPolicy::NoLock,
             utils::TrackingPolicy::DebugAndHighWatermark>;
 #else
     using HandleArena = utils::Arena<Allocator,
-            utils::LockingPolicy::Mutex>;
+            utils::LockingPolicy::NoLock>;
 #endif
 
+    using HandleCache = utils::MagazineCache<32, 4, 16>;
+
+    template<size_t SIZE>
+    HandleCache& getHandleCache() noexcept {
+        static_assert(SIZE == P0 || SIZE == P1 || SIZE == P2);
+        if constexpr (SIZE == P0) { return mHandleCache0; }
+        else if constexpr (SIZE == P1) { return mHandleCache1; }
+        else { return mHandleCache2; }
+    }
+
+    template<size_t SIZE>
+    UTILS_NOINLINE
+    size_t refillHandleCache(void** items, size_t count) noexcept {
+        std::lock_guard<utils::Mutex> const lock(mArenaLock);
+        size_t i = 0;
+        for (; i < count; i++) {
+            items[i] = mHandleArena.alloc(SIZE, alignof(std::max_align_t), 0);
+            if (UTILS_UNLIKELY(!items[i])) {
+                break;
+            }
+        }
+        return i;
+    }
+
+    template<size_t SIZE>
+    UTILS_NOINLINE
+    void drainHandleCache(void* const* items, size_t count) noexcept {
+        std::lock_guard<utils::Mutex> const lock(mArenaLock);
+        for (size_t i = 0; i < count; i++) {
+            mHandleArena.free(items[i], SIZE);
+        }
+    }
+
     // allocateHandle()/deallocateHandle() selects the pool to use at compile-time based on the
     // allocation size this is always inlined, because all these do is to call
     // allocateHandleInPool()/deallocateHandleFromPool() with the right pool size.
@@ -291,14 +316,16 @@ private:
     }
 
     // allocateHandleInPool()/deallocateHandleFromPool() is NOT inlined, which will cause three
-    // versions to be generated, one for each pool. Because the arena is synchronized,
-    // the code generated is not trivial (even if it's not insane either).
+    // versions to be generated, one for each pool. The common case only touches this thread's
+    // cache, the arena lock is taken once per batch.
     template<size_t SIZE>
     UTILS_NOINLINE
     HandleBase::HandleId allocateHandleInPool() noexcept {
-        uint8_t age;
-        void* p = mHandleArena.alloc(SIZE, alignof(std::max_align_t), 0, &age);
+        void* p = getHandleCache<SIZE>().pop([this](void** items, size_t count) {
+            return refillHandleCache<SIZE>(items, count);
+        });
         if (UTILS_LIKELY(p)) {
+            uint8_t const age = Allocator::age(p);
             uint32_t const tag = (uint32_t(age) << HANDLE_AGE_SHIFT) & HANDLE_AGE_MASK;
             return arenaPointerToHandle(p, tag);
         } else {
@@ -312,7 +339,18 @@ private:
         if (UTILS_LIKELY(isPoolHandle(id))) {
             auto [p, tag] = handleToPointer(id);
             uint8_t const age = (tag & HANDLE_AGE_MASK) >> HANDLE_AGE_SHIFT;
-            mHandleArena.free(p, SIZE, age);
+
+            // check for double-free
+            uint8_t& expectedAge = Allocator::age(p);
+            if (UTILS_UNLIKELY(!mUseAfterFreeCheckDisabled)) {
+                FILAMENT_CHECK_POSTCONDITION(expectedAge == age) <<
+                        "double-free of Handle of size " << SIZE << " at " << p;
+            }
+            expectedAge = (expectedAge + 1) & 0xF; // fixme
+
+            getHandleCache<SIZE>().push(p, [this](void* const* items, size_t count) {
+                drainHandleCache<SIZE>(items, count);
+            });
         } else {
             deallocateHandleSlow(id, SIZE);
         }
@@ -359,6 +397,10 @@ private:
     }
 
     HandleArena mHandleArena;
+    utils::Mutex mArenaLock;
+    HandleCache mHandleCache0;
+    HandleCache mHandleCache1;
+    HandleCache mHandleCache2;
 
     // Below is only used when running out of space in the HandleArena
     mutable utils::Mutex mLock;
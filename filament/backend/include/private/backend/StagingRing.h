@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_BACKEND_PRIVATE_STAGINGRING_H
+#define TNT_FILAMENT_BACKEND_PRIVATE_STAGINGRING_H
+
+#include <utils/compiler.h>
+#include <utils/debug.h>
+
+#include <deque>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament::backend {
+
+/*
+ * Linear sub-allocator over a circular range of `capacity` bytes, typically a persistently mapped
+ * staging buffer. It only does the bookkeeping, the memory itself is owned by the caller.
+ *
+ * Each allocation is tagged with a monotonically increasing batch id (e.g. a frame or submission
+ * number). retire(batch) releases all allocations made up to and including that batch, once the
+ * GPU is done with them. Allocations are never split: when an allocation doesn't fit before the
+ * end of the range, the tail end is skipped and it starts over at offset 0.
+ */
+class StagingRing {
+public:
+    static constexpr uint32_t INVALID_OFFSET = UINT32_MAX;
+
+    explicit StagingRing(uint32_t capacity) noexcept : mCapacity(capacity) { }
+
+    uint32_t getCapacity() const noexcept { return mCapacity; }
+
+    // bytes in flight, including padding and skipped space
+    uint32_t getUsed() const noexcept { return mUsed; }
+
+    bool empty() const noexcept { return mUsed == 0; }
+
+    // Returns the offset of `size` bytes aligned to `alignment` (which doesn't need to be a
+    // power of two), or INVALID_OFFSET if there is not enough room until older batches retire.
+    // `batch` must be greater or equal to the batch of the previous allocation.
+    uint32_t allocate(uint32_t size, uint32_t alignment, uint64_t batch) noexcept {
+        assert_invariant(alignment > 0);
+        assert_invariant(mBatches.empty() || mBatches.back().batch <= batch);
+
+        if (mUsed == 0) {
+            // nothing in flight, start over at the beginning
+            mHead = mTail = 0;
+        } else if (mHead == mTail) {
+            return INVALID_OFFSET;
+        }
+
+        uint64_t offset = alignUp(mHead, alignment);
+        uint32_t skipped = 0;
+        if (mHead >= mTail) {
+            // free space is [head, capacity) and [0, tail)
+            if (offset + size > mCapacity) {
+                if (size > mTail) {
+                    return INVALID_OFFSET;
+                }
+                skipped = mCapacity - mHead;
+                offset = 0;
+            }
+        } else if (offset + size > mTail) {
+            // free space is [head, tail)
+            return INVALID_OFFSET;
+        }
+
+        uint32_t const end = uint32_t(offset + size);
+        uint32_t const bytes = skipped ? skipped + end : end - mHead;
+        mHead = end == mCapacity ? 0 : end;
+        mUsed += bytes;
+
+        if (mBatches.empty() || mBatches.back().batch != batch) {
+            mBatches.push_back({ batch, mHead, bytes });
+        } else {
+            mBatches.back().end = mHead;
+            mBatches.back().bytes += bytes;
+        }
+        return uint32_t(offset);
+    }
+
+    // Releases the allocations of all batches up to and including `batch`.
+    void retire(uint64_t batch) noexcept {
+        while (!mBatches.empty() && mBatches.front().batch <= batch) {
+            Batch const& front = mBatches.front();
+            mTail = front.end;
+            mUsed -= front.bytes;
+            mBatches.pop_front();
+        }
+        if (mUsed == 0) {
+            mHead = mTail = 0;
+        }
+    }
+
+private:
+    static uint64_t alignUp(uint64_t offset, uint32_t alignment) noexcept {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    struct Batch {
+        uint64_t batch;
+        uint32_t end;       // head after the last allocation of this batch
+        uint32_t bytes;     // bytes consumed by this batch
+    };
+
+    uint32_t const mCapacity;
+    uint32_t mHead = 0;     // next allocation
+    uint32_t mTail = 0;     // oldest allocation in flight
+    uint32_t mUsed = 0;
+    std::deque<Batch> mBatches;
+};
+
+} // namespace filament::backend
+
+#endif // TNT_FILAMENT_BACKEND_PRIVATE_STAGINGRING_H
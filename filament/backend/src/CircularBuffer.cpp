@@ -15,6 +15,7 @@
  */
 
 #include "private/backend/CircularBuffer.h"
+#include "private/backend/CommandStream.h"
 
 #include <utils/Log.h>
 #include <utils/Panic.h>
@@ -22,6 +23,7 @@
 #include <utils/ashmem.h>
 #include <utils/compiler.h>
 #include <utils/debug.h>
+#include <utils/Mutex.h>
 #include <utils/ostream.h>
 
 #if !defined(WIN32) && !defined(__EMSCRIPTEN__) && !defined(IOS)
@@ -32,6 +34,10 @@
 #    define HAS_MMAP 0
 #endif
 
+#include <algorithm>
+#include <mutex>
+#include <new>
+
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -44,17 +50,119 @@ namespace filament::backend {
 
 size_t CircularBuffer::sPageSize = arch::getPageSize();
 
+// overflow blocks are released after this many recordings that fit in the circular buffer
+static constexpr uint32_t OVERFLOW_POOL_TRIM_INTERVAL = 1024;
+
+static_assert(sizeof(NoopCommand) <= CircularBuffer::LINK_SIZE);
+
+struct alignas(std::max_align_t) CircularBuffer::Block {
+    Block* next;
+    size_t capacity;
+    char* data() noexcept { return reinterpret_cast<char*>(this + 1); }
+};
+
 CircularBuffer::CircularBuffer(size_t size)
-    : mSize(size) {
+    : mSize(size),
+      mBudget(size),
+      mBlockCapacity(std::max(getBlockSize(), size / 4)) {
+    assert_invariant(size > LINK_SIZE);
     mData = alloc(size);
     mTail = mData;
     mHead = mData;
+    mSegment = mData;
+    mLimit = static_cast<char*>(mData) + mBudget - LINK_SIZE;
 }
 
 CircularBuffer::~CircularBuffer() noexcept {
+    freeBlocks(mFirstBlock);
+    freeBlocks(mPool);
     dealloc();
 }
 
+void CircularBuffer::setBudget(size_t budget) noexcept {
+    assert_invariant(empty());
+    assert_invariant(budget >= LINK_SIZE && budget <= mSize);
+    mBudget = budget;
+    mLimit = static_cast<char*>(mTail) + budget - LINK_SIZE;
+}
+
+UTILS_NOINLINE
+void* CircularBuffer::allocateSlow(size_t s) noexcept {
+    Block* const block = acquireBlock(s + LINK_SIZE);
+    char* const data = block->data();
+
+    // the reserve at the end of the current segment always has room for the jump
+    char* const link = static_cast<char*>(mHead);
+    assert_invariant(link <= mLimit);
+    new(link) NoopCommand(data);
+
+    if (!mFirstBlock) {
+        mCircularHead = link + LINK_SIZE;
+        mFirstBlock = block;
+    } else {
+        mLastBlock->next = block;
+    }
+    mLastBlock = block;
+    mSpilled += (link + LINK_SIZE) - static_cast<char*>(mSegment);
+
+    mSegment = data;
+    mHead = data + s;
+    mLimit = data + block->capacity - LINK_SIZE;
+    return data;
+}
+
+CircularBuffer::Block* CircularBuffer::acquireBlock(size_t capacity) noexcept {
+    capacity = std::max(capacity, mBlockCapacity);
+    Block* stale = nullptr;
+    Block* block = nullptr;
+    {
+        std::lock_guard<utils::Mutex> const lock(mPoolLock);
+        while (mPool) {
+            Block* const b = mPool;
+            mPool = b->next;
+            if (b->capacity >= capacity) {
+                block = b;
+                break;
+            }
+            // smaller than what we need now, it won't be used again
+            b->next = stale;
+            stale = b;
+        }
+    }
+    freeBlocks(stale);
+
+    if (!block) {
+        void* const p = ::malloc(sizeof(Block) + capacity);
+        FILAMENT_CHECK_POSTCONDITION(p) <<
+                "couldn't allocate " << (capacity / 1024) <<
+                " KiB for the command buffer overflow";
+        block = new(p) Block{ nullptr, capacity };
+    }
+    block->next = nullptr;
+    return block;
+}
+
+void CircularBuffer::recycle(Block* blocks) noexcept {
+    if (!blocks) {
+        return;
+    }
+    Block* last = blocks;
+    while (last->next) {
+        last = last->next;
+    }
+    std::lock_guard<utils::Mutex> const lock(mPoolLock);
+    last->next = mPool;
+    mPool = blocks;
+}
+
+void CircularBuffer::freeBlocks(Block* blocks) noexcept {
+    while (blocks) {
+        Block* const next = blocks->next;
+        ::free(blocks);
+        blocks = next;
+    }
+}
+
 // If the system support mmap(), use it for creating a "hard circular buffer" where two virtual
 // address ranges are mapped to the same physical pages.
 //
@@ -158,7 +266,34 @@ void CircularBuffer::dealloc() noexcept {
 
 
 CircularBuffer::Range CircularBuffer::getBuffer() noexcept {
-    Range const range{ .tail = mTail, .head = mHead };
+    Range range{ .tail = mTail, .head = mHead, .overflow = nullptr };
+
+    if (UTILS_UNLIKELY(mFirstBlock)) {
+        // the recording continued in overflow blocks, the circular part ends with the jump
+        size_t const spilled = getUsed() - (intptr_t(mCircularHead) - intptr_t(mTail));
+        range.head = mCircularHead;
+        range.overflow = mFirstBlock;
+        mHead = mCircularHead;
+        mFirstBlock = nullptr;
+        mLastBlock = nullptr;
+
+        // size the next overflow block so that a recording of the same size fits in one block
+        size_t const blockSize = getBlockSize();
+        mBlockCapacity = std::max(mBlockCapacity,
+                (spilled + LINK_SIZE + blockSize - 1) & ~(blockSize - 1));
+        mOverflowHighWatermark = std::max(mOverflowHighWatermark, spilled);
+        mOverflowCount++;
+        mIdleRecordings = 0;
+    } else if (UTILS_UNLIKELY(++mIdleRecordings == OVERFLOW_POOL_TRIM_INTERVAL)) {
+        Block* pool;
+        {
+            std::lock_guard<utils::Mutex> const lock(mPoolLock);
+            pool = mPool;
+            mPool = nullptr;
+        }
+        freeBlocks(pool);
+        mIdleRecordings = 0;
+    }
 
     char* const pData = static_cast<char*>(mData);
     char const* const pEnd = pData + mSize;
@@ -186,6 +321,9 @@ CircularBuffer::Range CircularBuffer::getBuffer() noexcept {
         }
     }
     mTail = mHead;
+    mSegment = mHead;
+    mSpilled = 0;
+    mLimit = static_cast<char*>(mTail) + mBudget - LINK_SIZE;
 
     return range;
 }
@@ -78,6 +78,20 @@ bool CommandBufferQueue::isExitRequested() const {
 }
 
 
+CommandBufferQueue::Metrics CommandBufferQueue::getMetrics() const noexcept {
+    std::lock_guard<utils::Mutex> const lock(mLock);
+    return {
+            .capacity = mRequiredSize,
+            .bufferSize = mCircularBuffer.size(),
+            .used = mCircularBuffer.size() - mFreeSpace,
+            .highWatermark = mHighWatermark,
+            .overflowHighWatermark = mCircularBuffer.getOverflowHighWatermark(),
+            .pendingBuffers = uint32_t(mCommandBuffersToExecute.size()),
+            .overflowCount = mCircularBuffer.getOverflowCount(),
+            .stallCount = mStallCount,
+    };
+}
+
 void CommandBufferQueue::flush() noexcept {
     SYSTRACE_CALL();
 
@@ -88,12 +102,12 @@ void CommandBufferQueue::flush() noexcept {
 
     // add the terminating command
     // always guaranteed to have enough space for the NoopCommand
-    new(circularBuffer.allocate(sizeof(NoopCommand))) NoopCommand(nullptr);
+    new(circularBuffer.allocateLink()) NoopCommand(nullptr);
 
     const size_t requiredSize = mRequiredSize;
 
-    // get the current buffer
-    auto const [begin, end] = circularBuffer.getBuffer();
+    // get the current buffer, commands that didn't fit in the circular buffer are in `overflow`
+    auto const [begin, end, overflow] = circularBuffer.getBuffer();
 
     assert_invariant(circularBuffer.empty());
 
@@ -104,42 +118,46 @@ void CommandBufferQueue::flush() noexcept {
 
     std::unique_lock<utils::Mutex> lock(mLock);
 
-    // circular buffer is too small, we corrupted the stream
-    FILAMENT_CHECK_POSTCONDITION(used <= mFreeSpace) <<
-            "Backend CommandStream overflow. Commands are corrupted and unrecoverable.\n"
-            "Please increase minCommandBufferSizeMB inside the Config passed to Engine::create.\n"
-            "Space used at this time: " << used <<
-            " bytes, overflow: " << used - mFreeSpace << " bytes";
+    // the budget given to the circular buffer guarantees this
+    assert_invariant(used <= mFreeSpace);
 
     mFreeSpace -= used;
-    mCommandBuffersToExecute.push_back({ begin, end });
+    mCommandBuffersToExecute.push_back({ begin, end, overflow });
     mCondition.notify_one();
 
+    size_t const totalUsed = circularBuffer.size() - mFreeSpace;
+    mHighWatermark = std::max(mHighWatermark, totalUsed);
+
     // wait until there is enough space in the buffer
     if (UTILS_UNLIKELY(mFreeSpace < requiredSize)) {
 
 #ifndef NDEBUG
-        size_t const totalUsed = circularBuffer.size() - mFreeSpace;
         slog.d << "CommandStream used too much space (will block): "
                 << "needed space " << requiredSize << " out of " << mFreeSpace
                 << ", totalUsed=" << totalUsed << ", current=" << used
                 << ", queue size=" << mCommandBuffersToExecute.size() << " buffers"
                 << io::endl;
-
-        mHighWatermark = std::max(mHighWatermark, totalUsed);
 #endif
 
-        SYSTRACE_NAME("waiting: CircularBuffer::flush()");
-
-        FILAMENT_CHECK_POSTCONDITION(!mPaused) <<
-                "CommandStream is full, but since the rendering thread is paused, "
-                "the buffer cannot flush and we will deadlock. Instead, abort.";
-
-        mCondition.wait(lock, [this, requiredSize]() -> bool {
-            // TODO: on macOS, we need to call pumpEvents from time to time
-            return mFreeSpace >= requiredSize;
-        });
+        if (UTILS_UNLIKELY(mPaused)) {
+            // The rendering thread can't free any space, waiting would deadlock. Keep going with
+            // what's left, the next commands will be recorded in overflow blocks.
+            FILAMENT_CHECK_POSTCONDITION(mFreeSpace >= CircularBuffer::LINK_SIZE) <<
+                    "CommandStream is full, but since the rendering thread is paused, "
+                    "the buffer cannot flush and we will deadlock. Instead, abort.";
+        } else {
+            SYSTRACE_NAME("waiting: CircularBuffer::flush()");
+            mStallCount++;
+            mCondition.wait(lock, [this, requiredSize]() -> bool {
+                // TODO: on macOS, we need to call pumpEvents from time to time
+                return mFreeSpace >= requiredSize;
+            });
+        }
     }
+
+    // free space can only grow from here, so this much can be recorded without overwriting
+    // commands still in flight
+    circularBuffer.setBudget(mFreeSpace);
 }
 
 std::vector<CommandBufferQueue::Range> CommandBufferQueue::waitForCommands() const {
@@ -156,6 +174,7 @@ std::vector<CommandBufferQueue::Range> CommandBufferQueue::waitForCommands() con
 void CommandBufferQueue::releaseBuffer(CommandBufferQueue::Range const& buffer) {
     size_t const used = std::distance(
             static_cast<char const*>(buffer.begin), static_cast<char const*>(buffer.end));
+    mCircularBuffer.recycle(buffer.overflow);
     std::lock_guard<utils::Mutex> const lock(mLock);
     mFreeSpace += used;
     mCondition.notify_one();
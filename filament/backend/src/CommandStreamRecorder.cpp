@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "private/backend/CommandStreamRecorder.h"
+
+#include <utils/Log.h>
+#include <utils/ostream.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace utils;
+
+namespace filament::backend {
+
+const char* getCapturedCommandName(CapturedCommand command) noexcept {
+    switch (command) {
+#define DECL_DRIVER_API(methodName, paramsDecl, params) \
+        case CapturedCommand::methodName: return #methodName;
+#define DECL_DRIVER_API_RETURN(RetType, methodName, paramsDecl, params) \
+        case CapturedCommand::methodName: return #methodName;
+#define DECL_DRIVER_API_SYNCHRONOUS(RetType, methodName, paramsDecl, params)
+#include "private/backend/DriverAPI.inc"
+        case CapturedCommand::COUNT:
+            break;
+    }
+    return "unknown";
+}
+
+CommandStreamRecorder::CommandStreamRecorder(const char* path, Backend backend,
+        uint32_t frameCount) noexcept
+        : mPath(path), mBackend(backend), mFrameCount(frameCount) {
+    mFile = fopen(path, "wb");
+    if (!mFile) {
+        slog.e << "Cannot open " << path << " for the command stream capture" << io::endl;
+        return;
+    }
+    mData.reserve(1024 * 1024);
+    // the frame count is patched when the capture is complete
+    Header const header{ MAGIC, VERSION, uint32_t(backend), 0 };
+    writeBytes(&header, sizeof(header));
+}
+
+CommandStreamRecorder::~CommandStreamRecorder() noexcept {
+    finish();
+}
+
+void CommandStreamRecorder::finish() noexcept {
+    if (!mFile) {
+        return;
+    }
+    Header const header{ MAGIC, VERSION, uint32_t(mBackend), mFramesRecorded };
+    bool success = fwrite(mData.data(), 1, mData.size(), mFile) == mData.size();
+    success = success && fseek(mFile, 0, SEEK_SET) == 0;
+    success = success && fwrite(&header, sizeof(header), 1, mFile) == 1;
+    success = (fclose(mFile) == 0) && success;
+    mFile = nullptr;
+    mData = {};
+    if (success) {
+        slog.i << "Captured " << mFramesRecorded << " frames to " << mPath.c_str() << io::endl;
+    } else {
+        slog.e << "Error writing the command stream capture " << mPath.c_str() << io::endl;
+    }
+}
+
+size_t CommandStreamRecorder::beginRecord(CapturedCommand command) {
+    size_t const start = mData.size();
+    RecordHeader const header{ command, 0, 0 };
+    writeBytes(&header, sizeof(header));
+    return start;
+}
+
+void CommandStreamRecorder::endRecord(size_t start, CapturedCommand command) {
+    mData.resize((mData.size() + 7u) & ~size_t(7u));
+    uint32_t const size = uint32_t(mData.size() - start - sizeof(RecordHeader));
+    memcpy(mData.data() + start + offsetof(RecordHeader, size), &size, sizeof(size));
+
+    if (command == CapturedCommand::endFrame) {
+        mFramesRecorded++;
+        if (mFramesRecorded == mFrameCount) {
+            finish();
+        } else if (fwrite(mData.data(), 1, mData.size(), mFile) == mData.size()) {
+            mData.clear();
+        } else {
+            slog.e << "Error writing the command stream capture " << mPath.c_str() << io::endl;
+            fclose(mFile);
+            mFile = nullptr;
+        }
+    }
+}
+
+void CommandStreamRecorder::writeBytes(void const* data, size_t size) {
+    if (!size) {
+        return;
+    }
+    size_t const offset = mData.size();
+    mData.resize(offset + size);
+    memcpy(mData.data() + offset, data, size);
+}
+
+void CommandStreamRecorder::writeBlob(void const* data, size_t size) {
+    // payloads are aligned, so they can be used without a copy when replayed
+    mData.resize((mData.size() + 7u) & ~size_t(7u));
+    uint64_t const size64 = data ? size : 0;
+    writeBytes(&size64, sizeof(size64));
+    writeBytes(data, size64);
+    mData.resize((mData.size() + 7u) & ~size_t(7u));
+}
+
+void CommandStreamRecorder::writeString(const char* string, size_t length) {
+    uint32_t const length32 = uint32_t(length);
+    writeBytes(&length32, sizeof(length32));
+    writeBytes(string, length);
+    mData.push_back(0);
+}
+
+void CommandStreamRecorder::write(BufferDescriptor const& data) {
+    writeBlob(data.buffer, data.size);
+}
+
+void CommandStreamRecorder::write(PixelBufferDescriptor const& data) {
+    writeBlob(data.buffer, data.size);
+    write(data.left);
+    write(data.top);
+    write(PixelDataType(data.type));
+    write(uint8_t(data.alignment));
+    if (data.type == PixelDataType::COMPRESSED) {
+        write(data.imageSize);
+        write(data.compressedFormat);
+    } else {
+        write(data.stride);
+        write(data.format);
+    }
+}
+
+void CommandStreamRecorder::write(CString const& string) {
+    writeString(string.c_str_safe(), string.size());
+}
+
+void CommandStreamRecorder::write(Program const& program) {
+    write(program.getPriorityQueue());
+    write(program.isMultiview());
+    write(program.getCacheId());
+    write(program.getShaderLanguage());
+    write(program.getName());
+
+    for (auto const& blob : program.getShadersSource()) {
+        writeBlob(blob.data(), blob.size());
+    }
+
+    for (auto const& name : program.getUniformBlockBindings()) {
+        write(name);
+    }
+
+    for (auto const& group : program.getSamplerGroupInfo()) {
+        write(group.stageFlags);
+        write(uint32_t(group.samplers.size()));
+        for (auto const& sampler : group.samplers) {
+            write(sampler.name);
+            write(sampler.binding);
+        }
+    }
+
+    for (auto const& uniforms : program.getBindingUniformInfo()) {
+        write(uint32_t(uniforms.size()));
+        for (auto const& uniform : uniforms) {
+            write(uniform.name);
+            write(uniform.offset);
+            write(uniform.size);
+            write(uniform.type);
+        }
+    }
+
+    write(uint32_t(program.getAttributes().size()));
+    for (auto const& [name, location] : program.getAttributes()) {
+        write(name);
+        write(location);
+    }
+
+    write(uint32_t(program.getSpecializationConstants().size()));
+    for (auto const& constant : program.getSpecializationConstants()) {
+        write(constant.id);
+        write(constant.value);
+    }
+
+    for (size_t i = 0; i < Program::SHADER_TYPE_COUNT; i++) {
+        auto const& constants = program.getPushConstants(ShaderStage(i));
+        write(uint32_t(constants.size()));
+        for (auto const& constant : constants) {
+            write(constant.name);
+            write(constant.type);
+        }
+    }
+}
+
+} // namespace filament::backend
@@ -0,0 +1,441 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "private/backend/CommandStreamReplay.h"
+
+#include "private/backend/Driver.h"
+
+#include <backend/SamplerDescriptor.h>
+
+#include <utils/Log.h>
+#include <utils/ostream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace utils;
+
+namespace filament::backend {
+
+// commands are executed at least once per frame, the circular buffer spills in overflow
+// blocks if a frame doesn't fit
+static constexpr size_t REPLAY_BUFFER_SIZE = 4u * 1024u * 1024u;
+
+using Header = CommandStreamRecorder::Header;
+using RecordHeader = CommandStreamRecorder::RecordHeader;
+
+// Reads the parameters of a command in the format written by CommandStreamRecorder. Buffers and
+// strings point directly into the loaded capture.
+class CommandStreamReplay::Reader {
+public:
+    Reader(uint8_t const* data, size_t size) noexcept
+            : mNext(data), mEnd(data + size) {
+    }
+
+    bool hasError() const noexcept { return mError; }
+
+    bool next(CapturedCommand* command) noexcept {
+        if (mNext == mEnd || mError) {
+            return false;
+        }
+        RecordHeader header{};
+        if (size_t(mEnd - mNext) < sizeof(header)) {
+            mError = true;
+            return false;
+        }
+        memcpy(&header, mNext, sizeof(header));
+        mCurrent = mNext + sizeof(header);
+        if (size_t(header.command) >= size_t(CapturedCommand::COUNT) ||
+                size_t(mEnd - mCurrent) < header.size) {
+            mError = true;
+            return false;
+        }
+        mRecordEnd = mCurrent + header.size;
+        mNext = mRecordEnd;
+        *command = header.command;
+        return true;
+    }
+
+    template<typename T>
+    T read() noexcept {
+        if constexpr (std::is_same_v<T, BufferDescriptor>) {
+            auto const [data, size] = readBlob();
+            return BufferDescriptor(data, size);
+        } else if constexpr (std::is_same_v<T, PixelBufferDescriptor>) {
+            return readPixelBuffer();
+        } else if constexpr (std::is_same_v<T, Program>) {
+            return readProgram();
+        } else if constexpr (std::is_same_v<T, CString>) {
+            uint32_t length = 0;
+            const char* const string = readString(&length);
+            return CString(string, length);
+        } else if constexpr (std::is_same_v<T, const char*>) {
+            uint32_t length = 0;
+            return readString(&length);
+        } else if constexpr (std::is_pointer_v<T> ||
+                std::is_same_v<T, FrameScheduledCallback> ||
+                std::is_same_v<T, utils::Invocable<void(void)>>) {
+            return T{};
+        } else {
+            T value{};
+            readBytes(&value, sizeof(T));
+            return value;
+        }
+    }
+
+private:
+    void readBytes(void* out, size_t size) noexcept {
+        if (UTILS_UNLIKELY(size_t(mRecordEnd - mCurrent) < size)) {
+            mError = true;
+            mCurrent = mRecordEnd;
+            return;
+        }
+        memcpy(out, mCurrent, size);
+        mCurrent += size;
+    }
+
+    void align() noexcept {
+        uintptr_t const p = (uintptr_t(mCurrent) + 7u) & ~uintptr_t(7u);
+        mCurrent = std::min(mRecordEnd, (uint8_t const*)p);
+    }
+
+    std::pair<void const*, size_t> readBlob() noexcept {
+        align();
+        uint64_t const size = read<uint64_t>();
+        if (UTILS_UNLIKELY(size_t(mRecordEnd - mCurrent) < size)) {
+            mError = true;
+            mCurrent = mRecordEnd;
+            return { nullptr, 0 };
+        }
+        void const* const data = size ? mCurrent : nullptr;
+        mCurrent += size;
+        align();
+        return { data, size };
+    }
+
+    const char* readString(uint32_t* length) noexcept {
+        *length = read<uint32_t>();
+        if (UTILS_UNLIKELY(size_t(mRecordEnd - mCurrent) <= *length)) {
+            mError = true;
+            mCurrent = mRecordEnd;
+            *length = 0;
+            return "";
+        }
+        const char* const string = (const char*)mCurrent;
+        mCurrent += *length + 1;
+        return string;
+    }
+
+    PixelBufferDescriptor readPixelBuffer() noexcept {
+        auto const [data, size] = readBlob();
+        uint32_t const left = read<uint32_t>();
+        uint32_t const top = read<uint32_t>();
+        PixelDataType const type = read<PixelDataType>();
+        uint8_t const alignment = read<uint8_t>();
+        if (type == PixelDataType::COMPRESSED) {
+            uint32_t const imageSize = read<uint32_t>();
+            auto const format = read<CompressedPixelDataType>();
+            return { data, size, format, imageSize, nullptr };
+        }
+        uint32_t const stride = read<uint32_t>();
+        auto const format = read<PixelDataFormat>();
+        return { data, size, format, type, alignment, left, top, stride };
+    }
+
+    Program readProgram() noexcept {
+        Program program;
+        program.priorityQueue(read<CompilerPriorityQueue>());
+        program.multiview(read<bool>());
+        program.cacheId(read<uint64_t>());
+        program.shaderLanguage(read<ShaderLanguage>());
+        program.getName() = read<CString>();
+
+        for (auto& blob : program.getShadersSource()) {
+            auto const [data, size] = readBlob();
+            blob = Program::ShaderBlob(size);
+            if (size) {
+                memcpy(blob.data(), data, size);
+            }
+        }
+
+        for (auto& name : program.getUniformBlockBindings()) {
+            name = read<CString>();
+        }
+
+        for (auto& group : program.getSamplerGroupInfo()) {
+            group.stageFlags = read<ShaderStageFlags>();
+            group.samplers = FixedCapacityVector<Program::Sampler>(readCount());
+            for (auto& sampler : group.samplers) {
+                sampler.name = read<CString>();
+                sampler.binding = read<uint32_t>();
+            }
+        }
+
+        for (auto& uniforms : program.getBindingUniformInfo()) {
+            uniforms = Program::UniformInfo(readCount());
+            for (auto& uniform : uniforms) {
+                uniform.name = read<CString>();
+                uniform.offset = read<uint16_t>();
+                uniform.size = read<uint8_t>();
+                uniform.type = read<UniformType>();
+            }
+        }
+
+        auto& attributes = program.getAttributes();
+        attributes = std::remove_reference_t<decltype(attributes)>(readCount());
+        for (auto& [name, location] : attributes) {
+            name = read<CString>();
+            location = read<uint8_t>();
+        }
+
+        auto& constants = program.getSpecializationConstants();
+        constants = FixedCapacityVector<Program::SpecializationConstant>(readCount());
+        for (auto& constant : constants) {
+            constant.id = read<uint32_t>();
+            constant.value = read<Program::SpecializationConstant::Type>();
+        }
+
+        for (size_t i = 0; i < Program::SHADER_TYPE_COUNT; i++) {
+            auto& pushConstants = program.getPushConstants(ShaderStage(i));
+            pushConstants = FixedCapacityVector<Program::PushConstant>(readCount());
+            for (auto& constant : pushConstants) {
+                constant.name = read<CString>();
+                constant.type = read<ConstantType>();
+            }
+        }
+        return program;
+    }
+
+    uint32_t readCount() noexcept {
+        // a corrupted count can't be larger than what's left in the record
+        uint32_t const count = read<uint32_t>();
+        if (UTILS_UNLIKELY(count > size_t(mRecordEnd - mCurrent))) {
+            mError = true;
+            mCurrent = mRecordEnd;
+            return 0;
+        }
+        return count;
+    }
+
+    uint8_t const* mNext;
+    uint8_t const* mEnd;
+    uint8_t const* mCurrent = nullptr;
+    uint8_t const* mRecordEnd = nullptr;
+    bool mError = false;
+};
+
+CommandStreamReplay::CommandStreamReplay(Driver& driver)
+        : mDriver(driver),
+          mBuffer(REPLAY_BUFFER_SIZE),
+          mStream(driver, mBuffer) {
+}
+
+CommandStreamReplay::~CommandStreamReplay() noexcept = default;
+
+bool CommandStreamReplay::load(const char* path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        slog.e << "Cannot open " << path << io::endl;
+        return false;
+    }
+    std::vector<uint8_t> data(size_t(in.tellg()));
+    in.seekg(0);
+    Header header{};
+    if (data.size() < sizeof(header) ||
+            !in.read((char*)data.data(), (std::streamsize)data.size())) {
+        slog.e << "Cannot read " << path << io::endl;
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != CommandStreamRecorder::MAGIC ||
+            header.version != CommandStreamRecorder::VERSION) {
+        slog.e << path << " is not a command stream capture, or has an unsupported version"
+               << io::endl;
+        return false;
+    }
+    mData = std::move(data);
+    mCapturedBackend = Backend(header.backend);
+    mFrameCount = header.frameCount;
+    return true;
+}
+
+CommandStreamReplay::Stats CommandStreamReplay::replay(bool perCommand) {
+    using clock = std::chrono::steady_clock;
+    auto elapsed = [](clock::time_point start, clock::time_point end) {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    };
+
+    Stats stats;
+    if (mData.empty()) {
+        return stats;
+    }
+    stats.frameNs.reserve(mFrameCount);
+
+    mHandles.clear();
+
+    Reader reader(mData.data() + sizeof(Header), mData.size() - sizeof(Header));
+    CapturedCommand command{};
+    clock::time_point const start = clock::now();
+    clock::time_point frameStart = start;
+    while (reader.next(&command)) {
+        CommandStats& commandStats = stats.commands[size_t(command)];
+        commandStats.count++;
+        if (perCommand) {
+            clock::time_point const t = clock::now();
+            dispatch(command, reader);
+            execute();
+            uint64_t const ns = elapsed(t, clock::now());
+            commandStats.totalNs += ns;
+            commandStats.maxNs = std::max(commandStats.maxNs, ns);
+        } else {
+            dispatch(command, reader);
+        }
+        if (command == CapturedCommand::endFrame) {
+            execute();
+            mDriver.purge();
+            clock::time_point const now = clock::now();
+            stats.frameNs.push_back(elapsed(frameStart, now));
+            frameStart = now;
+        }
+    }
+    execute();
+    mDriver.purge();
+    stats.totalNs = elapsed(start, clock::now());
+
+    if (reader.hasError()) {
+        slog.w << "The command stream capture is truncated or corrupted" << io::endl;
+    }
+    return stats;
+}
+
+void CommandStreamReplay::execute() {
+    if (mBuffer.empty()) {
+        return;
+    }
+    new(mBuffer.allocateLink()) NoopCommand(nullptr);
+    auto const [begin, end, overflow] = mBuffer.getBuffer();
+    mStream.execute(begin);
+    mBuffer.recycle(overflow);
+}
+
+template<typename ... ARGS>
+void CommandStreamReplay::replayCommand(Reader& reader, void (CommandStream::*method)(ARGS...)) {
+    // braced initializers are evaluated in order, which is the order they were written in
+    std::tuple<std::decay_t<ARGS>...> args{ reader.read<std::decay_t<ARGS>>()... };
+    std::apply([this, method](auto& ... arg) {
+        (remap(arg), ...);
+        (mStream.*method)(std::move(arg)...);
+    }, args);
+}
+
+template<typename R, typename ... ARGS>
+void CommandStreamReplay::replayCreate(Reader& reader, R (CommandStream::*method)(ARGS...)) {
+    R const recorded = reader.read<R>();
+    std::tuple<std::decay_t<ARGS>...> args{ reader.read<std::decay_t<ARGS>>()... };
+    R const result = std::apply([this, method](auto& ... arg) {
+        (remap(arg), ...);
+        return (mStream.*method)(std::move(arg)...);
+    }, args);
+    if (recorded) {
+        mHandles[recorded.getId()] = result.getId();
+    }
+}
+
+template<typename T>
+void CommandStreamReplay::remap(Handle<T>& handle) noexcept {
+    if (handle) {
+        auto const pos = mHandles.find(handle.getId());
+        // handles created by synchronous calls, e.g. streams, are not captured
+        handle = pos != mHandles.end() ? Handle<T>(pos->second) : Handle<T>{};
+    }
+}
+
+void CommandStreamReplay::remap(PipelineState& state) noexcept {
+    remap(state.program);
+    remap(state.vertexBufferInfo);
+}
+
+void CommandStreamReplay::remap(TargetBufferInfo& info) noexcept {
+    remap(info.handle);
+}
+
+void CommandStreamReplay::remap(MRT& mrt) noexcept {
+    for (size_t i = 0; i < MRT::MAX_SUPPORTED_RENDER_TARGET_COUNT; i++) {
+        remap(mrt[i]);
+    }
+}
+
+void CommandStreamReplay::dispatch(CapturedCommand command, Reader& reader) {
+    if (command == CapturedCommand::createSwapChain) {
+        // the captured native window doesn't exist in this process
+        auto const recorded = reader.read<SwapChainHandle>();
+        uint64_t const flags = reader.read<uint64_t>();
+        SwapChainHandle const sch =
+                mStream.createSwapChainHeadless(mSwapChainWidth, mSwapChainHeight, flags);
+        if (recorded) {
+            mHandles[recorded.getId()] = sch.getId();
+        }
+        return;
+    }
+
+    if (command == CapturedCommand::updateSamplerGroup) {
+        // the samplers reference textures, which need to be remapped as well
+        auto sbh = reader.read<SamplerGroupHandle>();
+        auto const data = reader.read<BufferDescriptor>();
+        size_t const count = data.size / sizeof(SamplerDescriptor);
+        auto* const samplers = (SamplerDescriptor*)malloc(count * sizeof(SamplerDescriptor));
+        for (size_t i = 0; i < count; i++) {
+            SamplerDescriptor* const sampler = new(samplers + i) SamplerDescriptor(
+                    static_cast<SamplerDescriptor const*>(data.buffer)[i]);
+            remap(sampler->t);
+        }
+        remap(sbh);
+        mStream.updateSamplerGroup(sbh, { samplers, count * sizeof(SamplerDescriptor),
+                +[](void* buffer, size_t, void*) { free(buffer); }});
+        return;
+    }
+
+    if (command == CapturedCommand::setFrameScheduledCallback ||
+            command == CapturedCommand::setFrameCompletedCallback) {
+        // these only register callbacks, which are not captured
+        return;
+    }
+
+    switch (command) {
+#define DECL_DRIVER_API(methodName, paramsDecl, params)                                         \
+        case CapturedCommand::methodName:                                                       \
+            replayCommand(reader, &CommandStream::methodName);                                  \
+            break;
+#define DECL_DRIVER_API_RETURN(RetType, methodName, paramsDecl, params)                         \
+        case CapturedCommand::methodName:                                                       \
+            replayCreate(reader, &CommandStream::methodName);                                   \
+            break;
+#define DECL_DRIVER_API_SYNCHRONOUS(RetType, methodName, paramsDecl, params)
+#include "private/backend/DriverAPI.inc"
+        case CapturedCommand::COUNT:
+            break;
+    }
+}
+
+} // namespace filament::backend
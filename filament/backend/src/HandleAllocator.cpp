@@ -40,9 +40,8 @@ using namespace utils;
 template <size_t P0, size_t P1, size_t P2>
 UTILS_NOINLINE
 HandleAllocator<P0, P1, P2>::Allocator::Allocator(AreaPolicy::HeapArea const& area,
-        bool disableUseAfterFreeCheck)
-        : mArea(area),
-          mUseAfterFreeCheckDisabled(disableUseAfterFreeCheck) {
+        bool)
+        : mArea(area) {
 
     // The largest handle this allocator can generate currently depends on the architecture's
     // min alignment, typically 8 or 16 bytes.
@@ -108,6 +108,8 @@ constexpr inline GLenum getBufferUsage(BufferUsage usage) noexcept {
     switch (usage) {
         case BufferUsage::STATIC:
             return GL_STATIC_DRAW;
+        case BufferUsage::STREAM:
+            return GL_STREAM_DRAW;
         default:
             return GL_DYNAMIC_DRAW;
     }
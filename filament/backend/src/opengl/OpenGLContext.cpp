@@ -671,6 +671,7 @@ void OpenGLContext::initExtensionsGLES(Extensions* ext, GLint major, GLint minor
     using namespace std::literals;
     ext->APPLE_color_buffer_packed_float = exts.has("GL_APPLE_color_buffer_packed_float"sv);
 #ifndef __EMSCRIPTEN__
+    ext->EXT_buffer_storage = exts.has("GL_EXT_buffer_storage"sv);
     ext->EXT_clip_control = exts.has("GL_EXT_clip_control"sv);
 #endif
     ext->EXT_clip_cull_distance = exts.has("GL_EXT_clip_cull_distance"sv);
@@ -745,6 +746,7 @@ void OpenGLContext::initExtensionsGL(Extensions* ext, GLint major, GLint minor)
     using namespace std::literals;
     ext->APPLE_color_buffer_packed_float = true;  // Assumes core profile.
     ext->ARB_shading_language_packing = exts.has("GL_ARB_shading_language_packing"sv);
+    ext->EXT_buffer_storage = exts.has("GL_ARB_buffer_storage"sv);
     ext->EXT_color_buffer_float = true;  // Assumes core profile.
     ext->EXT_color_buffer_half_float = true;  // Assumes core profile.
     ext->EXT_clip_cull_distance = true;
@@ -787,6 +789,10 @@ void OpenGLContext::initExtensionsGL(Extensions* ext, GLint major, GLint minor)
         ext->EXT_discard_framebuffer = true;
         ext->KHR_debug = true;
     }
+    // OpenGL 4.4 implies ARB_buffer_storage
+    if (major > 4 || (major == 4 && minor >= 4)) {
+        ext->EXT_buffer_storage = true;
+    }
     // OpenGL 4.5 implies EXT_clip_control
     if (major > 4 || (major == 4 && minor >= 5)) {
         ext->EXT_clip_control = true;
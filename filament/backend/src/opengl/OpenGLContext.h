@@ -215,6 +215,7 @@ public:
     struct Extensions {
         bool APPLE_color_buffer_packed_float;
         bool ARB_shading_language_packing;
+        bool EXT_buffer_storage;
         bool EXT_clip_control;
         bool EXT_clip_cull_distance;
         bool EXT_color_buffer_float;
@@ -243,6 +243,7 @@ OpenGLDriver::OpenGLDriver(OpenGLPlatform* platform, const Platform::DriverConfi
         : mPlatform(*platform),
           mContext(mPlatform, driverConfig),
           mShaderCompilerService(*this),
+          mStreamingBuffer(mContext),
           mHandleAllocator("Handles",
                   driverConfig.handleArenaSize,
                   driverConfig.disableHandleUseAfterFreeCheck),
@@ -312,6 +313,9 @@ void OpenGLDriver::terminate() {
     assert_invariant(mGpuCommandCompleteOps.empty());
 #endif
 
+    // the GPU is idle, so all streaming regions can go
+    mStreamingBuffer.terminate();
+
     delete mCurrentPushConstants;
     mCurrentPushConstants = nullptr;
 
@@ -590,7 +594,7 @@ void OpenGLDriver::createIndexBufferR(
 
     auto& gl = mContext;
     uint8_t const elementSize = static_cast<uint8_t>(getElementTypeSize(elementType));
-    GLIndexBuffer* ib = construct<GLIndexBuffer>(ibh, elementSize, indexCount);
+    GLIndexBuffer* ib = construct<GLIndexBuffer>(ibh, elementSize, indexCount, usage);
     glGenBuffers(1, &ib->gl.buffer);
     GLsizeiptr const size = elementSize * indexCount;
     gl.bindVertexArray(nullptr);
@@ -2241,6 +2245,13 @@ void OpenGLDriver::updateIndexBuffer(
     GLIndexBuffer* ib = handle_cast<GLIndexBuffer *>(ibh);
     assert_invariant(ib->elementSize == 2 || ib->elementSize == 4);
 
+#ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
+    if (ib->usage != BufferUsage::STATIC && updateBufferStreaming(ib->gl.buffer, p, byteOffset)) {
+        scheduleDestroy(std::move(p));
+        return;
+    }
+#endif
+
     gl.bindVertexArray(nullptr);
     gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib->gl.buffer);
     glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, byteOffset, (GLsizeiptr)p.size, p.buffer);
@@ -2267,6 +2278,11 @@ void OpenGLDriver::updateBufferObject(
         assert_invariant(bo->gl.buffer);
         memcpy(static_cast<uint8_t*>(bo->gl.buffer) + byteOffset, bd.buffer, bd.size);
         bo->age++;
+#ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
+    } else if (bo->usage != BufferUsage::STATIC &&
+            updateBufferStreaming(bo->gl.id, bd, byteOffset)) {
+        // the update was copied into the persistently mapped streaming buffer
+#endif
     } else {
         assert_invariant(bo->gl.id);
         gl.bindBuffer(bo->gl.binding, bo->gl.id);
@@ -3444,6 +3460,30 @@ void OpenGLDriver::whenGpuCommandsComplete(const std::function<void()>& fn) noex
     CHECK_GL_ERROR(utils::slog.e)
 }
 
+bool OpenGLDriver::updateBufferStreaming(GLuint buffer, BufferDescriptor const& bd,
+        uint32_t byteOffset) noexcept {
+    auto& sb = mStreamingBuffer;
+    if (!sb.accepts(bd.size)) {
+        return false;
+    }
+    if (UTILS_LIKELY(sb.upload(buffer, byteOffset, bd.buffer, bd.size))) {
+        return true;
+    }
+    // the ring is full, fence what we have so far and recycle whatever the GPU is done with
+    fenceStreamingBuffer();
+    executeGpuCommandsCompleteOps();
+    return sb.upload(buffer, byteOffset, bd.buffer, bd.size);
+}
+
+void OpenGLDriver::fenceStreamingBuffer() noexcept {
+    if (mStreamingBuffer.hasPendingBatch()) {
+        uint64_t const batch = mStreamingBuffer.closeBatch();
+        whenGpuCommandsComplete([this, batch]() {
+            mStreamingBuffer.retire(batch);
+        });
+    }
+}
+
 void OpenGLDriver::executeGpuCommandsCompleteOps() noexcept {
     auto& v = mGpuCommandCompleteOps;
     auto it = v.begin();
@@ -3541,6 +3581,9 @@ void OpenGLDriver::endFrame(UTILS_UNUSED uint32_t frameId) {
 #endif
     //SYSTRACE_NAME("glFinish");
     //glFinish();
+#ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
+    fenceStreamingBuffer();
+#endif
     mPlatform.endFrame(frameId);
     insertEventMarker("endFrame");
 }
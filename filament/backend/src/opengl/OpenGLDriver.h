@@ -19,6 +19,7 @@
 
 #include "DriverBase.h"
 #include "OpenGLContext.h"
+#include "OpenGLStreamingBuffer.h"
 #include "OpenGLTimerQuery.h"
 #include "GLBufferObject.h"
 #include "GLTexture.h"
@@ -118,9 +119,13 @@ public:
 
     struct GLIndexBuffer : public HwIndexBuffer {
         using HwIndexBuffer::HwIndexBuffer;
+        GLIndexBuffer(uint8_t elementSize, uint32_t indexCount, BufferUsage usage) noexcept
+                : HwIndexBuffer(elementSize, indexCount), usage(usage) {
+        }
         struct {
             GLuint buffer{};
         } gl;
+        BufferUsage usage = BufferUsage::STATIC;
     };
 
     struct GLSamplerGroup : public HwSamplerGroup {
@@ -196,6 +201,7 @@ private:
     OpenGLPlatform& mPlatform;
     OpenGLContext mContext;
     ShaderCompilerService mShaderCompilerService;
+    OpenGLStreamingBuffer mStreamingBuffer;
 
     friend class TimerQueryFactory;
     friend class TimerQueryNativeFactory;
@@ -369,6 +375,13 @@ private:
 
     void whenFrameComplete(const std::function<void()>& fn) noexcept;
     std::vector<std::function<void()>> mFrameCompleteOps;
+
+    // uploads DYNAMIC and STREAM buffer updates through mStreamingBuffer, returns false if the
+    // regular path must be used instead.
+    bool updateBufferStreaming(GLuint buffer, BufferDescriptor const& bd,
+            uint32_t byteOffset) noexcept;
+    // fences the uploads made since the last call, so their regions can be recycled.
+    void fenceStreamingBuffer() noexcept;
 #endif
 
     // tasks regularly executed on the main thread at until they return true
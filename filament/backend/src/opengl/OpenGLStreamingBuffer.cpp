@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OpenGLStreamingBuffer.h"
+
+#include "GLUtils.h"
+#include "OpenGLContext.h"
+
+#include <utils/Log.h>
+#include <utils/compiler.h>
+#include <utils/debug.h>
+
+#include <string.h>
+
+// glBufferStorage is core in GL 4.4 and an extension on GLES 3.1
+#if !defined(FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2) && \
+        (defined(BACKEND_OPENGL_VERSION_GL) || defined(GL_EXT_buffer_storage))
+#   define HAS_BUFFER_STORAGE 1
+#else
+#   define HAS_BUFFER_STORAGE 0
+#endif
+
+namespace filament::backend {
+
+OpenGLStreamingBuffer::OpenGLStreamingBuffer(OpenGLContext& context) noexcept
+        : mContext(context) {
+}
+
+OpenGLStreamingBuffer::~OpenGLStreamingBuffer() noexcept {
+    assert_invariant(!mId);
+}
+
+bool OpenGLStreamingBuffer::init() noexcept {
+#if HAS_BUFFER_STORAGE
+    auto& gl = mContext;
+    if (gl.isES2() || !gl.ext.EXT_buffer_storage) {
+        mUnavailable = true;
+        return false;
+    }
+
+    GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &mId);
+    glBindBuffer(GL_COPY_READ_BUFFER, mId);
+    glBufferStorage(GL_COPY_READ_BUFFER, CAPACITY, nullptr, flags);
+    mMapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, CAPACITY, flags));
+    if (UTILS_UNLIKELY(!mMapped)) {
+        utils::slog.w << "Persistent buffer mapping failed, streaming buffer disabled"
+                << utils::io::endl;
+        glDeleteBuffers(1, &mId);
+        mId = 0;
+        mUnavailable = true;
+    }
+    CHECK_GL_ERROR(utils::slog.e)
+    return mMapped != nullptr;
+#else
+    mUnavailable = true;
+    return false;
+#endif
+}
+
+bool OpenGLStreamingBuffer::upload(GLuint buffer, uint32_t offset,
+        void const* data, uint32_t size) noexcept {
+#if HAS_BUFFER_STORAGE
+    if (UTILS_UNLIKELY(!mMapped)) {
+        if (mUnavailable || !init()) {
+            return false;
+        }
+    }
+
+    if (!accepts(size)) {
+        return false;
+    }
+
+    uint32_t const ringOffset = mRing.allocate(size, 16, mCurrentBatch);
+    if (ringOffset == StagingRing::INVALID_OFFSET) {
+        return false;
+    }
+    mPendingBatch = true;
+
+    // the mapping is coherent, so the data is visible to all GL commands issued from now on
+    memcpy(mMapped + ringOffset, data, size);
+
+    // the copy targets are not tracked by OpenGLContext, so we can bind them directly
+    glBindBuffer(GL_COPY_READ_BUFFER, mId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, ringOffset, offset, size);
+    CHECK_GL_ERROR(utils::slog.e)
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t OpenGLStreamingBuffer::closeBatch() noexcept {
+    mPendingBatch = false;
+    return mCurrentBatch++;
+}
+
+void OpenGLStreamingBuffer::terminate() noexcept {
+#if HAS_BUFFER_STORAGE
+    if (mId) {
+        glBindBuffer(GL_COPY_READ_BUFFER, mId);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glDeleteBuffers(1, &mId);
+        mId = 0;
+        mMapped = nullptr;
+    }
+#endif
+}
+
+} // namespace filament::backend
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_BACKEND_OPENGL_OPENGLSTREAMINGBUFFER_H
+#define TNT_FILAMENT_BACKEND_OPENGL_OPENGLSTREAMINGBUFFER_H
+
+#include "gl_headers.h"
+
+#include "private/backend/StagingRing.h"
+
+#include <stdint.h>
+
+namespace filament::backend {
+
+class OpenGLContext;
+
+/*
+ * A persistently mapped ring buffer used to upload DYNAMIC and STREAM buffer updates.
+ *
+ * Updates are memcpy'ed into the mapped ring and copied into the destination buffer on the GPU
+ * with glCopyBufferSubData, which avoids both the glBufferSubData stalls and the per-update
+ * map/unmap. Regions are tagged with a batch and recycled once the fence that follows their batch
+ * signals. The buffer is only created on first use and requires GL 4.4 or EXT_buffer_storage;
+ * when it's not available upload() always fails and the caller falls back to the regular path.
+ */
+class OpenGLStreamingBuffer {
+public:
+    static constexpr uint32_t CAPACITY = 16u * 1024u * 1024u;
+
+    // larger updates would hog the ring, they're better off on the regular path
+    static constexpr uint32_t MAX_UPLOAD_SIZE = CAPACITY / 4u;
+
+    explicit OpenGLStreamingBuffer(OpenGLContext& context) noexcept;
+    ~OpenGLStreamingBuffer() noexcept;
+
+    OpenGLStreamingBuffer(OpenGLStreamingBuffer const&) = delete;
+    OpenGLStreamingBuffer& operator=(OpenGLStreamingBuffer const&) = delete;
+
+    // Whether an update of `size` bytes can go through the streaming buffer at all.
+    bool accepts(uint32_t size) const noexcept {
+        return !mUnavailable && size <= MAX_UPLOAD_SIZE;
+    }
+
+    // Copies `size` bytes from `data` into `buffer` at `offset`. Returns false if the streaming
+    // buffer is not supported, the update is too large, or the ring is full.
+    bool upload(GLuint buffer, uint32_t offset, void const* data, uint32_t size) noexcept;
+
+    // Whether uploads were made since the last call to closeBatch().
+    bool hasPendingBatch() const noexcept { return mPendingBatch; }
+
+    // Ends the current batch and returns its id. It must be passed to retire() once the GPU
+    // commands issued so far have completed.
+    uint64_t closeBatch() noexcept;
+
+    // Recycles the regions of all batches up to and including `batch`.
+    void retire(uint64_t batch) noexcept { mRing.retire(batch); }
+
+    // Destroys the GL buffer, the GPU must be done with all uploads (e.g. after glFinish).
+    void terminate() noexcept;
+
+private:
+    bool init() noexcept;
+
+    OpenGLContext& mContext;
+    StagingRing mRing{ CAPACITY };
+    uint8_t* mMapped = nullptr;
+    uint64_t mCurrentBatch = 0;
+    GLuint mId = 0;
+    bool mPendingBatch = false;
+    bool mUnavailable = false;
+};
+
+} // namespace filament::backend
+
+#endif // TNT_FILAMENT_BACKEND_OPENGL_OPENGLSTREAMINGBUFFER_H
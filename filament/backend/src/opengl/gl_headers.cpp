@@ -61,6 +61,9 @@ PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOES;
 #ifdef GL_EXT_clip_control
 PFNGLCLIPCONTROLEXTPROC glClipControlEXT;
 #endif
+#ifdef GL_EXT_buffer_storage
+PFNGLBUFFERSTORAGEEXTPROC glBufferStorageEXT;
+#endif
 #ifdef GL_EXT_discard_framebuffer
 PFNGLDISCARDFRAMEBUFFEREXTPROC glDiscardFramebufferEXT;
 #endif
@@ -114,6 +117,9 @@ void importGLESExtensionsEntryPoints() {
 #ifdef GL_EXT_clip_control
     getProcAddress(glClipControlEXT, "glClipControlEXT");
 #endif
+#ifdef GL_EXT_buffer_storage
+    getProcAddress(glBufferStorageEXT, "glBufferStorageEXT");
+#endif
 #ifdef GL_EXT_discard_framebuffer
         getProcAddress(glDiscardFramebufferEXT, "glDiscardFramebufferEXT");
 #endif
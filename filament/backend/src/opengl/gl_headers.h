@@ -132,6 +132,9 @@ extern PFNGLGETDEBUGMESSAGELOGKHRPROC glGetDebugMessageLogKHR;
 #ifdef GL_EXT_clip_control
 extern PFNGLCLIPCONTROLEXTPROC glClipControlEXT;
 #endif
+#ifdef GL_EXT_buffer_storage
+extern PFNGLBUFFERSTORAGEEXTPROC glBufferStorageEXT;
+#endif
 #ifdef GL_EXT_disjoint_timer_query
 extern PFNGLGENQUERIESEXTPROC glGenQueriesEXT;
 extern PFNGLDELETEQUERIESEXTPROC glDeleteQueriesEXT;
@@ -179,6 +182,12 @@ using namespace glext;
 #   define GL_ZERO_TO_ONE                           GL_ZERO_TO_ONE_EXT
 #endif
 
+#ifdef GL_EXT_buffer_storage
+#   define GL_MAP_PERSISTENT_BIT                    GL_MAP_PERSISTENT_BIT_EXT
+#   define GL_MAP_COHERENT_BIT                      GL_MAP_COHERENT_BIT_EXT
+#   define glBufferStorage                          glBufferStorageEXT
+#endif
+
 #ifdef GL_KHR_parallel_shader_compile
 #   define GL_COMPLETION_STATUS                     GL_COMPLETION_STATUS_KHR
 #else
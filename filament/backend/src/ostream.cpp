@@ -94,6 +94,7 @@ io::ostream& operator<<(io::ostream& out, BufferUsage usage) {
     switch (usage) {
         CASE(BufferUsage, STATIC)
         CASE(BufferUsage, DYNAMIC)
+        CASE(BufferUsage, STREAM)
     }
     return out;
 }
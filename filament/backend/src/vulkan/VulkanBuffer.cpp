@@ -51,12 +51,9 @@ VulkanBuffer::~VulkanBuffer() {
 
 void VulkanBuffer::loadFromCpu(VkCommandBuffer cmdbuf, const void* cpuData, uint32_t byteOffset,
         uint32_t numBytes) {
-    VulkanStage const* stage = mStagePool.acquireStage(numBytes);
-    void* mapped;
-    vmaMapMemory(mAllocator, stage->memory, &mapped);
-    memcpy(mapped, cpuData, numBytes);
-    vmaUnmapMemory(mAllocator, stage->memory);
-    vmaFlushAllocation(mAllocator, stage->memory, byteOffset, numBytes);
+    VulkanStageRange const stage = mStagePool.acquireStage(numBytes);
+    memcpy(stage.mapped, cpuData, numBytes);
+    vmaFlushAllocation(mAllocator, stage.memory, stage.offset, numBytes);
 
     // If there was a previous update, then we need to make sure the following write is properly
     // synced with the previous read.
@@ -89,11 +86,11 @@ void VulkanBuffer::loadFromCpu(VkCommandBuffer cmdbuf, const void* cpuData, uint
     }
 
     VkBufferCopy region {
-            .srcOffset = 0,
+            .srcOffset = stage.offset,
             .dstOffset = byteOffset,
             .size = numBytes,
     };
-    vkCmdCopyBuffer(cmdbuf, stage->buffer, mGpuBuffer, 1, &region);
+    vkCmdCopyBuffer(cmdbuf, stage.buffer, mGpuBuffer, 1, &region);
 
 	mUpdatedOffset = byteOffset;
     mUpdatedBytes = numBytes;
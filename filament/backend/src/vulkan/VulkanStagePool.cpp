@@ -25,13 +25,118 @@
 
 static constexpr uint32_t TIME_BEFORE_EVICTION = FVK_MAX_COMMAND_BUFFERS;
 
+// Uploads up to RING_MAX_ALLOCATION_SIZE share the ring blocks, larger ones get a dedicated stage
+// so that a single upload can't monopolize the ring.
+static constexpr uint32_t RING_BLOCK_SIZE = 8u * 1024u * 1024u;
+static constexpr uint32_t RING_MAX_BLOCK_COUNT = 4;
+static constexpr uint32_t RING_MAX_ALLOCATION_SIZE = RING_BLOCK_SIZE / 4;
+
 namespace filament::backend {
 
 VulkanStagePool::VulkanStagePool(VmaAllocator allocator, VulkanCommands* commands)
     : mAllocator(allocator),
       mCommands(commands) {}
 
-VulkanStage const* VulkanStagePool::acquireStage(uint32_t numBytes) {
+VulkanStageRange VulkanStagePool::acquireStage(uint32_t numBytes, uint32_t alignment) {
+    VulkanStageRange range{};
+    if (numBytes <= RING_MAX_ALLOCATION_SIZE && acquireFromRing(numBytes, alignment, &range)) {
+        return range;
+    }
+    VulkanStage const* stage = acquireDedicatedStage(numBytes);
+    return { stage->buffer, stage->memory, 0, stage->mapped };
+}
+
+bool VulkanStagePool::acquireFromRing(uint32_t numBytes, uint32_t alignment,
+        VulkanStageRange* outRange) {
+    // Each command buffer is a batch, which is retired once its fence has signaled.
+    std::shared_ptr<VulkanCmdFence> const& fence = mCommands->get().fence;
+    if (mRingBatches.empty() || mRingBatches.back().second != fence) {
+        mRingBatches.emplace_back(++mCurrentRingBatch, fence);
+    }
+
+    auto allocate = [this, numBytes, alignment, outRange](RingBlock* block) {
+        uint32_t const offset = block->ring.allocate(numBytes, alignment, mCurrentRingBatch);
+        if (offset == StagingRing::INVALID_OFFSET) {
+            return false;
+        }
+        block->lastAccessed = mCurrentFrame;
+        *outRange = { block->buffer, block->memory, offset, block->mapped + offset };
+        return true;
+    };
+
+    for (auto const& block : mRingBlocks) {
+        if (allocate(block.get())) {
+            return true;
+        }
+    }
+
+    // All blocks are full, reclaim the ranges of the command buffers that completed since the
+    // last gc() before growing the ring.
+    mCommands->updateFences();
+    retireRingBatches();
+    for (auto const& block : mRingBlocks) {
+        if (allocate(block.get())) {
+            return true;
+        }
+    }
+
+    if (mRingBlocks.size() < RING_MAX_BLOCK_COUNT) {
+        RingBlock* const block = createRingBlock();
+        return block && allocate(block);
+    }
+    return false;
+}
+
+VulkanStagePool::RingBlock* VulkanStagePool::createRingBlock() {
+    VkBufferCreateInfo const bufferInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = RING_BLOCK_SIZE,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    };
+    VmaAllocationCreateInfo const allocInfo{
+        .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_CPU_ONLY
+    };
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VmaAllocation memory = VK_NULL_HANDLE;
+    VmaAllocationInfo info{};
+    VkResult const result = vmaCreateBuffer(mAllocator, &bufferInfo, &allocInfo, &buffer, &memory,
+            &info);
+    if (result != VK_SUCCESS) {
+#if FVK_ENABLED(FVK_DEBUG_ALLOCATION)
+        FVK_LOGE << "Allocation error: " << result << utils::io::endl;
+#endif
+        return nullptr;
+    }
+    mRingBlocks.push_back(std::make_unique<RingBlock>(RingBlock{
+        .memory = memory,
+        .buffer = buffer,
+        .mapped = static_cast<uint8_t*>(info.pMappedData),
+        .ring = StagingRing(RING_BLOCK_SIZE),
+        .lastAccessed = mCurrentFrame,
+    }));
+    return mRingBlocks.back().get();
+}
+
+void VulkanStagePool::destroyRingBlock(RingBlock* block) noexcept {
+    vmaDestroyBuffer(mAllocator, block->buffer, block->memory);
+}
+
+void VulkanStagePool::retireRingBatches() noexcept {
+    // command buffers complete in submission order
+    uint64_t completed = 0;
+    while (!mRingBatches.empty() && mRingBatches.front().second->status.load() == VK_SUCCESS) {
+        completed = mRingBatches.front().first;
+        mRingBatches.pop_front();
+    }
+    if (completed) {
+        for (auto const& block : mRingBlocks) {
+            block->ring.retire(completed);
+        }
+    }
+}
+
+VulkanStage const* VulkanStagePool::acquireDedicatedStage(uint32_t numBytes) {
     // First check if a stage exists whose capacity is greater than or equal to the requested size.
     auto iter = mFreeStages.lower_bound(numBytes);
     if (iter != mFreeStages.end()) {
@@ -45,6 +150,7 @@ VulkanStage const* VulkanStagePool::acquireStage(uint32_t numBytes) {
         .memory = VK_NULL_HANDLE,
         .buffer = VK_NULL_HANDLE,
         .capacity = numBytes,
+        .mapped = nullptr,
         .lastAccessed = mCurrentFrame,
     });
 
@@ -55,9 +161,14 @@ VulkanStage const* VulkanStagePool::acquireStage(uint32_t numBytes) {
         .size = numBytes,
         .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
     };
-    VmaAllocationCreateInfo allocInfo { .usage = VMA_MEMORY_USAGE_CPU_ONLY };
+    VmaAllocationCreateInfo allocInfo {
+        .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_CPU_ONLY
+    };
+    VmaAllocationInfo info{};
     UTILS_UNUSED_IN_RELEASE VkResult result = vmaCreateBuffer(mAllocator, &bufferInfo,
-            &allocInfo, &stage->buffer, &stage->memory, nullptr);
+            &allocInfo, &stage->buffer, &stage->memory, &info);
+    stage->mapped = info.pMappedData;
 
 #if FVK_ENABLED(FVK_DEBUG_ALLOCATION)
     if (result != VK_SUCCESS) {
@@ -132,12 +243,27 @@ void VulkanStagePool::gc() noexcept {
     FVK_SYSTRACE_CONTEXT();
     FVK_SYSTRACE_START("stagepool::gc");
 
+    // Reclaim the ring ranges used by command buffers that have completed.
+    retireRingBatches();
+
     // If this is one of the first few frames, return early to avoid wrapping unsigned integers.
     if (++mCurrentFrame <= TIME_BEFORE_EVICTION) {
+        FVK_SYSTRACE_END();
         return;
     }
     const uint64_t evictionTime = mCurrentFrame - TIME_BEFORE_EVICTION;
 
+    // Destroy ring blocks that have been empty for several frames, but keep one around.
+    for (auto it = mRingBlocks.begin(); it != mRingBlocks.end() && mRingBlocks.size() > 1;) {
+        RingBlock* const block = it->get();
+        if (block->ring.empty() && block->lastAccessed < evictionTime) {
+            destroyRingBlock(block);
+            it = mRingBlocks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
     // Destroy buffers that have not been used for several frames.
     decltype(mFreeStages) freeStages;
     freeStages.swap(mFreeStages);
@@ -189,6 +315,12 @@ void VulkanStagePool::gc() noexcept {
 }
 
 void VulkanStagePool::terminate() noexcept {
+    for (auto const& block : mRingBlocks) {
+        destroyRingBlock(block.get());
+    }
+    mRingBlocks.clear();
+    mRingBatches.clear();
+
     for (auto stage : mUsedStages) {
         vmaDestroyBuffer(mAllocator, stage->buffer, stage->memory);
         delete stage;
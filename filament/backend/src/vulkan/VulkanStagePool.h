@@ -21,8 +21,14 @@
 #include "VulkanContext.h"
 #include "VulkanMemory.h"
 
+#include "private/backend/StagingRing.h"
+
+#include <deque>
 #include <map>
+#include <memory>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace filament::backend {
 
@@ -31,9 +37,19 @@ struct VulkanStage {
     VmaAllocation memory;
     VkBuffer buffer;
     uint32_t capacity;
+    void* mapped;
     mutable uint64_t lastAccessed;
 };
 
+// A range of persistently mapped staging memory, either carved from a shared ring block or
+// covering a whole dedicated stage.
+struct VulkanStageRange {
+    VkBuffer buffer;
+    VmaAllocation memory;
+    uint32_t offset;    // offset of the range in `buffer`, use it as the copy source offset
+    void* mapped;       // host address of `offset`
+};
+
 struct VulkanStageImage {
     VkFormat format;
     uint32_t width;
@@ -45,13 +61,19 @@ struct VulkanStageImage {
 
 // Manages a pool of stages, periodically releasing stages that have been unused for a while.
 // This class manages two types of host-mappable staging areas: buffer stages and image stages.
+//
+// Most buffer uploads are small, they are sub-allocated linearly from a few large ring blocks
+// instead, which avoids a lookup and often a VMA allocation per upload. Ring ranges are recycled
+// as soon as the command buffer they were acquired for has completed.
 class VulkanStagePool {
 public:
     VulkanStagePool(VmaAllocator allocator, VulkanCommands* commands);
 
-    // Finds or creates a stage whose capacity is at least the given number of bytes.
-    // The stage is automatically released back to the pool after TIME_BEFORE_EVICTION frames.
-    VulkanStage const* acquireStage(uint32_t numBytes);
+    // Returns a mapped range of at least the given number of bytes, whose offset is a multiple
+    // of `alignment`. The range must be used by the command buffer currently being recorded.
+    // Very large uploads get a dedicated stage, which is automatically released back to the pool
+    // after TIME_BEFORE_EVICTION frames.
+    VulkanStageRange acquireStage(uint32_t numBytes, uint32_t alignment = 1);
 
     // Images have VK_IMAGE_LAYOUT_GENERAL and must not be transitioned to any other layout
     VulkanStageImage const* acquireImage(PixelDataFormat format, PixelDataType type,
@@ -65,9 +87,30 @@ public:
     void terminate() noexcept;
 
 private:
+    struct RingBlock {
+        VmaAllocation memory;
+        VkBuffer buffer;
+        uint8_t* mapped;
+        StagingRing ring;
+        uint64_t lastAccessed;
+    };
+
+    bool acquireFromRing(uint32_t numBytes, uint32_t alignment, VulkanStageRange* outRange);
+    RingBlock* createRingBlock();
+    void destroyRingBlock(RingBlock* block) noexcept;
+    void retireRingBatches() noexcept;
+    VulkanStage const* acquireDedicatedStage(uint32_t numBytes);
+
     VmaAllocator mAllocator;
     VulkanCommands* mCommands;
 
+    std::vector<std::unique_ptr<RingBlock>> mRingBlocks;
+
+    // Each command buffer that acquired ring ranges is a batch, they're retired in order once
+    // their fence has signaled.
+    std::deque<std::pair<uint64_t, std::shared_ptr<VulkanCmdFence>>> mRingBatches;
+    uint64_t mCurrentRingBatch = 0;
+
     // Use an ordered multimap for quick (capacity => stage) lookups using lower_bound().
     std::multimap<uint32_t, VulkanStage const*> mFreeStages;
 
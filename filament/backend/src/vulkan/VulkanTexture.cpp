@@ -277,21 +277,19 @@ void VulkanTexture::updateImage(const PixelBufferDescriptor& data, uint32_t widt
 
     assert_invariant(hostData->size > 0 && "Data is empty");
 
-    // Otherwise, use vkCmdCopyBufferToImage.
-    void* mapped = nullptr;
-    VulkanStage const* stage = mStagePool.acquireStage(hostData->size);
-    assert_invariant(stage->memory);
-    vmaMapMemory(mAllocator, stage->memory, &mapped);
-    memcpy(mapped, hostData->buffer, hostData->size);
-    vmaUnmapMemory(mAllocator, stage->memory);
-    vmaFlushAllocation(mAllocator, stage->memory, 0, hostData->size);
+    // Otherwise, use vkCmdCopyBufferToImage. The buffer offset must be a multiple of both the
+    // texel block size and 4, 48 works for all the formats we support.
+    VulkanStageRange const stage = mStagePool.acquireStage(hostData->size, 48);
+    assert_invariant(stage.memory);
+    memcpy(stage.mapped, hostData->buffer, hostData->size);
+    vmaFlushAllocation(mAllocator, stage.memory, stage.offset, hostData->size);
 
     VulkanCommandBuffer& commands = mCommands->get();
     VkCommandBuffer const cmdbuf = commands.buffer();
     commands.acquire(this);
 
     VkBufferImageCopy copyRegion = {
-        .bufferOffset = {},
+        .bufferOffset = stage.offset,
         .bufferRowLength = {},
         .bufferImageHeight = {},
         .imageSubresource = {
@@ -334,7 +332,7 @@ void VulkanTexture::updateImage(const PixelBufferDescriptor& data, uint32_t widt
 
     transitionLayout(cmdbuf, transitionRange, newLayout);
 
-    vkCmdCopyBufferToImage(cmdbuf, stage->buffer, mTextureImage, newVkLayout, 1, &copyRegion);
+    vkCmdCopyBufferToImage(cmdbuf, stage.buffer, mTextureImage, newVkLayout, 1, &copyRegion);
 
     transitionLayout(cmdbuf, transitionRange, nextLayout);
 }
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "private/backend/StagingRing.h"
+
+using namespace filament::backend;
+
+namespace test {
+
+// This only exercises the bookkeeping, so it doesn't need a driver.
+TEST(StagingRing, AllocateAndRetire) {
+    StagingRing ring(1024);
+    EXPECT_TRUE(ring.empty());
+
+    EXPECT_EQ(ring.allocate(100, 16, 0), 0);
+    EXPECT_EQ(ring.allocate(100, 16, 0), 112);      // aligned
+    EXPECT_EQ(ring.allocate(12, 12, 1), 216);       // non power-of-two alignment
+    EXPECT_EQ(ring.getUsed(), 228);
+
+    // nothing is released until the batch retires
+    ring.retire(0);
+    EXPECT_EQ(ring.getUsed(), 16);
+    ring.retire(1);
+    EXPECT_TRUE(ring.empty());
+
+    // an empty ring starts over at the beginning
+    EXPECT_EQ(ring.allocate(1024, 16, 2), 0);
+    EXPECT_EQ(ring.allocate(1, 1, 2), StagingRing::INVALID_OFFSET);
+    ring.retire(2);
+    EXPECT_EQ(ring.allocate(1025, 1, 3), StagingRing::INVALID_OFFSET);
+}
+
+TEST(StagingRing, WrapAround) {
+    StagingRing ring(1000);
+    EXPECT_EQ(ring.allocate(400, 1, 0), 0);
+    EXPECT_EQ(ring.allocate(400, 1, 1), 400);
+    // doesn't fit at the end, and batch 0 is still in flight
+    EXPECT_EQ(ring.allocate(300, 1, 2), StagingRing::INVALID_OFFSET);
+
+    ring.retire(0);
+    // the last 200 bytes are skipped
+    EXPECT_EQ(ring.allocate(300, 1, 2), 0);
+    EXPECT_EQ(ring.getUsed(), 900);
+    // free space is now [300, 400)
+    EXPECT_EQ(ring.allocate(101, 1, 2), StagingRing::INVALID_OFFSET);
+    EXPECT_EQ(ring.allocate(100, 1, 2), 300);
+    EXPECT_EQ(ring.allocate(1, 1, 2), StagingRing::INVALID_OFFSET);
+
+    // the skipped bytes are released with batch 2
+    ring.retire(1);
+    EXPECT_EQ(ring.getUsed(), 600);
+    EXPECT_EQ(ring.allocate(401, 1, 3), StagingRing::INVALID_OFFSET);
+    EXPECT_EQ(ring.allocate(400, 1, 3), 400);
+    ring.retire(3);
+    EXPECT_TRUE(ring.empty());
+}
+
+} // namespace test
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "ResourceAllocator.h"
+
+#include "fg/FrameGraph.h"
+#include "fg/FrameGraphResources.h"
+
+#include <stdint.h>
+
+using namespace filament;
+using namespace backend;
+
+namespace {
+
+// Compiling a FrameGraph never allocates concrete resources, only execute() does.
+class NullResourceAllocator : public ResourceAllocatorInterface {
+    struct NullDisposer : public ResourceAllocatorDisposerInterface {
+        void destroy(TextureHandle) noexcept override {}
+    } mDisposer;
+
+public:
+    RenderTargetHandle createRenderTarget(const char*, TargetBufferFlags, uint32_t, uint32_t,
+            uint8_t, uint8_t, MRT, TargetBufferInfo, TargetBufferInfo) noexcept override {
+        return {};
+    }
+    void destroyRenderTarget(RenderTargetHandle) noexcept override {}
+    TextureHandle createTexture(const char*, SamplerType, uint8_t, TextureFormat, uint8_t,
+            uint32_t, uint32_t, uint32_t, std::array<TextureSwizzle, 4>,
+            TextureUsage) noexcept override {
+        return {};
+    }
+    void destroyTexture(TextureHandle) noexcept override {}
+    ResourceAllocatorDisposerInterface& getDisposer() noexcept override { return mDisposer; }
+};
+
+struct PassData {
+    FrameGraphId<FrameGraphTexture> input;
+    FrameGraphId<FrameGraphTexture> output;
+};
+
+// Roughly the shape of a View's graph: a shadow atlas written one layer per pass, then a chain
+// of render passes each reading the previous output, with a few unused passes that get culled.
+void declare(FrameGraph& fg, uint32_t passCount) {
+    auto& shadows = fg.addPass<PassData>("Prepare Shadows",
+            [&](FrameGraph::Builder& builder, auto& data) {
+                data.output = builder.createTexture("Shadowmap", {
+                        .width = 1024, .height = 1024, .depth = 4,
+                        .type = SamplerType::SAMPLER_2D_ARRAY, .format = TextureFormat::DEPTH16 });
+                builder.sideEffect();
+            },
+            [](FrameGraphResources const&, auto const&, DriverApi&) {});
+
+    for (uint8_t layer = 0; layer < 4; layer++) {
+        fg.addPass<PassData>("Shadow Pass", [&](FrameGraph::Builder& builder, auto& data) {
+                    data.output = builder.createSubresource(shadows->output, "Shadowmap Layer",
+                            { .layer = layer });
+                    data.output = builder.write(data.output,
+                            FrameGraphTexture::Usage::DEPTH_ATTACHMENT);
+                    builder.declareRenderPass("Shadow RT",
+                            { .attachments = { .depth = data.output }});
+                },
+                [](FrameGraphResources const&, auto const&, DriverApi&) {});
+    }
+
+    FrameGraphId<FrameGraphTexture> input = shadows->output;
+    for (uint32_t i = 0; i < passCount; i++) {
+        auto& pass = fg.addPass<PassData>("Pass", [&](FrameGraph::Builder& builder, auto& data) {
+                    data.input = builder.sample(input);
+                    data.output = builder.createTexture("Color", {
+                            .width = 1920, .height = 1080, .format = TextureFormat::RGBA16F });
+                    data.output = builder.declareRenderPass(data.output);
+                },
+                [](FrameGraphResources const&, auto const&, DriverApi&) {});
+        if (i % 8 == 7) {
+            // a pass whose output is never used
+            fg.addPass<PassData>("Unused Pass", [&](FrameGraph::Builder& builder, auto& data) {
+                        data.input = builder.sample(input);
+                        data.output = builder.createTexture("Unused", {
+                                .width = 1920, .height = 1080, .format = TextureFormat::RGBA8 });
+                        data.output = builder.declareRenderPass(data.output);
+                    },
+                    [](FrameGraphResources const&, auto const&, DriverApi&) {});
+        }
+        input = pass->output;
+    }
+    fg.present(input);
+}
+
+} // anonymous namespace
+
+// range(0) is the number of passes, range(1) is whether a CompileCache is used.
+static void BM_frameGraphSetupAndCompile(benchmark::State& state) {
+    NullResourceAllocator resourceAllocator;
+    FrameGraph::CompileCache cache;
+    uint32_t const passCount = uint32_t(state.range(0));
+    FrameGraph::CompileCache* const pCache = state.range(1) ? &cache : nullptr;
+    for (auto _ : state) {
+        FrameGraph fg{ resourceAllocator };
+        declare(fg, passCount);
+        fg.compile(pCache);
+        benchmark::ClobberMemory();
+    }
+}
+
+static void passCounts(benchmark::internal::Benchmark* b) {
+    for (int64_t passCount : { 16, 64, 128 }) {
+        b->Args({ passCount, 0 });
+        b->Args({ passCount, 1 });
+    }
+}
+
+BENCHMARK(BM_frameGraphSetupAndCompile)->Apply(passCounts)->Unit(benchmark::kMicrosecond);
@@ -53,6 +53,7 @@ class UTILS_PUBLIC BufferObject : public FilamentAPI {
 public:
     using BufferDescriptor = backend::BufferDescriptor;
     using BindingType = backend::BufferObjectBinding;
+    using BufferUsage = backend::BufferUsage;
 
     class Builder : public BuilderBase<BuilderDetails> {
         friend struct BuilderDetails;
@@ -78,6 +79,17 @@ public:
          */
         Builder& bindingType(BindingType bindingType) noexcept;
 
+        /**
+         * How the content of the buffer is expected to change. (defaults to STATIC)
+         *
+         * Use DYNAMIC or STREAM for buffers updated every frame, some backends can then upload
+         * the data without stalling, e.g. through a persistently mapped streaming buffer.
+         *
+         * @param usage Usage hint for the buffer.
+         * @return A reference to this Builder for chaining calls.
+         */
+        Builder& usage(BufferUsage usage) noexcept;
+
         /**
          * Creates the BufferObject and returns a pointer to it. After creation, the buffer
          * object is uninitialized. Use BufferObject::setBuffer() to initialize it.
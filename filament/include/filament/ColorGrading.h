@@ -197,7 +197,8 @@ public:
          *
          * The specified tone mapper must have a lifecycle that exceeds the lifetime of
          * this builder. Since the build(Engine&) method is synchronous, it is safe to
-         * delete the tone mapper object after that finishes executing.
+         * delete the tone mapper object after that finishes executing, unless
+         * asynchronous(true) was requested, see asynchronous(bool).
          *
          * @param toneMapper The tone mapping operator to apply to the HDR color buffer
          *
@@ -468,6 +469,23 @@ public:
          */
         Builder& outputColorSpace(const color::ColorSpace& colorSpace) noexcept;
 
+        /**
+         * When enabled, the 3D LUT is generated on the engine's JobSystem and build(Engine&)
+         * returns immediately. The LUT texture is created the first time isReady() observes the
+         * generation has completed, or when the ColorGrading object is first used for rendering,
+         * in which case the rendering thread waits for the generation to finish.
+         *
+         * When this is enabled, the tone mapper set with toneMapper() must be kept alive until
+         * isReady() returns true.
+         *
+         * The default is false.
+         *
+         * @param enabled Whether the LUT generation should be asynchronous
+         *
+         * @return This Builder, for chaining calls
+         */
+        Builder& asynchronous(bool enabled) noexcept;
+
         /**
          * Creates the ColorGrading object and returns a pointer to it.
          *
@@ -481,6 +499,15 @@ public:
         friend class FColorGrading;
     };
 
+    /**
+     * Returns whether the 3D LUT of this ColorGrading is ready to be used without blocking.
+     * This is always true for ColorGrading objects that were not built with
+     * Builder::asynchronous(true). This method never blocks.
+     *
+     * @return true if the LUT has been generated and uploaded, false otherwise
+     */
+    bool isReady() const noexcept;
+
 protected:
     // prevent heap allocation
     ~ColorGrading() = default;
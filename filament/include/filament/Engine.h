@@ -345,9 +345,13 @@ public:
         uint8_t stereoscopicEyeCount = 2;
 
         /*
-         * @deprecated This value is no longer used.
+         * Size in MiB above which the textures cached for reuse by the frame graph are evicted,
+         * oldest first. This is a soft limit: textures released during the last frame are
+         * always kept, because the next frame is likely to need them.
+         * 0 means no size limit, the cache is then only trimmed by age.
+         * The default is 0.
          */
-        uint32_t resourceAllocatorCacheSizeMB = 64;
+        uint32_t resourceAllocatorCacheSizeMB = 0;
 
         /*
          * This value determines how many frames texture entries are kept for in the cache. This
@@ -465,6 +469,22 @@ public:
          */
         Builder& paused(bool paused) noexcept;
 
+        /**
+         * Records the driver commands of the first frames to a file, so they can be replayed
+         * without the application, e.g. with the `cmdreplay` tool on the noop backend. Buffer
+         * contents are recorded as well, so captures can be large. Native windows and
+         * callbacks are not recorded.
+         *
+         * This is meant for debugging and benchmarking, it slows down the engine noticeably
+         * while the capture is in progress.
+         *
+         * @param path       File to write the capture to, nullptr disables the capture.
+         * @param frameCount Number of frames to capture, the capture also ends when the
+         *                   Engine is destroyed.
+         * @return A reference to this Builder for chaining calls.
+         */
+        Builder& commandCapture(const char* UTILS_NULLABLE path, uint32_t frameCount = 1) noexcept;
+
 #if UTILS_HAS_THREADING
         /**
          * Creates the filament Engine asynchronously.
@@ -940,6 +960,30 @@ public:
       */
     void flush();
 
+    /**
+     * Occupancy of the command buffer shared with the rendering thread.
+     *
+     * <p>When a single batch of commands doesn't fit in the command buffer, it continues in
+     * heap-allocated overflow blocks instead of aborting. Frequent overflows or stalls are a
+     * sign that Config::commandBufferSizeMB or Config::minCommandBufferSizeMB is too small.</p>
+     *
+     * @see getCommandBufferStats
+     */
+    struct CommandBufferStats {
+        size_t bufferSize;              //!< size of the command buffer in bytes
+        size_t used;                    //!< bytes waiting to be executed by the rendering thread
+        size_t highWatermark;           //!< largest value of `used` so far
+        size_t overflowHighWatermark;   //!< largest batch that spilled into overflow blocks
+        uint32_t pendingBuffers;        //!< flushed batches not picked up by the rendering thread
+        uint32_t overflowCount;         //!< number of batches that needed overflow blocks
+        uint32_t stallCount;            //!< number of times flushing blocked waiting for space
+    };
+
+    /**
+     * Returns the command buffer occupancy. Must be called from the Engine's thread.
+     */
+    CommandBufferStats getCommandBufferStats() const noexcept;
+
     /**
      * Get paused state of rendering thread.
      *
@@ -959,7 +1003,7 @@ public:
      * Do not rely on a buffer callback to unpause the thread.
      * </li><li>
      * While the rendering thread is paused, rendering commands will continue to be queued until the
-     * buffer limit is reached. When the limit is reached, the program will abort.
+     * buffer limit is reached. Beyond that, they are queued in heap-allocated overflow blocks.
      * </li></ul>
      */
     void setPaused(bool paused);
@@ -50,6 +50,7 @@ class UTILS_PUBLIC IndexBuffer : public FilamentAPI {
 
 public:
     using BufferDescriptor = backend::BufferDescriptor;
+    using BufferUsage = backend::BufferUsage;
 
     /**
      * Type of the index buffer
@@ -83,6 +84,17 @@ public:
          */
         Builder& bufferType(IndexType indexType) noexcept;
 
+        /**
+         * How the content of the index buffer is expected to change. (defaults to STATIC)
+         *
+         * Use DYNAMIC or STREAM for indices updated every frame, some backends can then upload
+         * the data without stalling, e.g. through a persistently mapped streaming buffer.
+         *
+         * @param usage Usage hint for the index buffer.
+         * @return A reference to this Builder for chaining calls.
+         */
+        Builder& usage(BufferUsage usage) noexcept;
+
         /**
          * Creates the IndexBuffer object and returns a pointer to it. After creation, the index
          * buffer is uninitialized. Use IndexBuffer::setBuffer() to initialize the IndexBuffer.
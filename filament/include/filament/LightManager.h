@@ -383,6 +383,19 @@ public:
          * Ignored if the light type isn't directional. For artistic use. Use with caution.
          */
         math::quatf transform{ 1.0f };
+
+        /**
+         * Whether this light's shadow maps are kept from one frame to the next. A cached shadow
+         * map is only rendered again when the light's view or projection changes, or when one of
+         * the shadow casters it sees is added, removed, moved or has its visibility flags
+         * changed. This is useful for lights that don't move in mostly static scenes.
+         *
+         * Changes that don't affect a caster's transform, such as a new material or updated
+         * vertex data, are not detected. Shadow maps that see skinned or morphed casters are
+         * rendered every frame. This is ignored when the View's ShadowType is set to VSM.
+         * (off by default)
+         */
+        bool cached = false;
     };
 
     struct ShadowCascades {
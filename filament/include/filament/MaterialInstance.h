@@ -131,6 +131,25 @@ public:
         setParameter<T>(name, strlen(name), value);
     }
 
+    /**
+     * Resolves a uniform parameter to its byte offset in the uniform buffer. The offset is shared
+     * by all the instances of the same Material, and lets setParameterAt() skip the name lookup
+     * performed by setParameter().
+     *
+     * @param name          Name of the parameter as defined by Material. Cannot be nullptr.
+     * @return              The offset of the parameter, or -1 if there is no such uniform.
+     */
+    int32_t getParameterOffset(const char* UTILS_NONNULL name) const;
+
+    /**
+     * Set a uniform at an offset returned by getParameterOffset().
+     *
+     * @param offset        Offset of the parameter. Negative offsets are ignored.
+     * @param value         Value of the parameter to set, T must match the parameter's type.
+     */
+    template<typename T, typename = is_supported_parameter_t<T>>
+    void setParameterAt(int32_t offset, T const& value) noexcept;
+
 
     /**
      * Set a uniform array by name
@@ -114,6 +114,30 @@ public:
      */
     size_t getMaxFrameHistorySize() const noexcept;
 
+    /**
+     * Memory used by the textures this Renderer allocates for its passes, e.g. shadow maps or
+     * post-processing targets. Sizes are computed from the textures' dimensions and formats.
+     * @see getTransientMemoryStats()
+     */
+    struct TransientMemoryStats {
+        size_t inUse;       //!< bytes of the textures in use, by all the Engine's Renderers
+        size_t inUsePeak;   //!< largest value of `inUse` so far
+        size_t cached;      //!< bytes of the textures kept for reuse by later frames
+        size_t cachedPeak;  //!< largest value of `cached` so far
+        size_t totalPeak;   //!< largest value of `inUse + cached` so far
+    };
+
+    /**
+     * Returns the memory used by this Renderer's transient textures.
+     *
+     * A texture is released as soon as the last pass that needs it has run, and is reused by
+     * later passes and views that need a texture of the same shape. `inUsePeak` is therefore
+     * what rendering needed at once, and `totalPeak` includes the textures kept in the cache.
+     *
+     * @see Engine::Config::resourceAllocatorCacheSizeMB
+     */
+    TransientMemoryStats getTransientMemoryStats() const noexcept;
+
     /**
      * Use FrameRateOptions to set the desired frame rate and control how quickly the system
      * reacts to GPU load changes.
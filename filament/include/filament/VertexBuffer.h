@@ -60,6 +60,7 @@ class UTILS_PUBLIC VertexBuffer : public FilamentAPI {
 public:
     using AttributeType = backend::ElementType;
     using BufferDescriptor = backend::BufferDescriptor;
+    using BufferUsage = backend::BufferUsage;
 
     class Builder : public BuilderBase<BuilderDetails> {
         friend struct BuilderDetails;
@@ -101,6 +102,20 @@ public:
          */
         Builder& enableBufferObjects(bool enabled = true) noexcept;
 
+        /**
+         * How the content of the vertex buffers is expected to change. (defaults to STATIC)
+         *
+         * Use DYNAMIC or STREAM for vertices updated every frame, some backends can then upload
+         * the data without stalling, e.g. through a persistently mapped streaming buffer.
+         *
+         * This only applies to the buffers created internally, when buffer objects are enabled
+         * the usage is set with BufferObject::Builder::usage().
+         *
+         * @param usage Usage hint for the buffers.
+         * @return A reference to this Builder for chaining calls.
+         */
+        Builder& usage(BufferUsage usage) noexcept;
+
         /**
          * Sets up an attribute for this vertex buffer set.
          *
@@ -378,6 +378,10 @@ utils::JobSystem& Engine::getJobSystem() noexcept {
     return downcast(this)->getJobSystem();
 }
 
+Engine::CommandBufferStats Engine::getCommandBufferStats() const noexcept {
+    return downcast(this)->getCommandBufferStats();
+}
+
 bool Engine::isPaused() const noexcept {
     FILAMENT_CHECK_PRECONDITION(UTILS_HAS_THREADING)
             << "Pause is meant for multi-threaded platforms.";
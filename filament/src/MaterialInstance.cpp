@@ -124,6 +124,52 @@ template UTILS_PUBLIC void MaterialInstance::setParameter<mat4f>   (const char*
 
 // ------------------------------------------------------------------------------------------------
 
+int32_t MaterialInstance::getParameterOffset(const char* name) const {
+    return int32_t(downcast(this)->getMaterial()->getUniformInterfaceBlock().getFieldOffset(name, 0));
+}
+
+template<typename T, typename>
+void MaterialInstance::setParameterAt(int32_t offset, T const& value) noexcept {
+    downcast(this)->setParameterAtImpl(offset, value);
+}
+
+template<>
+UTILS_PUBLIC void MaterialInstance::setParameterAt(int32_t offset, bool const& v) noexcept {
+    downcast(this)->setParameterAtImpl(offset, (uint32_t)v);
+}
+
+template<>
+UTILS_PUBLIC void MaterialInstance::setParameterAt(int32_t offset, bool2 const& v) noexcept {
+    downcast(this)->setParameterAtImpl(offset, uint2(v));
+}
+
+template<>
+UTILS_PUBLIC void MaterialInstance::setParameterAt(int32_t offset, bool3 const& v) noexcept {
+    downcast(this)->setParameterAtImpl(offset, uint3(v));
+}
+
+template<>
+UTILS_PUBLIC void MaterialInstance::setParameterAt(int32_t offset, bool4 const& v) noexcept {
+    downcast(this)->setParameterAtImpl(offset, uint4(v));
+}
+
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<float>   (int32_t offset, float const&    v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<int32_t> (int32_t offset, int32_t const&  v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<uint32_t>(int32_t offset, uint32_t const& v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<int2>    (int32_t offset, int2 const&     v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<int3>    (int32_t offset, int3 const&     v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<int4>    (int32_t offset, int4 const&     v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<uint2>   (int32_t offset, uint2 const&    v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<uint3>   (int32_t offset, uint3 const&    v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<uint4>   (int32_t offset, uint4 const&    v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<float2>  (int32_t offset, float2 const&   v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<float3>  (int32_t offset, float3 const&   v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<float4>  (int32_t offset, float4 const&   v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<mat3f>   (int32_t offset, mat3f const&    v) noexcept;
+template UTILS_PUBLIC void MaterialInstance::setParameterAt<mat4f>   (int32_t offset, mat4f const&    v) noexcept;
+
+// ------------------------------------------------------------------------------------------------
+
 template <typename T, typename>
 void MaterialInstance::setParameter(const char* name, size_t nameLength, const T* value, size_t count) {
     downcast(this)->setParameterImpl({ name, nameLength }, value, count);
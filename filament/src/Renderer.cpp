@@ -115,4 +115,8 @@ size_t Renderer::getMaxFrameHistorySize() const noexcept {
     return downcast(this)->getMaxFrameHistorySize();
 }
 
+Renderer::TransientMemoryStats Renderer::getTransientMemoryStats() const noexcept {
+    return downcast(this)->getTransientMemoryStats();
+}
+
 } // namespace filament
@@ -37,6 +37,7 @@
 #include <array>
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -91,6 +92,14 @@ void ResourceAllocator::AssociativeContainer<K, V, H>::emplace(ARGS&& ... args)
     mContainer.emplace_back(std::forward<ARGS>(args)...);
 }
 
+template<typename K, typename V, typename H>
+template<typename... ARGS>
+UTILS_NOINLINE
+typename ResourceAllocator::AssociativeContainer<K, V, H>::iterator
+ResourceAllocator::AssociativeContainer<K, V, H>::emplace_hint(iterator hint, ARGS&& ... args) {
+    return mContainer.emplace(hint, std::forward<ARGS>(args)...);
+}
+
 // ------------------------------------------------------------------------------------------------
 
 ResourceAllocatorInterface::~ResourceAllocatorInterface() = default;
@@ -102,24 +111,49 @@ ResourceAllocatorDisposerInterface::~ResourceAllocatorDisposerInterface() = defa
 // ------------------------------------------------------------------------------------------------
 
 size_t ResourceAllocator::TextureKey::getSize() const noexcept {
-    size_t const pixelCount = width * height * depth;
-    size_t size = pixelCount * FTexture::getFormatSize(format);
-    size_t const s = std::max(uint8_t(1), samples);
-    if (s > 1) {
-        // if we have MSAA, we assume N times the storage
-        size *= s;
-    }
-    if (levels > 1) {
-        // if we have mip-maps we assume the full pyramid
-        size += size / 3;
+    // add up the actual size of each level, only 3D textures are mipmapped in depth
+    size_t const layers = (target == SamplerType::SAMPLER_CUBEMAP ||
+            target == SamplerType::SAMPLER_CUBEMAP_ARRAY) ? depth * 6 : depth;
+    size_t pixelCount = 0;
+    for (size_t level = 0, c = std::max(uint8_t(1), levels); level < c; level++) {
+        size_t const w = std::max(size_t(1), size_t(width) >> level);
+        size_t const h = std::max(size_t(1), size_t(height) >> level);
+        size_t const d = target == SamplerType::SAMPLER_3D ?
+                std::max(size_t(1), layers >> level) : layers;
+        pixelCount += w * h * d;
     }
+    size_t size = pixelCount * FTexture::getFormatSize(format);
+    // if we have MSAA, we assume N times the storage
+    size *= std::max(uint8_t(1), samples);
     // TODO: this is not taking into account the potential sidecar MS buffer
     //  but we have no way to know about its existence at this point.
     return size;
 }
 
+bool ResourceAllocator::TextureKey::canReplace(const TextureKey& other) const noexcept {
+    // protected and regular memory can't be used in place of each other
+    constexpr TextureUsage mustMatch = TextureUsage::PROTECTED;
+    return target == other.target &&
+           levels == other.levels &&
+           format == other.format &&
+           samples == other.samples &&
+           width == other.width &&
+           height == other.height &&
+           depth == other.depth &&
+           swizzle == other.swizzle &&
+           (usage & other.usage) == other.usage &&
+           (usage & mustMatch) == (other.usage & mustMatch);
+}
+
+static size_t getCacheMaxSize(Engine::Config const& config) noexcept {
+    // no size limit unless one is set, the cache is then only trimmed by age
+    return config.resourceAllocatorCacheSizeMB ?
+            size_t(config.resourceAllocatorCacheSizeMB) << 20u : std::numeric_limits<size_t>::max();
+}
+
 ResourceAllocator::ResourceAllocator(Engine::Config const& config, DriverApi& driverApi) noexcept
         : mCacheMaxAge(config.resourceAllocatorCacheMaxAge),
+          mCacheMaxSize(getCacheMaxSize(config)),
           mBackend(driverApi),
           mDisposer(std::make_shared<ResourceAllocatorDisposer>(driverApi)) {
 }
@@ -127,6 +161,7 @@ ResourceAllocator::ResourceAllocator(Engine::Config const& config, DriverApi& dr
 ResourceAllocator::ResourceAllocator(std::shared_ptr<ResourceAllocatorDisposer> disposer,
         Engine::Config const& config, DriverApi& driverApi) noexcept
         : mCacheMaxAge(config.resourceAllocatorCacheMaxAge),
+          mCacheMaxSize(getCacheMaxSize(config)),
           mBackend(driverApi),
           mDisposer(std::move(disposer)) {
 }
@@ -173,11 +208,15 @@ backend::TextureHandle ResourceAllocator::createTexture(const char* name,
     if constexpr (mEnabled) {
         auto& textureCache = mTextureCache;
         const TextureKey key{ name, target, levels, format, samples, width, height, depth, usage, swizzle };
-        auto it = textureCache.find(key);
+        auto it = findBestFit(key);
         if (UTILS_LIKELY(it != textureCache.end())) {
-            // we do, move the entry to the in-use list, and remove from the cache
+            // we do, move the entry to the in-use list, and remove from the cache. The texture
+            // keeps its own usage, so it goes back to the cache as what it really is.
             handle = it->second.handle;
             mCacheSize -= it->second.size;
+            TextureKey cachedKey = it->first;
+            cachedKey.name = name;
+            mDisposer->checkout(handle, cachedKey);
             textureCache.erase(it);
         } else {
             // we don't, allocate a new texture and populate the in-use list
@@ -189,8 +228,10 @@ backend::TextureHandle ResourceAllocator::createTexture(const char* name,
                         target, levels, format, samples, width, height, depth, usage,
                         swizzle[0], swizzle[1], swizzle[2], swizzle[3]);
             }
+            mDisposer->checkout(handle, key);
+            mTotalSizeHiWaterMark = std::max(mTotalSizeHiWaterMark,
+                    mDisposer->mInUseSize + mCacheSize);
         }
-        mDisposer->checkout(handle, key);
     } else {
         if (swizzle == defaultSwizzle) {
             handle = mBackend.createTexture(
@@ -208,8 +249,14 @@ void ResourceAllocator::destroyTexture(TextureHandle h) noexcept {
     if constexpr (mEnabled) {
         auto const key = mDisposer->checkin(h);
         if (UTILS_LIKELY(key.has_value())) {
-            uint32_t const size = key.value().getSize();
-            mTextureCache.emplace(key.value(), TextureCachePayload{ h, mAge, size });
+            size_t const size = key.value().getSize();
+            size_t const shape = key.value().getShapeHash();
+            // the cache is kept sorted by shape, so that findBestFit() only visits the
+            // textures that can be reused
+            auto pos = std::upper_bound(mTextureCache.begin(), mTextureCache.end(), shape,
+                    [](size_t shape, auto const& entry) { return shape < entry.second.shape; });
+            mTextureCache.emplace_hint(pos,
+                    key.value(), TextureCachePayload{ h, mAge, size, shape });
             mCacheSize += size;
             mCacheSizeHiWaterMark = std::max(mCacheSizeHiWaterMark, mCacheSize);
         }
@@ -222,6 +269,43 @@ ResourceAllocatorDisposerInterface& ResourceAllocator::getDisposer() noexcept {
     return *mDisposer;
 }
 
+ResourceAllocator::MemoryStats ResourceAllocator::getMemoryStats() const noexcept {
+    return {
+            .inUse = mDisposer->mInUseSize,
+            .inUsePeak = mDisposer->mInUseSizeHiWaterMark,
+            .cached = mCacheSize,
+            .cachedPeak = mCacheSizeHiWaterMark,
+            .totalPeak = mTotalSizeHiWaterMark,
+    };
+}
+
+ResourceAllocator::CacheContainer::iterator ResourceAllocator::findBestFit(
+        TextureKey const& key) noexcept {
+    // Textures of the same shape with more usages than requested can be used too, which
+    // lets e.g. a sampleable attachment be reused for an attachment that's never sampled.
+    // We take the candidate with the fewest extra usages, and between equal candidates, the
+    // most recently released one, so that older textures can age out of the cache.
+    auto& textureCache = mTextureCache;
+    auto best = textureCache.end();
+    int bestExtraUsages = std::numeric_limits<int>::max();
+    size_t const shape = key.getShapeHash();
+    auto it = std::lower_bound(textureCache.begin(), textureCache.end(), shape,
+            [](auto const& entry, size_t shape) { return entry.second.shape < shape; });
+    for (; it != textureCache.end() && it->second.shape == shape; ++it) {
+        if (!it->first.canReplace(key)) {
+            continue;
+        }
+        int const extraUsages = utils::popcount(
+                uint32_t(it->first.usage) & ~uint32_t(key.usage));
+        if (extraUsages < bestExtraUsages ||
+                (extraUsages == bestExtraUsages && it->second.age > best->second.age)) {
+            best = it;
+            bestExtraUsages = extraUsages;
+        }
+    }
+    return best;
+}
+
 void ResourceAllocator::gc(bool skippedFrame) noexcept {
     // this is called regularly -- usually once per frame
 
@@ -232,6 +316,8 @@ void ResourceAllocator::gc(bool skippedFrame) noexcept {
     }
 
     // Purging strategy:
+    //  - remove the oldest entries while the cache is larger than mCacheMaxSize, except those
+    //    released during the last frame
     //  - remove all entries older than MAX_AGE_SKIPPED_FRAME when skipping a frame
     //  - remove entries older than mCacheMaxAgeSoft
     //      - remove only MAX_EVICTION_COUNT entry per gc(),
@@ -250,6 +336,19 @@ void ResourceAllocator::gc(bool skippedFrame) noexcept {
     // maximum number of unique ages in the cache
     constexpr size_t MAX_UNIQUE_AGE_COUNT = 3;
 
+    // Textures released during this frame are likely needed by the next one, they're never
+    // evicted for size, so the cache can exceed its budget by one frame's worth of textures.
+    while (mCacheSize > mCacheMaxSize) {
+        auto oldest = std::min_element(textureCache.begin(), textureCache.end(),
+                [](auto const& lhs, auto const& rhs) {
+                    return lhs.second.age < rhs.second.age;
+                });
+        if (oldest == textureCache.end() || oldest->second.age == age) {
+            break;
+        }
+        purge(oldest);
+    }
+
     utils::bitset32 ages;
     uint32_t evictedCount = 0;
     for (auto it = textureCache.begin(); it != textureCache.end();) {
@@ -291,6 +390,8 @@ void ResourceAllocator::dump(bool brief) const noexcept {
     slog.d  << "# entries=" << mTextureCache.size()
             << ", sz=" << (float)mCacheSize * MiB << " MiB"
             << ", max=" << (float)mCacheSizeHiWaterMark * MiB << " MiB"
+            << ", in-use=" << (float)mDisposer->mInUseSize * MiB << " MiB"
+            << ", in-use max=" << (float)mDisposer->mInUseSizeHiWaterMark * MiB << " MiB"
             << io::endl;
     if (!brief) {
         for (auto const& it : mTextureCache) {
@@ -336,6 +437,8 @@ void ResourceAllocatorDisposer::destroy(backend::TextureHandle handle) noexcept
 
 void ResourceAllocatorDisposer::checkout(backend::TextureHandle handle,
         ResourceAllocator::TextureKey key) {
+    mInUseSize += key.getSize();
+    mInUseSizeHiWaterMark = std::max(mInUseSizeHiWaterMark, mInUseSize);
     mInUseTextures.emplace(handle, key);
 }
 
@@ -350,6 +453,7 @@ std::optional<ResourceAllocator::TextureKey> ResourceAllocatorDisposer::checkin(
     TextureKey const key = it->second;
     // remove it from the in-use list
     mInUseTextures.erase(it);
+    mInUseSize -= key.getSize();
     return key;
 }
 
@@ -115,8 +115,20 @@ public:
 
     void gc(bool skippedFrame = false) noexcept;
 
+    // Memory used by the textures handed out by this allocator, see TextureKey::getSize().
+    struct MemoryStats {
+        size_t inUse;           // textures currently owned by a FrameGraph or detached from it
+        size_t inUsePeak;       // largest inUse so far
+        size_t cached;          // textures kept for reuse
+        size_t cachedPeak;      // largest cached so far
+        size_t totalPeak;       // largest inUse + cached so far, i.e. what was allocated at once
+    };
+
+    MemoryStats getMemoryStats() const noexcept;
+
 private:
     size_t const mCacheMaxAge;
+    size_t const mCacheMaxSize;
 
     struct TextureKey {
         const char* name; // doesn't participate in the hash
@@ -132,6 +144,10 @@ private:
 
         size_t getSize() const noexcept;
 
+        // whether a texture created with this key can be used in place of one created with
+        // `other`: same shape, and a superset of its usages.
+        bool canReplace(const TextureKey& other) const noexcept;
+
         bool operator==(const TextureKey& other) const noexcept {
             return target == other.target &&
                    levels == other.levels &&
@@ -144,6 +160,24 @@ private:
                    swizzle == other.swizzle;
         }
 
+        // hash of what canReplace() requires to be equal, i.e. everything but the usage
+        size_t getShapeHash() const noexcept {
+            size_t seed = 0;
+            utils::hash::combine_fast(seed, target);
+            utils::hash::combine_fast(seed, levels);
+            utils::hash::combine_fast(seed, format);
+            utils::hash::combine_fast(seed, samples);
+            utils::hash::combine_fast(seed, width);
+            utils::hash::combine_fast(seed, height);
+            utils::hash::combine_fast(seed, depth);
+            utils::hash::combine_fast(seed, usage & backend::TextureUsage::PROTECTED);
+            utils::hash::combine_fast(seed, swizzle[0]);
+            utils::hash::combine_fast(seed, swizzle[1]);
+            utils::hash::combine_fast(seed, swizzle[2]);
+            utils::hash::combine_fast(seed, swizzle[3]);
+            return seed;
+        }
+
         friend size_t hash_value(TextureKey const& k) {
             size_t seed = 0;
             utils::hash::combine_fast(seed, k.target);
@@ -165,7 +199,8 @@ private:
     struct TextureCachePayload {
         backend::TextureHandle handle;
         size_t age = 0;
-        uint32_t size = 0;
+        size_t size = 0;
+        size_t shape = 0;   // TextureKey::getShapeHash(), the cache is sorted by it
     };
 
     template<typename T>
@@ -211,18 +246,24 @@ private:
         iterator find(key_type const& key);
         template<typename ... ARGS>
         void emplace(ARGS&&... args);
+        template<typename ... ARGS>
+        iterator emplace_hint(iterator hint, ARGS&&... args);
     };
 
     using CacheContainer = AssociativeContainer<TextureKey, TextureCachePayload>;
 
     void purge(ResourceAllocator::CacheContainer::iterator const& pos);
 
+    // finds the cached texture that can best replace one created with key
+    CacheContainer::iterator findBestFit(TextureKey const& key) noexcept;
+
     backend::DriverApi& mBackend;
     std::shared_ptr<ResourceAllocatorDisposer> mDisposer;
     CacheContainer mTextureCache;
     size_t mAge = 0;
-    uint32_t mCacheSize = 0;
-    uint32_t mCacheSizeHiWaterMark = 0;
+    size_t mCacheSize = 0;
+    size_t mCacheSizeHiWaterMark = 0;
+    size_t mTotalSizeHiWaterMark = 0;
     static constexpr bool mEnabled = true;
 
     friend class ResourceAllocatorDisposer;
@@ -244,6 +285,8 @@ private:
     using InUseContainer = ResourceAllocator::AssociativeContainer<backend::TextureHandle, TextureKey>;
     backend::DriverApi& mBackend;
     InUseContainer mInUseTextures;
+    size_t mInUseSize = 0;
+    size_t mInUseSizeHiWaterMark = 0;
 };
 
 } // namespace filament
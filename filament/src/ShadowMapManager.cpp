@@ -16,6 +16,7 @@
 
 #include "ShadowMapManager.h"
 #include "RenderPass.h"
+#include "ResourceAllocator.h"
 #include "ShadowMap.h"
 
 #include <filament/Frustum.h>
@@ -28,18 +29,21 @@
 
 #include "details/Camera.h"
 #include "details/DebugRegistry.h"
+#include "details/InstanceBuffer.h"
 #include "details/Texture.h"
 #include "details/View.h"
 
 #include "fg/FrameGraph.h"
 #include "fg/FrameGraphId.h"
 #include "fg/FrameGraphRenderPass.h"
+#include "fg/FrameGraphResources.h"
 #include "fg/FrameGraphTexture.h"
 
 #include <backend/DriverApiForward.h>
 #include <backend/DriverEnums.h>
 
 #include <utils/FixedCapacityVector.h>
+#include <utils/Hash.h>
 #include <utils/Range.h>
 #include <utils/Slice.h>
 #include <utils/compiler.h>
@@ -104,6 +108,8 @@ void ShadowMapManager::terminate(FEngine& engine) {
             std::launder(reinterpret_cast<ShadowMap*>(&entry))->terminate(engine);
         }
     }
+    engine.getResourceAllocatorDisposer().destroy(mCachedAtlas.handle);
+    mCachedAtlas.handle.clear();
 }
 
 ShadowMapManager::ShadowTechnique ShadowMapManager::update(
@@ -240,10 +246,32 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
 
     VsmShadowOptions const& vsmShadowOptions = view.getVsmShadowOptions();
 
+    // When some lights cache their shadow maps, the atlas must outlive the frame: it's detached
+    // from the FrameGraph at the end of the frame it's created in, and imported afterward.
+    // It's dropped when the atlas requirements change, which invalidates all the layers.
+    const bool cacheEnabled = isShadowMapCacheEnabled(view);
+    if (mCachedAtlas.handle && (!cacheEnabled ||
+            mCachedAtlasDesc.width != textureRequirements.size ||
+            mCachedAtlasDesc.depth != textureRequirements.layers ||
+            mCachedAtlasDesc.levels != textureRequirements.levels ||
+            mCachedAtlasDesc.format != textureRequirements.format)) {
+        engine.getResourceAllocatorDisposer().destroy(mCachedAtlas.handle);
+        mCachedAtlas.handle.clear();
+    }
+
+    FrameGraphId<FrameGraphTexture> cachedAtlas;
+    if (mCachedAtlas.handle) {
+        cachedAtlas = fg.import("Shadowmap", mCachedAtlasDesc,
+                FrameGraphTexture::Usage::DEPTH_ATTACHMENT | FrameGraphTexture::Usage::SAMPLEABLE,
+                mCachedAtlas);
+    } else {
+        mCachedLayerSignatures.fill(0);
+    }
+
     auto& prepareShadowPass = fg.addPass<PrepareShadowPassData>("Prepare Shadow Pass",
             [&](FrameGraph::Builder& builder, auto& data) {
                 data.passList.reserve(CONFIG_MAX_SHADOWMAPS);
-                data.shadows = builder.createTexture("Shadowmap", {
+                data.shadows = cachedAtlas ? cachedAtlas : builder.createTexture("Shadowmap", {
                         .width = textureRequirements.size, .height = textureRequirements.size,
                         .depth = textureRequirements.layers,
                         .levels = textureRequirements.levels,
@@ -259,7 +287,11 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                 if (!directionalShadowCastersRange.empty()) {
                     for (auto& shadowMap : getCascadedShadowMap()) {
                         // for the directional light, we already know if it has visible shadows.
-                        if (shadowMap.hasVisibleShadows()) {
+                        if (shadowMap.hasVisibleShadows() &&
+                                !isShadowMapCached(shadowMap, engine, view,
+                                        scene->getRenderableData(), directionalShadowCastersRange,
+                                        VISIBLE_DIR_SHADOW_RENDERABLE, scene->getLightData(),
+                                        bool(cachedAtlas))) {
                             passList.push_back({
                                     {}, &shadowMap, directionalShadowCastersRange,
                                     VISIBLE_DIR_SHADOW_RENDERABLE });
@@ -287,7 +319,11 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                                 break;
                         }
 
-                        if (shadowMap.hasVisibleShadows()) {
+                        if (shadowMap.hasVisibleShadows() &&
+                                !isShadowMapCached(shadowMap, engine, view,
+                                        scene->getRenderableData(), spotShadowCastersRange,
+                                        VISIBLE_DYN_SHADOW_RENDERABLE, scene->getLightData(),
+                                        bool(cachedAtlas))) {
                             passList.push_back({
                                     {}, &shadowMap, spotShadowCastersRange,
                                     VISIBLE_DYN_SHADOW_RENDERABLE });
@@ -528,9 +564,135 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
         }
     }
 
+    // keep the atlas we just rendered for the next frame
+    if (cacheEnabled && !cachedAtlas && !passList.empty()) {
+        struct CacheShadowPassData {
+            FrameGraphId<FrameGraphTexture> shadows;
+        };
+        fg.addPass<CacheShadowPassData>("Cache Shadowmap",
+                [&](FrameGraph::Builder& builder, auto& data) {
+                    // The output of this pass is only used by the next frame, as an import.
+                    builder.sideEffect();
+                    data.shadows = builder.sample(prepareShadowPass->shadows);
+                },
+                [this](FrameGraphResources const& resources, auto const& data, DriverApi&) {
+                    resources.detach(data.shadows, &mCachedAtlas, &mCachedAtlasDesc);
+                });
+    }
+
     return prepareShadowPass->shadows;
 }
 
+bool ShadowMapManager::isShadowMapCacheEnabled(FView const& view) noexcept {
+    // VSM shadow maps are blurred and mipmapped through temporaries, they're never cached
+    if (view.hasVSM()) {
+        return false;
+    }
+    for (auto const& shadowMap : getCascadedShadowMap()) {
+        if (shadowMap.getShadowOptions()->cached) {
+            return true;
+        }
+    }
+    for (auto const& shadowMap : getSpotShadowMaps()) {
+        if (shadowMap.getShadowOptions()->cached) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ShadowMapManager::isShadowMapCached(ShadowMap const& shadowMap, FEngine& engine, FView& view,
+        FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
+        FScene::VisibleMaskType visibilityMask, FScene::LightSoa& lightData,
+        bool atlasImported) noexcept {
+    uint64_t& cachedSignature = mCachedLayerSignatures[shadowMap.getLayer()];
+    if (view.hasVSM() || !shadowMap.getShadowOptions()->cached) {
+        // this layer is rendered every frame, its content can't be trusted next frame
+        cachedSignature = 0;
+        return false;
+    }
+
+    // We need this shadow map's casters now, to know whether its pass is needed at all. Culling
+    // is done again right before generating the commands, because all spot and point shadow
+    // maps share the same visibility bit.
+    switch (shadowMap.getShadowType()) {
+        case ShadowType::DIRECTIONAL:
+            // already culled in updateCascadeShadowMaps()
+            break;
+        case ShadowType::SPOT:
+            cullSpotShadowMap(shadowMap, engine, view, renderableData, range, lightData);
+            break;
+        case ShadowType::POINT:
+            cullPointShadowMap(shadowMap, view, renderableData, range, lightData);
+            break;
+    }
+
+    const uint64_t signature = computeShadowMapSignature(shadowMap, renderableData, range,
+            visibilityMask);
+    const bool cached = atlasImported && signature && signature == cachedSignature;
+    cachedSignature = signature;
+    return cached;
+}
+
+uint64_t ShadowMapManager::computeShadowMapSignature(ShadowMap const& shadowMap,
+        FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+        FScene::VisibleMaskType visibilityMask) noexcept {
+
+    // Two independent 32-bits hashes of everything the content of the shadow map depends on,
+    // that we can observe.
+    uint32_t lo = 0x9e3779b9u;
+    uint32_t hi = 0x85ebca6bu;
+    auto add = [&lo, &hi](auto const& value) {
+        static_assert(sizeof(value) % sizeof(uint32_t) == 0);
+        auto const* const words = reinterpret_cast<uint32_t const*>(&value);
+        lo = utils::hash::murmur3(words, sizeof(value) / sizeof(uint32_t), lo);
+        hi = utils::hash::murmur3(words, sizeof(value) / sizeof(uint32_t), hi ^ lo);
+    };
+
+    // The shadow map itself. The light index isn't used, it changes when lights are sorted
+    // differently, but the shadow camera doesn't.
+    auto const* const options = shadowMap.getShadowOptions();
+    add(uint32_t(shadowMap.getShadowType()) | uint32_t(shadowMap.getFace()) << 8 |
+            uint32_t(shadowMap.getLayer()) << 16);
+    add(options->mapSize);
+    add(options->polygonOffsetConstant);
+    add(options->polygonOffsetSlope);
+    add(shadowMap.getViewport());
+    add(shadowMap.getScissor());
+    add(shadowMap.getCamera().getProjectionMatrix());
+    add(shadowMap.getCamera().getModelMatrix());
+
+    // and the casters it sees
+    auto const* const instances = renderableData.data<FScene::RENDERABLE_INSTANCE>();
+    auto const* const worldTransforms = renderableData.data<FScene::WORLD_TRANSFORM>();
+    auto const* const visibility = renderableData.data<FScene::VISIBILITY_STATE>();
+    auto const* const instancesInfo = renderableData.data<FScene::INSTANCES>();
+    auto const* const visibleMask = renderableData.data<FScene::VISIBLE_MASK>();
+    for (uint32_t i : range) {
+        if (!(visibleMask[i] & visibilityMask)) {
+            continue;
+        }
+        FRenderableManager::Visibility const v = visibility[i];
+        if (v.skinning || v.morphing) {
+            // the geometry can change without notice
+            return 0;
+        }
+        add(instances[i].asValue());
+        add(worldTransforms[i]);
+        add(uint32_t(reinterpret_cast<uint16_t const&>(v)));
+        add(uint32_t(instancesInfo[i].count));
+        if (FInstanceBuffer const* const buffer = instancesInfo[i].buffer) {
+            for (size_t j = 0, c = buffer->getInstanceCount(); j < c; j++) {
+                add(buffer->getLocalTransform(j));
+            }
+        }
+    }
+
+    // 0 means "no signature"
+    const uint64_t signature = uint64_t(hi) << 32 | lo;
+    return signature ? signature : 1;
+}
+
 ShadowMapManager::ShadowTechnique ShadowMapManager::updateCascadeShadowMaps(FEngine& engine,
         FView& view, CameraInfo cameraInfo, FScene::RenderableSoa& renderableData,
         FScene::LightSoa const& lightData, ShadowMap::SceneInfo sceneInfo) noexcept {
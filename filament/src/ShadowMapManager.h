@@ -175,6 +175,17 @@ private:
             FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
             FScene::LightSoa& lightData) noexcept;
 
+    bool isShadowMapCacheEnabled(FView const& view) noexcept;
+
+    bool isShadowMapCached(ShadowMap const& shadowMap, FEngine& engine, FView& view,
+            FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
+            FScene::VisibleMaskType visibilityMask, FScene::LightSoa& lightData,
+            bool atlasImported) noexcept;
+
+    static uint64_t computeShadowMapSignature(ShadowMap const& shadowMap,
+            FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+            FScene::VisibleMaskType visibilityMask) noexcept;
+
     static void updateSpotVisibilityMasks(
             uint8_t visibleLayers,
             uint8_t const* UTILS_RESTRICT layers,
@@ -228,6 +239,12 @@ private:
 
     ShadowMap::SceneInfo mSceneInfo;
 
+    // The shadow atlas kept from the previous frame when shadow map caching is used, and for
+    // each of its layers, the signature of what was last rendered into it (0 when unknown).
+    FrameGraphTexture mCachedAtlas;
+    FrameGraphTexture::Descriptor mCachedAtlasDesc;
+    std::array<uint64_t, CONFIG_MAX_SHADOW_LAYERS> mCachedLayerSignatures{};
+
     // Inline storage for all our ShadowMap objects, we can't easily use a std::array<> directly.
     // Because ShadowMap doesn't have a default ctor, and we avoid out-of-line allocations.
     // Each ShadowMap is currently 40 bytes (total of 2.5KB for 64 shadow maps)
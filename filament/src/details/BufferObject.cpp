@@ -24,6 +24,7 @@ namespace filament {
 
 struct BufferObject::BuilderDetails {
     BindingType mBindingType = BindingType::VERTEX;
+    BufferUsage mUsage = BufferUsage::STATIC;
     uint32_t mByteCount = 0;
 };
 
@@ -45,6 +46,11 @@ BufferObject::Builder& BufferObject::Builder::bindingType(BindingType bindingTyp
     return *this;
 }
 
+BufferObject::Builder& BufferObject::Builder::usage(BufferUsage usage) noexcept {
+    mImpl->mUsage = usage;
+    return *this;
+}
+
 BufferObject* BufferObject::Builder::build(Engine& engine) {
     return downcast(engine).createBufferObject(*this);
 }
@@ -55,7 +61,7 @@ FBufferObject::FBufferObject(FEngine& engine, const BufferObject::Builder& build
         : mByteCount(builder->mByteCount), mBindingType(builder->mBindingType) {
     FEngine::DriverApi& driver = engine.getDriverApi();
     mHandle = driver.createBufferObject(builder->mByteCount, builder->mBindingType,
-            backend::BufferUsage::STATIC);
+            builder->mUsage);
 }
 
 void FBufferObject::terminate(FEngine& engine) {
@@ -33,6 +33,7 @@
 #include <utils/Mutex.h>
 #include <utils/Systrace.h>
 
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <mutex>
@@ -59,6 +60,11 @@ struct ColorGrading::BuilderDetails {
 
     bool hasAdjustments = false;
 
+    // Generate the LUT on the JobSystem without waiting for it in build()
+    bool asynchronous = false;
+    // Set by build() when it allocated the fallback tone mapper of an asynchronous build
+    bool ownsToneMapper = false;
+
     // Everything below must be part of the == comparison operator
     LutFormat format = LutFormat::INTEGER;
     uint8_t dimension = 32;
@@ -268,6 +274,11 @@ ColorGrading::Builder& ColorGrading::Builder::outputColorSpace(
     return *this;
 }
 
+ColorGrading::Builder& ColorGrading::Builder::asynchronous(bool enabled) noexcept {
+    mImpl->asynchronous = enabled;
+    return *this;
+}
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
 ColorGrading* ColorGrading::Builder::build(Engine& engine) {
@@ -299,11 +310,18 @@ ColorGrading* ColorGrading::Builder::build(Engine& engine) {
         }
     }
 
+    // An asynchronous LUT still needs the tone mapper after build() returns, in that case the
+    // FColorGrading takes ownership of the fallback tone mapper and deletes it once uploaded.
+    mImpl->ownsToneMapper = needToneMapper && mImpl->asynchronous;
+
     FColorGrading* colorGrading = downcast(engine).createColorGrading(*this);
 
     if (needToneMapper) {
-        delete mImpl->toneMapper;
+        if (!mImpl->ownsToneMapper) {
+            delete mImpl->toneMapper;
+        }
         mImpl->toneMapper = nullptr;
+        mImpl->ownsToneMapper = false;
     }
 
     return colorGrading;
@@ -637,21 +655,40 @@ struct Config {
     ColorTransform oetf;
 };
 
+// State of a LUT generation, it outlives the FColorGrading constructor when the LUT is
+// generated asynchronously.
+struct FColorGrading::LutJob {
+    explicit LutJob(const Builder& builder) noexcept : builder(builder) { }
+
+    Builder builder;
+    Config c;
+    // This lock protects the data inside Config, which is written to by the Filament thread,
+    // and read from multiple Job threads.
+    utils::Mutex configLock;
+
+    void* data = nullptr;
+    void* converted = nullptr;
+    size_t lutElementCount = 0;
+    TextureFormat textureFormat{};
+    PixelDataFormat format{};
+    PixelDataType type{};
+
+    JobSystem::Job* slices = nullptr;
+    // number of slices still being generated, lets isReady() poll without blocking
+    std::atomic<uint32_t> pendingSlices{ 0 };
+};
+
 // Inside the FColorGrading constructor, TSAN sporadically detects a data race on the config struct;
 // the Filament thread writes and the Job thread reads. In practice there should be no data race, so
 // we force TSAN off to silence the warning.
 UTILS_NO_SANITIZE_THREAD
-FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
+FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) : mEngine(engine) {
     SYSTRACE_CALL();
 
-    DriverApi& driver = engine.getDriverApi();
-
-    Config c;
-    // This lock protects the data inside Config, which is written to by the Filament thread,
-    // and read from multiple Job threads.
-    utils::Mutex configLock;
+    LutJob* const lut = new LutJob(builder);
+    Config& c = lut->c;
     {
-        std::lock_guard<utils::Mutex> const lock(configLock);
+        std::lock_guard<utils::Mutex> const lock(lut->configLock);
         c.lutDimension          = builder->dimension;
         c.adaptationTransform   = adaptationTransform(builder->whiteBalance);
         c.colorGradingIn        = selectColorGradingTransformIn(builder->toneMapping);
@@ -662,18 +699,16 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
 
     mDimension = c.lutDimension;
 
-    size_t lutElementCount = c.lutDimension * c.lutDimension * c.lutDimension;
-    size_t elementSize = sizeof(half4);
-    void* data = malloc(lutElementCount * elementSize);
+    lut->lutElementCount = c.lutDimension * c.lutDimension * c.lutDimension;
+    lut->data = malloc(lut->lutElementCount * sizeof(half4));
 
-    auto [textureFormat, format, type] = selectLutTextureParams(builder->format);
-    assert_invariant(FTexture::isTextureFormatSupported(engine, textureFormat));
-    assert_invariant(FTexture::validatePixelFormatAndType(textureFormat, format, type));
+    std::tie(lut->textureFormat, lut->format, lut->type) = selectLutTextureParams(builder->format);
+    assert_invariant(FTexture::isTextureFormatSupported(engine, lut->textureFormat));
+    assert_invariant(FTexture::validatePixelFormatAndType(lut->textureFormat, lut->format, lut->type));
 
-    void* converted = nullptr;
-    if (type == PixelDataType::UINT_2_10_10_10_REV) {
+    if (lut->type == PixelDataType::UINT_2_10_10_10_REV) {
         // convert input to UINT_2_10_10_10_REV if needed
-        converted = malloc(lutElementCount * sizeof(uint32_t));
+        lut->converted = malloc(lut->lutElementCount * sizeof(uint32_t));
     }
 
     //auto now = std::chrono::steady_clock::now();
@@ -683,14 +718,18 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
     // This takes about 3-6ms on Android in Release
     JobSystem& js = engine.getJobSystem();
     auto *slices = js.createJob();
+    lut->pendingSlices.store(uint32_t(c.lutDimension), std::memory_order_relaxed);
     for (size_t b = 0; b < c.lutDimension; b++) {
         auto *job = js.createJob(slices,
-                [data, converted, b, &c, &configLock, builder](JobSystem&, JobSystem::Job*) {
+                [lut, b](JobSystem&, JobSystem::Job*) {
             Config config;
             {
-                std::lock_guard<utils::Mutex> lock(configLock);
-                config = c;
+                std::lock_guard<utils::Mutex> lock(lut->configLock);
+                config = lut->c;
             }
+            const Builder& builder = lut->builder;
+            void* const data = lut->data;
+            void* const converted = lut->converted;
             half4* UTILS_RESTRICT p = (half4*) data + b * config.lutDimension * config.lutDimension;
             for (size_t g = 0; g < config.lutDimension; g++) {
                 for (size_t r = 0; r < config.lutDimension; r++) {
@@ -711,7 +750,7 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
                     }
 
                     // Move to color grading color space
-                    v = c.colorGradingIn * v;
+                    v = config.colorGradingIn * v;
 
                     if (builder->hasAdjustments) {
                         // White balance
@@ -724,7 +763,7 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
                         v = channelMixer(v, builder->outRed, builder->outGreen, builder->outBlue);
 
                         // Shadows/mid-tones/highlights
-                        v = tonalRanges(v, c.colorGradingLuminance,
+                        v = tonalRanges(v, config.colorGradingLuminance,
                                 builder->shadows, builder->midtones, builder->highlights,
                                 builder->tonalRanges);
 
@@ -741,10 +780,10 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
                         v = LogC_to_linear(v);
 
                         // Vibrance in linear space
-                        v = vibrance(v, c.colorGradingLuminance, builder->vibrance);
+                        v = vibrance(v, config.colorGradingLuminance, builder->vibrance);
 
                         // Saturation in linear space
-                        v = saturation(v, c.colorGradingLuminance, builder->saturation);
+                        v = saturation(v, config.colorGradingLuminance, builder->saturation);
 
                         // Kill negative values before curves
                         v = max(v, 0.0f);
@@ -756,13 +795,13 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
 
                     // Tone mapping
                     if (builder->luminanceScaling) {
-                        v = luminanceScaling(v, *builder->toneMapper, c.colorGradingLuminance);
+                        v = luminanceScaling(v, *builder->toneMapper, config.colorGradingLuminance);
                     } else {
                         v = (*builder->toneMapper)(v);
                     }
 
                     // Go back to display color space
-                    v = c.colorGradingOut * v;
+                    v = config.colorGradingOut * v;
 
                     // Apply gamut mapping
                     if (builder->gamutMapping) {
@@ -778,7 +817,7 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
                     v = saturate(v);
 
                     // Apply OETF
-                    v = c.oetf(v);
+                    v = config.oetf(v);
 
                     *p++ = half4{v, 0.0f};
                 }
@@ -802,21 +841,43 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
                 }
             }
 
+            lut->pendingSlices.fetch_sub(1, std::memory_order_release);
         });
         js.run(job);
     }
 
-    // TODO: Should we do a runAndRetain() and defer the wait() + texture creation until
-    //       getHwHandle() is invoked?
+    mLutJob = lut;
+    if (builder->asynchronous) {
+        // The wait() and the texture creation are deferred until isReady() or getHwHandle()
+        lut->slices = js.runAndRetain(slices);
+        return;
+    }
+
     js.runAndWait(slices);
 
     //std::chrono::duration<float, std::milli> duration = std::chrono::steady_clock::now() - now;
     //slog.d << "LUT generation time: " << duration.count() << " ms" << io::endl;
 
+    finalize();
+}
+
+FColorGrading::~FColorGrading() noexcept = default;
+
+void FColorGrading::finalize() const noexcept {
+    LutJob* const lut = mLutJob;
+    assert_invariant(lut);
+
+    if (lut->slices) {
+        mEngine.getJobSystem().waitAndRelease(lut->slices);
+    }
+
+    const Config& c = lut->c;
+    DriverApi& driver = mEngine.getDriverApi();
+
     mLutHandle = driver.createTexture(
             SamplerType::SAMPLER_3D,
             1,
-            textureFormat,
+            lut->textureFormat,
             1,
             c.lutDimension,
             c.lutDimension,
@@ -824,9 +885,11 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
             TextureUsage::DEFAULT
     );
 
-    if (converted) {
+    void* data = lut->data;
+    size_t elementSize = sizeof(half4);
+    if (lut->converted) {
         free(data);
-        data = converted;
+        data = lut->converted;
         elementSize = sizeof(uint32_t);
     }
 
@@ -834,17 +897,43 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
             0, 0, 0,
             c.lutDimension, c.lutDimension, c.lutDimension,
             PixelBufferDescriptor{
-                    data, lutElementCount * elementSize,format, type,
+                    data, lut->lutElementCount * elementSize, lut->format, lut->type,
                     [](void* buffer, size_t, void*) { free(buffer); }
             }
     );
+
+    if (lut->builder->ownsToneMapper) {
+        delete lut->builder->toneMapper;
+    }
+
+    delete lut;
+    mLutJob = nullptr;
 }
 
-FColorGrading::~FColorGrading() noexcept = default;
+bool FColorGrading::isReady() const noexcept {
+    if (UTILS_LIKELY(!mLutJob)) {
+        return true;
+    }
+    if (mLutJob->pendingSlices.load(std::memory_order_acquire) != 0) {
+        return false;
+    }
+    // all slices are done, only the (empty) parent job may still be finishing
+    finalize();
+    return true;
+}
 
 void FColorGrading::terminate(FEngine& engine) {
+    if (mLutJob) {
+        finalize();
+    }
     DriverApi& driver = engine.getDriverApi();
     driver.destroyTexture(mLutHandle);
 }
 
+// ------------------------------------------------------------------------------------------------
+
+bool ColorGrading::isReady() const noexcept {
+    return downcast(this)->isReady();
+}
+
 } //namespace filament
@@ -26,6 +26,8 @@
 
 #include <math/mathfwd.h>
 
+#include <utils/compiler.h>
+
 namespace filament {
 
 class FEngine;
@@ -41,12 +43,27 @@ public:
     // frees driver resources, object becomes invalid
     void terminate(FEngine& engine);
 
-    backend::TextureHandle getHwHandle() const noexcept { return mLutHandle; }
+    bool isReady() const noexcept;
+
+    // waits for the LUT generation if it's still in flight
+    backend::TextureHandle getHwHandle() const noexcept {
+        if (UTILS_UNLIKELY(mLutJob)) {
+            finalize();
+        }
+        return mLutHandle;
+    }
 
     uint32_t getDimension() const noexcept { return mDimension; }
 
 private:
-    backend::TextureHandle mLutHandle;
+    struct LutJob;
+
+    // waits for the LUT generation and uploads it, must be called on the engine thread
+    void finalize() const noexcept;
+
+    FEngine& mEngine;
+    mutable LutJob* mLutJob = nullptr;
+    mutable backend::TextureHandle mLutHandle;
     uint32_t mDimension;
 };
 
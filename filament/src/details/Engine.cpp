@@ -73,6 +73,8 @@ struct Engine::BuilderDetails {
     FeatureLevel mFeatureLevel = FeatureLevel::FEATURE_LEVEL_1;
     void* mSharedContext = nullptr;
     bool mPaused = false;
+    utils::CString mCommandCapturePath;
+    uint32_t mCommandCaptureFrameCount = 0;
     static Config validateConfig(Config config) noexcept;
 };
 
@@ -201,6 +203,8 @@ FEngine::FEngine(Engine::Builder const& builder) :
         mActiveFeatureLevel(builder->mFeatureLevel),
         mPlatform(builder->mPlatform),
         mSharedGLContext(builder->mSharedContext),
+        mCommandCapturePath(builder->mCommandCapturePath),
+        mCommandCaptureFrameCount(builder->mCommandCaptureFrameCount),
         mPostProcessManager(*this),
         mEntityManager(EntityManager::get()),
         mRenderableManager(*this),
@@ -255,6 +259,12 @@ void FEngine::init() {
 
     DriverApi& driverApi = getDriverApi();
 
+    if (!mCommandCapturePath.empty()) {
+        mCommandStreamRecorder = std::make_unique<CommandStreamRecorder>(
+                mCommandCapturePath.c_str(), mBackend, mCommandCaptureFrameCount);
+        driverApi.setRecorder(mCommandStreamRecorder.get());
+    }
+
     mActiveFeatureLevel = std::min(mActiveFeatureLevel, driverApi.getFeatureLevel());
 
 #ifndef FILAMENT_ENABLE_FEATURE_LEVEL_0
@@ -452,10 +462,14 @@ void FEngine::shutdown() {
 
 #ifndef NDEBUG
     // print out some statistics about this run
-    size_t const wm = mCommandBufferQueue.getHighWatermark();
+    auto const metrics = mCommandBufferQueue.getMetrics();
+    size_t const wm = metrics.highWatermark;
     size_t const wmpct = wm / (getCommandBufferSize() / 100);
     slog.d << "CircularBuffer: High watermark "
-           << wm / 1024 << " KiB (" << wmpct << "%)" << io::endl;
+           << wm / 1024 << " KiB (" << wmpct << "%), "
+           << metrics.stallCount << " stalls, "
+           << metrics.overflowCount << " overflows (largest "
+           << metrics.overflowHighWatermark / 1024 << " KiB)" << io::endl;
 #endif
 
     DriverApi& driver = getDriverApi();
@@ -546,6 +560,10 @@ void FEngine::shutdown() {
     // These callbacks CANNOT call driver APIs.
     getDriver().purge();
 
+    // the capture ends here if it didn't reach its frame count
+    getDriverApi().setRecorder(nullptr);
+    mCommandStreamRecorder.reset();
+
     // and destroy the CommandStream
     std::destroy_at(std::launder(reinterpret_cast<DriverApi*>(&mDriverApiStorage)));
 
@@ -1252,6 +1270,19 @@ void FEngine::destroy(FEngine* engine) {
     }
 }
 
+Engine::CommandBufferStats FEngine::getCommandBufferStats() const noexcept {
+    auto const metrics = mCommandBufferQueue.getMetrics();
+    return {
+            .bufferSize = metrics.bufferSize,
+            .used = metrics.used,
+            .highWatermark = metrics.highWatermark,
+            .overflowHighWatermark = metrics.overflowHighWatermark,
+            .pendingBuffers = metrics.pendingBuffers,
+            .overflowCount = metrics.overflowCount,
+            .stallCount = metrics.stallCount,
+    };
+}
+
 bool FEngine::isPaused() const noexcept {
     return mCommandBufferQueue.isPaused();
 }
@@ -1325,6 +1356,12 @@ Engine::Builder& Engine::Builder::paused(bool paused) noexcept {
     return *this;
 }
 
+Engine::Builder& Engine::Builder::commandCapture(const char* path, uint32_t frameCount) noexcept {
+    mImpl->mCommandCapturePath = path ? CString(path) : CString();
+    mImpl->mCommandCaptureFrameCount = frameCount;
+    return *this;
+}
+
 #if UTILS_HAS_THREADING
 
 void Engine::Builder::build(Invocable<void(void*)>&& callback) const {
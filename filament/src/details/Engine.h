@@ -44,6 +44,7 @@
 
 #include "private/backend/CommandBufferQueue.h"
 #include "private/backend/CommandStream.h"
+#include "private/backend/CommandStreamRecorder.h"
 #include "private/backend/DriverApi.h"
 
 #include <private/filament/EngineEnums.h>
@@ -61,6 +62,7 @@
 
 #include <utils/Allocator.h>
 #include <utils/CountDownLatch.h>
+#include <utils/CString.h>
 #include <utils/FixedCapacityVector.h>
 #include <utils/JobSystem.h>
 #include <utils/compiler.h>
@@ -373,6 +375,7 @@ public:
     void destroy(utils::Entity e);
 
     bool isPaused() const noexcept;
+    CommandBufferStats getCommandBufferStats() const noexcept;
     void setPaused(bool paused);
 
     void flushAndWait();
@@ -502,6 +505,9 @@ private:
     bool mOwnPlatform = false;
     bool mAutomaticInstancingEnabled = false;
     void* mSharedGLContext = nullptr;
+    utils::CString mCommandCapturePath;
+    uint32_t mCommandCaptureFrameCount = 0;
+    std::unique_ptr<backend::CommandStreamRecorder> mCommandStreamRecorder;
     backend::Handle<backend::HwRenderPrimitive> mFullScreenTriangleRph;
     FVertexBuffer* mFullScreenTriangleVb = nullptr;
     FIndexBuffer* mFullScreenTriangleIb = nullptr;
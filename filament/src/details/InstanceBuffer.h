@@ -41,6 +41,10 @@ public:
 
     inline size_t getInstanceCount() const noexcept { return mInstanceCount; }
 
+    math::mat4f const& getLocalTransform(size_t index) const noexcept {
+        return mLocalTransforms[index];
+    }
+
     void setLocalTransforms(math::mat4f const* localTransforms, size_t count, size_t offset);
 
     void prepare(FEngine& engine, math::mat4f rootTransform, const PerRenderableData& ubo,
@@ -234,6 +234,13 @@ private:
     template<typename T>
     T getParameterImpl(std::string_view name) const;
 
+    template<typename T>
+    void setParameterAtImpl(int32_t offset, T const& value) noexcept {
+        if (UTILS_LIKELY(offset >= 0)) {
+            mUniforms.setUniform(size_t(offset), value);
+        }
+    }
+
     // initialize the default instance
     FMaterialInstance(FEngine& engine, FMaterial const* material) noexcept;
 
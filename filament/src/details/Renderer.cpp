@@ -188,6 +188,17 @@ void FRenderer::resetUserTime() {
     mUserEpoch = std::chrono::steady_clock::now();
 }
 
+Renderer::TransientMemoryStats FRenderer::getTransientMemoryStats() const noexcept {
+    ResourceAllocator::MemoryStats const stats = mResourceAllocator->getMemoryStats();
+    return {
+            .inUse = stats.inUse,
+            .inUsePeak = stats.inUsePeak,
+            .cached = stats.cached,
+            .cachedPeak = stats.cachedPeak,
+            .totalPeak = stats.totalPeak,
+    };
+}
+
 TextureFormat FRenderer::getHdrFormat(const FView& view, bool translucent) const noexcept {
     if (translucent) {
         return mHdrTranslucent;
@@ -1316,7 +1327,7 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
 
     fg.present(fgViewRenderTarget);
 
-    fg.compile();
+    fg.compile(&view.getFrameGraphCompileCache());
 
     //fg.export_graphviz(slog.d, view.getName());
 
@@ -155,6 +155,8 @@ public:
         return MAX_FRAMETIME_HISTORY;
     }
 
+    Renderer::TransientMemoryStats getTransientMemoryStats() const noexcept;
+
 private:
     friend class Renderer;
     using Command = RenderPass::Command;
@@ -79,6 +79,7 @@ private:
     AttributeBitset mDeclaredAttributes;
     uint32_t mVertexCount = 0;
     uint8_t mBufferCount = 0;
+    BufferUsage mUsage = BufferUsage::STATIC;
     bool mBufferObjectsEnabled = false;
     bool mAdvancedSkinningEnabled = false;
 };
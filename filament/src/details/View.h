@@ -33,6 +33,8 @@
 #include "ShadowMapManager.h"
 #include "TypedUniformBuffer.h"
 
+#include "fg/FrameGraph.h"
+
 #include "details/Camera.h"
 #include "details/ColorGrading.h"
 #include "details/RenderTarget.h"
@@ -417,6 +419,12 @@ public:
     FrameHistory& getFrameHistory() noexcept { return mFrameHistory; }
     FrameHistory const& getFrameHistory() const noexcept { return mFrameHistory; }
 
+    // Returns the results of the last FrameGraph compilation for this view, they're reused
+    // when the next frame declares the same passes.
+    FrameGraph::CompileCache& getFrameGraphCompileCache() noexcept {
+        return mFrameGraphCompileCache;
+    }
+
     // Clean-up the oldest frame and save the current frame information.
     // This is typically called after all operations for this View's rendering are complete.
     // (e.g.: after the FrameGraph execution).
@@ -552,6 +560,8 @@ private:
 
     mutable FrameHistory mFrameHistory{};
 
+    FrameGraph::CompileCache mFrameGraphCompileCache;
+
     FPickingQuery* mActivePickingQueriesList = nullptr;
 
     utils::CString mName;
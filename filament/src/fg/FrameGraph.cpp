@@ -116,14 +116,65 @@ void FrameGraph::reset() noexcept {
     mResourceSlots.clear();
 }
 
-FrameGraph& FrameGraph::compile() noexcept {
+bool FrameGraph::CompileCache::update(FrameGraph const& fg) noexcept {
+    // The structure of the graph: everything culling and the resources lifetimes depend on.
+    // Node ids are allocated in declaration order, so equal keys mean identical graphs.
+    DependencyGraph const& dependencyGraph = fg.mGraph;
+    auto const& nodes = dependencyGraph.getNodes();
+    auto const& edges = dependencyGraph.getEdges();
+    std::vector<uint32_t>& key = mScratchKey;
+    key.clear();
+    key.reserve(3 + nodes.size() + fg.mPassNodes.size() + fg.mResourceNodes.size() * 2 +
+            edges.size() * 2);
+    key.push_back(nodes.size());
+    key.push_back(fg.mPassNodes.size());
+    key.push_back(edges.size());
+    for (auto const* pNode : nodes) {
+        key.push_back(pNode->isTarget());
+    }
+    for (auto const* pPassNode : fg.mPassNodes) {
+        key.push_back(pPassNode->getId());
+    }
+    for (auto const* pResourceNode : fg.mResourceNodes) {
+        key.push_back(pResourceNode->getId());
+        key.push_back(uint32_t(uint16_t(pResourceNode->resourceHandle.index)) << 16 |
+                pResourceNode->resourceHandle.version);
+    }
+    for (auto const* pEdge : edges) {
+        key.push_back(pEdge->from);
+        key.push_back(pEdge->to);
+    }
+
+    if (!mRefCounts.empty() && key == mKey) {
+        mHitCount++;
+        return true;
+    }
+    std::swap(mKey, mScratchKey);
+    mRefCounts.clear();
+    mRegistrations.clear();
+    mMissCount++;
+    return false;
+}
+
+FrameGraph& FrameGraph::compile(CompileCache* cache) noexcept {
 
     SYSTRACE_CALL();
 
     DependencyGraph& dependencyGraph = mGraph;
 
+    // when the graph is the same as the one the cache was filled with, we skip culling and
+    // reuse the resources each active pass registered the last time.
+    const bool cached = cache && cache->update(*this);
+
     // first we cull unreachable nodes
-    dependencyGraph.cull();
+    if (cached) {
+        dependencyGraph.setRefCounts(cache->mRefCounts);
+    } else {
+        dependencyGraph.cull();
+        if (cache) {
+            dependencyGraph.getRefCounts(cache->mRefCounts);
+        }
+    }
 
     /*
      * update the reference counter of the resource themselves and
@@ -137,30 +188,57 @@ FrameGraph& FrameGraph::compile() noexcept {
 
     auto first = mPassNodes.begin();
     const auto activePassNodesEnd = mActivePassNodesEnd;
-    while (first != activePassNodesEnd) {
-        PassNode* const passNode = *first;
-        first++;
-        assert_invariant(!passNode->isCulled());
-
+    if (cached) {
+        // registrations are stored as the number of resources of each pass, then their nodes
+        uint32_t const* pRegistration = cache->mRegistrations.data();
+        while (first != activePassNodesEnd) {
+            PassNode* const passNode = *first;
+            first++;
+            assert_invariant(!passNode->isCulled());
+
+            uint32_t const count = *pRegistration++;
+            for (uint32_t i = 0; i < count; i++) {
+                auto pNode = static_cast<ResourceNode*>(dependencyGraph.getNode(*pRegistration++));
+                passNode->registerResource(pNode->resourceHandle);
+            }
 
-        auto const& reads = dependencyGraph.getIncomingEdges(passNode);
-        for (auto const& edge : reads) {
-            // all incoming edges should be valid by construction
-            assert_invariant(dependencyGraph.isEdgeValid(edge));
-            auto pNode = static_cast<ResourceNode*>(dependencyGraph.getNode(edge->from));
-            passNode->registerResource(pNode->resourceHandle);
+            passNode->resolve();
         }
+    } else {
+        while (first != activePassNodesEnd) {
+            PassNode* const passNode = *first;
+            first++;
+            assert_invariant(!passNode->isCulled());
+
+            auto const& reads = dependencyGraph.getIncomingEdges(passNode);
+            auto const& writes = dependencyGraph.getOutgoingEdges(passNode);
+            if (cache) {
+                cache->mRegistrations.push_back(reads.size() + writes.size());
+            }
 
-        auto const& writes = dependencyGraph.getOutgoingEdges(passNode);
-        for (auto const& edge : writes) {
-            // An outgoing edge might be invalid if the node it points to has been culled
-            // but because we are not culled, and we're a pass we add a reference to
-            // the resource we are writing to.
-            auto pNode = static_cast<ResourceNode*>(dependencyGraph.getNode(edge->to));
-            passNode->registerResource(pNode->resourceHandle);
-        }
+            for (auto const& edge : reads) {
+                // all incoming edges should be valid by construction
+                assert_invariant(dependencyGraph.isEdgeValid(edge));
+                auto pNode = static_cast<ResourceNode*>(dependencyGraph.getNode(edge->from));
+                passNode->registerResource(pNode->resourceHandle);
+                if (cache) {
+                    cache->mRegistrations.push_back(edge->from);
+                }
+            }
 
-        passNode->resolve();
+            for (auto const& edge : writes) {
+                // An outgoing edge might be invalid if the node it points to has been culled
+                // but because we are not culled, and we're a pass we add a reference to
+                // the resource we are writing to.
+                auto pNode = static_cast<ResourceNode*>(dependencyGraph.getNode(edge->to));
+                passNode->registerResource(pNode->resourceHandle);
+                if (cache) {
+                    cache->mRegistrations.push_back(edge->to);
+                }
+            }
+
+            passNode->resolve();
+        }
     }
 
     // add resource to de-virtualize or destroy to the corresponding list for each active pass
@@ -35,6 +35,7 @@
 #include <backend/Handle.h>
 
 #include <functional>
+#include <vector>
 
 namespace filament {
 
@@ -285,11 +286,38 @@ public:
     template<typename Execute>
     void addTrivialSideEffectPass(const char* name, Execute&& execute);
 
+    /**
+     * Results of compile() kept from one FrameGraph to the next, typically one per View.
+     * When a FrameGraph declares the same passes, resources and dependencies as the one the
+     * cache was last used with, its culling and the resources each pass needs are reused
+     * instead of being computed again.
+     */
+    class CompileCache {
+    public:
+        //! number of compile() calls that reused the cached results
+        uint32_t getHitCount() const noexcept { return mHitCount; }
+
+        //! number of compile() calls that had to compute the results
+        uint32_t getMissCount() const noexcept { return mMissCount; }
+
+    private:
+        friend class FrameGraph;
+        // returns whether fg has the structure of the cached results, or resets them.
+        bool update(FrameGraph const& fg) noexcept;
+        std::vector<uint32_t> mKey;             // structure of the graph the results are for
+        std::vector<uint32_t> mScratchKey;      // structure of the graph being compiled
+        std::vector<uint32_t> mRefCounts;       // reference count of each node after culling
+        std::vector<uint32_t> mRegistrations;   // for each active pass, a count then the nodes
+        uint32_t mHitCount = 0;
+        uint32_t mMissCount = 0;
+    };
+
     /**
      * Allocates concrete resources and culls unreferenced passes.
+     * @param cache optional results of a previous compile(), updated if they can't be used.
      * @return a reference to the FrameGraph, for chaining calls.
      */
-    FrameGraph& compile() noexcept;
+    FrameGraph& compile(CompileCache* cache = nullptr) noexcept;
 
     /**
      * Execute all referenced passes
@@ -163,6 +163,12 @@ public:
     //! cull unreferenced nodes. Links ARE NOT removed, only reference counts are updated.
     void cull() noexcept;
 
+    //! copy the reference counts computed by cull(), indexed by NodeID
+    void getRefCounts(std::vector<uint32_t>& refCounts) const noexcept;
+
+    //! set the reference counts from getRefCounts() of an identical graph, instead of cull()
+    void setRefCounts(std::vector<uint32_t> const& refCounts) noexcept;
+
     /**
      * Return whether an edge is valid, that is if both ends are connected to nodes
      * that are not culled. Valid only after cull() is called.
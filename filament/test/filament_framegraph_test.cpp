@@ -951,3 +951,145 @@ TEST_F(FrameGraphTest, WriteResourceReadAsAttachment) {
 
     fg.execute(driverApi);
 }
+
+TEST_F(FrameGraphTest, CompileCache) {
+    struct PassData {
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    FrameGraph::CompileCache cache;
+
+    auto declare = [](FrameGraph& fg, bool extraPass) {
+        auto& pass = fg.addPass<PassData>("Pass", [&](FrameGraph::Builder& builder, auto& data) {
+                    data.output = builder.create<FrameGraphTexture>("Output buffer", {.width=16, .height=32});
+                    data.output = builder.write(data.output, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                },
+                [=](FrameGraphResources const& resources, auto const& data, backend::DriverApi&) {
+                    EXPECT_TRUE(resources.get(data.output).handle);
+                    EXPECT_EQ(resources.getUsage(data.output), FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                });
+
+        // never consumed, this pass is culled
+        auto& culledPass = fg.addPass<PassData>("Culled Pass", [&](FrameGraph::Builder& builder, auto& data) {
+                    data.output = builder.create<FrameGraphTexture>("Unused buffer", {.width=16, .height=32});
+                    data.output = builder.write(data.output, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                },
+                [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {
+                    ADD_FAILURE();
+                });
+
+        if (extraPass) {
+            fg.addTrivialSideEffectPass("Extra Pass", [](backend::DriverApi&) {});
+        }
+
+        fg.present(pass->output);
+        return std::make_pair(&pass, &culledPass);
+    };
+
+    for (size_t i = 0; i < 3; i++) {
+        // the third graph has a different structure, it can't use the cache
+        FrameGraph fg{ resourceAllocator };
+        auto [pass, culledPass] = declare(fg, i == 2);
+        fg.compile(&cache);
+
+        EXPECT_FALSE(fg.isCulled(*pass));
+        EXPECT_TRUE(fg.isCulled(*culledPass));
+
+        fg.execute(driverApi);
+    }
+
+    EXPECT_EQ(cache.getMissCount(), 2);
+    EXPECT_EQ(cache.getHitCount(), 1);
+}
+
+TEST_F(FrameGraphTest, ResourceAllocatorReuse) {
+    ResourceAllocator allocator(Engine::Config{}, driverApi);
+
+    auto createTexture = [&allocator](TextureUsage usage) {
+        using TS = TextureSwizzle;
+        return allocator.createTexture("Texture", SamplerType::SAMPLER_2D, 1,
+                TextureFormat::RGBA8, 1, 16, 32, 1,
+                { TS::CHANNEL_0, TS::CHANNEL_1, TS::CHANNEL_2, TS::CHANNEL_3 }, usage);
+    };
+
+    TextureHandle const sampleable =
+            createTexture(TextureUsage::COLOR_ATTACHMENT | TextureUsage::SAMPLEABLE);
+    EXPECT_EQ(allocator.getMemoryStats().inUse, 16 * 32 * 4);
+    allocator.destroyTexture(sampleable);
+    EXPECT_EQ(allocator.getMemoryStats().inUse, 0);
+    EXPECT_EQ(allocator.getMemoryStats().cached, 16 * 32 * 4);
+
+    // an attachment that is never sampled can use the cached sampleable texture...
+    TextureHandle const attachment = createTexture(TextureUsage::COLOR_ATTACHMENT);
+    EXPECT_EQ(attachment, sampleable);
+    EXPECT_EQ(allocator.getMemoryStats().cached, 0);
+
+    // ...and it goes back to the cache as a sampleable texture
+    allocator.destroyTexture(attachment);
+    TextureHandle const blittable =
+            createTexture(TextureUsage::COLOR_ATTACHMENT | TextureUsage::BLIT_SRC);
+    EXPECT_NE(blittable, sampleable);
+    TextureHandle const reused =
+            createTexture(TextureUsage::COLOR_ATTACHMENT | TextureUsage::SAMPLEABLE);
+    EXPECT_EQ(reused, sampleable);
+
+    EXPECT_EQ(allocator.getMemoryStats().inUse, 2 * 16 * 32 * 4);
+    EXPECT_EQ(allocator.getMemoryStats().inUsePeak, 2 * 16 * 32 * 4);
+    EXPECT_EQ(allocator.getMemoryStats().totalPeak, 2 * 16 * 32 * 4);
+
+    allocator.destroyTexture(blittable);
+    allocator.destroyTexture(reused);
+    allocator.terminate();
+}
+
+TEST_F(FrameGraphTest, ResourceAllocatorCacheSize) {
+    auto createTexture = [](ResourceAllocator& allocator, uint32_t size) {
+        using TS = TextureSwizzle;
+        return allocator.createTexture("Texture", SamplerType::SAMPLER_2D, 1,
+                TextureFormat::RGBA8, 1, size, size, 1,
+                { TS::CHANNEL_0, TS::CHANNEL_1, TS::CHANNEL_2, TS::CHANNEL_3 },
+                TextureUsage::COLOR_ATTACHMENT);
+    };
+    size_t const size = 512 * 512 * 4; // 1 MiB
+
+    Engine::Config config;
+    config.resourceAllocatorCacheMaxAge = 10;
+
+    // by default the cache has no size limit
+    {
+        ResourceAllocator allocator(config, driverApi);
+        TextureHandle const a = createTexture(allocator, 512);
+        TextureHandle const b = createTexture(allocator, 512);
+        allocator.destroyTexture(a);
+        allocator.destroyTexture(b);
+        allocator.gc();
+        allocator.gc();
+        EXPECT_EQ(allocator.getMemoryStats().cached, 2 * size);
+        allocator.terminate();
+    }
+
+    config.resourceAllocatorCacheSizeMB = 1;
+    {
+        ResourceAllocator allocator(config, driverApi);
+        TextureHandle const a = createTexture(allocator, 512);
+        TextureHandle const b = createTexture(allocator, 512);
+        allocator.destroyTexture(a);
+        allocator.destroyTexture(b);
+
+        // a texture of another shape doesn't reuse them
+        TextureHandle const c = createTexture(allocator, 256);
+        EXPECT_NE(c, a);
+        EXPECT_NE(c, b);
+        allocator.destroyTexture(c);
+        EXPECT_EQ(allocator.getMemoryStats().cached, 2 * size + size / 4);
+
+        // textures released during the last frame are kept, even over the budget...
+        allocator.gc();
+        EXPECT_EQ(allocator.getMemoryStats().cached, 2 * size + size / 4);
+
+        // ...and the oldest are evicted the next frame, until the cache fits
+        allocator.gc();
+        EXPECT_LE(allocator.getMemoryStats().cached, size);
+        allocator.terminate();
+    }
+}
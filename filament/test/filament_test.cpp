@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <random>
 
@@ -35,6 +37,16 @@
 #include <private/filament/BufferInterfaceBlock.h>
 #include <private/filament/UibStructs.h>
 #include <private/backend/BackendUtils.h>
+#include <private/backend/CommandBufferQueue.h>
+#include <private/backend/CommandStream.h>
+#include <private/backend/CommandStreamRecorder.h>
+#include <private/backend/CommandStreamReplay.h>
+#include <private/backend/Driver.h>
+#include <private/backend/PlatformFactory.h>
+
+#include <backend/Platform.h>
+
+#include <utils/Path.h>
 
 #include "Allocators.h"
 #include "details/Material.h"
@@ -803,6 +815,155 @@ TEST(FilamentTest, GoogleLineDirective) {
     }
 }
 
+TEST(FilamentTest, CommandBufferOverflow) {
+    using namespace filament::backend;
+    size_t const blockSize = CircularBuffer::getBlockSize();
+    CommandBufferQueue queue(blockSize, blockSize * 4, false);
+    CircularBuffer& circularBuffer = queue.getCircularBuffer();
+
+    // record three times the size of the circular buffer in one go
+    constexpr size_t CHUNK_SIZE = 256;
+    std::vector<uint8_t*> chunks;
+    while (circularBuffer.getUsed() < circularBuffer.size() * 3) {
+        auto* p = static_cast<uint8_t*>(circularBuffer.allocate(CHUNK_SIZE));
+        memset(p, int(chunks.size() & 0xFF), CHUNK_SIZE);
+        chunks.push_back(p);
+    }
+    EXPECT_GE(circularBuffer.getUsed(), chunks.size() * CHUNK_SIZE);
+
+    queue.flush();
+    EXPECT_TRUE(circularBuffer.empty());
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        EXPECT_EQ(chunks[i][0], uint8_t(i & 0xFF));
+        EXPECT_EQ(chunks[i][CHUNK_SIZE - 1], uint8_t(i & 0xFF));
+    }
+
+    auto metrics = queue.getMetrics();
+    EXPECT_EQ(metrics.overflowCount, 1u);
+    EXPECT_EQ(metrics.pendingBuffers, 1u);
+    EXPECT_GE(metrics.overflowHighWatermark, circularBuffer.size());
+    EXPECT_LE(metrics.used, circularBuffer.size());
+
+    auto buffers = queue.waitForCommands();
+    ASSERT_EQ(buffers.size(), 1u);
+    EXPECT_NE(buffers[0].overflow, nullptr);
+    queue.releaseBuffer(buffers[0]);
+
+    metrics = queue.getMetrics();
+    EXPECT_EQ(metrics.used, 0u);
+    EXPECT_EQ(metrics.stallCount, 0u);
+
+    // a recording that fits doesn't spill
+    circularBuffer.allocate(CHUNK_SIZE);
+    queue.flush();
+    buffers = queue.waitForCommands();
+    ASSERT_EQ(buffers.size(), 1u);
+    EXPECT_EQ(buffers[0].overflow, nullptr);
+    queue.releaseBuffer(buffers[0]);
+    EXPECT_EQ(queue.getMetrics().overflowCount, 1u);
+}
+
+TEST(FilamentTest, CommandStreamCaptureRoundTrip) {
+    using namespace filament::backend;
+    Backend backend = Backend::NOOP;
+    Platform* platform = PlatformFactory::create(&backend);
+    ASSERT_NE(platform, nullptr);
+    Driver* const driver = platform->createDriver(nullptr, {});
+    ASSERT_NE(driver, nullptr);
+
+    std::string const path =
+            (utils::Path::getTemporaryDirectory() + "filament_test_capture.bin").getPath();
+
+    // two frames, the second one not recorded since the capture stops after the first
+    static uint8_t const data[64] = {};
+    std::vector<CapturedCommand> const expected = {
+            CapturedCommand::beginFrame,
+            CapturedCommand::createBufferObject,
+            CapturedCommand::updateBufferObject,
+            CapturedCommand::updateBufferObject,
+            CapturedCommand::destroyBufferObject,
+            CapturedCommand::endFrame,
+    };
+    {
+        CircularBuffer buffer(CircularBuffer::getBlockSize() * 4);
+        CommandStream stream(*driver, buffer);
+        CommandStreamRecorder recorder(path.c_str(), backend, 1);
+        ASSERT_TRUE(recorder.isRecording());
+        stream.setRecorder(&recorder);
+        for (uint32_t frameId = 0; frameId < 2; frameId++) {
+            stream.beginFrame(0, 0, frameId);
+            BufferObjectHandle const boh = stream.createBufferObject(
+                    sizeof(data), BufferObjectBinding::VERTEX, BufferUsage::STATIC);
+            stream.updateBufferObject(boh, { data, sizeof(data) }, 0);
+            stream.updateBufferObject(boh, { data, sizeof(data) / 2 }, sizeof(data) / 2);
+            stream.destroyBufferObject(boh);
+            stream.endFrame(frameId);
+        }
+        EXPECT_FALSE(recorder.isRecording());
+        stream.setRecorder(nullptr);
+
+        new(buffer.allocateLink()) NoopCommand(nullptr);
+        auto const [begin, end, overflow] = buffer.getBuffer();
+        stream.execute(begin);
+        buffer.recycle(overflow);
+    }
+
+    // the records are serialized in order
+    std::ifstream in(path, std::ios::binary);
+    ASSERT_TRUE(in.good());
+    CommandStreamRecorder::Header header{};
+    ASSERT_TRUE(in.read((char*)&header, sizeof(header)));
+    EXPECT_EQ(header.magic, CommandStreamRecorder::MAGIC);
+    EXPECT_EQ(header.version, CommandStreamRecorder::VERSION);
+    EXPECT_EQ(header.backend, uint32_t(Backend::NOOP));
+    EXPECT_EQ(header.frameCount, 1u);
+    std::vector<CapturedCommand> recorded;
+    CommandStreamRecorder::RecordHeader record{};
+    while (in.read((char*)&record, sizeof(record))) {
+        EXPECT_EQ(record.size % 8, 0u);
+        recorded.push_back(record.command);
+        in.seekg(record.size, std::ios::cur);
+    }
+    EXPECT_EQ(recorded, expected);
+    in.close();
+
+    // and replayed as they were recorded, every time
+    {
+        CommandStreamReplay replay(*driver);
+        ASSERT_TRUE(replay.load(path.c_str()));
+        EXPECT_EQ(replay.getFrameCount(), 1u);
+        EXPECT_EQ(replay.getCapturedBackend(), Backend::NOOP);
+        for (int i = 0; i < 2; i++) {
+            auto const stats = replay.replay(i == 1);
+            EXPECT_EQ(stats.frameNs.size(), 1u);
+            size_t total = 0;
+            for (size_t c = 0; c < stats.commands.size(); c++) {
+                size_t const count = std::count(expected.begin(), expected.end(), CapturedCommand(c));
+                EXPECT_EQ(stats.commands[c].count, count)
+                        << getCapturedCommandName(CapturedCommand(c));
+                total += stats.commands[c].count;
+            }
+            EXPECT_EQ(total, expected.size());
+        }
+    }
+
+    // a file that's not a capture is rejected
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "not a capture";
+    }
+    {
+        CommandStreamReplay replay(*driver);
+        EXPECT_FALSE(replay.load(path.c_str()));
+    }
+
+    utils::Path(path).unlinkFile();
+    driver->terminate();
+    delete driver;
+    PlatformFactory::destroy(&platform);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
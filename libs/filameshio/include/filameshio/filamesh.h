@@ -79,6 +79,28 @@ struct Part {
     Box aabb;
 };
 
+// A pack is a container of several filamesh files, e.g. the separate objects of a scene. It starts
+// with PACK_MAGICID and a PackHeader, followed by PackHeader::meshes entries. Each entry locates
+// a complete filamesh blob (starting with MAGICID) relative to the beginning of the pack; blobs
+// are aligned to PACK_ALIGNMENT so that they can be used in place when the pack is memory-mapped.
+// The entry table is followed by the mesh names, each stored as a uint32_t length and a null
+// terminated string, like the material names of a filamesh.
+static const char PACK_MAGICID[] { 'F', 'I', 'L', 'A', 'M', 'P', 'A', 'K' };
+
+static const uint32_t PACK_VERSION = 1;
+
+static const uint32_t PACK_ALIGNMENT = 16;
+
+struct PackHeader {
+    uint32_t version;
+    uint32_t meshes;
+};
+
+struct PackEntry {
+    uint64_t offset;
+    uint64_t size;
+};
+
 } // namespace filamesh
 
 #endif // TNT_FILAMENT_FILAMESHIO_FILAMESH_H
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <geometry/TangentSpaceMesh.h>
+
+#include <utils/JobSystem.h>
+
+#include <math/vec2.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace filament::geometry;
+using namespace filament::math;
+using namespace utils;
+
+namespace {
+
+using Algorithm = TangentSpaceMesh::Algorithm;
+
+// A uv sphere without its poles, with (segments + 1)^2 vertices.
+struct Sphere {
+    explicit Sphere(uint32_t segments) {
+        for (uint32_t r = 0; r <= segments; ++r) {
+            float const theta = float(M_PI) * (float(r) + 0.5f) / float(segments + 1);
+            for (uint32_t s = 0; s <= segments; ++s) {
+                float const phi = 2.0f * float(M_PI) * float(s) / float(segments);
+                float3 const p{ std::sin(theta) * std::cos(phi), std::cos(theta),
+                        std::sin(theta) * std::sin(phi) };
+                positions.push_back(p);
+                normals.push_back(p);
+                uvs.push_back({ float(s) / float(segments), float(r) / float(segments) });
+                tangents.push_back({ -std::sin(phi), 0.0f, std::cos(phi), 1.0f });
+            }
+        }
+        for (uint32_t r = 0; r < segments; ++r) {
+            for (uint32_t s = 0; s < segments; ++s) {
+                uint32_t const a = r * (segments + 1) + s;
+                uint32_t const b = a + segments + 1;
+                triangles.push_back({ a, b, a + 1 });
+                triangles.push_back({ a + 1, b, b + 1 });
+            }
+        }
+    }
+
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> uvs;
+    std::vector<float4> tangents;
+    std::vector<uint3> triangles;
+};
+
+enum class Method : int64_t {
+    FRISVAD, HUGHES_MOLLER, FLAT_SHADING, TANGENTS_PROVIDED, LENGYEL, MIKKTSPACE
+};
+
+TangentSpaceMesh* build(Sphere const& sphere, Method method, JobSystem* js) {
+    TangentSpaceMesh::Builder builder;
+    builder.vertexCount(sphere.positions.size()).jobSystem(js);
+    switch (method) {
+        case Method::FRISVAD:
+            builder.normals(sphere.normals.data()).algorithm(Algorithm::FRISVAD);
+            break;
+        case Method::HUGHES_MOLLER:
+            builder.normals(sphere.normals.data()).algorithm(Algorithm::HUGHES_MOLLER);
+            break;
+        case Method::FLAT_SHADING:
+            // selected by default when there are only positions and triangles
+            builder.positions(sphere.positions.data())
+                    .triangleCount(sphere.triangles.size())
+                    .triangles(sphere.triangles.data());
+            break;
+        case Method::TANGENTS_PROVIDED:
+            // selected by default when there are only normals and tangents
+            builder.normals(sphere.normals.data())
+                    .tangents(sphere.tangents.data());
+            break;
+        case Method::LENGYEL:
+        case Method::MIKKTSPACE:
+            builder.normals(sphere.normals.data())
+                    .positions(sphere.positions.data())
+                    .uvs(sphere.uvs.data())
+                    .triangleCount(sphere.triangles.size())
+                    .triangles(sphere.triangles.data())
+                    .algorithm(method == Method::LENGYEL ? Algorithm::LENGYEL
+                                                         : Algorithm::MIKKTSPACE);
+            break;
+    }
+    return builder.build();
+}
+
+} // anonymous namespace
+
+// range(0) is the method, range(1) is whether the JobSystem is used.
+static void BM_tangentSpaceMesh(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+    {
+        Sphere const sphere(1024);
+        Method const method = Method(state.range(0));
+        JobSystem* const jobSystem = state.range(1) ? &js : nullptr;
+        std::vector<short4> quats;
+        for (auto _ : state) {
+            TangentSpaceMesh* mesh = build(sphere, method, jobSystem);
+            quats.resize(mesh->getVertexCount());
+            mesh->getQuats(quats.data());
+            benchmark::DoNotOptimize(quats.data());
+            TangentSpaceMesh::destroy(mesh);
+        }
+        state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(sphere.positions.size()));
+    }
+    js.emancipate();
+}
+
+// Every method, without and with the JobSystem.
+static void methods(benchmark::internal::Benchmark* b) {
+    for (int64_t method = 0; method <= int64_t(Method::MIKKTSPACE); method++) {
+        b->Args({ method, 0 });
+        b->Args({ method, 1 });
+    }
+}
+
+BENCHMARK(BM_tangentSpaceMesh)->Apply(methods)->Unit(benchmark::kMillisecond);
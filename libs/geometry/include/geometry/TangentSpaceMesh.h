@@ -21,6 +21,8 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include <utils/JobSystem.h>
+
 #include <variant>
 
 namespace filament {
@@ -223,6 +225,28 @@ public:
          */
         Builder& algorithm(Algorithm algorithm) noexcept;
 
+        /**
+         * Splits the computation in chunks of vertices (or triangles) that run in parallel on the
+         * given JobSystem. The same JobSystem is used by the `getQuats` methods of the resulting
+         * mesh. Both build() and getQuats() must then be called from a thread that belongs to
+         * the JobSystem, e.g. from a job or an adopted thread. MIKKTSPACE always runs serially.
+         *
+         * @param jobSystem The JobSystem to use, or nullptr (the default) to run serially.
+         * @return Builder
+         */
+        Builder& jobSystem(utils::JobSystem* jobSystem) noexcept;
+
+        /**
+         * The priority of the jobs the computation is split into, by build() and by the
+         * `getQuats` methods of the resulting mesh. Use BACKGROUND when the mesh is built from a
+         * background job, e.g. while loading assets, so that its jobs don't compete with the
+         * frame's jobs.
+         *
+         * @param priority CRITICAL (the default) or BACKGROUND.
+         * @return Builder
+         */
+        Builder& jobPriority(utils::JobSystem::JobPriority priority) noexcept;
+
         /**
          * Computes the tangent space mesh. The resulting mesh object is owned by the callee. The
          * callee must call TangentSpaceMesh::destroy on the object once they are finished with it.
@@ -22,11 +22,18 @@
 #include <math/mat3.h>
 #include <math/norm.h>
 
+#include <utils/compiler.h>
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 #include <utils/Panic.h>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <vector>
 
+#include <limits.h>
+
 namespace filament {
 namespace geometry {
 
@@ -166,20 +173,147 @@ AlgorithmImpl selectAlgorithm(TangentSpaceMeshInput *input) noexcept {
     return outAlgo;
 }
 
-// The paper uses a Z-up world basis, which has been converted to Y-up here
-inline std::pair<float3, float3> frisvadKernel(float3 const& n) {
-    float3 b, t;
-    if (n.y < -1.0f + std::numeric_limits<float>::epsilon()) {
-        // Handle the singularity
-        t = float3{-1.0f, 0.0f, 0.0f};
-        b = float3{0.0f, 0.0f, -1.0f};
-    } else {
-        float const va = 1.0f / (1.0f + n.y);
-        float const vb = -n.z * n.x * va;
-        t = float3{vb, -n.z, 1.0f - n.z * n.z * va};
-        b = float3{1.0f - n.x * n.x * va, -n.x, vb};
+// Vertices (or triangles) are processed in chunks of at least this size, each chunk is a job when
+// a JobSystem is provided.
+constexpr size_t CHUNK_SIZE = 4096;
+
+// Within a chunk, tangent frames are computed and packed in blocks of this size, in SoA form, so
+// that the compiler can vectorize the kernels.
+constexpr size_t BLOCK_SIZE = 64;
+
+// Calls fn(start, count) over [0, count), split into jobs of the input's priority when it has a
+// JobSystem.
+template<typename F>
+void forEachChunk(TangentSpaceMeshInput const* input, size_t count, F&& fn) {
+    utils::JobSystem* const js = input->jobSystem;
+    if (!js || count < CHUNK_SIZE * 2) {
+        fn(size_t(0), count);
+        return;
+    }
+    auto chunk = [&fn](uint32_t start, uint32_t count) { fn(size_t(start), size_t(count)); };
+    utils::JobSystem::Job* job = utils::jobs::parallel_for(*js, nullptr, 0u, uint32_t(count),
+            std::cref(chunk), utils::jobs::CountSplitter<CHUNK_SIZE, 16>());
+    job = js->runAndRetain(job, input->jobPriority);
+    js->waitAndRelease(job);
+}
+
+// A block of tangent frames in SoA form.
+struct FrameBlock {
+    float tx[BLOCK_SIZE], ty[BLOCK_SIZE], tz[BLOCK_SIZE];
+    float bx[BLOCK_SIZE], by[BLOCK_SIZE], bz[BLOCK_SIZE];
+    float nx[BLOCK_SIZE], ny[BLOCK_SIZE], nz[BLOCK_SIZE];
+
+    void loadNormals(float3 const* normals, size_t stride, size_t count) noexcept {
+        for (size_t i = 0; i < count; i++) {
+            float3 const& n = *pointerAdd(normals, i, stride);
+            nx[i] = n.x;
+            ny[i] = n.y;
+            nz[i] = n.z;
+        }
+    }
+
+    void set(size_t i, float3 const& t, float3 const& b, float3 const& n) noexcept {
+        tx[i] = t.x; ty[i] = t.y; tz[i] = t.z;
+        bx[i] = b.x; by[i] = b.y; bz[i] = b.z;
+        nx[i] = n.x; ny[i] = n.y; nz[i] = n.z;
+    }
+};
+
+// Same as mat3f::packTangentFrame({t, b, n}, storageSize) for each frame of the block, including
+// the choice of the quaternion extraction made by mat3f::toQuaternion(), but without branches so
+// that the compiler vectorizes it.
+void packTangentFrames(FrameBlock const& f, size_t count, quatf* UTILS_RESTRICT out,
+        size_t storageSize) noexcept {
+    float const bias = 1.0f / float((1 << (storageSize * CHAR_BIT - 1)) - 1);
+    float const biasFactor = float(std::sqrt(1.0 - double(bias) * double(bias)));
+    for (size_t i = 0; i < count; i++) {
+        float const tx = f.tx[i], ty = f.ty[i], tz = f.tz[i];
+        float const nx = f.nx[i], ny = f.ny[i], nz = f.nz[i];
+
+        // the matrix is { t, cross(n, t), n }, m[column][row]
+        float const m00 = tx, m01 = ty, m02 = tz;
+        float const m10 = ny * tz - nz * ty, m11 = nz * tx - nx * tz, m12 = nx * ty - ny * tx;
+        float const m20 = nx, m21 = ny, m22 = nz;
+
+        float const trace = m00 + m11 + m22;
+        bool const caseW = trace > 0.0f;
+        bool const caseZ = !caseW && m22 > std::max(m00, m11);
+        bool const caseY = !caseW && !caseZ && m11 > m00;
+        bool const caseX = !caseW && !caseZ && !caseY;
+
+        // Selecting the case with 0/1 weights rather than with conditionals keeps the loop free
+        // of control flow. All candidates are finite, so the weighted sums are exact.
+        float const wW = caseW ? 1.0f : 0.0f;
+        float const wX = caseX ? 1.0f : 0.0f;
+        float const wY = caseY ? 1.0f : 0.0f;
+        float const wZ = caseZ ? 1.0f : 0.0f;
+
+        // mat3f::toQuaternion(), with the same operations in each case
+        float const diag = wW * trace +
+                wX * (m00 - (m11 + m22)) +
+                wY * (m11 - (m22 + m00)) +
+                wZ * (m22 - (m00 + m11));
+        float const root = std::sqrt(diag + 1.0f);
+        float const half = 0.5f * root;
+        float const inv = root > 0.0f ? 0.5f / root : 0.0f;
+        float const dx = (m12 - m21) * inv, dy = (m20 - m02) * inv, dz = (m01 - m10) * inv;
+        float const sxy = (m01 + m10) * inv, syz = (m12 + m21) * inv, szx = (m20 + m02) * inv;
+        float qx = wW * dx + wX * half + wY * sxy + wZ * szx;
+        float qy = wW * dy + wX * sxy + wY * half + wZ * syz;
+        float qz = wW * dz + wX * szx + wY * syz + wZ * half;
+        float qw = wW * half + wX * dx + wY * dy + wZ * dz;
+
+        // normalize, with a positive w
+        float const length = std::sqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+        float const sign = qw < 0.0f ? -1.0f : 1.0f;
+        qx = sign * (qx / length);
+        qy = sign * (qy / length);
+        qz = sign * (qz / length);
+        qw = sign * (qw / length);
+
+        // ensure w is never 0.0
+        float const factor = qw < bias ? biasFactor : 1.0f;
+        qx *= factor;
+        qy *= factor;
+        qz *= factor;
+        qw = std::max(qw, bias);
+
+        // if there's a reflection ((n x t) . b <= 0), make sure w is negative
+        float const cx = ty * nz - tz * ny, cy = tz * nx - tx * nz, cz = tx * ny - ty * nx;
+        float const r = (cx * f.bx[i] + cy * f.by[i] + cz * f.bz[i]) < 0.0f ? -1.0f : 1.0f;
+
+        out[i] = quatf{ qw * r, qx * r, qy * r, qz * r };
+    }
+}
+
+// The paper uses a Z-up world basis, which has been converted to Y-up here. Computes the frames
+// of a block whose normals are loaded. The paper's tangents are stored as the tangents when
+// FLIP is false or as the bitangents when FLIP is true, and conversely for its bitangents.
+template<bool FLIP>
+void frisvadKernel(FrameBlock& f, size_t count) noexcept {
+    float* UTILS_RESTRICT ox = FLIP ? f.bx : f.tx;
+    float* UTILS_RESTRICT oy = FLIP ? f.by : f.ty;
+    float* UTILS_RESTRICT oz = FLIP ? f.bz : f.tz;
+    float* UTILS_RESTRICT px = FLIP ? f.tx : f.bx;
+    float* UTILS_RESTRICT py = FLIP ? f.ty : f.by;
+    float* UTILS_RESTRICT pz = FLIP ? f.tz : f.bz;
+    for (size_t i = 0; i < count; i++) {
+        float const nx = f.nx[i], ny = f.ny[i], nz = f.nz[i];
+        bool const singular = ny < -1.0f + std::numeric_limits<float>::epsilon();
+
+        // Handle the singularity by zeroing out the regular frame and adding { -x, -z } to it,
+        // the clamp keeps the regular frame finite so that this is exact.
+        float const va = 1.0f / std::max(1.0f + ny, std::numeric_limits<float>::epsilon());
+        float const vb = -nz * nx * va;
+        float const s = singular ? 1.0f : 0.0f;
+        float const k = 1.0f - s;
+        ox[i] = k * vb - s;
+        oy[i] = k * -nz;
+        oz[i] = k * (1.0f - nz * nz * va);
+        px[i] = k * (1.0f - nx * nx * va);
+        py[i] = k * -nx;
+        pz[i] = k * vb - s;
     }
-    return {b, t};
 }
 
 void frisvadMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutput* output)
@@ -187,15 +321,19 @@ void frisvadMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutput* o
     size_t const vertexCount = input->vertexCount;
     quatf* quats = output->tspace().allocate(vertexCount);
 
-    float3 const* UTILS_RESTRICT normals = input->normals();
+    float3 const* normals = input->normals();
     size_t const nstride = input->normalsStride();
 
-    for (size_t qindex = 0; qindex < vertexCount; ++qindex) {
-        float3 const n = *normals;
-        auto const [b, t] = frisvadKernel(n);
-        quats[qindex] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-        normals = pointerAdd(normals, 1, nstride);
-    }
+    forEachChunk(input, vertexCount, [=](size_t start, size_t count) {
+        FrameBlock f;
+        for (size_t i = start, end = start + count; i < end; i += BLOCK_SIZE) {
+            size_t const n = std::min(BLOCK_SIZE, end - i);
+            f.loadNormals(pointerAdd(normals, i, nstride), nstride, n);
+            frisvadKernel<false>(f, n);
+            packTangentFrames(f, n, quats + i, sizeof(int32_t));
+        }
+    });
+
     output->vertexCount = input->vertexCount;
     output->triangleCount = input->triangleCount;
     output->passthrough(input->attributeData, {AttributeImpl::UV0, AttributeImpl::POSITIONS});
@@ -209,24 +347,36 @@ void hughesMollerMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutp
     size_t const vertexCount = input->vertexCount;
     quatf* quats = output->tspace().allocate(vertexCount);
 
-    float3 const* UTILS_RESTRICT normals = input->normals();
+    float3 const* normals = input->normals();
     size_t const nstride = input->normalsStride();
 
-    for (size_t qindex = 0; qindex < vertexCount; ++qindex) {
-        float3 const n = *normals;
-        float3 b, t;
-
-        if (abs(n.x) > abs(n.z) + std::numeric_limits<float>::epsilon()) {
-            t = float3{-n.y, n.x, 0.0f};
-        } else {
-            t = float3{0.0f, -n.z, n.y};
+    forEachChunk(input, vertexCount, [=](size_t start, size_t count) {
+        FrameBlock f;
+        for (size_t i = start, end = start + count; i < end; i += BLOCK_SIZE) {
+            size_t const n = std::min(BLOCK_SIZE, end - i);
+            f.loadNormals(pointerAdd(normals, i, nstride), nstride, n);
+            for (size_t j = 0; j < n; j++) {
+                float const nx = f.nx[j], ny = f.ny[j], nz = f.nz[j];
+                bool const xz = std::abs(nx) > std::abs(nz) + std::numeric_limits<float>::epsilon();
+                float tx = xz ? -ny : 0.0f;
+                float ty = xz ?  nx : -nz;
+                float tz = xz ? 0.0f : ny;
+                float const s = 1.0f / std::sqrt(tx * tx + ty * ty + tz * tz);
+                tx *= s;
+                ty *= s;
+                tz *= s;
+                f.tx[j] = tx;
+                f.ty[j] = ty;
+                f.tz[j] = tz;
+                // b = cross(n, t)
+                f.bx[j] = ny * tz - nz * ty;
+                f.by[j] = nz * tx - nx * tz;
+                f.bz[j] = nx * ty - ny * tx;
+            }
+            packTangentFrames(f, n, quats + i, sizeof(int32_t));
         }
-        t = normalize(t);
-        b = cross(n, t);
+    });
 
-        quats[qindex] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-        normals = pointerAdd(normals, 1, nstride);
-    }
     output->vertexCount = input->vertexCount;
     output->triangleCount = input->triangleCount;
     output->passthrough(input->attributeData, {AttributeImpl::UV0, AttributeImpl::POSITIONS});
@@ -309,66 +459,81 @@ void flatShadingMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutpu
     size_t const outTriangleCount = triangleCount;
     uint3* outTriangles = output->triangles32.allocate(outTriangleCount);
 
-    size_t vindex = 0;
-    for (size_t tindex = 0; tindex < triangleCount; ++tindex) {
-        uint3 tri = isTriangle16 ?
-                uint3(*(ushort3*)(pointerAdd(triangles, tindex, tstride))) :
-                *(uint3*)(pointerAdd(triangles, tindex, tstride));
-
-        float3 const pa = *pointerAdd(positions, tri.x, pstride);
-        float3 const pb = *pointerAdd(positions, tri.y, pstride);
-        float3 const pc = *pointerAdd(positions, tri.z, pstride);
-
-        uint32_t i0 = vindex++, i1 = vindex++, i2 = vindex++;
-        outTriangles[tindex] = uint3{i0, i1, i2};
-
-        outPositions[i0] = pa;
-        outPositions[i1] = pb;
-        outPositions[i2] = pc;
-
-        float3 const n = normalize(cross(pc - pb, pa - pb));
-        const auto [t, b] = frisvadKernel(n);
-
-        quatf const tspace = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-        quats[i0] = tspace;
-        quats[i1] = tspace;
-        quats[i2] = tspace;
+    // Every triangle gets its own 3 vertices, so the triangles can be processed in any order.
+    forEachChunk(input, triangleCount, [&](size_t start, size_t count) {
+        FrameBlock f;
+        quatf frames[BLOCK_SIZE];
+        for (size_t first = start, end = start + count; first < end; first += BLOCK_SIZE) {
+            size_t const n = std::min(BLOCK_SIZE, end - first);
+            for (size_t j = 0; j < n; j++) {
+                size_t const tindex = first + j;
+                uint3 tri = isTriangle16 ?
+                        uint3(*(ushort3*)(pointerAdd(triangles, tindex, tstride))) :
+                        *(uint3*)(pointerAdd(triangles, tindex, tstride));
+
+                float3 const pa = *pointerAdd(positions, tri.x, pstride);
+                float3 const pb = *pointerAdd(positions, tri.y, pstride);
+                float3 const pc = *pointerAdd(positions, tri.z, pstride);
+
+                uint32_t const i0 = uint32_t(tindex * 3), i1 = i0 + 1, i2 = i0 + 2;
+                outTriangles[tindex] = uint3{i0, i1, i2};
+
+                outPositions[i0] = pa;
+                outPositions[i1] = pb;
+                outPositions[i2] = pc;
+
+                float3 const nrm = normalize(cross(pc - pb, pa - pb));
+                f.nx[j] = nrm.x;
+                f.ny[j] = nrm.y;
+                f.nz[j] = nrm.z;
+
+                // We need to make sure that the aux data is ported to the new mesh
+                for (auto const& [indata, outdata, attrib, stride]: outAttributes) {
+                    if (std::holds_alternative<float2 const*>(indata)) {
+                        float2* out = std::get<float2*>(outdata);
+                        float2 const* in = std::get<float2 const*>(indata);
+                        out[i0] = *pointerAdd(in, tri.x, stride);
+                        out[i1] = *pointerAdd(in, tri.y, stride);
+                        out[i2] = *pointerAdd(in, tri.z, stride);
+                    } else if (std::holds_alternative<float3 const*>(indata)) {
+                        float3* out = std::get<float3*>(outdata);
+                        float3 const* in = std::get<float3 const*>(indata);
+                        out[i0] = *pointerAdd(in, tri.x, stride);
+                        out[i1] = *pointerAdd(in, tri.y, stride);
+                        out[i2] = *pointerAdd(in, tri.z, stride);
+                    } else if (std::holds_alternative<float4 const*>(indata)) {
+                        float4* out = std::get<float4*>(outdata);
+                        float4 const* in = std::get<float4 const*>(indata);
+                        out[i0] = *pointerAdd(in, tri.x, stride);
+                        out[i1] = *pointerAdd(in, tri.y, stride);
+                        out[i2] = *pointerAdd(in, tri.z, stride);
+                    } else if (std::holds_alternative<ushort3 const*>(indata)) {
+                        ushort3* out = std::get<ushort3*>(outdata);
+                        ushort3 const* in = std::get<ushort3 const*>(indata);
+                        out[i0] = *pointerAdd(in, tri.x, stride);
+                        out[i1] = *pointerAdd(in, tri.y, stride);
+                        out[i2] = *pointerAdd(in, tri.z, stride);
+                    } else if (std::holds_alternative<ushort4 const*>(indata)) {
+                        ushort4* out = std::get<ushort4*>(outdata);
+                        ushort4 const* in = std::get<ushort4 const*>(indata);
+                        out[i0] = *pointerAdd(in, tri.x, stride);
+                        out[i1] = *pointerAdd(in, tri.y, stride);
+                        out[i2] = *pointerAdd(in, tri.z, stride);
+                    }
+                }
+            }
 
-        // We need to make sure that the aux data is ported to the new mesh
-        for (auto& [indata, outdata, attrib, stride]: outAttributes) {
-            if (std::holds_alternative<float2 const*>(indata)) {
-                float2* out = std::get<float2*>(outdata);
-                float2 const* in = std::get<float2 const*>(indata);
-                out[i0] = *pointerAdd(in, tri.x, stride);
-                out[i1] = *pointerAdd(in, tri.y, stride);
-                out[i2] = *pointerAdd(in, tri.z, stride);
-            } else if (std::holds_alternative<float3 const*>(indata)) {
-                float3* out = std::get<float3*>(outdata);
-                float3 const* in = std::get<float3 const*>(indata);
-                out[i0] = *pointerAdd(in, tri.x, stride);
-                out[i1] = *pointerAdd(in, tri.y, stride);
-                out[i2] = *pointerAdd(in, tri.z, stride);
-            } else if (std::holds_alternative<float4 const*>(indata)) {
-                float4* out = std::get<float4*>(outdata);
-                float4 const* in = std::get<float4 const*>(indata);
-                out[i0] = *pointerAdd(in, tri.x, stride);
-                out[i1] = *pointerAdd(in, tri.y, stride);
-                out[i2] = *pointerAdd(in, tri.z, stride);
-            } else if (std::holds_alternative<ushort3 const*>(indata)) {
-                ushort3* out = std::get<ushort3*>(outdata);
-                ushort3 const* in = std::get<ushort3 const*>(indata);
-                out[i0] = *pointerAdd(in, tri.x, stride);
-                out[i1] = *pointerAdd(in, tri.y, stride);
-                out[i2] = *pointerAdd(in, tri.z, stride);
-            } else if (std::holds_alternative<ushort4 const*>(indata)) {
-                ushort4* out = std::get<ushort4*>(outdata);
-                ushort4 const* in = std::get<ushort4 const*>(indata);
-                out[i0] = *pointerAdd(in, tri.x, stride);
-                out[i1] = *pointerAdd(in, tri.y, stride);
-                out[i2] = *pointerAdd(in, tri.z, stride);
+            // the flat shading frame uses frisvad's bitangent as its tangent
+            frisvadKernel<true>(f, n);
+            packTangentFrames(f, n, frames, sizeof(int32_t));
+            for (size_t j = 0; j < n; j++) {
+                quatf* const q = quats + (first + j) * 3;
+                q[0] = frames[j];
+                q[1] = frames[j];
+                q[2] = frames[j];
             }
         }
-    }
+    });
 
     output->vertexCount = outVertexCount;
     output->triangleCount = outTriangleCount;
@@ -385,20 +550,27 @@ void tangentsProvidedMethod(TangentSpaceMeshInput const* input, TangentSpaceMesh
     float4 const* tanvec = input->tangents();
     size_t const tstride = input->tangentsStride();
 
-    for (size_t qindex = 0; qindex < vertexCount; ++qindex) {
-        float3 const& n = *pointerAdd(normal, qindex, nstride);
-        float4 const& t4 = *pointerAdd(tanvec, qindex, nstride);
-        float3 tv = t4.xyz;
-        float3 b = t4.w > 0 ? cross(tv, n) : cross(n, tv);
-
-        // Some assets do not provide perfectly orthogonal tangents and normals, so we adjust the
-        // tangent to enforce orthonormality. We would rather honor the exact normal vector than
-        // the exact tangent vector since the latter is only used for bump mapping and anisotropic
-        // lighting.
-        tv = t4.w > 0 ? cross(n, b) : cross(b, n);
-
-        quats[qindex] = mat3f::packTangentFrame({tv, b, n});
-    }
+    forEachChunk(input, vertexCount, [=](size_t start, size_t count) {
+        FrameBlock f;
+        for (size_t i = start, end = start + count; i < end; i += BLOCK_SIZE) {
+            size_t const n = std::min(BLOCK_SIZE, end - i);
+            for (size_t j = 0; j < n; j++) {
+                float3 const& nv = *pointerAdd(normal, i + j, nstride);
+                float4 const& t4 = *pointerAdd(tanvec, i + j, tstride);
+                float3 tv = t4.xyz;
+                float3 const b = t4.w > 0 ? cross(tv, nv) : cross(nv, tv);
+
+                // Some assets do not provide perfectly orthogonal tangents and normals, so we
+                // adjust the tangent to enforce orthonormality. We would rather honor the exact
+                // normal vector than the exact tangent vector since the latter is only used for
+                // bump mapping and anisotropic lighting.
+                tv = t4.w > 0 ? cross(nv, b) : cross(b, nv);
+
+                f.set(j, tv, b, nv);
+            }
+            packTangentFrames(f, n, quats + i, sizeof(int16_t));
+        }
+    });
 
     output->vertexCount = vertexCount;
     output->triangleCount = input->triangleCount;
@@ -434,66 +606,108 @@ void lengyelMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutput* o
     auto positions = input->positions();
     auto uvs = input->uvs();
     auto normals = input->normals();
+    auto const triangle = [=](size_t a) -> uint3 {
+        return triangles16 ? uint3(triangles16[a]) : triangles32[a];
+    };
+
+    // Scattering the directions of each triangle into its vertices races when triangles are
+    // processed in parallel, and per-chunk accumulation buffers would cost a copy of the vertex
+    // data per chunk. Instead the directions are computed per triangle in parallel, then each
+    // vertex gathers the directions of its triangles. A vertex sums its triangles in increasing
+    // order, just like the serial scatter would, so the results don't depend on the job split.
+    std::vector<float3> sdirs(triangleCount);
+    std::vector<float3> tdirs(triangleCount);
+    forEachChunk(input, triangleCount, [&](size_t start, size_t count) {
+        for (size_t a = start, end = start + count; a < end; ++a) {
+            uint3 const tri = triangle(a);
+            assert_invariant(tri.x < vertexCount && tri.y < vertexCount && tri.z < vertexCount);
+            float3 const& v1 = *pointerAdd(positions, tri.x, positionStride);
+            float3 const& v2 = *pointerAdd(positions, tri.y, positionStride);
+            float3 const& v3 = *pointerAdd(positions, tri.z, positionStride);
+            float2 const& w1 = *pointerAdd(uvs, tri.x, uvStride);
+            float2 const& w2 = *pointerAdd(uvs, tri.y, uvStride);
+            float2 const& w3 = *pointerAdd(uvs, tri.z, uvStride);
+            float const x1 = v2.x - v1.x;
+            float const x2 = v3.x - v1.x;
+            float const y1 = v2.y - v1.y;
+            float const y2 = v3.y - v1.y;
+            float const z1 = v2.z - v1.z;
+            float const z2 = v3.z - v1.z;
+            float const s1 = w2.x - w1.x;
+            float const s2 = w3.x - w1.x;
+            float const t1 = w2.y - w1.y;
+            float const t2 = w3.y - w1.y;
+            float const d = s1 * t2 - s2 * t1;
+            float3 sdir, tdir;
+            // In general we can't guarantee smooth tangents when the UV's are non-smooth, but
+            // let's at least avoid divide-by-zero and fall back to normals-only method.
+            if (d == 0.0) {
+                float3 const& n1 = *pointerAdd(normals, tri.x, normalStride);
+                sdir = randomPerp(n1);
+                tdir = cross(n1, sdir);
+            } else {
+                sdir = {t2 * x1 - t1 * x2, t2 * y1 - t1 * y2, t2 * z1 - t1 * z2};
+                tdir = {s1 * x2 - s2 * x1, s1 * y2 - s2 * y1, s1 * z2 - s2 * z1};
+                float const r = 1.0f / d;
+                sdir *= r;
+                tdir *= r;
+            }
+            sdirs[a] = sdir;
+            tdirs[a] = tdir;
+        }
+    });
 
-    std::vector<float3> tan1(vertexCount, float3{0.0f});
-    std::vector<float3> tan2(vertexCount, float3{0.0f});
+    // triangles of each vertex, in increasing order: those of vertex v are
+    // vertexTriangles[firstTriangle[v]] to vertexTriangles[firstTriangle[v + 1] - 1]
+    std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+    std::vector<uint32_t> vertexTriangles(triangleCount * 3);
     for (size_t a = 0; a < triangleCount; ++a) {
-        uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
-        assert_invariant(tri.x < vertexCount && tri.y < vertexCount && tri.z < vertexCount);
-        float3 const& v1 = *pointerAdd(positions, tri.x, positionStride);
-        float3 const& v2 = *pointerAdd(positions, tri.y, positionStride);
-        float3 const& v3 = *pointerAdd(positions, tri.z, positionStride);
-        float2 const& w1 = *pointerAdd(uvs, tri.x, uvStride);
-        float2 const& w2 = *pointerAdd(uvs, tri.y, uvStride);
-        float2 const& w3 = *pointerAdd(uvs, tri.z, uvStride);
-        float const x1 = v2.x - v1.x;
-        float const x2 = v3.x - v1.x;
-        float const y1 = v2.y - v1.y;
-        float const y2 = v3.y - v1.y;
-        float const z1 = v2.z - v1.z;
-        float const z2 = v3.z - v1.z;
-        float const s1 = w2.x - w1.x;
-        float const s2 = w3.x - w1.x;
-        float const t1 = w2.y - w1.y;
-        float const t2 = w3.y - w1.y;
-        float const d = s1 * t2 - s2 * t1;
-        float3 sdir, tdir;
-        // In general we can't guarantee smooth tangents when the UV's are non-smooth, but let's at
-        // least avoid divide-by-zero and fall back to normals-only method.
-        if (d == 0.0) {
-            float3 const& n1 = *pointerAdd(normals, tri.x, normalStride);
-            sdir = randomPerp(n1);
-            tdir = cross(n1, sdir);
-        } else {
-            sdir = {t2 * x1 - t1 * x2, t2 * y1 - t1 * y2, t2 * z1 - t1 * z2};
-            tdir = {s1 * x2 - s2 * x1, s1 * y2 - s2 * y1, s1 * z2 - s2 * z1};
-            float const r = 1.0f / d;
-            sdir *= r;
-            tdir *= r;
+        uint3 const tri = triangle(a);
+        firstTriangle[tri.x + 1]++;
+        firstTriangle[tri.y + 1]++;
+        firstTriangle[tri.z + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        firstTriangle[v + 1] += firstTriangle[v];
+    }
+    {
+        std::vector<uint32_t> cursor(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t a = 0; a < triangleCount; ++a) {
+            uint3 const tri = triangle(a);
+            vertexTriangles[cursor[tri.x]++] = uint32_t(a);
+            vertexTriangles[cursor[tri.y]++] = uint32_t(a);
+            vertexTriangles[cursor[tri.z]++] = uint32_t(a);
         }
-        tan1[tri.x] += sdir;
-        tan1[tri.y] += sdir;
-        tan1[tri.z] += sdir;
-        tan2[tri.x] += tdir;
-        tan2[tri.y] += tdir;
-        tan2[tri.z] += tdir;
     }
 
     quatf* quats = output->tspace().allocate(vertexCount);
-    for (size_t a = 0; a < vertexCount; a++) {
-        float3 const& n = *pointerAdd(normals, a, normalStride);
-        float3 const& t1 = tan1[a];
-        float3 const& t2 = tan2[a];
+    forEachChunk(input, vertexCount, [&](size_t start, size_t count) {
+        FrameBlock f;
+        for (size_t i = start, end = start + count; i < end; i += BLOCK_SIZE) {
+            size_t const n = std::min(BLOCK_SIZE, end - i);
+            for (size_t j = 0; j < n; j++) {
+                size_t const a = i + j;
+                float3 t1{0.0f};
+                float3 t2{0.0f};
+                for (uint32_t k = firstTriangle[a], e = firstTriangle[a + 1]; k < e; ++k) {
+                    t1 += sdirs[vertexTriangles[k]];
+                    t2 += tdirs[vertexTriangles[k]];
+                }
 
-        // Gram-Schmidt orthogonalize
-        float3 const t = normalize(t1 - n * dot(n, t1));
+                float3 const& nv = *pointerAdd(normals, a, normalStride);
 
-        // Calculate handedness
-        float const w = (dot(cross(n, t1), t2) < 0.0f) ? -1.0f : 1.0f;
+                // Gram-Schmidt orthogonalize
+                float3 const t = normalize(t1 - nv * dot(nv, t1));
 
-        float3 b = w < 0 ? cross(t, n) : cross(n, t);
-        quats[a] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-    }
+                // Calculate handedness
+                float const w = (dot(cross(nv, t1), t2) < 0.0f) ? -1.0f : 1.0f;
+
+                float3 const b = w < 0 ? cross(t, nv) : cross(nv, t);
+                f.set(j, t, b, nv);
+            }
+            packTangentFrames(f, n, quats + i, sizeof(int32_t));
+        }
+    });
 
     output->vertexCount = vertexCount;
     output->triangleCount = triangleCount;
@@ -579,6 +793,16 @@ Builder& Builder::algorithm(Algorithm algo) noexcept {
     return *this;
 }
 
+Builder& Builder::jobSystem(utils::JobSystem* jobSystem) noexcept {
+    mMesh->mInput->jobSystem = jobSystem;
+    return *this;
+}
+
+Builder& Builder::jobPriority(utils::JobSystem::JobPriority priority) noexcept {
+    mMesh->mInput->jobPriority = priority;
+    return *this;
+}
+
 TangentSpaceMesh* Builder::build() {
     FILAMENT_CHECK_PRECONDITION(!mMesh->mInput->triangles32 || !mMesh->mInput->triangles16)
             << "Cannot provide both uint32 triangles and uint16 triangles";
@@ -719,31 +943,31 @@ void TangentSpaceMesh::getTriangles(ushort3* out) const {
 void TangentSpaceMesh::getQuats(quatf* out, size_t stride) const noexcept {
     stride = stride ? stride : sizeof(decltype((*out)));
     auto const& tangents = mOutput->tspace();
-    size_t const vertexCount = mOutput->vertexCount;
-    for (size_t i = 0; i < vertexCount; ++i) {
-        *out = tangents[i];
-        takeStride(out, stride);
-    }
+    forEachChunk(mInput, mOutput->vertexCount, [&](size_t start, size_t count) {
+        for (size_t i = start, end = start + count; i < end; ++i) {
+            *pointerAdd(out, i, stride) = tangents[i];
+        }
+    });
 }
 
 void TangentSpaceMesh::getQuats(short4* out, size_t stride) const noexcept {
     stride = stride ? stride : sizeof(decltype((*out)));
     auto const& tangents = mOutput->tspace();
-    size_t const vertexCount = mOutput->vertexCount;
-    for (size_t i = 0; i < vertexCount; ++i) {
-        *out = packSnorm16(tangents[i].xyzw);
-        takeStride(out, stride);
-    }
+    forEachChunk(mInput, mOutput->vertexCount, [&](size_t start, size_t count) {
+        for (size_t i = start, end = start + count; i < end; ++i) {
+            *pointerAdd(out, i, stride) = packSnorm16(tangents[i].xyzw);
+        }
+    });
 }
 
 void TangentSpaceMesh::getQuats(quath* out, size_t stride) const noexcept {
     stride = stride ? stride : sizeof(decltype((*out)));
     auto const& tangents = mOutput->tspace();
-    size_t const vertexCount = mOutput->vertexCount;
-    for (size_t i = 0; i < vertexCount; ++i) {
-        *out = quath(tangents[i].xyzw);
-        takeStride(out, stride);
-    }
+    forEachChunk(mInput, mOutput->vertexCount, [&](size_t start, size_t count) {
+        for (size_t i = start, end = start + count; i < end; ++i) {
+            *pointerAdd(out, i, stride) = quath(tangents[i].xyzw);
+        }
+    });
 }
 
 template void TangentSpaceMesh::getAux<float2>(AuxAttribute attribute, float2* out,
@@ -327,6 +327,10 @@ struct TangentSpaceMeshInput {
     AttributeMap attributeData;
 
     Algorithm algorithm;
+
+    // when set, the methods and getQuats() run in parallel on it
+    utils::JobSystem* jobSystem = nullptr;
+    utils::JobSystem::JobPriority jobPriority = utils::JobSystem::JobPriority::CRITICAL;
 };
 
 struct TangentSpaceMeshOutput {
@@ -16,13 +16,16 @@
 
 #include <geometry/TangentSpaceMesh.h>
 
+#include <math/norm.h>
 #include <math/quat.h>
 #include <math/vec3.h>
 
 #include <gtest/gtest.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 
+#include <cmath>
 #include <vector>
 
 class TangentSpaceMeshTest : public testing::Test {};
@@ -427,6 +430,145 @@ TEST_F(TangentSpaceMeshTest, Lengyel) {
     TangentSpaceMesh::destroy(mesh);
 }
 
+TEST_F(TangentSpaceMeshTest, JobSystem) {
+    // A uv sphere without its poles, large enough to be split in several jobs
+    constexpr uint32_t SEGMENTS = 128;
+    constexpr uint32_t RINGS = 128;
+    std::vector<float3> positions;
+    std::vector<float2> uvs;
+    std::vector<float4> tangents;
+    for (uint32_t r = 0; r <= RINGS; ++r) {
+        float const theta = float(M_PI) * (float(r) + 0.5f) / float(RINGS + 1);
+        for (uint32_t s = 0; s <= SEGMENTS; ++s) {
+            float const phi = 2.0f * float(M_PI) * float(s) / float(SEGMENTS);
+            positions.push_back({ std::sin(theta) * std::cos(phi), std::cos(theta),
+                    std::sin(theta) * std::sin(phi) });
+            uvs.push_back({ float(s) / float(SEGMENTS), float(r) / float(RINGS) });
+            tangents.push_back({ -std::sin(phi), 0.0f, std::cos(phi), 1.0f });
+        }
+    }
+    std::vector<uint3> triangles;
+    for (uint32_t r = 0; r < RINGS; ++r) {
+        for (uint32_t s = 0; s < SEGMENTS; ++s) {
+            uint32_t const a = r * (SEGMENTS + 1) + s;
+            uint32_t const b = a + SEGMENTS + 1;
+            triangles.push_back({ a, b, a + 1 });
+            triangles.push_back({ a + 1, b, b + 1 });
+        }
+    }
+
+    utils::JobSystem js;
+    js.adopt();
+
+    using Algorithm = TangentSpaceMesh::Algorithm;
+    enum Input { NORMALS, NORMALS_TANGENTS, POSITIONS, ALL };
+    auto const build = [&](Algorithm algorithm, Input input, utils::JobSystem* jobSystem) {
+        TangentSpaceMesh::Builder builder;
+        builder.vertexCount(positions.size())
+                .algorithm(algorithm)
+                .jobSystem(jobSystem);
+        if (input != POSITIONS) {
+            builder.normals(positions.data());
+        }
+        if (input == NORMALS_TANGENTS) {
+            builder.tangents(tangents.data());
+        }
+        if (input == POSITIONS || input == ALL) {
+            builder.positions(positions.data())
+                    .triangleCount(triangles.size())
+                    .triangles(triangles.data());
+        }
+        if (input == ALL) {
+            builder.uvs(uvs.data());
+        }
+        return builder.build();
+    };
+
+    // the default algorithm selects tangents provided and flat shading for these inputs
+    std::pair<Algorithm, Input> const cases[] = {
+            { Algorithm::DEFAULT, NORMALS_TANGENTS },
+            { Algorithm::DEFAULT, POSITIONS },
+            { Algorithm::FRISVAD, NORMALS },
+            { Algorithm::HUGHES_MOLLER, NORMALS },
+            { Algorithm::LENGYEL, ALL },
+    };
+
+    for (auto const& [algorithm, input] : cases) {
+        TangentSpaceMesh* serial = build(algorithm, input, nullptr);
+        TangentSpaceMesh* parallel = build(algorithm, input, &js);
+        ASSERT_EQ(serial->getVertexCount(), parallel->getVertexCount());
+
+        size_t const vertexCount = serial->getVertexCount();
+        std::vector<quatf> serialQuats(vertexCount);
+        std::vector<quatf> parallelQuats(vertexCount);
+        serial->getQuats(serialQuats.data());
+        parallel->getQuats(parallelQuats.data());
+
+        // The results must not depend on how the work was split
+        for (size_t i = 0; i < vertexCount; ++i) {
+            EXPECT_EQ(serialQuats[i], parallelQuats[i]);
+            EXPECT_PRED2(isAlmostEqual4, serialQuats[i].xyzw,
+                    normalize(serialQuats[i]).xyzw);
+        }
+
+        std::vector<short4> packed(vertexCount);
+        parallel->getQuats(packed.data());
+        for (size_t i = 0; i < vertexCount; ++i) {
+            EXPECT_EQ(packed[i], packSnorm16(serialQuats[i].xyzw));
+        }
+
+        TangentSpaceMesh::destroy(serial);
+        TangentSpaceMesh::destroy(parallel);
+    }
+
+    js.emancipate();
+}
+
+TEST_F(TangentSpaceMeshTest, BackgroundJobs) {
+    // enough vertices for the work to be split in several jobs
+    std::vector<float3> normals(64 * 1024, float3{ 0.0f, 0.0f, 1.0f });
+
+    utils::JobSystem js;
+    js.adopt();
+
+    using JobPriority = utils::JobSystem::JobPriority;
+    auto const buildIn = [&](JobPriority priority) {
+        TangentSpaceMesh* mesh = nullptr;
+        auto* job = utils::jobs::createJob(js, nullptr, [&] {
+            mesh = TangentSpaceMesh::Builder()
+                    .vertexCount(normals.size())
+                    .normals(normals.data())
+                    .algorithm(TangentSpaceMesh::Algorithm::FRISVAD)
+                    .jobSystem(&js)
+                    .jobPriority(priority)
+                    .build();
+        });
+        job = js.runAndRetain(job, priority);
+        js.waitAndRelease(job);
+        return mesh;
+    };
+
+    // the mesh is built from a background job, and so are all the jobs its work is split into
+    utils::JobSystem::Stats before = js.getStats();
+    TangentSpaceMesh* mesh = buildIn(JobPriority::BACKGROUND);
+    utils::JobSystem::Stats after = js.getStats();
+    ASSERT_NE(mesh, nullptr);
+    EXPECT_GT(after.jobsRun - before.jobsRun, 2u);
+    EXPECT_EQ(after.jobsRun - before.jobsRun, after.backgroundJobsRun - before.backgroundJobsRun);
+    TangentSpaceMesh::destroy(mesh);
+
+    // by default, they are critical
+    before = js.getStats();
+    mesh = buildIn(JobPriority::CRITICAL);
+    after = js.getStats();
+    ASSERT_NE(mesh, nullptr);
+    EXPECT_GT(after.jobsRun - before.jobsRun, 2u);
+    EXPECT_EQ(0u, after.backgroundJobsRun - before.backgroundJobsRun);
+    TangentSpaceMesh::destroy(mesh);
+
+    js.emancipate();
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
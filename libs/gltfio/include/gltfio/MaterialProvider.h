@@ -196,6 +196,9 @@ void processShaderString(std::string* shader, const UvMap& uvmap,
  * Creates a material provider that builds materials on the fly, composing GLSL at run time.
  *
  * @param optimizeShaders Optimizes shaders, but at significant cost to construction time.
+ * @param cacheFolder Optional folder where compiled material packages are kept across runs. When
+ *                    a material with the same key, uv map and engine configuration was built
+ *                    before, its package is loaded from disk instead of being compiled again.
  * @return New material provider that can build materials at run time.
  *
  * Requires \c libfilamat to be linked in. Not available in \c libgltfio_core.
@@ -203,7 +206,8 @@ void processShaderString(std::string* shader, const UvMap& uvmap,
  * @see createUbershaderProvider
  */
 UTILS_PUBLIC
-MaterialProvider* createJitShaderProvider(Engine* engine, bool optimizeShaders = false);
+MaterialProvider* createJitShaderProvider(Engine* engine, bool optimizeShaders = false,
+        const char* cacheFolder = nullptr);
 
 /**
  * Creates a material provider that loads a small set of pre-built materials.
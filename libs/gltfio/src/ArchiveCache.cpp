@@ -64,20 +64,112 @@ void ArchiveCache::load(const void* archiveData, uint64_t archiveByteCount) {
     if (decompSize == ZSTD_CONTENTSIZE_UNKNOWN || decompSize == ZSTD_CONTENTSIZE_ERROR) {
         PANIC_POSTCONDITION("Decompression error.");
     }
+    // Only the first frame is decompressed here. In version 1 archives it holds the specs and
+    // flags, the packages that follow are kept compressed until a material needs them.
+    const size_t headerByteCount = ZSTD_findFrameCompressedSize(archiveData, archiveByteCount);
+    if (ZSTD_isError(headerByteCount)) {
+        PANIC_POSTCONDITION("Decompression error.");
+    }
     uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
-    ZSTD_decompress(basePointer, decompSize, archiveData, archiveByteCount);
+    ZSTD_decompress(basePointer, decompSize, archiveData, headerByteCount);
     mArchive = (ReadableArchive*) basePointer;
-    convertOffsetsToPointers(mArchive);
+    if (mArchive->version != 0) {
+        // The client may release the archive after load(), so keep our own copy of the packages.
+        const uint8_t* packages = (const uint8_t*) archiveData + headerByteCount;
+        mPackages = FixedCapacityVector<uint8_t>(archiveByteCount - headerByteCount);
+        memcpy(mPackages.data(), packages, mPackages.size());
+    }
+    convertOffsetsToPointers(mArchive, mPackages.data());
     mMaterials = FixedCapacityVector<Material*>(mArchive->specsCount, nullptr);
+    buildIndex();
+}
+
+void ArchiveCache::buildIndex() {
+    mSpecMasks = FixedCapacityVector<SpecMasks>(mArchive->specsCount);
+    for (uint64_t i = 0; i < mArchive->specsCount; ++i) {
+        const ArchiveSpec& spec = mArchive->specs[i];
+        SpecMasks& masks = mSpecMasks[i];
+        masks = {};
+        for (uint64_t j = 0; j < spec.flagsCount; ++j) {
+            const ArchiveFlag& flag = spec.flags[j];
+            auto [iter, inserted] = mFeatureBits.try_emplace(flag.name, mFeatureBits.size());
+            if (iter->second >= sizeof(FeatureMask) * 8) {
+                mFeatureBits.clear();
+                mSpecMasks.clear();
+                return;
+            }
+            const FeatureMask bit = FeatureMask(1) << iter->second;
+            if (flag.value != ArchiveFeature::UNSUPPORTED) {
+                masks.supported |= bit;
+            }
+            if (flag.value == ArchiveFeature::REQUIRED) {
+                masks.required |= bit;
+            }
+        }
+    }
+    mIndexed = true;
 }
 
-// This loops though all ubershaders and returns the first one that meets the given requirements.
 Material* ArchiveCache::getMaterial(const ArchiveRequirements& reqs) {
     assert_invariant(mArchive && "Please call load() before requesting any materials.");
     if (mArchive == nullptr) {
         return nullptr;
     }
 
+    if (UTILS_UNLIKELY(!mIndexed)) {
+        const int32_t specIndex = findSpec(reqs);
+        return specIndex < 0 ? nullptr : getSpecMaterial(specIndex);
+    }
+
+    RequirementKey key{ 0, reqs.shadingModel, reqs.blendingMode };
+    for (const auto& req : reqs.features) {
+        if (req.second == false) {
+            continue;
+        }
+        auto iter = mFeatureBits.find(std::string_view(req.first.c_str(), req.first.size()));
+        if (iter == mFeatureBits.end()) {
+            // No spec in the archive lists this feature, so none of them can support it.
+            return nullptr;
+        }
+        key.features |= FeatureMask(1) << iter->second;
+    }
+
+    auto iter = mResults.find(key);
+    if (iter == mResults.end()) {
+        iter = mResults.emplace(key, findSpec(key)).first;
+    }
+    const int32_t specIndex = iter->second;
+    return specIndex < 0 ? nullptr : getSpecMaterial(specIndex);
+}
+
+// Returns the first spec whose flags cover the requested features, using the bitmask index.
+int32_t ArchiveCache::findSpec(const RequirementKey& key) const {
+    for (uint64_t i = 0; i < mArchive->specsCount; ++i) {
+        const ArchiveSpec& spec = mArchive->specs[i];
+        if (spec.blendingMode != INVALID_BLENDING && spec.blendingMode != key.blendingMode) {
+            debugSuitability(i, "blend mode mismatch.");
+            continue;
+        }
+        if (spec.shadingModel != INVALID_SHADING_MODEL && spec.shadingModel != key.shadingModel) {
+            debugSuitability(i, "material model.");
+            continue;
+        }
+        const SpecMasks& masks = mSpecMasks[i];
+        if ((key.features & ~masks.supported) != 0) {
+            debugSuitability(i, "unsupported feature.");
+            continue;
+        }
+        if (UTILS_UNLIKELY((masks.required & ~key.features) != 0)) {
+            debugSuitability(i, "missing required feature.");
+            continue;
+        }
+        return int32_t(i);
+    }
+    return -1;
+}
+
+// This loops though all ubershaders and returns the first one that meets the given requirements.
+int32_t ArchiveCache::findSpec(const ArchiveRequirements& reqs) const {
     for (uint64_t i = 0; i < mArchive->specsCount; ++i) {
         const ArchiveSpec& spec = mArchive->specs[i];
         if (spec.blendingMode != INVALID_BLENDING && spec.blendingMode != reqs.blendingMode) {
@@ -131,28 +223,40 @@ Material* ArchiveCache::getMaterial(const ArchiveRequirements& reqs) {
         }
 
         if (specIsSuitable) {
-            if (mMaterials[i] == nullptr) {
-                mMaterials[i] = Material::Builder()
-                    .package(spec.package, spec.packageByteCount)
-                    .build(mEngine);
-            }
-
-            return mMaterials[i];
+            return int32_t(i);
         }
     }
-    return nullptr;
+    return -1;
+}
+
+Material* ArchiveCache::getSpecMaterial(size_t specIndex) {
+    if (mMaterials[specIndex] != nullptr) {
+        return mMaterials[specIndex];
+    }
+    const ArchiveSpec& spec = mArchive->specs[specIndex];
+    if (mArchive->version == 0) {
+        mMaterials[specIndex] = Material::Builder()
+            .package(spec.package, spec.packageByteCount)
+            .build(mEngine);
+        return mMaterials[specIndex];
+    }
+    // The material parser keeps its own copy of the package, so the scratch buffer can go.
+    FixedCapacityVector<uint8_t> package(getPackageSize(*mArchive, spec));
+    if (package.empty() || !readPackage(*mArchive, spec, package.data())) {
+        slog.e << "Unable to decompress the package of spec " << specIndex << io::endl;
+        return nullptr;
+    }
+    mMaterials[specIndex] = Material::Builder()
+        .package(package.data(), package.size())
+        .build(mEngine);
+    return mMaterials[specIndex];
 }
 
 Material* ArchiveCache::getDefaultMaterial() {
     assert_invariant(mArchive && "Please call load() before requesting any materials.");
     assert_invariant(!mMaterials.empty() && "Archive must have at least one material.");
     if (!mArchive) return nullptr;
-    if (mMaterials[0] == nullptr) {
-        mMaterials[0] = Material::Builder()
-            .package(mArchive->specs[0].package, mArchive->specs[0].packageByteCount)
-            .build(mEngine);
-    }
-    return mMaterials[0];
+    return getSpecMaterial(0);
 }
 
 void ArchiveCache::destroyMaterials() {
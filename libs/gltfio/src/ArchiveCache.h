@@ -50,9 +50,48 @@ namespace filament::gltfio {
         FeatureMap getFeatureMap(Material* material) const;
 
     private:
+        // Each feature flag found in the archive gets one bit. Archives with more distinct flags
+        // than bits fall back to scanning the flags of every spec.
+        using FeatureMask = uint64_t;
+
+        struct SpecMasks {
+            FeatureMask supported; // OPTIONAL or REQUIRED
+            FeatureMask required;
+        };
+
+        struct RequirementKey {
+            FeatureMask features;
+            Shading shadingModel;
+            BlendingMode blendingMode;
+            bool operator==(const RequirementKey& rhs) const noexcept {
+                return features == rhs.features && shadingModel == rhs.shadingModel &&
+                        blendingMode == rhs.blendingMode;
+            }
+        };
+
+        struct RequirementKeyHasher {
+            size_t operator()(const RequirementKey& key) const noexcept {
+                return std::hash<uint64_t>{}(key.features ^
+                        (uint64_t(key.shadingModel) << 56) ^ (uint64_t(key.blendingMode) << 48));
+            }
+        };
+
+        void buildIndex();
+        int32_t findSpec(const ArchiveRequirements& requirements) const;
+        int32_t findSpec(const RequirementKey& key) const;
+        Material* getSpecMaterial(size_t specIndex);
+
         Engine& mEngine;
         utils::FixedCapacityVector<Material*> mMaterials;
         uberz::ReadableArchive* mArchive = nullptr;
+
+        // Compressed packages that follow the header frame, decompressed on first use.
+        utils::FixedCapacityVector<uint8_t> mPackages;
+
+        bool mIndexed = false;
+        tsl::robin_map<std::string_view, uint8_t> mFeatureBits;
+        utils::FixedCapacityVector<SpecMasks> mSpecMasks;
+        tsl::robin_map<RequirementKey, int32_t, RequirementKeyHasher> mResults;
     };
 
     struct ArchiveRequirements {
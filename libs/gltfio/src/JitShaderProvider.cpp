@@ -16,6 +16,8 @@
 
 #include <gltfio/MaterialProvider.h>
 
+#include "MaterialPackageCache.h"
+
 #include <filamat/MaterialBuilder.h>
 
 #include <utils/Hash.h>
@@ -33,7 +35,7 @@ namespace {
 
 class JitShaderProvider : public MaterialProvider {
 public:
-    explicit JitShaderProvider(Engine* engine, bool optimizeShaders);
+    JitShaderProvider(Engine* engine, bool optimizeShaders, const char* cacheFolder);
     ~JitShaderProvider() override;
 
     MaterialInstance* createMaterialInstance(MaterialKey* config, UvMap* uvmap,
@@ -54,10 +56,12 @@ public:
     std::vector<Material*> mMaterials;
     Engine* const mEngine;
     const bool mOptimizeShaders;
+    const MaterialPackageCache mPackageCache;
 };
 
-JitShaderProvider::JitShaderProvider(Engine* engine, bool optimizeShaders) : mEngine(engine),
-        mOptimizeShaders(optimizeShaders) {
+JitShaderProvider::JitShaderProvider(Engine* engine, bool optimizeShaders, const char* cacheFolder)
+        : mEngine(engine), mOptimizeShaders(optimizeShaders),
+          mPackageCache(cacheFolder ? cacheFolder : "") {
     MaterialBuilder::init();
 }
 
@@ -344,9 +348,24 @@ std::string shaderFromKey(const MaterialKey& config) {
 }
 
 Material* createMaterial(Engine* engine, const MaterialKey& config, const UvMap& uvmap,
-        const char* name, bool optimizeShaders) {
+        const char* name, bool optimizeShaders, const MaterialPackageCache& packageCache) {
     std::string shader = shaderFromKey(config);
     processShaderString(&shader, uvmap, config);
+
+    // The package is fully determined by the shader text, the key, the uv map and the engine
+    // state hashed by the cache. The name is left out, as it is for the in-memory cache.
+    uint64_t cacheKey = 0;
+    if (packageCache.isEnabled()) {
+        std::string source = shader;
+        source.append((const char*) &config, sizeof(config));
+        source.append((const char*) uvmap.data(), sizeof(UvSet) * uvmap.size());
+        source.push_back(optimizeShaders ? 1 : 0);
+        cacheKey = MaterialPackageCache::computeKey(*engine, source.data(), source.size());
+        if (Material* material = packageCache.load(*engine, cacheKey)) {
+            return material;
+        }
+    }
+
     MaterialBuilder builder;
     builder.name(name)
            .flipUV(false)
@@ -586,7 +605,11 @@ Material* createMaterial(Engine* engine, const MaterialKey& config, const UvMap&
     }
 
     Package pkg = builder.build(engine->getJobSystem());
-    return Material::Builder().package(pkg.getData(), pkg.getSize()).build(*engine);
+    Material* material = Material::Builder().package(pkg.getData(), pkg.getSize()).build(*engine);
+    if (material && cacheKey) {
+        packageCache.store(cacheKey, pkg.getData(), pkg.getSize());
+    }
+    return material;
 }
 
 Material* JitShaderProvider::getMaterial(MaterialKey* config, UvMap* uvmap, const char* label) {
@@ -599,7 +622,8 @@ Material* JitShaderProvider::getMaterial(MaterialKey* config, UvMap* uvmap, cons
         optimizeShaders = false;
 #endif
 
-        Material* mat = createMaterial(mEngine, *config, *uvmap, label, optimizeShaders);
+        Material* mat = createMaterial(mEngine, *config, *uvmap, label, optimizeShaders,
+                mPackageCache);
         mCache.emplace(std::make_pair(*config, mat));
         mMaterials.push_back(mat);
         return mat;
@@ -616,8 +640,9 @@ MaterialInstance* JitShaderProvider::createMaterialInstance(MaterialKey* config,
 
 namespace filament::gltfio {
 
-MaterialProvider* createJitShaderProvider(filament::Engine* engine, bool optimizeShaders) {
-    return new JitShaderProvider(engine, optimizeShaders);
+MaterialProvider* createJitShaderProvider(filament::Engine* engine, bool optimizeShaders,
+        const char* cacheFolder) {
+    return new JitShaderProvider(engine, optimizeShaders, cacheFolder);
 }
 
 } // namespace filament::gltfio
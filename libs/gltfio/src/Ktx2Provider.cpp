@@ -80,6 +80,7 @@ private:
     size_t mDecodedCount = 0;
     vector<unique_ptr<QueueItem> > mQueueItems;
     JobSystem::Job* mDecoderRootJob;
+    CancellationToken mCancellation;
     std::string mRecentPushMessage;
     std::string mRecentPopMessage;
     std::unique_ptr<ktxreader::Ktx2Reader> mKtxReader;
@@ -116,13 +117,20 @@ Texture* Ktx2Provider::pushTexture(const uint8_t* data, size_t byteCount,
     }
 
     JobSystem* js = &mEngine->getJobSystem();
-    item->job = jobs::createJob(*js, mDecoderRootJob, [item] {
+    item->job = jobs::createJob(*js, mDecoderRootJob, [item, token = &mCancellation] {
+        // Transcoding may not even have started when cancelDecoding() is called, in which case
+        // there is no point in doing it.
+        if (token->isCancelled()) {
+            item->transcoderState.store(TranscoderState::ERROR);
+            return;
+        }
         using Result = ktxreader::Ktx2Reader::Result;
         const bool success = Result::SUCCESS == item->async->doTranscoding();
         item->transcoderState.store(success ? TranscoderState::SUCCESS : TranscoderState::ERROR);
     });
 
-    js->runAndRetain(item->job);
+    // Transcoding is spread over several frames anyway, it shouldn't delay the frame's own jobs.
+    js->runAndRetain(item->job, JobSystem::JobPriority::BACKGROUND);
     return async->getTexture();
 }
 
@@ -193,10 +201,11 @@ void Ktx2Provider::waitForCompletion() {
 }
 
 void Ktx2Provider::cancelDecoding() {
-    // TODO: Currently, Ktx2Provider runs jobs eagerly and JobSystem does not allow cancellation of
-    // in-flight jobs. We should consider throttling the number of simultaneous decoder jobs, which
-    // would allow for actual cancellation.
+    // Transcoders that haven't started yet return immediately once the token is cancelled, so
+    // this only waits for the ones that are in flight.
+    mCancellation.cancel();
     waitForCompletion();
+    mCancellation.reset();
 
     // For cancelled jobs, we need to set the QueueItemState to POPPED and free the decoded data
     // stored in item->async.
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MaterialPackageCache.h"
+
+#include <filament/Engine.h>
+#include <filament/Material.h>
+#include <filament/MaterialEnums.h>
+
+#include <utils/Hash.h>
+#include <utils/Log.h>
+#include <utils/Path.h>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace utils;
+
+namespace filament::gltfio {
+
+namespace {
+
+constexpr uint32_t CACHE_MAGIC = 0x4d43564a; // "JVCM"
+constexpr uint32_t CACHE_FORMAT = 1;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t format;
+    uint64_t key;
+    uint64_t size;
+    uint32_t checksum;
+    uint32_t padding;
+};
+
+uint32_t checksum(const void* data, size_t size) noexcept {
+    return hash::murmurSlow((const uint8_t*) data, size, 0);
+}
+
+} // anonymous namespace
+
+MaterialPackageCache::MaterialPackageCache(std::string folder) : mFolder(std::move(folder)) {
+    if (!mFolder.empty() && !Path(mFolder).mkdirRecursive()) {
+        slog.w << "Material cache folder " << mFolder.c_str() << " is not writable, "
+               << "materials will be compiled every time." << io::endl;
+        mFolder.clear();
+    }
+}
+
+std::string MaterialPackageCache::getPath(uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.filamat", (unsigned long long) key);
+    return Path::concat(mFolder, name).getPath();
+}
+
+Material* MaterialPackageCache::load(Engine& engine, uint64_t key) const {
+    if (!isEnabled()) {
+        return nullptr;
+    }
+    std::ifstream in(getPath(key), std::ios::binary);
+    if (!in) {
+        return nullptr;
+    }
+    CacheHeader header{};
+    if (!in.read((char*) &header, sizeof(header)) || header.magic != CACHE_MAGIC ||
+            header.format != CACHE_FORMAT || header.key != key) {
+        return nullptr;
+    }
+    std::vector<uint8_t> package(header.size);
+    if (!in.read((char*) package.data(), (std::streamsize) package.size()) ||
+            checksum(package.data(), package.size()) != header.checksum) {
+        slog.w << "Ignoring corrupted material cache entry " << getPath(key).c_str() << io::endl;
+        return nullptr;
+    }
+    return Material::Builder().package(package.data(), package.size()).build(engine);
+}
+
+bool MaterialPackageCache::store(uint64_t key, const void* package, size_t size) const {
+    if (!isEnabled() || package == nullptr || size == 0) {
+        return false;
+    }
+    const CacheHeader header{ CACHE_MAGIC, CACHE_FORMAT, key, size, checksum(package, size), 0 };
+    const std::string path = getPath(key);
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.write((const char*) &header, sizeof(header)) ||
+                !out.write((const char*) package, (std::streamsize) size)) {
+            out.close();
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    // rename() does not replace an existing file on Windows
+    std::remove(path.c_str());
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+uint64_t MaterialPackageCache::computeKey(Engine const& engine, const void* source,
+        size_t size) noexcept {
+    const Engine::Config& config = engine.getConfig();
+    const uint32_t state[] = {
+        uint32_t(MATERIAL_VERSION),
+        uint32_t(engine.getBackend()),
+        uint32_t(engine.getActiveFeatureLevel()),
+        uint32_t(config.stereoscopicType),
+        uint32_t(config.stereoscopicEyeCount),
+    };
+    const uint32_t seed = hash::murmur3(state, sizeof(state) / sizeof(uint32_t), 0);
+    const auto* bytes = (const uint8_t*) source;
+    return (uint64_t(hash::murmurSlow(bytes, size, seed)) << 32) |
+            hash::murmurSlow(bytes, size, ~seed);
+}
+
+} // namespace filament::gltfio
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_MATERIAL_PACKAGE_CACHE_H
+#define GLTFIO_MATERIAL_PACKAGE_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+namespace filament {
+class Engine;
+class Material;
+}
+
+namespace filament::gltfio {
+
+// Stores compiled material packages in a folder so that materials built at run time survive
+// across sessions.
+//
+// Each package is written to "<folder>/<key>.filamat" behind a small header that repeats the key
+// and carries a checksum of the payload, so truncated or foreign files are rejected instead of
+// reaching the material parser. The key must capture everything that affects the generated
+// package, see computeKey().
+class MaterialPackageCache {
+public:
+    // An empty folder disables the cache.
+    explicit MaterialPackageCache(std::string folder);
+
+    bool isEnabled() const noexcept { return !mFolder.empty(); }
+
+    // Returns a material built from the cached package, or null if there is no valid entry.
+    Material* load(Engine& engine, uint64_t key) const;
+
+    // Writes the package through a temporary file so concurrent readers never see a partial entry.
+    bool store(uint64_t key, const void* package, size_t size) const;
+
+    // Hashes the material source plus the engine state that the material builder depends on
+    // (backend, feature level, stereo settings and the material version).
+    static uint64_t computeKey(Engine const& engine, const void* source, size_t size) noexcept;
+
+private:
+    std::string getPath(uint64_t key) const;
+    std::string mFolder;
+};
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_MATERIAL_PACKAGE_CACHE_H
@@ -737,14 +737,18 @@ void ResourceLoader::Impl::computeTangents(FFilamentAsset* asset) {
         }
     }
 
-    // Kick off jobs for computing tangent frames.
+    // Kick off jobs for computing tangent frames. They run in the background so that a load
+    // running alongside rendering can't take the workers away from the frame's jobs, this thread
+    // helps with them while it waits.
     JobSystem* js = &mEngine->getJobSystem();
     JobSystem::Job* parent = js->createJob();
     for (Params& params : jobParams) {
         Params* pptr = &params;
-        js->run(jobs::createJob(*js, parent, [pptr] { TangentsJob::run(pptr); }));
+        js->run(jobs::createJob(*js, parent, [pptr] { TangentsJob::run(pptr); }),
+                JobSystem::JobPriority::BACKGROUND);
     }
-    js->runAndWait(parent);
+    parent = js->runAndRetain(parent, JobSystem::JobPriority::BACKGROUND);
+    js->waitAndRelease(parent);
 
     // Finally, upload quaternions to the GPU from the main thread.
     for (Params& params : jobParams) {
@@ -81,6 +81,7 @@ private:
     size_t mDecodedCount = 0;
     vector<unique_ptr<TextureInfo> > mTextures;
     JobSystem::Job* mDecoderRootJob;
+    CancellationToken mCancellation;
     std::string mRecentPushMessage;
     std::string mRecentPopMessage;
     Engine* const mEngine;
@@ -126,10 +127,17 @@ Texture* StbProvider::pushTexture(const uint8_t* data, size_t byteCount,
     }
 
     JobSystem* js = &mEngine->getJobSystem();
-    info->decoderJob = jobs::createJob(*js, mDecoderRootJob, [info] {
+    info->decoderJob = jobs::createJob(*js, mDecoderRootJob, [info, token = &mCancellation] {
         auto& source = info->sourceBuffer;
         int width, height, comp;
 
+        // Decoding may not even have started when cancelDecoding() is called, in which case there
+        // is no point in doing it.
+        if (token->isCancelled()) {
+            info->decodedTexelsBaseMipmap.store(DECODING_ERROR);
+            return;
+        }
+
         // Test asynchronous loading by uncommenting this line.
         // std::this_thread::sleep_for(std::chrono::milliseconds(rand() % 10000));
 
@@ -140,7 +148,8 @@ Texture* StbProvider::pushTexture(const uint8_t* data, size_t byteCount,
         info->decodedTexelsBaseMipmap.store(texels ? intptr_t(texels) : DECODING_ERROR);
     });
 
-    js->runAndRetain(info->decoderJob);
+    // Decoding is spread over several frames anyway, it shouldn't delay the frame's own jobs.
+    js->runAndRetain(info->decoderJob, JobSystem::JobPriority::BACKGROUND);
     return texture;
 }
 
@@ -215,10 +224,11 @@ void StbProvider::waitForCompletion() {
 }
 
 void StbProvider::cancelDecoding() {
-    // TODO: Currently, StbProvider runs jobs eagerly and JobSystem does not allow cancellation of
-    // in-flight jobs. We should consider throttling the number of simultaneous decoder jobs, which
-    // would allow for actual cancellation.
+    // Decoders that haven't started yet return immediately once the token is cancelled, so this
+    // only waits for the ones that are in flight.
+    mCancellation.cancel();
     waitForCompletion();
+    mCancellation.reset();
 
     // For cancelled jobs, we need to set the TextureInfo to the popped state and free the decoded
     // data.
@@ -230,8 +240,9 @@ void StbProvider::cancelDecoding() {
         // decodedTexelsBaseMipmap is loaded is in the job threads, and we have waited them to
         // completion above. We also expect the TextureProvider API calls to be made only from one
         // thread.
-        if (intptr_t data = info->decodedTexelsBaseMipmap.load()) {
-            delete [] (uint8_t*) data;
+        intptr_t const data = info->decodedTexelsBaseMipmap.load();
+        if (data != DECODING_NOT_READY && data != DECODING_ERROR) {
+            stbi_image_free((void*) data);
         }
         info->state = TextureState::POPPED;
     }
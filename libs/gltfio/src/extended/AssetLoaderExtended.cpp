@@ -161,13 +161,20 @@ std::vector<BufferSlot> computeGeometries(cgltf_primitive const* prim, uint8_t c
         };
     }
 
+    // Like in ResourceLoader, the tangent frames are computed in the background so that loading
+    // can't take the workers away from the frame's jobs. The jobs they're split into are
+    // background jobs too.
+    using JobPriority = utils::JobSystem::JobPriority;
     utils::JobSystem& js = engine->getJobSystem();
     utils::JobSystem::Job* parent = js.createJob();
     for (auto& [key, params]: jobs) {
+        params.in.jobSystem = &js;
+        params.in.jobPriority = JobPriority::BACKGROUND;
         js.run(utils::jobs::createJob(js, parent,
-                [pptr = &params] { TangentsJobExtended::run(pptr); }));
+                [pptr = &params] { TangentsJobExtended::run(pptr); }), JobPriority::BACKGROUND);
     }
-    js.runAndWait(parent);
+    parent = js.runAndRetain(parent, JobPriority::BACKGROUND);
+    js.waitAndRelease(parent);
 
     std::vector<BufferSlot> slots;
 
@@ -111,6 +111,10 @@ struct PassthroughBuilder {
         mPassthrough.data[static_cast<int>(type)] = data;
     }
 
+    // Nothing is computed for a passthrough mesh.
+    void jobSystem(utils::JobSystem*) noexcept {}
+    void jobPriority(utils::JobSystem::JobPriority) noexcept {}
+
     PassthroughMesh* build() const noexcept {
         return new PassthroughMesh(mPassthrough);
     }
@@ -230,6 +234,10 @@ struct TangentSpaceMeshWrapper::Builder::Impl {
     void positions(float3 const* positions) noexcept { DO_BUILDER_IMPL(positions, positions); }
     void triangles(uint3 const* triangles) noexcept { DO_BUILDER_IMPL(triangles, triangles); }
     void triangleCount(size_t count) noexcept { DO_BUILDER_IMPL(triangleCount, count); }
+    void jobSystem(utils::JobSystem* js) noexcept { DO_BUILDER_IMPL(jobSystem, js); }
+    void jobPriority(utils::JobSystem::JobPriority priority) noexcept {
+        DO_BUILDER_IMPL(jobPriority, priority);
+    }
 
     template<typename T, typename = is_supported_aux_t<T>>
     void aux(AuxType type, T data) {
@@ -292,6 +300,16 @@ Builder& Builder::triangles(uint3 const* triangles) noexcept {
     return *this;
 }
 
+Builder& Builder::jobSystem(utils::JobSystem* jobSystem) noexcept {
+    mImpl->jobSystem(jobSystem);
+    return *this;
+}
+
+Builder& Builder::jobPriority(utils::JobSystem::JobPriority priority) noexcept {
+    mImpl->jobPriority(priority);
+    return *this;
+}
+
 template Builder& Builder::aux<float2*>(AuxType attribute, float2* data);
 template Builder& Builder::aux<float3*>(AuxType attribute, float3* data);
 template Builder& Builder::aux<float4*>(AuxType attribute, float4* data);
@@ -396,6 +396,8 @@ void TangentsJobExtended::run(Params* params) {
     using AuxType = TangentSpaceMeshWrapper::AuxType;
     TangentSpaceMeshWrapper::Builder tob(isUnlit);
     tob.vertexCount(vertexCount);
+    tob.jobSystem(params->in.jobSystem);
+    tob.jobPriority(params->in.jobPriority);
 
     // We go through all of the accessors (that we care about) associated with the primitive and
     // extra the associated data. For morph targets, we also find the associated morph target offset
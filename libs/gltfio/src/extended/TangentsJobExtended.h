@@ -20,6 +20,8 @@
 #include <gltfio/MaterialProvider.h> // for UvMap
 #include <math/vec4.h>
 
+#include <utils/JobSystem.h>
+
 #include <cgltf.h>
 
 namespace filament::gltfio {
@@ -37,6 +39,12 @@ struct TangentsJobExtended {
         cgltf_primitive const* prim;
         int morphTargetIndex = kMorphTargetUnused;
         UvMap uvmap;
+
+        // When set, the tangent space generation is split into jobs. The procedure must then be
+        // invoked from a thread of this JobSystem.
+        utils::JobSystem* jobSystem = nullptr;
+        // The priority of those jobs, which should be the one the procedure is run with.
+        utils::JobSystem::JobPriority jobPriority = utils::JobSystem::JobPriority::CRITICAL;
     };
 
     // The outputs of the procedure. The results array gets malloc'd by the procedure, so clients
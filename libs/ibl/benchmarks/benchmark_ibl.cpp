@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ibl/Cubemap.h>
+#include <ibl/CubemapIBL.h>
+#include <ibl/CubemapSH.h>
+#include <ibl/CubemapUtils.h>
+#include <ibl/Image.h>
+
+#include <utils/JobSystem.h>
+
+#include <math/vec3.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace filament::ibl;
+using namespace filament::math;
+using namespace utils;
+
+namespace {
+
+// A procedural environment and its mip chain, prepared the same way cmgen does.
+class Environment {
+public:
+    Environment(JobSystem& js, size_t dim) {
+        Image image;
+        Cubemap base = CubemapUtils::create(image, dim);
+        for (size_t face = 0; face < 6; face++) {
+            Image& faceImage = base.getImageForFace(Cubemap::Face(face));
+            for (size_t y = 0; y < dim; y++) {
+                for (size_t x = 0; x < dim; x++) {
+                    Cubemap::writeAt(faceImage.getPixelRef(x, y), {
+                            std::sin(float(x) * 0.1f + float(face)) * 0.5f + 0.5f,
+                            std::cos(float(y) * 0.07f) * 0.5f + 0.5f,
+                            float((x ^ y) & 15u) / 15.0f });
+                }
+            }
+        }
+        base.makeSeamless();
+        images.push_back(std::move(image));
+        levels.push_back(std::move(base));
+
+        while (dim > 1) {
+            dim >>= 1u;
+            Cubemap level = CubemapUtils::create(image, dim);
+            CubemapUtils::downsampleCubemapLevelBoxFilter(js, level, levels.back());
+            level.makeSeamless();
+            images.push_back(std::move(image));
+            levels.push_back(std::move(level));
+        }
+    }
+
+    std::vector<Image> images;
+    std::vector<Cubemap> levels;
+};
+
+} // anonymous namespace
+
+static void BM_roughnessFilter(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+    {
+        Environment env(js, 256);
+        Image image;
+        Cubemap dst = CubemapUtils::create(image, 64);
+        const size_t numSamples = size_t(state.range(0));
+        for (auto _ : state) {
+            CubemapIBL::roughnessFilter(js, dst, env.levels, 0.25f, numSamples,
+                    float3{ 1, 1, 1 }, true);
+        }
+        state.SetItemsProcessed(int64_t(state.iterations()) * 6 * 64 * 64 * numSamples);
+    }
+    js.emancipate();
+}
+
+static void BM_computeSH(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+    {
+        Environment env(js, 256);
+        const size_t numBands = size_t(state.range(0));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(CubemapSH::computeSH(js, env.levels[0], numBands, true));
+        }
+        state.SetItemsProcessed(int64_t(state.iterations()) * 6 * 256 * 256);
+    }
+    js.emancipate();
+}
+
+BENCHMARK(BM_roughnessFilter)->Arg(64)->Arg(1024)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_computeSH)->Arg(3)->Arg(9)->Unit(benchmark::kMillisecond);
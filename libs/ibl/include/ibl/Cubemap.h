@@ -136,6 +136,18 @@ public:
     //! returns the face and texture coordinates of the given direction
     static Address getAddressFor(const filament::math::float3& direction);
 
+    /**
+     * Same as getAddressFor() for `count` directions given as separate x, y, z arrays.
+     * This is branchless so that it vectorizes, use it to address blocks of samples.
+     */
+    static void getAddressesFor(size_t count,
+            float const* x, float const* y, float const* z,
+            Face* face, float* s, float* t);
+
+    //! same as trilinearFilterAt() above, for an address returned by getAddress[es]For()
+    static Texel trilinearFilterAt(const Cubemap& c0, const Cubemap& c1, float lerp,
+            const Address& address);
+
 private:
     size_t mDimensions = 0;
     float mScale = 1;
@@ -101,6 +101,10 @@ private:
 
     static void computeShBasis(float* SHb, size_t numBands, const math::float3& s);
 
+    // same as above for `count` directions, SHb holds numBands^2 rows of `count` bases
+    static void computeShBasis(float* SHb, size_t numBands, size_t count,
+            float const* x, float const* y, float const* z, float* cm, float* sm);
+
     static float Kml(ssize_t m, size_t l);
 
     static std::vector<float> Ki(size_t numBands);
@@ -91,6 +91,27 @@ Cubemap::Address Cubemap::getAddressFor(const float3& r) {
     return addr;
 }
 
+void Cubemap::getAddressesFor(size_t count,
+        float const* UTILS_RESTRICT x, float const* UTILS_RESTRICT y, float const* UTILS_RESTRICT z,
+        Face* UTILS_RESTRICT face, float* UTILS_RESTRICT s, float* UTILS_RESTRICT t) {
+    // This must select the same face as getAddressFor(), the faces are ordered such that
+    // face = 2 * major_axis + (major_axis < 0)
+    for (size_t i = 0; i < count; i++) {
+        const float rx = std::abs(x[i]);
+        const float ry = std::abs(y[i]);
+        const float rz = std::abs(z[i]);
+        const bool isX = rx >= ry && rx >= rz;
+        const bool isY = !isX && ry >= rz;
+        const float ma = 1.0f / (isX ? rx : (isY ? ry : rz));
+        const bool negative = (isX ? x[i] : (isY ? y[i] : z[i])) < 0;
+        const float sc = isX ? (negative ? z[i] : -z[i]) : (isY || !negative ? x[i] : -x[i]);
+        const float tc = isY ? (negative ? -z[i] : z[i]) : -y[i];
+        face[i] = Face((isX ? 0 : (isY ? 2 : 4)) + (negative ? 1 : 0));
+        s[i] = (sc * ma + 1.0f) * 0.5f;
+        t[i] = (tc * ma + 1.0f) * 0.5f;
+    }
+}
+
 void Cubemap::makeSeamless() {
     size_t dim = getDimensions();
     size_t D = dim;
@@ -203,7 +224,12 @@ Cubemap::Texel Cubemap::filterAtCenter(const Image& image, size_t x0, size_t y0)
 Cubemap::Texel Cubemap::trilinearFilterAt(const Cubemap& l0, const Cubemap& l1, float lerp,
         const float3& L)
 {
-    Cubemap::Address addr(getAddressFor(L));
+    return trilinearFilterAt(l0, l1, lerp, getAddressFor(L));
+}
+
+Cubemap::Texel Cubemap::trilinearFilterAt(const Cubemap& l0, const Cubemap& l1, float lerp,
+        const Address& addr)
+{
     const Image& i0 = l0.getImageForFace(addr.face);
     const Image& i1 = l1.getImageForFace(addr.face);
     float x0 = std::min(addr.s * l0.mDimensions, l0.mUpperBound);
@@ -28,6 +28,7 @@
 #include <math/mat3.h>
 #include <math/scalar.h>
 
+#include <algorithm>
 #include <random>
 #include <vector>
 
@@ -415,6 +416,22 @@ void CubemapIBL::roughnessFilter(
         return lhs.brdf_NoL < rhs.brdf_NoL;
     });
 
+    // The samples only depend on the roughness, so they're shared by all faces and texels. Their
+    // directions are also stored as a structure of arrays, padded to a whole number of blocks, so
+    // that the rotation and addressing of a block of samples vectorize. Only the fetches remain
+    // scalar.
+    constexpr size_t BLOCK_SIZE = 8;
+    const size_t sampleCount = cache.size();
+    const size_t numPaddedSamples = (sampleCount + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1);
+    std::vector<float> sampleX(numPaddedSamples, 0.0f);
+    std::vector<float> sampleY(numPaddedSamples, 0.0f);
+    std::vector<float> sampleZ(numPaddedSamples, 1.0f);
+    for (size_t i = 0; i < sampleCount; i++) {
+        sampleX[i] = cache[i].L.x;
+        sampleY[i] = cache[i].L.y;
+        sampleZ[i] = cache[i].L.z;
+    }
+
 
     struct State {
         // maybe blue-noise instead would look even better
@@ -429,7 +446,6 @@ void CubemapIBL::roughnessFilter(
             updater(0, (float) p / ((float) dim * 6.0f), userdata);
         }
         mat3 R;
-        const size_t numSamples = cache.size();
         for (size_t x = 0; x < dim; ++x, ++data) {
             const float2 p(Cubemap::center(x, y));
             const float3 N(dst.getDirectionFor(f, p.x, p.y) * mirror);
@@ -443,13 +459,31 @@ void CubemapIBL::roughnessFilter(
             R *= mat3f::rotation(state.distribution(state.gen), float3{0,0,1});
 
             float3 Li = 0;
-            for (size_t sample = 0; sample < numSamples; sample++) {
-                const CacheEntry& e = cache[sample];
-                const float3 L(R * e.L);
-                const Cubemap& cmBase = levels[e.l0];
-                const Cubemap& next = levels[e.l1];
-                const float3 c0 = Cubemap::trilinearFilterAt(cmBase, next, e.lerp, L);
-                Li += c0 * e.brdf_NoL;
+            for (size_t base = 0; base < sampleCount; base += BLOCK_SIZE) {
+                float const* UTILS_RESTRICT const sx = sampleX.data() + base;
+                float const* UTILS_RESTRICT const sy = sampleY.data() + base;
+                float const* UTILS_RESTRICT const sz = sampleZ.data() + base;
+                float Lx[BLOCK_SIZE], Ly[BLOCK_SIZE], Lz[BLOCK_SIZE];
+                for (size_t i = 0; i < BLOCK_SIZE; i++) {
+                    // L = R * e.L
+                    Lx[i] = R[0].x * sx[i] + R[1].x * sy[i] + R[2].x * sz[i];
+                    Ly[i] = R[0].y * sx[i] + R[1].y * sy[i] + R[2].y * sz[i];
+                    Lz[i] = R[0].z * sx[i] + R[1].z * sy[i] + R[2].z * sz[i];
+                }
+
+                Cubemap::Face face[BLOCK_SIZE];
+                float s[BLOCK_SIZE], t[BLOCK_SIZE];
+                Cubemap::getAddressesFor(BLOCK_SIZE, Lx, Ly, Lz, face, s, t);
+
+                const size_t count = std::min(BLOCK_SIZE, sampleCount - base);
+                for (size_t i = 0; i < count; i++) {
+                    const CacheEntry& e = cache[base + i];
+                    const Cubemap& cmBase = levels[e.l0];
+                    const Cubemap& next = levels[e.l1];
+                    const float3 c0 = Cubemap::trilinearFilterAt(cmBase, next, e.lerp,
+                            { face[i], s[i], t[i] });
+                    Li += c0 * e.brdf_NoL;
+                }
             }
             Cubemap::writeAt(data, Cubemap::Texel(Li));
         }
@@ -27,6 +27,7 @@
 
 #include <math/mat4.h>
 
+#include <algorithm>
 #include <array>
 #include <limits>
 #include <iomanip>
@@ -205,6 +206,80 @@ void CubemapSH::computeShBasis(
     }
 }
 
+/*
+ * Same as above, but evaluates the bases of a whole row of directions at once. Each basis is
+ * stored as a row of `count` values, and all the loops below run over the directions so they
+ * vectorize. cm and sm are scratch arrays of `count` floats.
+ */
+void CubemapSH::computeShBasis(
+        float* UTILS_RESTRICT SHb,
+        size_t numBands, size_t count,
+        float const* UTILS_RESTRICT x,
+        float const* UTILS_RESTRICT y,
+        float const* UTILS_RESTRICT z,
+        float* UTILS_RESTRICT cm,
+        float* UTILS_RESTRICT sm)
+{
+    auto row = [SHb, count](ssize_t m, size_t l) { return SHb + SHindex(m, l) * count; };
+
+    // m = 0
+    std::fill_n(row(0, 0), count, 1.0f);
+    for (size_t l = 1; l < numBands; l++) {
+        float const* UTILS_RESTRICT Pml_1 = row(0, l - 1);
+        float const* UTILS_RESTRICT Pml_2 = l >= 2 ? row(0, l - 2) : nullptr;
+        float* UTILS_RESTRICT Pml = row(0, l);
+        for (size_t i = 0; i < count; i++) {
+            const float p2 = Pml_2 ? Pml_2[i] : 0.0f;
+            Pml[i] = ((2*l-1.0f)*Pml_1[i]*z[i] - (l-1.0f)*p2) / l;
+        }
+    }
+
+    // Pmm doesn't depend on the direction (see [1] above)
+    float Pmm = 1;
+    for (size_t m = 1; m < numBands; m++) {
+        Pmm = (1.0f - 2*m) * Pmm;
+        // l == m
+        std::fill_n(row(m, m), count, Pmm);
+        if (m + 1 < numBands) {
+            // l == m+1
+            float* UTILS_RESTRICT Pml = row(m, m + 1);
+            for (size_t i = 0; i < count; i++) {
+                Pml[i] = (2*m + 1.0f)*Pmm*z[i];
+            }
+            for (size_t l = m + 2; l < numBands; l++) {
+                float const* UTILS_RESTRICT Pml_1 = row(m, l - 1);
+                float const* UTILS_RESTRICT Pml_2 = row(m, l - 2);
+                Pml = row(m, l);
+                for (size_t i = 0; i < count; i++) {
+                    Pml[i] = ((2*l - 1.0f)*Pml_1[i]*z[i] - (l + m - 1.0f)*Pml_2[i]) / (l-m);
+                }
+            }
+        }
+    }
+
+    // ( cos(m*phi), sin(m*phi) ) * sin(theta)^|m| recursion, see above
+    std::copy_n(x, count, cm);
+    std::copy_n(y, count, sm);
+    for (size_t m = 1; m < numBands; m++) {
+        for (size_t l = m; l < numBands; l++) {
+            float const* UTILS_RESTRICT P = row(m, l);
+            float* UTILS_RESTRICT Sb = row(-m, l);
+            float* UTILS_RESTRICT Cb = row(m, l);
+            for (size_t i = 0; i < count; i++) {
+                Sb[i] = P[i] * sm[i];
+            }
+            for (size_t i = 0; i < count; i++) {
+                Cb[i] *= cm[i];
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            const float Cm1 = cm[i] * x[i] - sm[i] * y[i];
+            const float Sm1 = sm[i] * x[i] + cm[i] * y[i];
+            cm[i] = Cm1;
+            sm[i] = Sm1;
+        }
+    }
+}
 
 /*
  * utilities to rotate very low order spherical harmonics (up to 3rd band)
@@ -513,22 +588,33 @@ std::unique_ptr<float3[]> CubemapSH::computeSH(JobSystem& js, const Cubemap& cm,
     const size_t numCoefs = numBands * numBands;
     std::unique_ptr<float3[]> SH(new float3[numCoefs]{});
 
+    // The bases and colors of a whole scanline are computed at once, as a structure of arrays
+    // so that both the bases and their dot products with the colors vectorize.
+    enum { X, Y, Z, R, G, B, COS, SIN, COUNT };
+
     struct State {
         State() = default;
-        explicit State(size_t numCoefs) : numCoefs(numCoefs) { }
+        State(size_t numCoefs, size_t dim) : numCoefs(numCoefs), dim(dim) { }
 
         State& operator=(State const & rhs) {
+            numCoefs = rhs.numCoefs;
+            dim = rhs.dim;
             SH.reset(new float3[rhs.numCoefs]{}); // NOLINT(modernize-make-unique)
-            SHb.reset(new float[rhs.numCoefs]{}); // NOLINT(modernize-make-unique)
+            SHb.reset(new float[rhs.numCoefs * rhs.dim]{}); // NOLINT(modernize-make-unique)
+            scanline.reset(new float[COUNT * rhs.dim]{}); // NOLINT(modernize-make-unique)
             return *this;
         }
         size_t numCoefs = 0;
+        size_t dim = 0;
         std::unique_ptr<float3[]> SH;
         std::unique_ptr<float[]> SHb;
-    } prototype(numCoefs);
+        std::unique_ptr<float[]> scanline;
+    } prototype(numCoefs, cm.getDimensions());
 
     CubemapUtils::process<State>(const_cast<Cubemap&>(cm), js,
             [&](State& state, size_t y, Cubemap::Face f, Cubemap::Texel const* data, size_t dim) {
+        float* const scanline = state.scanline.get();
+        auto channel = [scanline, dim](size_t c) { return scanline + c * dim; };
         for (size_t x=0 ; x<dim ; ++x, ++data) {
 
             float3 s(cm.getDirectionFor(f, x, y));
@@ -539,12 +625,30 @@ std::unique_ptr<float3[]> CubemapSH::computeSH(JobSystem& js, const Cubemap& cm,
             // take solid angle into account
             color *= CubemapUtils::solidAngle(dim, x, y);
 
-            computeShBasis(state.SHb.get(), numBands, s);
+            channel(X)[x] = s.x;
+            channel(Y)[x] = s.y;
+            channel(Z)[x] = s.z;
+            channel(R)[x] = color.r;
+            channel(G)[x] = color.g;
+            channel(B)[x] = color.b;
+        }
+
+        computeShBasis(state.SHb.get(), numBands, dim,
+                channel(X), channel(Y), channel(Z), channel(COS), channel(SIN));
 
-            // apply coefficients to the sampled color
-            for (size_t i=0 ; i<numCoefs ; i++) {
-                state.SH[i] += color * state.SHb[i];
+        // apply coefficients to the sampled colors
+        float const* UTILS_RESTRICT const r = channel(R);
+        float const* UTILS_RESTRICT const g = channel(G);
+        float const* UTILS_RESTRICT const b = channel(B);
+        for (size_t i=0 ; i<numCoefs ; i++) {
+            float const* UTILS_RESTRICT const SHb = state.SHb.get() + i * dim;
+            float3 sum = 0;
+            for (size_t x=0 ; x<dim ; ++x) {
+                sum.r += r[x] * SHb[x];
+                sum.g += g[x] * SHb[x];
+                sum.b += b[x] * SHb[x];
             }
+            state.SH[i] += sum;
         }
     },
     [&](State& state) {
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <image/ImageOps.h>
+#include <image/ImageSampler.h>
+#include <image/LinearImage.h>
+
+#include <utils/JobSystem.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using namespace image;
+using namespace utils;
+
+static constexpr uint32_t SIZE = 2048;
+
+// A few disks on a black background, enough to give the distance transforms something to do.
+static LinearImage createImage(uint32_t size, uint32_t channels) {
+    LinearImage image(size, size, channels);
+    float* data = image.getPixelRef();
+    for (uint32_t row = 0; row < size; ++row) {
+        for (uint32_t col = 0; col < size; ++col) {
+            uint32_t const dx = (col % 256) - 128;
+            uint32_t const dy = (row % 256) - 128;
+            float const value = dx * dx + dy * dy < 48 * 48 ? 1.0f : 0.0f;
+            for (uint32_t c = 0; c < channels; ++c) {
+                *data++ = value;
+            }
+        }
+    }
+    return image;
+}
+
+static bool presence(const LinearImage& img, uint32_t col, uint32_t row, void*) {
+    return img.getPixelRef(col, row)[0] != 0.0f;
+}
+
+static void BM_edt(benchmark::State& state) {
+    LinearImage const src = createImage(SIZE, 1);
+    for (auto _ : state) {
+        LinearImage cf = computeCoordField(src, presence, nullptr);
+        benchmark::DoNotOptimize(edtFromCoordField(cf, true));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * SIZE * SIZE);
+}
+
+static void BM_edtParallel(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+    LinearImage const src = createImage(SIZE, 1);
+    for (auto _ : state) {
+        LinearImage cf = computeCoordField(js, src, presence, nullptr);
+        benchmark::DoNotOptimize(edtFromCoordField(js, cf, true));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * SIZE * SIZE);
+    js.emancipate();
+}
+
+static void BM_resample(benchmark::State& state) {
+    LinearImage const src = createImage(SIZE, uint32_t(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(resampleImage(src, SIZE / 3, SIZE / 3, Filter::LANCZOS));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * SIZE * SIZE);
+}
+
+static void BM_resampleParallel(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+    LinearImage const src = createImage(SIZE, uint32_t(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(resampleImage(js, src, SIZE / 3, SIZE / 3, Filter::LANCZOS));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * SIZE * SIZE);
+    js.emancipate();
+}
+
+static void BM_mipmaps(benchmark::State& state) {
+    LinearImage const src = createImage(SIZE, 4);
+    uint32_t const count = getMipmapCount(src);
+    std::vector<LinearImage> mips(count);
+    for (auto _ : state) {
+        generateMipmaps(src, Filter::DEFAULT, mips.data(), count);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * SIZE * SIZE);
+}
+
+static void BM_mipmapsParallel(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+    LinearImage const src = createImage(SIZE, 4);
+    uint32_t const count = getMipmapCount(src);
+    std::vector<LinearImage> mips(count);
+    for (auto _ : state) {
+        generateMipmaps(js, src, Filter::DEFAULT, mips.data(), count);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * SIZE * SIZE);
+    js.emancipate();
+}
+
+BENCHMARK(BM_edt)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_edtParallel)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_resample)->Arg(1)->Arg(3)->Arg(4)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_resampleParallel)->Arg(1)->Arg(3)->Arg(4)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_mipmaps)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_mipmapsParallel)->Unit(benchmark::kMillisecond);
@@ -24,8 +24,16 @@
 #include <cstddef>
 #include <initializer_list>
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace image {
 
+// The overloads taking a JobSystem split the work across rows and must be called from a thread
+// adopted by (or belonging to) that JobSystem. They produce the same results as their serial
+// counterparts.
+
 // Concatenates images horizontally to create a filmstrip atlas, similar to numpy's hstack.
 UTILS_PUBLIC LinearImage horizontalStack(std::initializer_list<LinearImage> images);
 UTILS_PUBLIC LinearImage horizontalStack(LinearImage const* img, size_t count);
@@ -51,6 +59,7 @@ UTILS_PUBLIC LinearImage combineChannels(LinearImage const* img, size_t count);
 
 // Generates a new image with rows & columns swapped.
 UTILS_PUBLIC LinearImage transpose(const LinearImage& image);
+UTILS_PUBLIC LinearImage transpose(utils::JobSystem& js, const LinearImage& image);
 
 // Extracts pixels by specifying a crop window where (0,0) is the top-left corner of the image.
 // The boundary is specified as Left Top Right Bottom.
@@ -72,15 +81,25 @@ using PresenceCallback = bool(*)(const LinearImage& img, uint32_t col, uint32_t
 UTILS_PUBLIC
 LinearImage computeCoordField(const LinearImage& src, PresenceCallback presence, void* user);
 
+// Same as above, the presence callback is invoked concurrently and must be thread-safe.
+UTILS_PUBLIC
+LinearImage computeCoordField(utils::JobSystem& js, const LinearImage& src,
+        PresenceCallback presence, void* user);
+
 // Generates a single-channel Euclidean distance field with positive values outside the region
 // of interest in the source image, and zero values inside. If sqrt is false, the computed
 // distances are squared. If signed distance (SDF) is desired, this function can be called a second
 // time using an inverted source field.
 UTILS_PUBLIC LinearImage edtFromCoordField(const LinearImage& coordField, bool sqrt);
+UTILS_PUBLIC
+LinearImage edtFromCoordField(utils::JobSystem& js, const LinearImage& coordField, bool sqrt);
 
 // Dereferences the given coordinate field. Useful for creating Voronoi diagrams or dilated images.
 UTILS_PUBLIC
 LinearImage voronoiFromCoordField(const LinearImage& coordField, const LinearImage& src);
+UTILS_PUBLIC
+LinearImage voronoiFromCoordField(utils::JobSystem& js, const LinearImage& coordField,
+        const LinearImage& src);
 
 // Copies content of a source image into a target image. Requires width/height/channels to match.
 UTILS_PUBLIC void blitImage(LinearImage& target, const LinearImage& source);
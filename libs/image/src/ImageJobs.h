@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IMAGE_IMAGEJOBS_H
+#define IMAGE_IMAGEJOBS_H
+
+#include <utils/JobSystem.h>
+
+#include <functional>
+
+#include <stdint.h>
+
+namespace image::details {
+
+// Calls fn(start, count) over [0, count), split into jobs when a JobSystem is given. Each split
+// is at least a few rows so that small images don't drown in scheduling overhead.
+template<typename F>
+void parallelRows(utils::JobSystem* js, uint32_t count, F&& fn) {
+    if (!js || count < 8) {
+        fn(0u, count);
+        return;
+    }
+    utils::JobSystem::Job* job = utils::jobs::parallel_for(*js, nullptr, 0u, count,
+            std::ref(fn), utils::jobs::CountSplitter<4, 8>());
+    js->runAndWait(job);
+}
+
+} // namespace image::details
+
+#endif // IMAGE_IMAGEJOBS_H
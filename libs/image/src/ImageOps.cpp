@@ -16,8 +16,11 @@
 
 #include <image/ImageOps.h>
 
+#include "ImageJobs.h"
+
 #include <math/vec3.h>
 #include <math/vec4.h>
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 
 #include <algorithm>
@@ -25,6 +28,8 @@
 #include <ratio>
 
 using namespace filament::math;
+using utils::JobSystem;
+using image::details::parallelRows;
 
 namespace image {
 
@@ -197,25 +202,36 @@ LinearImage combineChannels(LinearImage const* img, size_t count) {
 // (b) allows the client to consume columns in the same way that it consumes rows. Our
 // implementation does not support in-place transposition but it is simple and robust for non-square
 // images.
-LinearImage transpose(const LinearImage& image) {
+static LinearImage transpose(JobSystem* js, const LinearImage& image) {
     const uint32_t width = image.getWidth();
     const uint32_t height = image.getHeight();
     const uint32_t channels = image.getChannels();
     LinearImage result(height, width, channels);
     float const* source = image.getPixelRef();
     float* target = result.getPixelRef();
-    for (uint32_t n = 0; n < width * height; ++n) {
-        const uint32_t i = n / width;
-        const uint32_t j = n % width;
-        float const* src = source + channels * n;
-        float* dst = target + channels * (height * j + i);
-        for (uint32_t c = 0; c < channels; ++c) {
-            dst[c] = src[c];
+    // each source row becomes a target column, so the rows can be split across jobs
+    parallelRows(js, height, [=](uint32_t start, uint32_t count) {
+        for (uint32_t i = start; i < start + count; ++i) {
+            float const* src = source + channels * width * i;
+            float* dst = target + channels * i;
+            for (uint32_t j = 0; j < width; ++j, src += channels, dst += channels * height) {
+                for (uint32_t c = 0; c < channels; ++c) {
+                    dst[c] = src[c];
+                }
+            }
         }
-    }
+    });
     return result;
 }
 
+LinearImage transpose(const LinearImage& image) {
+    return transpose(nullptr, image);
+}
+
+LinearImage transpose(JobSystem& js, const LinearImage& image) {
+    return transpose(&js, image);
+}
+
 LinearImage cropRegion(const LinearImage& image, uint32_t left, uint32_t top, uint32_t right,
         uint32_t bottom) {
     uint32_t width = right - left;
@@ -313,22 +329,24 @@ static void edt(const float* f, float* d, float* z, float* v, float* i, size_t n
     }
 }
 
-static LinearImage computeHorizontalEdt(const LinearImage& src, LinearImage cx) {
+static LinearImage computeHorizontalEdt(JobSystem* js, const LinearImage& src, LinearImage cx) {
     const uint32_t width = src.getWidth();
     const uint32_t height = src.getHeight();
     LinearImage tmp0(width + 1, height + 1, 1);
     LinearImage tmp1(width + 1, height + 1, 1);
     LinearImage dst(width, height, 1);
 
-    // TODO: use utils::job::parallel_for.
-    for (uint32_t row = 0; row < height; ++row) {
-        const float* f = src.getPixelRef(0, row);
-        float* d = dst.getPixelRef(0, row);
-        float* z = tmp0.getPixelRef(0, row);
-        float* v = tmp1.getPixelRef(0, row);
-        float* i = cx.getPixelRef(0, row);
-        edt(f, d, z, v, i, width);
-    }
+    // rows are independent and each has its own temporaries
+    parallelRows(js, height, [&](uint32_t start, uint32_t count) {
+        for (uint32_t row = start; row < start + count; ++row) {
+            const float* f = src.getPixelRef(0, row);
+            float* d = dst.getPixelRef(0, row);
+            float* z = tmp0.getPixelRef(0, row);
+            float* v = tmp1.getPixelRef(0, row);
+            float* i = cx.getPixelRef(0, row);
+            edt(f, d, z, v, i, width);
+        }
+    });
 
     return dst;
 }
@@ -336,85 +354,122 @@ static LinearImage computeHorizontalEdt(const LinearImage& src, LinearImage cx)
 // Implements the paper 'Distance Transforms of Sampled Functions' by Felzenszwalb and Huttenlocher
 // but generalized to compute a coordinate field rather than a distance field. Coordinate fields are
 // more broadly useful and transforming them into distance fields is extremely cheap.
-LinearImage computeCoordField(const LinearImage& src, PresenceCallback presence, void* user) {
+static LinearImage computeCoordField(JobSystem* js, const LinearImage& src,
+        PresenceCallback presence, void* user) {
     const uint32_t width = src.getWidth();
     const uint32_t height = src.getHeight();
     LinearImage f0(width, height, 1);
-    for (uint32_t row = 0; row < height; ++row) {
-        float* pf = f0.getPixelRef(0, row);
-        for (uint32_t col = 0; col < width; ++col) {
-            pf[col] = presence(src, col, row, user) ? 0.0f : INF;
+    parallelRows(js, height, [&](uint32_t start, uint32_t count) {
+        for (uint32_t row = start; row < start + count; ++row) {
+            float* pf = f0.getPixelRef(0, row);
+            for (uint32_t col = 0; col < width; ++col) {
+                pf[col] = presence(src, col, row, user) ? 0.0f : INF;
+            }
         }
-    }
+    });
 
     LinearImage cx(width, height, 1);
     LinearImage cy(height, width, 1);
 
-    f0 = computeHorizontalEdt(f0, cx);
-    f0 = transpose(f0);
-    f0 = computeHorizontalEdt(f0, cy);
-    f0 = transpose(f0);
+    f0 = computeHorizontalEdt(js, f0, cx);
+    f0 = transpose(js, f0);
+    f0 = computeHorizontalEdt(js, f0, cy);
+    f0 = transpose(js, f0);
 
     // NOTE: this could be extended to compute a volumetric distance field by transposing
     // X with Z at this point (rather than X with Y) and re-invoking computeHorizontalEdt.
 
     LinearImage coords(width, height, 2);
-    for (uint32_t row = 0; row < height; ++row) {
-        for (uint32_t col = 0; col < width; ++col) {
-            float y = cy.getPixelRef(row, col)[0];
-            float x = cx.getPixelRef(col, y)[0];
-            float* dst = coords.getPixelRef(col, row);
-            dst[0] = x;
-            dst[1] = y;
+    parallelRows(js, height, [&](uint32_t start, uint32_t count) {
+        for (uint32_t row = start; row < start + count; ++row) {
+            float* dst = coords.getPixelRef(0, row);
+            for (uint32_t col = 0; col < width; ++col, dst += 2) {
+                float y = cy.getPixelRef(row, col)[0];
+                float x = cx.getPixelRef(col, y)[0];
+                dst[0] = x;
+                dst[1] = y;
+            }
         }
-    }
+    });
 
     return coords;
 }
 
-LinearImage edtFromCoordField(const LinearImage& coordField, bool sqrt) {
+LinearImage computeCoordField(const LinearImage& src, PresenceCallback presence, void* user) {
+    return computeCoordField(nullptr, src, presence, user);
+}
+
+LinearImage computeCoordField(JobSystem& js, const LinearImage& src,
+        PresenceCallback presence, void* user) {
+    return computeCoordField(&js, src, presence, user);
+}
+
+static LinearImage edtFromCoordField(JobSystem* js, const LinearImage& coordField, bool sqrt) {
     const uint32_t width = coordField.getWidth();
     const uint32_t height = coordField.getHeight();
     LinearImage result(width, height, 1);
-    for (int32_t row = 0; row < height; ++row) {
-        const float frow = row;
-        float* dst = result.getPixelRef(0, row);
-        for (uint32_t col = 0; col < width; ++col) {
-            const float fcol = col;
-            const float* coord = coordField.getPixelRef(col, row);
-            const float dx = coord[0] - fcol;
-            const float dy = coord[1] - frow;
-            float distance = dx * dx + dy * dy;
+    parallelRows(js, height, [&](uint32_t start, uint32_t count) {
+        for (uint32_t row = start; row < start + count; ++row) {
+            const float frow = row;
+            const float* UTILS_RESTRICT coord = coordField.getPixelRef(0, row);
+            float* UTILS_RESTRICT dst = result.getPixelRef(0, row);
+            // no loop-carried dependency, this vectorizes
+            for (uint32_t col = 0; col < width; ++col) {
+                const float dx = coord[col * 2 + 0] - float(col);
+                const float dy = coord[col * 2 + 1] - frow;
+                dst[col] = dx * dx + dy * dy;
+            }
             if (sqrt) {
-                distance = std::sqrt(distance);
+                for (uint32_t col = 0; col < width; ++col) {
+                    dst[col] = std::sqrt(dst[col]);
+                }
             }
-            dst[col] = distance;
         }
-    }
+    });
     return result;
 }
 
+LinearImage edtFromCoordField(const LinearImage& coordField, bool sqrt) {
+    return edtFromCoordField(nullptr, coordField, sqrt);
+}
+
+LinearImage edtFromCoordField(JobSystem& js, const LinearImage& coordField, bool sqrt) {
+    return edtFromCoordField(&js, coordField, sqrt);
+}
+
 // Dereferences the given coordinate field. Useful for creating Voronoi diagrams or dilated images.
-LinearImage voronoiFromCoordField(const LinearImage& coordField, const LinearImage& src) {
+static LinearImage voronoiFromCoordField(JobSystem* js, const LinearImage& coordField,
+        const LinearImage& src) {
     const uint32_t width = src.getWidth();
     const uint32_t height = src.getHeight();
     const uint32_t channels = src.getChannels();
     LinearImage result(width, height, channels);
-    for (int32_t row = 0; row < height; ++row) {
-        for (uint32_t col = 0; col < width; ++col) {
-            const float* coord = coordField.getPixelRef(col, row);
-            uint32_t srccol = coord[0];
-            uint32_t srcrow = coord[1];
-            float* presult = result.getPixelRef(col, row);
-            const float* psource = src.getPixelRef(srccol, srcrow);
-            for (uint32_t channel = 0; channel < channels; ++channel) {
-                presult[channel] = psource[channel];
+    parallelRows(js, height, [&](uint32_t start, uint32_t count) {
+        for (uint32_t row = start; row < start + count; ++row) {
+            for (uint32_t col = 0; col < width; ++col) {
+                const float* coord = coordField.getPixelRef(col, row);
+                uint32_t srccol = coord[0];
+                uint32_t srcrow = coord[1];
+                float* presult = result.getPixelRef(col, row);
+                const float* psource = src.getPixelRef(srccol, srcrow);
+                for (uint32_t channel = 0; channel < channels; ++channel) {
+                    presult[channel] = psource[channel];
+                }
             }
         }
-    }
+    });
     return result;
 }
 
+LinearImage voronoiFromCoordField(const LinearImage& coordField, const LinearImage& src) {
+    return voronoiFromCoordField(nullptr, coordField, src);
+}
+
+LinearImage voronoiFromCoordField(JobSystem& js, const LinearImage& coordField,
+        const LinearImage& src) {
+    return voronoiFromCoordField(&js, coordField, src);
+}
+
 void blitImage(LinearImage& target, const LinearImage& source) {
     FILAMENT_CHECK_PRECONDITION(source.getWidth() == target.getWidth())
             << "Images must have same width.";
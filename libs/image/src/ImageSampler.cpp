@@ -17,18 +17,29 @@
 #include <image/ImageSampler.h>
 #include <image/ImageOps.h>
 
+#include "ImageJobs.h"
+
 #include <math/scalar.h>
+#include <math/vec2.h>
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
+#include <utils/compiler.h>
+#include <utils/debug.h>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 using namespace image;
+using utils::JobSystem;
+using image::details::parallelRows;
 
 namespace {
 
@@ -132,7 +143,7 @@ void generateMadProgram(uint32_t ntarget, uint32_t nsource, float left, float ri
     // the [0,1] domain. If this were a huge number, the filtered results would look the same, but
     // the filter would perform very poorly because it would be iterating over a lot more samples
     // than necessary.
-    const float filterBounds = domainScale * std::abs(filter.boundingRadius);
+    const float filterBounds = std::abs(filter.boundingRadius) / domainScale;
 
     // Iterate through target samples. "xtarget" points to the center of each target pixel.
     float xtarget = dtarget / 2.0f;
@@ -143,9 +154,14 @@ void generateMadProgram(uint32_t ntarget, uint32_t nsource, float left, float ri
         uint32_t count = 0;
         float sum = 0;
 
-        // Iterate through source samples that lie within the bounded region.
-        const auto isource_lower = int32_t((xtarget - filterBounds) * nsource);
-        const auto isource_upper = int32_t(std::ceil((xtarget + filterBounds) * nsource));
+        // Iterate through source samples that lie within the bounded region, mapped back into the
+        // source range. The extra sample on each side absorbs rounding at the filter's edge, it's
+        // not needed by NEAREST which only ever looks at the closest samples.
+        const float xlower = left + (xtarget - filterBounds) * (right - left);
+        const float xupper = left + (xtarget + filterBounds) * (right - left);
+        const int32_t margin = filter.boundingRadius != 0 ? 1 : 0;
+        const auto isource_lower = int32_t(std::floor(xlower * nsource)) - margin;
+        const auto isource_upper = int32_t(std::ceil(xupper * nsource)) + margin;
         for (int32_t isource = isource_lower; isource <= isource_upper; ++isource) {
             const float xsource = (((isource + 0.5f) / nsource) - left) / (right - left);
             const bool outside_image = isource < 0 || isource >= int32_t(nsource);
@@ -172,22 +188,108 @@ void generateMadProgram(uint32_t ntarget, uint32_t nsource, float left, float ri
     }
 }
 
-// Transforms a MAD program intended for single-channel data into a program intended for
-// multi-channel data.
-void expandMadProgram(uint32_t nchannels, MadProgram* program) {
-    if (nchannels == 1) {
-        return;
+// A MAD program compiled into runs of consecutive source pixels, so that each target pixel is
+// a dot product of contiguous weights and contiguous source pixels, accumulated in registers.
+// Unlike the per-channel instructions, this is friendly to the compiler's vectorizer.
+struct MadSpan {
+    uint32_t targetIndex;   // target pixel
+    uint32_t sourceIndex;   // first source pixel
+    uint32_t count;         // number of consecutive source pixels
+    uint32_t weightIndex;   // first weight of this span in MadKernel::weights
+};
+
+struct MadKernel {
+    std::vector<MadSpan> spans;
+    std::vector<float> weights;
+};
+
+// Compiles a single-channel MAD program into spans. Instructions are visited in order, so the
+// accumulation order (and the result) is the same as executing the program one MAD at a time.
+void compileMadProgram(MadProgram const& program, MadKernel* kernel) {
+    kernel->spans.clear();
+    kernel->weights.clear();
+    kernel->weights.reserve(program.size());
+    for (auto const& mad : program) {
+        // all our filters reject external samples
+        assert_invariant(mad.sourceIndex >= 0);
+        MadSpan* span = kernel->spans.empty() ? nullptr : &kernel->spans.back();
+        if (span && span->targetIndex == mad.targetIndex &&
+                span->sourceIndex + span->count == uint32_t(mad.sourceIndex)) {
+            span->count++;
+        } else {
+            kernel->spans.push_back({ mad.targetIndex, uint32_t(mad.sourceIndex), 1,
+                    uint32_t(kernel->weights.size()) });
+        }
+        kernel->weights.push_back(mad.weight);
+    }
+}
+
+template<uint32_t N> struct Pixel { };
+template<> struct Pixel<1> { using type = float; };
+template<> struct Pixel<2> { using type = float2; };
+template<> struct Pixel<3> { using type = float3; };
+template<> struct Pixel<4> { using type = float4; };
+
+// Executes the kernel over `count` rows starting at `start`, for images with N channels.
+template<uint32_t N>
+void executeMadKernel(MadKernel const& kernel, float const* source, float* target,
+        uint32_t swidth, uint32_t twidth, uint32_t start, uint32_t count) {
+    using T = typename Pixel<N>::type;
+    float const* UTILS_RESTRICT const weights = kernel.weights.data();
+    for (uint32_t row = start; row < start + count; ++row) {
+        T const* UTILS_RESTRICT const src = (T const*)(source + size_t(row) * swidth * N);
+        T* UTILS_RESTRICT const dst = (T*)(target + size_t(row) * twidth * N);
+        for (MadSpan const& span : kernel.spans) {
+            T const* UTILS_RESTRICT const s = src + span.sourceIndex;
+            float const* UTILS_RESTRICT const w = weights + span.weightIndex;
+            T acc = dst[span.targetIndex];
+            for (uint32_t k = 0; k < span.count; ++k) {
+                acc += s[k] * w[k];
+            }
+            dst[span.targetIndex] = acc;
+        }
+    }
+}
+
+// Same as above for any number of channels.
+void executeMadKernel(MadKernel const& kernel, float const* source, float* target,
+        uint32_t swidth, uint32_t twidth, uint32_t nchan, uint32_t start, uint32_t count) {
+    float const* UTILS_RESTRICT const weights = kernel.weights.data();
+    for (uint32_t row = start; row < start + count; ++row) {
+        float const* UTILS_RESTRICT const src = source + size_t(row) * swidth * nchan;
+        float* UTILS_RESTRICT const dst = target + size_t(row) * twidth * nchan;
+        for (MadSpan const& span : kernel.spans) {
+            float const* const w = weights + span.weightIndex;
+            for (uint32_t c = 0; c < nchan; ++c) {
+                float const* const s = src + span.sourceIndex * nchan + c;
+                float acc = dst[span.targetIndex * nchan + c];
+                for (uint32_t k = 0; k < span.count; ++k) {
+                    acc += s[k * nchan] * w[k];
+                }
+                dst[span.targetIndex * nchan + c] = acc;
+            }
+        }
     }
-    MadProgram result;
-    result.reserve(program->size() * nchannels);
-    for (auto mad : *program) {
-        mad.sourceIndex *= nchannels;
-        mad.targetIndex *= nchannels;
-        for (uint32_t j = 0; j < nchannels; ++j, ++mad.sourceIndex, ++mad.targetIndex) {
-            result.push_back(mad);
+}
+
+// The MIN filter ignores the weights and keeps the smallest source value.
+void executeMinKernel(MadKernel const& kernel, float const* source, float* target,
+        uint32_t swidth, uint32_t twidth, uint32_t nchan, uint32_t start, uint32_t count) {
+    for (uint32_t row = start; row < start + count; ++row) {
+        float const* UTILS_RESTRICT const src = source + size_t(row) * swidth * nchan;
+        float* UTILS_RESTRICT const dst = target + size_t(row) * twidth * nchan;
+        std::fill_n(dst, twidth * nchan, std::numeric_limits<float>::max());
+        for (MadSpan const& span : kernel.spans) {
+            for (uint32_t c = 0; c < nchan; ++c) {
+                float const* const s = src + span.sourceIndex * nchan + c;
+                float acc = dst[span.targetIndex * nchan + c];
+                for (uint32_t k = 0; k < span.count; ++k) {
+                    acc = std::min(s[k * nchan], acc);
+                }
+                dst[span.targetIndex * nchan + c] = acc;
+            }
         }
     }
-    program->swap(result);
 }
 
 FilterFunction createFilterFunction(Filter ftype) {
@@ -226,7 +328,7 @@ void normalize(LinearImage& image) {
     }
 }
 
-LinearImage resampleImage1D(const LinearImage& source, MadProgram* program,
+LinearImage resampleImage1D(JobSystem* js, const LinearImage& source, MadProgram* program,
         uint32_t twidth, Filter filter, float left, float right, float filterRadiusMultiplier) {
     const uint32_t swidth = source.getWidth();
     const uint32_t sheight = source.getHeight();
@@ -235,41 +337,37 @@ LinearImage resampleImage1D(const LinearImage& source, MadProgram* program,
     if (filter == Filter::DEFAULT) filter = mag ? Filter::MITCHELL : Filter::LANCZOS;
     const FilterFunction hfn = createFilterFunction(filter);
 
-    // Generate a flat list of multiply-add (MAD) instructions.
+    // Generate a flat list of multiply-add (MAD) instructions, and compile it into spans.
     program->clear();
     generateMadProgram(twidth, swidth, left, right, hfn, filterRadiusMultiplier, program);
-    expandMadProgram(nchan, program);
+    MadKernel kernel;
+    compileMadProgram(*program, &kernel);
 
     // Allocate the target image.
     LinearImage result(twidth, sheight, nchan);
-    float const* sourceRow = source.getPixelRef();
-    float* targetRow = result.getPixelRef();
+    float const* source0 = source.getPixelRef();
+    float* target0 = result.getPixelRef();
 
     // The MIN filter is special because it starts with non-zero values and ignores filter weights.
     if (filter == Filter::MINIMUM) {
-        for (uint32_t n = 0; n < twidth * sheight * nchan; ++n) {
-            targetRow[n] = std::numeric_limits<float>::max();
-        }
-        for (uint32_t row = 0; row < sheight; ++row) {
-            for (auto mad : *program) {
-                const float a = sourceRow[mad.sourceIndex];
-                const float b = targetRow[mad.targetIndex];
-                targetRow[mad.targetIndex] = std::min(a, b);
-            }
-            targetRow += twidth * nchan;
-            sourceRow += swidth * nchan;
-        }
+        parallelRows(js, sheight, [&](uint32_t start, uint32_t count) {
+            executeMinKernel(kernel, source0, target0, swidth, twidth, nchan, start, count);
+        });
         return result;
     }
 
-    // Resize the image horizontally by executing the MAD instructions over each row.
-    for (uint32_t row = 0; row < sheight; ++row) {
-        for (auto mad : *program) {
-            targetRow[mad.targetIndex] += sourceRow[mad.sourceIndex] * mad.weight;
+    // Resize the image horizontally by executing the MAD kernel over each row.
+    parallelRows(js, sheight, [&](uint32_t start, uint32_t count) {
+        switch (nchan) {
+            case 1: executeMadKernel<1>(kernel, source0, target0, swidth, twidth, start, count); break;
+            case 2: executeMadKernel<2>(kernel, source0, target0, swidth, twidth, start, count); break;
+            case 3: executeMadKernel<3>(kernel, source0, target0, swidth, twidth, start, count); break;
+            case 4: executeMadKernel<4>(kernel, source0, target0, swidth, twidth, start, count); break;
+            default:
+                executeMadKernel(kernel, source0, target0, swidth, twidth, nchan, start, count);
+                break;
         }
-        targetRow += twidth * nchan;
-        sourceRow += swidth * nchan;
-    }
+    });
 
     // Perform post processing for the current pass.
     if (filter == Filter::GAUSSIAN_NORMALS) {
@@ -286,8 +384,8 @@ SingleSample::~SingleSample() {
     delete[] data;
 }
 
-LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t height,
-        const ImageSampler& sampler) {
+static LinearImage resampleImage(JobSystem* js, const LinearImage& source,
+        uint32_t width, uint32_t height, const ImageSampler& sampler) {
     FILAMENT_CHECK_PRECONDITION(sampler.east.mode == Boundary::EXCLUDE &&
             sampler.north.mode == Boundary::EXCLUDE && sampler.west.mode == Boundary::EXCLUDE &&
             sampler.south.mode == Boundary::EXCLUDE)
@@ -301,11 +399,19 @@ LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t he
     const float bottom = sampler.sourceRegion.bottom;
     MadProgram program;
     LinearImage result;
-    result = transpose(resampleImage1D(source, &program, width, hfilter, left, right, radius));
-    result = transpose(resampleImage1D(result, &program, height, vfilter, top, bottom, radius));
+    auto xpose = [js](LinearImage const& image) {
+        return js ? transpose(*js, image) : transpose(image);
+    };
+    result = xpose(resampleImage1D(js, source, &program, width, hfilter, left, right, radius));
+    result = xpose(resampleImage1D(js, result, &program, height, vfilter, top, bottom, radius));
     return result;
 }
 
+LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t height,
+        const ImageSampler& sampler) {
+    return resampleImage(nullptr, source, width, height, sampler);
+}
+
 LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t height,
         Filter filter) {
     return resampleImage(source, width, height, ImageSampler {
@@ -314,6 +420,19 @@ LinearImage resampleImage(const LinearImage& source, uint32_t width, uint32_t he
     });
 }
 
+LinearImage resampleImage(JobSystem& js, const LinearImage& source,
+        uint32_t width, uint32_t height, const ImageSampler& sampler) {
+    return resampleImage(&js, source, width, height, sampler);
+}
+
+LinearImage resampleImage(JobSystem& js, const LinearImage& source,
+        uint32_t width, uint32_t height, Filter filter) {
+    return resampleImage(&js, source, width, height, ImageSampler {
+        .horizontalFilter = filter,
+        .verticalFilter = filter
+    });
+}
+
 void computeSingleSample(const LinearImage& source, float x, float y, SingleSample* result,
         Filter filter) {
     const float radius = 1.0f;
@@ -322,8 +441,9 @@ void computeSingleSample(const LinearImage& source, float x, float y, SingleSamp
     const float right = x + radius / source.getWidth();
     const float bottom = y + radius / source.getHeight();
     MadProgram program;
-    LinearImage row = transpose(resampleImage1D(source, &program, 1, filter, left, right, radius));
-    row = resampleImage1D(row, &program, 1, filter, top, bottom, radius);
+    LinearImage row = transpose(
+            resampleImage1D(nullptr, source, &program, 1, filter, left, right, radius));
+    row = resampleImage1D(nullptr, row, &program, 1, filter, top, bottom, radius);
     if (!result->data) {
         result->data = new float[source.getChannels()];
     }
@@ -348,6 +468,24 @@ void generateMipmaps(const LinearImage& source, Filter filter, LinearImage* resu
     }
 }
 
+void generateMipmaps(JobSystem& js, const LinearImage& source, Filter filter,
+        LinearImage* result, uint32_t mips) {
+    mips = std::min(mips, getMipmapCount(source));
+    uint32_t width = source.getWidth();
+    uint32_t height = source.getHeight();
+    // all levels are resampled from the source, so they don't depend on each other
+    JobSystem::Job* parent = js.createJob();
+    for (uint32_t n = 0; n < mips; ++n) {
+        width = std::max(width >> 1u, 1u);
+        height = std::max(height >> 1u, 1u);
+        js.run(utils::jobs::createJob(js, parent, [&js, &source, filter, width, height,
+                level = result + n]() {
+            *level = resampleImage(js, source, width, height, filter);
+        }));
+    }
+    js.runAndWait(parent);
+}
+
 uint32_t getMipmapCount(const LinearImage& source) {
     uint32_t width = source.getWidth();
     uint32_t height = source.getHeight();
@@ -26,6 +26,7 @@
 
 #include <gtest/gtest.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 #include <utils/Path.h>
 
@@ -362,6 +363,43 @@ TEST_F(ImageTest, Mipmaps) { // NOLINT
     }
 }
 
+TEST_F(ImageTest, ParallelOps) { // NOLINT
+    utils::JobSystem js;
+    js.adopt();
+
+    // The JobSystem overloads must produce exactly the same results as the serial ones.
+    auto tiny = createColorFromAscii("00000 01020 00400 04000 00000");
+    for (Filter filter : { Filter::BOX, Filter::MITCHELL, Filter::LANCZOS, Filter::MINIMUM }) {
+        auto a = resampleImage(tiny, 300, 200, filter);
+        auto b = resampleImage(js, tiny, 300, 200, filter);
+        EXPECT_EQ(compare(a, b, 0.0f), 0);
+        EXPECT_EQ(compare(resampleImage(a, 37, 61, filter),
+                resampleImage(js, b, 37, 61, filter), 0.0f), 0);
+    }
+
+    auto src = resampleImage(tiny, 256, 128, Filter::BOX);
+    EXPECT_EQ(compare(transpose(src), transpose(js, src), 0.0f), 0);
+
+    auto presence = [] (const LinearImage& img, uint32_t col, uint32_t row, void*) {
+        return img.getPixelRef(col, row)[0] ? true : false;
+    };
+    auto cf = computeCoordField(src, presence, nullptr);
+    EXPECT_EQ(compare(cf, computeCoordField(js, src, presence, nullptr), 0.0f), 0);
+    EXPECT_EQ(compare(edtFromCoordField(cf, true), edtFromCoordField(js, cf, true), 0.0f), 0);
+    EXPECT_EQ(compare(voronoiFromCoordField(cf, src),
+            voronoiFromCoordField(js, cf, src), 0.0f), 0);
+
+    uint32_t count = getMipmapCount(src);
+    vector<LinearImage> mips(count), mipsParallel(count);
+    generateMipmaps(src, Filter::HERMITE, mips.data(), count);
+    generateMipmaps(js, src, Filter::HERMITE, mipsParallel.data(), count);
+    for (uint32_t index = 0; index < count; ++index) {
+        EXPECT_EQ(compare(mips[index], mipsParallel[index], 0.0f), 0);
+    }
+
+    js.emancipate();
+}
+
 TEST_F(ImageTest, Ktx) { // NOLINT
     uint8_t foo[] = {1, 2, 3};
     uint8_t* data;
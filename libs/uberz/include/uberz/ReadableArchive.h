@@ -25,10 +25,23 @@
 
 namespace filament::uberz {
 
+// Version 0 archives are a single zstd frame that holds the specs and every package. Starting with
+// version 1, the first zstd frame only holds the specs and flags, and each package follows as its
+// own zstd frame so that readers can decompress materials on first use.
+static constexpr uint32_t ARCHIVE_VERSION = 1;
+
 // ArchiveSpec is a parse-free binary format. The client simply casts a word-aligned content blob
-// into a ReadableArchive struct pointer, then calls the following function to convert all the
-// offset fields into pointers.
-void convertOffsetsToPointers(struct ReadableArchive* archive);
+// (the decompressed first frame) into a ReadableArchive struct pointer, then calls the following
+// function to convert all the offset fields into pointers. For version 1 archives, the packages
+// pointer must refer to the bytes that follow the first frame and stay valid while specs are read.
+void convertOffsetsToPointers(struct ReadableArchive* archive, const uint8_t* packages = nullptr);
+
+// Returns the uncompressed size of the given spec's package, or 0 if the package is corrupted.
+uint64_t getPackageSize(struct ReadableArchive const& archive, struct ArchiveSpec const& spec);
+
+// Copies (version 0) or decompresses (version 1) the spec's package into the destination, which
+// must hold getPackageSize() bytes.
+bool readPackage(struct ReadableArchive const& archive, struct ArchiveSpec const& spec, void* dst);
 
 UTILS_WARNING_PUSH
 UTILS_WARNING_ENABLE_PADDED
@@ -18,6 +18,10 @@
 
 #include <utils/debug.h>
 
+#include <zstd.h>
+
+#include <string.h>
+
 using namespace filament;
 using namespace utils;
 
@@ -27,8 +31,9 @@ static_assert(sizeof(ReadableArchive) == 4 + 4 + 8 + 8);
 static_assert(sizeof(ArchiveSpec) == 1 + 1 + 2 + 4 + 8 + 8);
 static_assert(sizeof(ArchiveFlag) == 8 + 8);
 
-void convertOffsetsToPointers(ReadableArchive* archive) {
+void convertOffsetsToPointers(ReadableArchive* archive, const uint8_t* packages) {
     constexpr size_t wordSize = sizeof(uint64_t);
+    assert_invariant((archive->version == 0 || packages) && "Missing packages for this version.");
     assert_invariant(archive->specsOffset % wordSize == 0);
     uint64_t* basePointer = (uint64_t*) archive;
     archive->specs = (ArchiveSpec*) (basePointer + archive->specsOffset / wordSize);
@@ -36,7 +41,8 @@ void convertOffsetsToPointers(ReadableArchive* archive) {
         ArchiveSpec& spec = archive->specs[i];
         assert_invariant(spec.flagsOffset % wordSize == 0);
         spec.flags = (ArchiveFlag*) (basePointer + (spec.flagsOffset / wordSize));
-        spec.package = ((uint8_t*) basePointer) + spec.packageOffset;
+        spec.package = archive->version == 0 ? ((uint8_t*) basePointer) + spec.packageOffset :
+                const_cast<uint8_t*>(packages) + spec.packageOffset;
         for (uint64_t j = 0; j < spec.flagsCount; ++j) {
             ArchiveFlag& flag = spec.flags[j];
             flag.name = ((const char*) basePointer) + flag.nameOffset;
@@ -44,4 +50,25 @@ void convertOffsetsToPointers(ReadableArchive* archive) {
     }
 }
 
+uint64_t getPackageSize(ReadableArchive const& archive, ArchiveSpec const& spec) {
+    if (archive.version == 0) {
+        return spec.packageByteCount;
+    }
+    const uint64_t size = ZSTD_getFrameContentSize(spec.package, spec.packageByteCount);
+    if (size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR) {
+        return 0;
+    }
+    return size;
+}
+
+bool readPackage(ReadableArchive const& archive, ArchiveSpec const& spec, void* dst) {
+    if (archive.version == 0) {
+        memcpy(dst, spec.package, spec.packageByteCount);
+        return true;
+    }
+    const uint64_t size = getPackageSize(archive, spec);
+    const size_t result = ZSTD_decompress(dst, size, spec.package, spec.packageByteCount);
+    return !ZSTD_isError(result) && result == size;
+}
+
 } // namespace filament::uberz
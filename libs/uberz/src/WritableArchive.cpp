@@ -227,6 +227,34 @@ void WritableArchive::addSpecLine(string_view line) {
 }
 
 FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
+    // Maximum zstd compression is slow, but that's okay since uberz is invoked during the build,
+    // not at run time.  However in debug builds it is debilitatingly slow, and we're fine with
+    // larger archives, so we use minimum compression.
+#ifdef NDEBUG
+    const int compressionLevel = ZSTD_maxCLevel();
+#else
+    const int compressionLevel = ZSTD_minCLevel();
+#endif
+
+    auto compress = [compressionLevel](const uint8_t* data, size_t size) {
+        FixedCapacityVector<uint8_t> compressedBuf(ZSTD_compressBound(size));
+        size_t zstdResult = ZSTD_compress(compressedBuf.data(), compressedBuf.size(), data, size,
+                compressionLevel);
+        if (ZSTD_isError(zstdResult)) {
+            PANIC_POSTCONDITION("Error during archive compression: %s",
+                    ZSTD_getErrorName(zstdResult));
+        }
+        compressedBuf.resize(zstdResult);
+        return compressedBuf;
+    };
+
+    // Each package is a standalone frame so that readers can decompress it on demand.
+    auto packages = FixedCapacityVector<FixedCapacityVector<uint8_t>>::with_capacity(
+            mMaterials.size());
+    for (const auto& mat : mMaterials) {
+        packages.push_back(compress(mat.package.data(), mat.package.size()));
+    }
+
     size_t byteCount = sizeof(ReadableArchive);
     for (const auto& mat : mMaterials) {
         byteCount += sizeof(ArchiveSpec);
@@ -243,29 +271,32 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
             byteCount += pair.first.size() + 1;
         }
     }
-    size_t filamatOffset = byteCount;
-    for (const auto& mat : mMaterials) {
-        byteCount += mat.package.size();
+    // Package offsets are relative to the end of the header frame.
+    size_t filamatOffset = 0;
+    size_t packagesByteCount = 0;
+    for (const auto& package : packages) {
+        packagesByteCount += package.size();
     }
 
     ReadableArchive archive;
     archive.magic = 'UBER';
-    archive.version = 0;
+    archive.version = ARCHIVE_VERSION;
     archive.specsCount = mMaterials.size();
     archive.specsOffset = sizeof(ReadableArchive);
 
     auto specs = FixedCapacityVector<ArchiveSpec>::with_capacity(mMaterials.size());
     size_t flagCount = 0;
-    for (const auto& mat : mMaterials) {
+    for (size_t i = 0; i < mMaterials.size(); ++i) {
+        const auto& mat = mMaterials[i];
         ArchiveSpec spec = {};
         spec.shadingModel = mat.shadingModel;
         spec.blendingMode = mat.blendingMode;
         spec.flagsCount = mat.flags.size();
         spec.flagsOffset = flaglistOffset + flagCount * sizeof(ArchiveFlag);
-        spec.packageByteCount = mat.package.size();
+        spec.packageByteCount = packages[i].size();
         spec.packageOffset = filamatOffset;
         specs.push_back(spec);
-        filamatOffset += mat.package.size();
+        filamatOffset += packages[i].size();
         flagCount += mat.flags.size();
     }
 
@@ -301,31 +332,19 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
     writeCursor += sizeof(ArchiveFlag) * flags.size();
     memcpy(writeCursor, flagNames.data(), charCount);
     writeCursor += charCount;
-    for (const auto& mat : mMaterials) {
-        memcpy(writeCursor, mat.package.data(), mat.package.size());
-        writeCursor += mat.package.size();
-    }
     assert_invariant(writeCursor - outputBuf.data() == outputBuf.size());
 
-    FixedCapacityVector<uint8_t> compressedBuf(ZSTD_compressBound(outputBuf.size()));
-
-    // Maximum zstd compression is slow, but that's okay since uberz is invoked during the build,
-    // not at run time.  However in debug builds it is debilitatingly slow, and we're fine with
-    // larger archives, so we use minimum compression.
-#ifdef NDEBUG
-    const int compressionLevel = ZSTD_maxCLevel();
-#else
-    const int compressionLevel = ZSTD_minCLevel();
-#endif
-
-    size_t zstdResult = ZSTD_compress(compressedBuf.data(), compressedBuf.size(), outputBuf.data(),
-            outputBuf.size(), compressionLevel);
-    if (ZSTD_isError(zstdResult)) {
-        PANIC_POSTCONDITION("Error during archive compression: %s", ZSTD_getErrorName(zstdResult));
+    FixedCapacityVector<uint8_t> header = compress(outputBuf.data(), outputBuf.size());
+    FixedCapacityVector<uint8_t> archiveBuf(header.size() + packagesByteCount);
+    writeCursor = archiveBuf.data();
+    memcpy(writeCursor, header.data(), header.size());
+    writeCursor += header.size();
+    for (const auto& package : packages) {
+        memcpy(writeCursor, package.data(), package.size());
+        writeCursor += package.size();
     }
-
-    compressedBuf.resize(zstdResult);
-    return compressedBuf;
+    assert_invariant(writeCursor - archiveBuf.data() == archiveBuf.size());
+    return archiveBuf;
 }
 
 void WritableArchive::setShadingModel(Shading sm) {
@@ -18,8 +18,12 @@
 
 #include <utils/Allocator.h>
 #include <utils/compiler.h>
+#include <utils/MagazineCache.h>
 #include <utils/Mutex.h>
 
+#include <atomic>
+#include <mutex>
+
 #include <benchmark/benchmark.h>
 
 using namespace utils;
@@ -39,6 +43,26 @@ protected:
     utils::Arena<utils::ObjectPoolAllocator<Payload>, std::mutex> mPoolAllocatorStdMutex;
     utils::Arena<utils::ObjectPoolAllocator<Payload>, utils::Mutex> mPoolAllocatorUtilsMutex;
     utils::Arena<utils::ThreadSafeObjectPoolAllocator<Payload>, LockingPolicy::NoLock> mPoolAllocatorAtomic;
+
+    // a utils::Mutex pool only accessed in batches, behind per-thread magazines
+    utils::Arena<utils::ObjectPoolAllocator<Payload>, LockingPolicy::NoLock> mPoolAllocatorBacking;
+    utils::Mutex mBackingLock;
+    utils::MagazineCache<> mMagazineCache;
+
+    size_t refill(void** items, size_t count) noexcept {
+        std::lock_guard<utils::Mutex> const lock(mBackingLock);
+        size_t i = 0;
+        for (; i < count && (items[i] = mPoolAllocatorBacking.alloc<Payload>(1)); i++) {
+        }
+        return i;
+    }
+
+    void drain(void* const* items, size_t count) noexcept {
+        std::lock_guard<utils::Mutex> const lock(mBackingLock);
+        for (size_t i = 0; i < count; i++) {
+            mPoolAllocatorBacking.free(items[i]);
+        }
+    }
 };
 
 static constexpr size_t POOL_ITEM_COUNT = 4096;
@@ -47,7 +71,8 @@ Allocators::Allocators()
         : mPoolAllocatorNoLock("nolock", POOL_ITEM_COUNT * sizeof(Payload)),
           mPoolAllocatorStdMutex("std::mutex", POOL_ITEM_COUNT * sizeof(Payload)),
           mPoolAllocatorUtilsMutex("utils::Mutex", POOL_ITEM_COUNT * sizeof(Payload)),
-          mPoolAllocatorAtomic("atomic", POOL_ITEM_COUNT * sizeof(Payload)) {
+          mPoolAllocatorAtomic("atomic", POOL_ITEM_COUNT * sizeof(Payload)),
+          mPoolAllocatorBacking("magazine", POOL_ITEM_COUNT * sizeof(Payload)) {
 }
 
 Allocators::~Allocators() = default;
@@ -88,6 +113,64 @@ BENCHMARK_DEFINE_F(Allocators, poolAllocator_atomic)(benchmark::State& state) {
     }
 }
 
+BENCHMARK_DEFINE_F(Allocators, poolAllocator_magazine)(benchmark::State& state) {
+    auto& cache = mMagazineCache;
+    auto refill = [this](void** items, size_t count) { return this->refill(items, count); };
+    auto drain = [this](void* const* items, size_t count) { this->drain(items, count); };
+    PerformanceCounters pc(state);
+    for (auto _ : state) {
+        void* p = cache.pop(refill);
+        cache.push(p, drain);
+    }
+}
+
+// One thread allocates, the other frees, e.g. the engine and driver threads with Handles.
+BENCHMARK_DEFINE_F(Allocators, poolAllocator_utils_mutex_handoff)(benchmark::State& state) {
+    auto& pool = mPoolAllocatorUtilsMutex;
+    static std::atomic<Payload*> sMailbox[64];
+    size_t i = 0;
+    for (auto _ : state) {
+        auto& slot = sMailbox[i++ % 64];
+        if (state.thread_index == 0) {
+            Payload* p = pool.alloc<Payload>(1);
+            if (p) {
+                p = slot.exchange(p);
+            }
+            if (p) {
+                pool.free(p);
+            }
+        } else {
+            if (Payload* p = slot.exchange(nullptr)) {
+                pool.free(p);
+            }
+        }
+    }
+}
+
+BENCHMARK_DEFINE_F(Allocators, poolAllocator_magazine_handoff)(benchmark::State& state) {
+    auto& cache = mMagazineCache;
+    auto refill = [this](void** items, size_t count) { return this->refill(items, count); };
+    auto drain = [this](void* const* items, size_t count) { this->drain(items, count); };
+    static std::atomic<void*> sMailbox[64];
+    size_t i = 0;
+    for (auto _ : state) {
+        auto& slot = sMailbox[i++ % 64];
+        if (state.thread_index == 0) {
+            void* p = cache.pop(refill);
+            if (p) {
+                p = slot.exchange(p);
+            }
+            if (p) {
+                cache.push(p, drain);
+            }
+        } else {
+            if (void* p = slot.exchange(nullptr)) {
+                cache.push(p, drain);
+            }
+        }
+    }
+}
+
 BENCHMARK_REGISTER_F(Allocators, poolAllocator_std_mutex)
         ->ThreadRange(1, 4)
         ->Threads(benchmark::CPUInfo::Get().num_cpus * 2);
@@ -99,3 +182,11 @@ BENCHMARK_REGISTER_F(Allocators, poolAllocator_utils_mutex)
 BENCHMARK_REGISTER_F(Allocators, poolAllocator_atomic)
         ->ThreadRange(1, 4)
         ->Threads(benchmark::CPUInfo::Get().num_cpus * 2);
+
+BENCHMARK_REGISTER_F(Allocators, poolAllocator_magazine)
+        ->ThreadRange(1, 4)
+        ->Threads(benchmark::CPUInfo::Get().num_cpus * 2);
+
+BENCHMARK_REGISTER_F(Allocators, poolAllocator_utils_mutex_handoff)->Threads(2);
+
+BENCHMARK_REGISTER_F(Allocators, poolAllocator_magazine_handoff)->Threads(2);
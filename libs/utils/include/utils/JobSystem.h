@@ -31,6 +31,7 @@
 #include <tsl/robin_map.h>
 
 #include <atomic>
+#include <deque>
 #include <functional>
 #include <mutex>
 #include <type_traits>
@@ -43,24 +44,54 @@
 
 namespace utils {
 
+/*
+ * A cooperative cancellation flag shared between the code that submits jobs and the jobs
+ * themselves. JobSystem never interrupts a job, instead jobs check isCancelled() before (or while)
+ * doing their work and return early. Cancelled jobs still run, but finish almost immediately, so
+ * waiting on them after cancel() is cheap. The token must outlive the jobs that reference it.
+ */
+class CancellationToken {
+public:
+    void cancel() noexcept { mCancelled.store(true, std::memory_order_release); }
+    void reset() noexcept { mCancelled.store(false, std::memory_order_release); }
+    bool isCancelled() const noexcept { return mCancelled.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<bool> mCancelled = { false };
+};
+
 class JobSystem {
-    static constexpr size_t MAX_JOB_COUNT = 1 << 14; // 16384
-    static constexpr uint32_t JOB_COUNT_MASK = MAX_JOB_COUNT - 1;
+public:
+    class Job;
+
+private:
+    // Jobs are allocated in segments, a new segment is added when all the jobs are in use.
+    static constexpr size_t SEGMENT_JOB_COUNT = 1 << 12; // 4096
+    static constexpr size_t MAX_SEGMENT_COUNT = 256;
+    static constexpr size_t MAX_JOB_COUNT = SEGMENT_JOB_COUNT * MAX_SEGMENT_COUNT; // 1M
+    static constexpr uint32_t JOB_COUNT_MASK = 0xFFFFFF;
     static constexpr uint32_t WAITER_COUNT_SHIFT = 24;
-    static_assert(MAX_JOB_COUNT <= 0x7FFE, "MAX_JOB_COUNT must be <= 0x7FFE");
-    using WorkQueue = WorkStealingDequeue<uint16_t, MAX_JOB_COUNT>;
+    static_assert(MAX_JOB_COUNT <= JOB_COUNT_MASK, "MAX_JOB_COUNT must fit in JOB_COUNT_MASK");
+    // Jobs that don't fit in a thread's queue go to a shared overflow queue
+    static constexpr size_t WORK_QUEUE_SIZE = 1 << 12; // 4096
+    static constexpr uint8_t BACKGROUND_FLAG = 0x1; // the job was run as BACKGROUND
+    using WorkQueue = WorkStealingDequeue<Job*, WORK_QUEUE_SIZE>;
     using Mutex = utils::Mutex;
     using Condition = utils::Condition;
 
 public:
-    class Job;
-
     using ThreadId = uint8_t;
 
     using JobFunc = void(*)(void*, JobSystem&, Job*);
 
     static constexpr ThreadId invalidThreadId = 0xff;
 
+    // How a job is scheduled, see run(Job*&, JobPriority).
+    enum class JobPriority : uint8_t {
+        CRITICAL,       // frame work, e.g. culling or command generation (default)
+        BACKGROUND      // latency tolerant work, e.g. decoding textures
+    };
+
     class alignas(CACHELINE_SIZE) Job {
     public:
         Job() noexcept {} /* = default; */ /* clang bug */ // NOLINT(modernize-use-equals-default,cppcoreguidelines-pro-type-member-init)
@@ -73,28 +104,44 @@ public:
         // Size is chosen so that we can store at least std::function<>
         // the alignas() qualifier ensures we're multiple of a cache-line.
         static constexpr size_t JOB_STORAGE_SIZE_BYTES =
-                sizeof(std::function<void()>) > 48 ? sizeof(std::function<void()>) : 48;
+                sizeof(std::function<void()>) > 72 ? sizeof(std::function<void()>) : 72;
         static constexpr size_t JOB_STORAGE_SIZE_WORDS =
                 (JOB_STORAGE_SIZE_BYTES + sizeof(void*) - 1) / sizeof(void*);
 
         // keep it first, so it's correctly aligned with all architectures
         // this is where we store the job's data, typically a std::function<>
                                                                 // v7 | v8
-        void* storage[JOB_STORAGE_SIZE_WORDS];                  // 48 | 48
+        void* storage[JOB_STORAGE_SIZE_WORDS];                  // 72 | 72
         JobFunc function;                                       //  4 |  8
-        uint16_t parent;                                        //  2 |  2
+        Job* parent;                                            //  4 |  8
+        Job* successors[2];                                     //  8 | 16 see precede()
+        std::atomic<uint32_t> runningJobCount = { 1 };          //  4 |  4
+        std::atomic<uint32_t> pendingCount = { 1 };             //  4 |  4 predecessors + run()
+        mutable std::atomic<uint32_t> nextFree = { 0 };         //  4 |  4 index + 1, in the pool
+        uint32_t index = 0;                                     //  4 |  4 in the pool
         mutable ThreadId id = invalidThreadId;                  //  1 |  1
         mutable std::atomic<uint8_t> refCount = { 1 };          //  1 |  1
-        std::atomic<uint32_t> runningJobCount = { 1 };          //  4 |  4
-                                                                //  4 |  0 (padding)
-                                                                // 64 | 64
+        uint8_t flags = 0;                                      //  1 |  1
+                                                                // 21 |  5 (padding)
+                                                                //128 |128
     };
 
 #ifndef WIN32
     // on windows std::function<void()> is bigger and forces the whole structure to be larger
-    static_assert(sizeof(Job) == 64);
+    static_assert(sizeof(Job) == 128);
 #endif
 
+    // Cumulative counters, sample them twice to get rates.
+    struct Stats {
+        uint64_t jobsRun = 0;           // jobs executed by all threads, including empty jobs
+        uint64_t backgroundJobsRun = 0; // the part of jobsRun that was run as BACKGROUND
+        uint64_t jobsStolen = 0;        // jobs taken from another thread's queue
+        uint64_t stealAttempts = 0;     // tries to take a job from another thread's queue
+        uint64_t overflowJobs = 0;      // jobs that didn't fit in their thread's queue
+        uint64_t idleNanoseconds = 0;   // time all threads spent sleeping while out of work
+        size_t jobCapacity = 0;         // jobs that can exist at once before the pool grows
+    };
+
     explicit JobSystem(size_t threadCount = 0, size_t adoptableThreadsCount = 1) noexcept;
 
     ~JobSystem();
@@ -128,16 +175,16 @@ public:
      * ----------------------
      *
      *  struct Functor {
-     *   uintptr_t storage[6];
+     *   uintptr_t storage[9];
      *   void operator()(JobSystem&, Jobsystem::Job*);
      *  } functor;
      *
      *  struct Foo {
-     *   uintptr_t storage[6];
+     *   uintptr_t storage[9];
      *   void method(JobSystem&, Jobsystem::Job*);
      *  } foo;
      *
-     *  Functor and Foo size muse be <= uintptr_t[6]
+     *  Functor and Foo size muse be <= uintptr_t[9]
      *
      *   createJob()
      *   createJob(parent)
@@ -146,7 +193,7 @@ public:
      *   createJob<Foo, &Foo::method>(parent, std::ref(foo))
      *   createJob(parent, functor)
      *   createJob(parent, std::ref(functor))
-     *   createJob(parent, [ up-to 6 uintptr_t ](JobSystem*, Jobsystem::Job*){ })
+     *   createJob(parent, [ up-to 9 uintptr_t ](JobSystem*, Jobsystem::Job*){ })
      *
      *  Utility functions:
      *  ------------------
@@ -169,11 +216,11 @@ public:
      *   etc...
      *
      *  struct SmallFunctor {
-     *   uintptr_t storage[3];
+     *   uintptr_t storage[6];
      *   void operator()(T* data, size_t count);
      *  } smallFunctor;
      *
-     *   jobs::parallel_for(js, data, count, [ up-to 3 uintptr_t ](T* data, size_t count) { });
+     *   jobs::parallel_for(js, data, count, [ up-to 6 uintptr_t ](T* data, size_t count) { });
      *   jobs::parallel_for(js, data, count, smallFunctor);
      *   jobs::parallel_for(js, data, count, std::ref(smallFunctor));
      *
@@ -261,11 +308,23 @@ public:
 
     /*
      * Jobs are normally finished automatically, this can be used to cancel a job before it is run.
+     * The successors of a cancelled job are released as if it had run.
      *
-     * Never use this once a flavor of run() has been called.
+     * Never use this once a flavor of run() has been called, or on a job that has predecessors.
      */
     void cancel(Job*& job) noexcept;
 
+    /*
+     * Makes successor wait for predecessor, without blocking any thread: successor is queued
+     * by the thread that finishes predecessor (and its children), with the priority successor
+     * was run with. e.g. decode -> upload -> build chains of jobs with a common parent.
+     *
+     * Both jobs must have been created and not run yet, successor must still be run() (it is
+     * only queued once both run() was called and all its predecessors finished).
+     * A job can have any number of predecessors and successors.
+     */
+    void precede(Job* predecessor, Job* successor) noexcept;
+
     /*
      * Adds a reference to a Job.
      *
@@ -313,6 +372,25 @@ public:
         run(p, id);
     }
 
+    /*
+     * Add job to the queue matching its priority. Its reference will drop automatically.
+     * CRITICAL jobs go to this thread's execution queue, like run(Job*&) does.
+     * BACKGROUND jobs go to a queue shared by all threads. A worker only picks a background job
+     * when it has no critical job to run or steal, and at most getBackgroundConcurrency() of them
+     * run on the workers at a time, so that long jobs can't starve the frame of threads.
+     * A thread waiting on a background job with waitAndRelease() helps with background jobs
+     * regardless of that limit; threads waiting on a critical job never pick them up.
+     * Jobs created from a background job are CRITICAL unless they're run otherwise, except for
+     * the jobs parallel_for() splits a background job into, which are BACKGROUND as well.
+     *
+     * The job can't be used after this call.
+     */
+    void run(Job*& job, JobPriority priority) noexcept;
+    void run(Job*&& job, JobPriority priority) noexcept { // allows run(createJob(...), priority);
+        Job* p = job;
+        run(p, priority);
+    }
+
     /*
      * Add job to this thread's execution queue and keep a reference to it.
      * The current thread must be owned by JobSystem's thread pool. See adopt().
@@ -320,6 +398,7 @@ public:
      * This job MUST BE waited on with wait(), or released with release().
      */
     Job* runAndRetain(Job* job) noexcept;
+    Job* runAndRetain(Job* job, JobPriority priority) noexcept;
 
     /*
      * Wait on a job and destroys it.
@@ -368,6 +447,16 @@ public:
 
     size_t getThreadCount() const { return mThreadCount; }
 
+    // Stats of all the threads so far, and the current capacity of the job pool.
+    Stats getStats() const noexcept;
+
+    // Maximum number of BACKGROUND jobs the worker threads run at the same time, at least 1.
+    // The default is half the thread pool.
+    void setBackgroundConcurrency(size_t count) noexcept;
+    size_t getBackgroundConcurrency() const noexcept {
+        return mBackgroundConcurrency.load(std::memory_order_relaxed);
+    }
+
     // returns the current ThreadId, which can be used with run(). This method can only be
     // called from a job's function.
     static ThreadId getThreadId(Job const* job) noexcept {
@@ -375,6 +464,11 @@ public:
         return job->id;
     }
 
+    // returns the priority a job was run with, jobs that haven't been run yet are CRITICAL.
+    static JobPriority getPriority(Job const* job) noexcept {
+        return (job->flags & BACKGROUND_FLAG) ? JobPriority::BACKGROUND : JobPriority::CRITICAL;
+    }
+
 private:
     // this is just to avoid using std::default_random_engine, since we're in a public header.
     class default_random_engine {
@@ -408,6 +502,13 @@ private:
         JobSystem* js;                  // this is in fact const and always initialized
         std::thread thread;             // unused for adopted threads
         default_random_engine rndGen;
+
+        // written only by the thread owning this state, see getStats()
+        std::atomic<uint64_t> jobsRun = { 0 };
+        std::atomic<uint64_t> backgroundJobsRun = { 0 };
+        std::atomic<uint64_t> jobsStolen = { 0 };
+        std::atomic<uint64_t> stealAttempts = { 0 };
+        std::atomic<uint64_t> idleNanoseconds = { 0 };
     };
 
     static_assert(sizeof(ThreadState) % CACHELINE_SIZE == 0,
@@ -419,24 +520,43 @@ private:
     void decRef(Job const* job) noexcept;
 
     Job* allocateJob() noexcept;
+    Job* popFreeJob() noexcept;
+    void pushFreeJobs(Job const* first, Job const* last) noexcept;
+    bool addJobSegment() noexcept;
+    Job* getJob(uint32_t index) const noexcept;
+    bool isReady(Job* job) noexcept;
+    void release(ThreadState& state, Job* successor) noexcept;
     JobSystem::ThreadState* getStateToStealFrom(JobSystem::ThreadState& state) noexcept;
     static bool hasJobCompleted(Job const* job) noexcept;
 
     void requestExit() noexcept;
     bool exitRequested() const noexcept;
     bool hasActiveJobs() const noexcept;
+    bool hasBackgroundJobs() const noexcept;
+    bool hasRunnableBackgroundJobs() const noexcept;
+
+    // which background jobs a thread may pick up when it runs out of critical jobs
+    enum class BackgroundPolicy : uint8_t {
+        NONE,       // none, e.g. while waiting on a critical job
+        BOUNDED,    // as long as fewer than mBackgroundConcurrency run, i.e. idle workers
+        ANY         // any, e.g. while waiting on a background job
+    };
 
     void loop(ThreadState* state) noexcept;
-    bool execute(JobSystem::ThreadState& state) noexcept;
+    bool execute(JobSystem::ThreadState& state, BackgroundPolicy policy) noexcept;
     Job* steal(JobSystem::ThreadState& state) noexcept;
-    void finish(Job* job) noexcept;
+    void finish(Job* job, ThreadState* state) noexcept;
 
     void put(WorkQueue& workQueue, Job* job) noexcept;
     Job* pop(WorkQueue& workQueue) noexcept;
     Job* steal(WorkQueue& workQueue) noexcept;
+    Job* popOverflow() noexcept;
+
+    void putBackground(Job* job) noexcept;
+    Job* popBackground(BackgroundPolicy policy) noexcept;
 
     [[nodiscard]]
-    uint32_t wait(std::unique_lock<Mutex>& lock, Job* job) noexcept;
+    uint32_t wait(std::unique_lock<Mutex>& lock, Job* job, BackgroundPolicy policy) noexcept;
     void wait(std::unique_lock<Mutex>& lock) noexcept;
     void wakeAll() noexcept;
     void wakeOne() noexcept;
@@ -446,7 +566,10 @@ private:
     Condition mWaiterCondition;
 
     std::atomic<int32_t> mActiveJobs = { 0 };
-    utils::Arena<utils::ThreadSafeObjectPoolAllocator<Job>, LockingPolicy::NoLock> mJobPool;
+    // lock-free list of the free jobs: index + 1 of the first one in the low 32 bits, and a
+    // counter in the high 32 bits so that a job popped and pushed back can't be mistaken for
+    // the one we read.
+    std::atomic<uint64_t> mFreeJobs = { 0 };
 
     template <typename T>
     using aligned_vector = std::vector<T, utils::STLAlignedAllocator<T>>;
@@ -461,13 +584,30 @@ private:
     aligned_vector<ThreadState> mThreadStates;          // actual data is stored offline
     std::atomic<bool> mExitRequested = { false };       // this one is almost never written
     std::atomic<uint16_t> mAdoptedThreads = { 0 };      // this one is almost never written
-    Job* const mJobStorageBase;                         // Base for conversion to indices
     uint16_t mThreadCount = 0;                          // total # of threads in the pool
     uint8_t mParallelSplitCount = 0;                    // # of split allowable in parallel_for
     Job* mRootJob = nullptr;
 
     Mutex mThreadMapLock; // this should have very little contention
     tsl::robin_map<std::thread::id, ThreadState *> mThreadMap;
+
+    // the pool only grows, a segment is never freed before the JobSystem is destroyed
+    Mutex mJobPoolLock;
+    std::atomic<Job*> mJobSegments[MAX_SEGMENT_COUNT] = {};     // written under mJobPoolLock
+    std::atomic<uint32_t> mJobSegmentCount = { 0 };             // written under mJobPoolLock
+
+    // overflowing a thread's queue only happens with huge fan-outs, a locked queue is good enough
+    Mutex mOverflowLock;
+    std::vector<Job*> mOverflowQueue;                   // guarded by mOverflowLock
+    std::atomic<uint32_t> mOverflowCount = { 0 };       // # of jobs in mOverflowQueue
+    std::atomic<uint64_t> mOverflowJobs = { 0 };        // # of jobs ever put in mOverflowQueue
+
+    // background jobs are rare and long, a locked queue shared by all threads is good enough
+    Mutex mBackgroundLock;
+    std::deque<Job*> mBackgroundQueue;                  // guarded by mBackgroundLock
+    std::atomic<uint32_t> mBackgroundJobs = { 0 };      // # of queued background jobs
+    std::atomic<uint32_t> mBackgroundRunning = { 0 };   // # of background jobs run by BOUNDED threads
+    std::atomic<uint32_t> mBackgroundConcurrency = { 1 };
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -544,8 +684,13 @@ right_side:
             }
 
             // start the left side before attempting the right side, so we parallelize in case
-            // of job creation failure -- rare, but still.
-            js.run(l, JobSystem::getThreadId(parent));
+            // of job creation failure -- rare, but still. It keeps the priority of the job it's
+            // split from, so that splitting background work doesn't make it critical.
+            if (JobSystem::getPriority(parent) == JobSystem::JobPriority::BACKGROUND) {
+                js.run(l, JobSystem::JobPriority::BACKGROUND);
+            } else {
+                js.run(l, JobSystem::getThreadId(parent));
+            }
 
             // don't spawn a job for the right side, just reuse us -- spawning jobs is more
             // costly than we'd like.
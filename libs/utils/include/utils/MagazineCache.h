@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_UTILS_MAGAZINECACHE_H
+#define TNT_UTILS_MAGAZINECACHE_H
+
+#include <utils/architecture.h>
+#include <utils/compiler.h>
+#include <utils/debug.h>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace utils {
+
+/*
+ * A per-thread cache of free objects, to put in front of a shared (and typically locked) pool.
+ *
+ * Each thread works on its own pair of "magazines" (small stacks of pointers) without any
+ * synchronization other than an uncontended flag. Full and empty magazines are exchanged between
+ * threads through a lock-free depot, so a thread that only frees objects and a thread that only
+ * allocates them (e.g. the engine and driver threads) pass whole magazines to each other. The
+ * backing pool is only accessed, one magazine at a time, when the depot can't help:
+ *
+ *  - refill(void** items, size_t count) -> size_t : pops up to count objects, returns how many
+ *  - drain(void* const* items, size_t count)      : returns count objects
+ *
+ * Threads are mapped to CACHE_COUNT caches by a process-wide thread index. When two threads map
+ * to the same cache and collide, the loser goes straight to the backing pool.
+ *
+ * This is based on "Magazines and Vmem: Extending the Slab Allocator to Many CPUs and Arbitrary
+ * Resources", Bonwick & Adams, 2001.
+ */
+template<size_t MAGAZINE_SIZE = 32, size_t CACHE_COUNT = 4, size_t DEPOT_SIZE = 16>
+class MagazineCache {
+    static_assert(MAGAZINE_SIZE > 0 && CACHE_COUNT > 0);
+    static constexpr size_t MAGAZINE_COUNT = CACHE_COUNT * 2 + DEPOT_SIZE;
+
+public:
+    MagazineCache() noexcept {
+        for (size_t i = 0; i < CACHE_COUNT; i++) {
+            mCaches[i].loaded = &mMagazines[i * 2];
+            mCaches[i].previous = &mMagazines[i * 2 + 1];
+        }
+        for (size_t i = CACHE_COUNT * 2; i < MAGAZINE_COUNT; i++) {
+            pushMagazine(mEmpty, &mMagazines[i]);
+        }
+    }
+
+    MagazineCache(MagazineCache const& rhs) = delete;
+    MagazineCache& operator=(MagazineCache const& rhs) = delete;
+
+    // returns a cached object, or one from refill(), or nullptr when the backing pool is empty
+    template<typename Refill>
+    void* pop(Refill&& refill) noexcept {
+        Cache& cache = getCache();
+        if (UTILS_UNLIKELY(cache.busy.exchange(true, std::memory_order_acquire))) {
+            void* p = nullptr;
+            refill(&p, 1);
+            return p;
+        }
+        Magazine* loaded = cache.loaded;
+        if (UTILS_UNLIKELY(loaded->count == 0)) {
+            loaded = reload(cache, std::forward<Refill>(refill));
+        }
+        void* const p = loaded->count ? loaded->items[--loaded->count] : nullptr;
+        cache.busy.store(false, std::memory_order_release);
+        return p;
+    }
+
+    // caches an object, the backing pool gets it back through drain() when the caches are full
+    template<typename Drain>
+    void push(void* p, Drain&& drain) noexcept {
+        assert_invariant(p);
+        Cache& cache = getCache();
+        if (UTILS_UNLIKELY(cache.busy.exchange(true, std::memory_order_acquire))) {
+            drain(&p, 1);
+            return;
+        }
+        Magazine* loaded = cache.loaded;
+        if (UTILS_UNLIKELY(loaded->count == MAGAZINE_SIZE)) {
+            loaded = unload(cache, std::forward<Drain>(drain));
+        }
+        loaded->items[loaded->count++] = p;
+        cache.busy.store(false, std::memory_order_release);
+    }
+
+    // Returns all cached objects to the backing pool. Not thread-safe.
+    template<typename Drain>
+    void clear(Drain&& drain) noexcept {
+        for (Magazine& magazine : mMagazines) {
+            if (magazine.count) {
+                drain(magazine.items, magazine.count);
+                magazine.count = 0;
+            }
+        }
+    }
+
+private:
+    struct Magazine {
+        std::atomic<int32_t> next{ -1 };    // index of the next magazine in a depot stack
+        uint32_t count = 0;
+        void* items[MAGAZINE_SIZE];
+    };
+
+    struct Cache {
+        std::atomic<bool> busy{ false };
+        Magazine* loaded = nullptr;     // partially filled
+        Magazine* previous = nullptr;   // always full or empty
+        // keep caches used by different threads on different cache-lines
+        char padding[CACHELINE_SIZE - sizeof(std::atomic<bool>) - 2 * sizeof(Magazine*)];
+    };
+
+    // a Treiber stack of magazine indices, the tag prevents the ABA problem
+    struct alignas(8) Head {
+        int32_t index;
+        uint32_t tag;
+    };
+
+    static uint32_t getThreadIndex() noexcept {
+#if UTILS_HAS_FEATURE_CXX_THREAD_LOCAL
+        static std::atomic<uint32_t> sNextIndex{ 0 };
+        static thread_local uint32_t const index =
+                sNextIndex.fetch_add(1, std::memory_order_relaxed);
+        return index;
+#else
+        return uint32_t(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+    }
+
+    Cache& getCache() noexcept {
+        return mCaches[getThreadIndex() % CACHE_COUNT];
+    }
+
+    void pushMagazine(std::atomic<Head>& stack, Magazine* magazine) noexcept {
+        int32_t const index = int32_t(magazine - mMagazines);
+        Head head = stack.load(std::memory_order_relaxed);
+        Head newHead;
+        do {
+            magazine->next.store(head.index, std::memory_order_relaxed);
+            newHead = { index, head.tag + 1 };
+        } while (!stack.compare_exchange_weak(head, newHead,
+                std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    Magazine* popMagazine(std::atomic<Head>& stack) noexcept {
+        Head head = stack.load(std::memory_order_acquire);
+        while (head.index >= 0) {
+            // `next` may be stale if another thread raced ahead of us, but then the tag won't
+            // match and the CAS fails.
+            int32_t const next = mMagazines[head.index].next.load(std::memory_order_relaxed);
+            if (stack.compare_exchange_weak(head, { next, head.tag + 1 },
+                    std::memory_order_acquire, std::memory_order_acquire)) {
+                return &mMagazines[head.index];
+            }
+        }
+        return nullptr;
+    }
+
+    template<typename Refill>
+    UTILS_NOINLINE
+    Magazine* reload(Cache& cache, Refill&& refill) noexcept {
+        if (cache.previous->count) {
+            std::swap(cache.loaded, cache.previous);
+            return cache.loaded;
+        }
+        Magazine* const full = popMagazine(mFull);
+        if (full) {
+            // both our magazines are empty, give one back to the depot
+            pushMagazine(mEmpty, cache.previous);
+            cache.previous = cache.loaded;
+            cache.loaded = full;
+            return full;
+        }
+        Magazine* const loaded = cache.loaded;
+        loaded->count = uint32_t(refill(loaded->items, MAGAZINE_SIZE));
+        return loaded;
+    }
+
+    template<typename Drain>
+    UTILS_NOINLINE
+    Magazine* unload(Cache& cache, Drain&& drain) noexcept {
+        if (!cache.previous->count) {
+            std::swap(cache.loaded, cache.previous);
+            return cache.loaded;
+        }
+        Magazine* const empty = popMagazine(mEmpty);
+        if (empty) {
+            // both our magazines are full, hand one over to the depot
+            pushMagazine(mFull, cache.previous);
+            cache.previous = cache.loaded;
+            cache.loaded = empty;
+            return empty;
+        }
+        Magazine* const loaded = cache.loaded;
+        drain(loaded->items, loaded->count);
+        loaded->count = 0;
+        return loaded;
+    }
+
+    Cache mCaches[CACHE_COUNT];
+    std::atomic<Head> mFull{ Head{ -1, 0 } };
+    std::atomic<Head> mEmpty{ Head{ -1, 0 } };
+    Magazine mMagazines[MAGAZINE_COUNT];
+};
+
+} // namespace utils
+
+#endif // TNT_UTILS_MAGAZINECACHE_H
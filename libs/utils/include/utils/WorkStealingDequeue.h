@@ -68,6 +68,7 @@ public:
     using value_type = TYPE;
 
     inline void push(TYPE item) noexcept;
+    inline bool tryPush(TYPE item) noexcept;
     inline TYPE pop() noexcept;
     inline TYPE steal() noexcept;
 
@@ -100,6 +101,25 @@ void WorkStealingDequeue<TYPE, COUNT>::push(TYPE item) noexcept {
     mBottom.store(bottom + 1, std::memory_order_seq_cst);
 }
 
+/*
+ * Adds an item at the BOTTOM of the queue, unless the queue is full.
+ *
+ * Must be called from the main thread.
+ *
+ * returns false if the queue is full, this can be a false positive while steal() is in progress.
+ */
+template <typename TYPE, size_t COUNT>
+bool WorkStealingDequeue<TYPE, COUNT>::tryPush(TYPE item) noexcept {
+    // mTop only increases, so a stale value can only make the queue look fuller than it is.
+    index_t const bottom = mBottom.load(std::memory_order_relaxed);
+    index_t const top = mTop.load(std::memory_order_relaxed);
+    if (bottom - top >= index_t(COUNT)) {
+        return false;
+    }
+    push(item);
+    return true;
+}
+
 /*
  * Removes an item from the BOTTOM of the queue.
  *
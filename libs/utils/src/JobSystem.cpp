@@ -28,6 +28,7 @@
 #include <utils/compiler.h>
 #include <utils/debug.h>
 #include <utils/Log.h>
+#include <utils/memalign.h>
 #include <utils/ostream.h>
 #include <utils/Panic.h>
 #include <utils/Systrace.h>
@@ -92,6 +93,17 @@
 
 namespace utils {
 
+// The stats are only written by the thread owning them, so a relaxed load and store is enough and
+// cheaper than an atomic increment.
+static inline void incStat(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static uint64_t nanosecondsSince(std::chrono::steady_clock::time_point start) noexcept {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+}
+
 void JobSystem::setThreadName(const char* name) noexcept {
 #if defined(__linux__)
     pthread_setname_np(pthread_self(), name);
@@ -147,11 +159,13 @@ void JobSystem::setThreadAffinityById(size_t id) noexcept {
 }
 
 JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreadsCount) noexcept
-    : mJobPool("JobSystem Job pool", MAX_JOB_COUNT * sizeof(Job)),
-      mJobStorageBase(static_cast<Job *>(mJobPool.getAllocator().getCurrent()))
 {
     SYSTRACE_ENABLE();
 
+    // the first segment is allocated upfront, the pool only grows with bigger workloads
+    UTILS_UNUSED_IN_RELEASE bool const added = addJobSegment();
+    assert_invariant(added);
+
     unsigned int threadPoolCount = userThreadCount;
     if (threadPoolCount == 0) {
         // default value, system dependant
@@ -172,10 +186,12 @@ JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreads
 
     mThreadStates = aligned_vector<ThreadState>(threadPoolCount + adoptableThreadsCount);
     mThreadCount = uint16_t(threadPoolCount);
+    mBackgroundConcurrency.store(std::max(1u, threadPoolCount / 2), std::memory_order_relaxed);
     mParallelSplitCount = (uint8_t)std::ceil((std::log2f(threadPoolCount + adoptableThreadsCount)));
 
     static_assert(std::atomic<bool>::is_always_lock_free);
     static_assert(std::atomic<uint16_t>::is_always_lock_free);
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
 
     std::random_device rd;
     const size_t hardwareThreadCount = mThreadCount;
@@ -203,6 +219,11 @@ JobSystem::~JobSystem() {
             state.thread.join();
         }
     }
+
+    for (size_t i = 0, n = mJobSegmentCount.load(std::memory_order_relaxed); i < n; i++) {
+        // Job is trivially destructible
+        aligned_free(mJobSegments[i].load(std::memory_order_relaxed));
+    }
 }
 
 inline void JobSystem::incRef(Job const* job) noexcept {
@@ -225,8 +246,8 @@ void JobSystem::decRef(Job const* job) noexcept {
     auto c = job->refCount.fetch_sub(1, std::memory_order_acq_rel);
     assert(c > 0);
     if (c == 1) {
-        // This was the last reference, it's safe to destroy the job.
-        mJobPool.destroy(job);
+        // This was the last reference, it's safe to recycle the job.
+        pushFreeJobs(job, job);
     }
 }
 
@@ -245,6 +266,16 @@ inline bool JobSystem::hasActiveJobs() const noexcept {
     return mActiveJobs.load(std::memory_order_relaxed) > 0;
 }
 
+inline bool JobSystem::hasBackgroundJobs() const noexcept {
+    return mBackgroundJobs.load(std::memory_order_relaxed) > 0;
+}
+
+inline bool JobSystem::hasRunnableBackgroundJobs() const noexcept {
+    return hasBackgroundJobs() &&
+           mBackgroundRunning.load(std::memory_order_relaxed) <
+           mBackgroundConcurrency.load(std::memory_order_relaxed);
+}
+
 inline bool JobSystem::hasJobCompleted(JobSystem::Job const* job) noexcept {
     return (job->runningJobCount.load(std::memory_order_acquire) & JOB_COUNT_MASK) == 0;
 }
@@ -254,11 +285,13 @@ inline void JobSystem::wait(std::unique_lock<Mutex>& lock) noexcept {
     mWaiterCondition.wait(lock);
 }
 
-inline uint32_t JobSystem::wait(std::unique_lock<Mutex>& lock, Job* const job) noexcept {
+inline uint32_t JobSystem::wait(std::unique_lock<Mutex>& lock, Job* const job,
+        BackgroundPolicy policy) noexcept {
     HEAVY_SYSTRACE_CALL();
     // signal we are waiting
 
-    if (hasActiveJobs() || exitRequested()) {
+    if (hasActiveJobs() || exitRequested() ||
+            (policy == BackgroundPolicy::ANY && hasBackgroundJobs())) {
         return job->runningJobCount.load(std::memory_order_acquire);
     }
 
@@ -307,17 +340,123 @@ inline JobSystem::ThreadState& JobSystem::getState() noexcept {
     return *iter->second;
 }
 
+inline JobSystem::Job* JobSystem::getJob(uint32_t index) const noexcept {
+    assert_invariant(index < MAX_JOB_COUNT);
+    // memory_order_relaxed is enough because the segment was published with mFreeJobs
+    Job* const segment = mJobSegments[index / SEGMENT_JOB_COUNT].load(std::memory_order_relaxed);
+    return segment + (index % SEGMENT_JOB_COUNT);
+}
+
+JobSystem::Job* JobSystem::popFreeJob() noexcept {
+    // std::memory_order_acquire is needed to see the job's nextFree (and its segment), as well
+    // as everything the thread that freed the job did with it.
+    uint64_t head = mFreeJobs.load(std::memory_order_acquire);
+    while (uint32_t(head)) {
+        Job* const job = getJob(uint32_t(head) - 1);
+        // nextFree could be stale if the job was popped since we read head, but then head has
+        // changed and the compare_exchange fails.
+        uint64_t const next = uint64_t(job->nextFree.load(std::memory_order_relaxed)) |
+                (((head >> 32u) + 1u) << 32u);
+        if (mFreeJobs.compare_exchange_weak(head, next,
+                std::memory_order_acquire, std::memory_order_acquire)) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::pushFreeJobs(Job const* first, Job const* last) noexcept {
+    // first to last must already be linked through nextFree
+    uint64_t head = mFreeJobs.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        last->nextFree.store(uint32_t(head), std::memory_order_relaxed);
+        next = uint64_t(first->index + 1u) | (((head >> 32u) + 1u) << 32u);
+    } while (!mFreeJobs.compare_exchange_weak(head, next,
+            std::memory_order_release, std::memory_order_relaxed));
+}
+
+UTILS_NOINLINE
+bool JobSystem::addJobSegment() noexcept {
+    uint32_t const segment = mJobSegmentCount.load(std::memory_order_relaxed);
+    if (UTILS_UNLIKELY(segment == MAX_SEGMENT_COUNT)) {
+        return false;
+    }
+
+    SYSTRACE_CALL();
+    Job* const jobs = static_cast<Job*>(aligned_alloc(SEGMENT_JOB_COUNT * sizeof(Job), alignof(Job)));
+    if (UTILS_UNLIKELY(!jobs)) {
+        return false;
+    }
+
+    uint32_t const base = segment * SEGMENT_JOB_COUNT;
+    for (uint32_t i = 0; i < SEGMENT_JOB_COUNT; i++) {
+        Job* const job = new(&jobs[i]) Job();
+        job->index = base + i;
+        job->nextFree.store(base + i + 2u, std::memory_order_relaxed);
+    }
+
+    // the segment must be visible before any of its jobs can be popped
+    mJobSegments[segment].store(jobs, std::memory_order_relaxed);
+    mJobSegmentCount.store(segment + 1, std::memory_order_relaxed);
+    pushFreeJobs(&jobs[0], &jobs[SEGMENT_JOB_COUNT - 1]);
+    return true;
+}
+
 JobSystem::Job* JobSystem::allocateJob() noexcept {
-    return mJobPool.make<Job>();
+    Job* job = popFreeJob();
+    if (UTILS_UNLIKELY(!job)) {
+        std::lock_guard<Mutex> const lock(mJobPoolLock);
+        // another thread could have grown the pool while we were waiting for the lock
+        job = popFreeJob();
+        while (!job && addJobSegment()) {
+            job = popFreeJob();
+        }
+        if (UTILS_UNLIKELY(!job)) {
+            return nullptr;
+        }
+    }
+
+    // recycled jobs keep their state from the last time they were used
+    job->successors[0] = nullptr;
+    job->successors[1] = nullptr;
+    job->runningJobCount.store(1, std::memory_order_relaxed);
+    job->pendingCount.store(1, std::memory_order_relaxed);
+    job->refCount.store(1, std::memory_order_relaxed);
+    job->id = invalidThreadId;
+    job->flags = 0;
+    return job;
+}
+
+inline bool JobSystem::isReady(Job* job) noexcept {
+    // pendingCount is the number of unfinished predecessors, plus one for the run() call. In the
+    // common case there are no predecessors and we don't need to decrement it.
+    return job->pendingCount.load(std::memory_order_acquire) == 1 ||
+           job->pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+
+void JobSystem::release(ThreadState& state, Job* successor) noexcept {
+    // std::memory_order_acq_rel is needed so that the successor "sees" everything its
+    // predecessors did, regardless of which one releases it.
+    if (successor->pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (successor->flags & BACKGROUND_FLAG) {
+            putBackground(successor);
+        } else {
+            put(state.workQueue, successor);
+        }
+    }
 }
 
 void JobSystem::put(WorkQueue& workQueue, Job* job) noexcept {
     assert(job);
-    size_t const index = job - mJobStorageBase;
-    assert(index >= 0 && index < MAX_JOB_COUNT);
 
-    // put the job into the queue
-    workQueue.push(uint16_t(index + 1));
+    // put the job into the queue, or in the overflow queue if it's full
+    if (UTILS_UNLIKELY(!workQueue.tryPush(job))) {
+        std::lock_guard<Mutex> const lock(mOverflowLock);
+        mOverflowQueue.push_back(job);
+        mOverflowCount.fetch_add(1, std::memory_order_relaxed);
+        mOverflowJobs.fetch_add(1, std::memory_order_relaxed);
+    }
 
     // increase our active job count (the order in which we're doing this must not matter
     // because we're not using std::memory_order_seq_cst (here or in WorkQueue::push()).
@@ -331,9 +470,7 @@ void JobSystem::put(WorkQueue& workQueue, Job* job) noexcept {
 }
 
 JobSystem::Job* JobSystem::pop(WorkQueue& workQueue) noexcept {
-    size_t const index = workQueue.pop();
-    assert(index <= MAX_JOB_COUNT);
-    Job* const job = !index ? nullptr : &mJobStorageBase[index - 1];
+    Job* const job = workQueue.pop();
     if (UTILS_LIKELY(job)) {
         mActiveJobs.fetch_sub(1, std::memory_order_relaxed);
     }
@@ -341,15 +478,84 @@ JobSystem::Job* JobSystem::pop(WorkQueue& workQueue) noexcept {
 }
 
 JobSystem::Job* JobSystem::steal(WorkQueue& workQueue) noexcept {
-    size_t const index = workQueue.steal();
-    assert_invariant(index <= MAX_JOB_COUNT);
-    Job* const job = !index ? nullptr : &mJobStorageBase[index - 1];
+    Job* const job = workQueue.steal();
     if (UTILS_LIKELY(job)) {
         mActiveJobs.fetch_sub(1, std::memory_order_relaxed);
     }
     return job;
 }
 
+JobSystem::Job* JobSystem::popOverflow() noexcept {
+    if (UTILS_LIKELY(!mOverflowCount.load(std::memory_order_relaxed))) {
+        return nullptr;
+    }
+    Job* job = nullptr;
+    {
+        std::lock_guard<Mutex> const lock(mOverflowLock);
+        if (!mOverflowQueue.empty()) {
+            job = mOverflowQueue.back();
+            mOverflowQueue.pop_back();
+            mOverflowCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    if (job) {
+        mActiveJobs.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+void JobSystem::putBackground(Job* job) noexcept {
+    assert(job);
+    // run() flagged the job, waitAndRelease() uses this to know it may help with background jobs
+    assert_invariant(job->flags & BACKGROUND_FLAG);
+
+    {
+        std::lock_guard<Mutex> const lock(mBackgroundLock);
+        mBackgroundQueue.push_back(job);
+        // updated under the lock so that it never disagrees with the queue
+        mBackgroundJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // wakeOne() could wake a thread that is not allowed to run background jobs (e.g. one waiting
+    // on a critical job), in which case no worker would pick this one up. Background jobs are
+    // rare enough that we can afford waking everybody.
+    wakeAll();
+}
+
+JobSystem::Job* JobSystem::popBackground(BackgroundPolicy policy) noexcept {
+    assert_invariant(policy != BackgroundPolicy::NONE);
+    if (!hasBackgroundJobs()) {
+        return nullptr;
+    }
+
+    bool const bounded = policy == BackgroundPolicy::BOUNDED;
+    if (bounded) {
+        // reserve a slot before popping, so that the concurrency limit can't be exceeded
+        uint32_t running = mBackgroundRunning.load(std::memory_order_relaxed);
+        do {
+            if (running >= mBackgroundConcurrency.load(std::memory_order_relaxed)) {
+                return nullptr;
+            }
+        } while (!mBackgroundRunning.compare_exchange_weak(running, running + 1,
+                std::memory_order_relaxed));
+    }
+
+    Job* job = nullptr;
+    {
+        std::lock_guard<Mutex> const lock(mBackgroundLock);
+        if (!mBackgroundQueue.empty()) {
+            job = mBackgroundQueue.front();
+            mBackgroundQueue.pop_front();
+            mBackgroundJobs.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (UTILS_UNLIKELY(!job && bounded)) {
+        mBackgroundRunning.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
 inline JobSystem::ThreadState* JobSystem::getStateToStealFrom(JobSystem::ThreadState& state) noexcept {
     auto& threadStates = mThreadStates;
     // memory_order_relaxed is okay because we don't take any action that has data dependency
@@ -375,18 +581,27 @@ inline JobSystem::ThreadState* JobSystem::getStateToStealFrom(JobSystem::ThreadS
 JobSystem::Job* JobSystem::steal(JobSystem::ThreadState& state) noexcept {
     HEAVY_SYSTRACE_CALL();
     Job* job = nullptr;
+    uint64_t attempts = 0;
     do {
         ThreadState* const stateToStealFrom = getStateToStealFrom(state);
         if (stateToStealFrom) {
+            attempts++;
             job = steal(stateToStealFrom->workQueue);
         }
+        if (!job) {
+            // the active jobs could all be in the overflow queue
+            job = popOverflow();
+        } else {
+            incStat(state.jobsStolen, 1);
+        }
         // nullptr -> nothing to steal in that queue either, if there are active jobs,
         // continue to try stealing one.
     } while (!job && hasActiveJobs());
+    incStat(state.stealAttempts, attempts);
     return job;
 }
 
-bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
+bool JobSystem::execute(JobSystem::ThreadState& state, BackgroundPolicy policy) noexcept {
     HEAVY_SYSTRACE_CALL();
 
     Job* job = pop(state.workQueue);
@@ -400,6 +615,13 @@ bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
         job = steal(state);
     }
 
+    bool background = false;
+    if (UTILS_UNLIKELY(!job && policy != BackgroundPolicy::NONE)) {
+        // there is no critical work left for us, fall back to a background job
+        job = popBackground(policy);
+        background = job != nullptr;
+    }
+
     if (UTILS_LIKELY(job)) {
         assert((job->runningJobCount.load(std::memory_order_relaxed) & JOB_COUNT_MASK) >= 1);
         if (UTILS_LIKELY(job->function)) {
@@ -408,7 +630,20 @@ bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
             job->function(job->storage, *this, job);
             job->id = invalidThreadId;
         }
-        finish(job);
+        // counted before finish(), which can release a thread that then reads the stats
+        incStat(state.jobsRun, 1);
+        if (job->flags & BACKGROUND_FLAG) {
+            incStat(state.backgroundJobsRun, 1);
+        }
+        finish(job, &state);
+    }
+
+    if (UTILS_UNLIKELY(background && policy == BackgroundPolicy::BOUNDED)) {
+        mBackgroundRunning.fetch_sub(1, std::memory_order_relaxed);
+        // a worker might have gone to sleep because the limit was reached
+        if (hasBackgroundJobs()) {
+            wakeAll();
+        }
     }
     return job != nullptr;
 }
@@ -426,23 +661,26 @@ void JobSystem::loop(ThreadState* state) noexcept {
 
     // run our main loop...
     do {
-        if (!execute(*state)) {
+        if (!execute(*state, BackgroundPolicy::BOUNDED)) {
             std::unique_lock<Mutex> lock(mWaiterLock);
-            while (!exitRequested() && !hasActiveJobs()) {
-                wait(lock);
+            if (!exitRequested() && !hasActiveJobs() && !hasRunnableBackgroundJobs()) {
+                auto const idleStart = std::chrono::steady_clock::now();
+                do {
+                    wait(lock);
+                } while (!exitRequested() && !hasActiveJobs() && !hasRunnableBackgroundJobs());
+                incStat(state->idleNanoseconds, nanosecondsSince(idleStart));
             }
         }
     } while (!exitRequested());
 }
 
 UTILS_NOINLINE
-void JobSystem::finish(Job* job) noexcept {
+void JobSystem::finish(Job* job, ThreadState* state) noexcept {
     HEAVY_SYSTRACE_CALL();
 
     bool notify = false;
 
     // terminate this job and notify its parent
-    Job* const storage = mJobStorageBase;
     do {
         // std::memory_order_release here is needed to synchronize with JobSystem::wait()
         // which needs to "see" all changes that happened before the job terminated.
@@ -456,7 +694,18 @@ void JobSystem::finish(Job* job) noexcept {
             if (waiters) {
                 notify = true;
             }
-            Job* const parent = job->parent == 0x7FFF ? nullptr : &storage[job->parent];
+            // the job and its children are done, its successors can start
+            if (UTILS_UNLIKELY(job->successors[0])) {
+                if (!state) {
+                    state = &getState();
+                }
+                for (Job* const successor : job->successors) {
+                    if (successor) {
+                        release(*state, successor);
+                    }
+                }
+            }
+            Job* const parent = job->parent;
             decRef(job);
             job = parent;
         } else {
@@ -480,7 +729,6 @@ JobSystem::Job* JobSystem::create(JobSystem::Job* parent, JobFunc func) noexcept
     parent = (parent == nullptr) ? mRootJob : parent;
     Job* const job = allocateJob();
     if (UTILS_LIKELY(job)) {
-        size_t index = 0x7FFF;
         if (parent) {
             // add a reference to the parent to make sure it can't be terminated.
             // memory_order_relaxed is safe because no action is taken at this point
@@ -490,21 +738,43 @@ JobSystem::Job* JobSystem::create(JobSystem::Job* parent, JobFunc func) noexcept
 
             // can't create a child job of a terminated parent
             assert((parentJobCount & JOB_COUNT_MASK) > 0);
-
-            index = parent - mJobStorageBase;
-            assert(index < MAX_JOB_COUNT);
         }
         job->function = func;
-        job->parent = uint16_t(index);
+        job->parent = parent;
     }
     return job;
 }
 
 void JobSystem::cancel(Job*& job) noexcept {
-    finish(job);
+    finish(job, nullptr);
     job = nullptr;
 }
 
+void JobSystem::precede(Job* predecessor, Job* successor) noexcept {
+    assert(predecessor && successor && predecessor != successor);
+
+    // memory_order_relaxed is safe because neither job is running yet
+    successor->pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+    Job** const successors = predecessor->successors;
+    if (!successors[0]) {
+        successors[0] = successor;
+    } else if (!successors[1]) {
+        successors[1] = successor;
+    } else {
+        // no room left, the second slot becomes an empty job that releases both the successor
+        // it replaces and the new one
+        Job* const relay = allocateJob();
+        FILAMENT_CHECK_POSTCONDITION(relay) << "JobSystem is out of jobs";
+        relay->function = nullptr;
+        relay->parent = nullptr;
+        relay->successors[0] = successors[1];
+        relay->successors[1] = successor;
+        // the relay is never run(), it only waits for predecessor
+        successors[1] = relay;
+    }
+}
+
 JobSystem::Job* JobSystem::retain(JobSystem::Job* job) noexcept {
     JobSystem::Job* retained = job;
     incRef(retained);
@@ -521,7 +791,9 @@ void JobSystem::run(Job*& job) noexcept {
 
     ThreadState& state(getState());
 
-    put(state.workQueue, job);
+    if (isReady(job)) {
+        put(state.workQueue, job);
+    }
 
     // after run() returns, the job is virtually invalid (it'll die on its own)
     job = nullptr;
@@ -533,7 +805,25 @@ void JobSystem::run(Job*& job, uint8_t id) noexcept {
     ThreadState& state = mThreadStates[id];
     assert_invariant(&state == &getState());
 
-    put(state.workQueue, job);
+    if (isReady(job)) {
+        put(state.workQueue, job);
+    }
+
+    // after run() returns, the job is virtually invalid (it'll die on its own)
+    job = nullptr;
+}
+
+void JobSystem::run(Job*& job, JobPriority priority) noexcept {
+    if (priority == JobPriority::CRITICAL) {
+        run(job);
+        return;
+    }
+
+    // set before the job can be released by its predecessors
+    job->flags |= BACKGROUND_FLAG;
+    if (isReady(job)) {
+        putBackground(job);
+    }
 
     // after run() returns, the job is virtually invalid (it'll die on its own)
     job = nullptr;
@@ -545,15 +835,35 @@ JobSystem::Job* JobSystem::runAndRetain(Job* job) noexcept {
     return retained;
 }
 
+JobSystem::Job* JobSystem::runAndRetain(Job* job, JobPriority priority) noexcept {
+    JobSystem::Job* retained = retain(job);
+    run(job, priority);
+    return retained;
+}
+
+void JobSystem::setBackgroundConcurrency(size_t count) noexcept {
+    count = std::clamp(count, size_t(1), size_t(mThreadStates.size()));
+    mBackgroundConcurrency.store(uint32_t(count), std::memory_order_relaxed);
+    // workers may now be allowed to pick up background jobs
+    if (hasBackgroundJobs()) {
+        wakeAll();
+    }
+}
+
 void JobSystem::waitAndRelease(Job*& job) noexcept {
     SYSTRACE_CALL();
 
     assert(job);
     assert(job->refCount.load(std::memory_order_relaxed) >= 1);
 
+    // only help with background jobs if we're waiting on one, otherwise a long background job
+    // could delay whatever critical work we're waiting on
+    BackgroundPolicy const policy = (job->flags & BACKGROUND_FLAG) ?
+            BackgroundPolicy::ANY : BackgroundPolicy::NONE;
+
     ThreadState& state(getState());
     do {
-        if (UTILS_UNLIKELY(!execute(state))) {
+        if (UTILS_UNLIKELY(!execute(state, policy))) {
             // test if job has completed first, to possibly avoid taking the lock
             if (hasJobCompleted(job)) {
                 break;
@@ -569,7 +879,9 @@ void JobSystem::waitAndRelease(Job*& job) noexcept {
             // continue to handle more jobs, as they get added.
 
             std::unique_lock<Mutex> lock(mWaiterLock);
-            uint32_t const runningJobCount = wait(lock, job);
+            auto const idleStart = std::chrono::steady_clock::now();
+            uint32_t const runningJobCount = wait(lock, job, policy);
+            incStat(state.idleNanoseconds, nanosecondsSince(idleStart));
             // we could be waking up because either:
             // - the job we're waiting on has completed
             // - more jobs where added to the JobSystem
@@ -644,11 +956,31 @@ void JobSystem::emancipate() {
     mThreadMap.erase(iter);
 }
 
+JobSystem::Stats JobSystem::getStats() const noexcept {
+    Stats stats;
+    for (auto const& state : mThreadStates) {
+        stats.jobsRun += state.jobsRun.load(std::memory_order_relaxed);
+        stats.backgroundJobsRun += state.backgroundJobsRun.load(std::memory_order_relaxed);
+        stats.jobsStolen += state.jobsStolen.load(std::memory_order_relaxed);
+        stats.stealAttempts += state.stealAttempts.load(std::memory_order_relaxed);
+        stats.idleNanoseconds += state.idleNanoseconds.load(std::memory_order_relaxed);
+    }
+    stats.overflowJobs = mOverflowJobs.load(std::memory_order_relaxed);
+    stats.jobCapacity = mJobSegmentCount.load(std::memory_order_relaxed) * SEGMENT_JOB_COUNT;
+    return stats;
+}
+
 io::ostream& operator<<(io::ostream& out, JobSystem const& js) {
     for (auto const& item : js.mThreadStates) {
         size_t const id = std::distance(js.mThreadStates.data(), &item);
         out << id << ": " << item.workQueue.getCount() << io::endl;
     }
+    out << "overflow: " << js.mOverflowCount.load(std::memory_order_relaxed) << io::endl;
+    out << "capacity: " << js.mJobSegmentCount.load(std::memory_order_relaxed) *
+            JobSystem::SEGMENT_JOB_COUNT << " jobs" << io::endl;
+    out << "background: " << js.mBackgroundJobs.load(std::memory_order_relaxed)
+        << " queued, " << js.mBackgroundRunning.load(std::memory_order_relaxed)
+        << " running" << io::endl;
     return out;
 }
 
@@ -17,12 +17,17 @@
 #include <algorithm>
 #include <bitset>
 #include <functional>
+#include <mutex>
 #include <utility>
 #include <vector>
 
 #include <gtest/gtest.h>
 
 #include <utils/Allocator.h>
+#include <utils/MagazineCache.h>
+
+#include <atomic>
+#include <thread>
 
 using namespace utils;
 
@@ -330,3 +335,66 @@ TEST(AllocatorTest, STLAllocator) {
 
     EXPECT_EQ(0, arena.getListener().allocations.size());
 }
+
+TEST(AllocatorTest, MagazineCache) {
+    constexpr size_t COUNT = 1024;
+    std::vector<int> storage(COUNT);
+    std::vector<void*> pool;
+    std::mutex lock;
+    for (int& i : storage) {
+        pool.push_back(&i);
+    }
+    auto refill = [&](void** items, size_t count) {
+        std::lock_guard<std::mutex> const guard(lock);
+        size_t i = 0;
+        for (; i < count && !pool.empty(); i++) {
+            items[i] = pool.back();
+            pool.pop_back();
+        }
+        return i;
+    };
+    auto drain = [&](void* const* items, size_t count) {
+        std::lock_guard<std::mutex> const guard(lock);
+        pool.insert(pool.end(), items, items + count);
+    };
+
+    MagazineCache<8, 2, 4> cache;
+
+    // the cache hands out every object exactly once, then runs dry
+    std::vector<void*> objects;
+    while (void* p = cache.pop(refill)) {
+        objects.push_back(p);
+    }
+    EXPECT_EQ(objects.size(), COUNT);
+    std::sort(objects.begin(), objects.end());
+    EXPECT_EQ(std::unique(objects.begin(), objects.end()), objects.end());
+
+    // objects freed on one thread are allocated on another one
+    std::atomic<void*> mailbox[16] = {};
+    std::thread consumer([&]() {
+        for (size_t n = 0; n < COUNT;) {
+            for (auto& slot : mailbox) {
+                if (void* p = slot.exchange(nullptr)) {
+                    cache.push(p, drain);
+                    n++;
+                }
+            }
+        }
+    });
+    for (size_t i = 0; i < COUNT; i++) {
+        auto& slot = mailbox[i % 16];
+        void* expected = nullptr;
+        while (!slot.compare_exchange_weak(expected, objects[i])) {
+            expected = nullptr;
+        }
+    }
+    consumer.join();
+
+    // what's left in the consumer's magazines is only reachable after clear()
+    size_t count = 0;
+    while (cache.pop(refill)) {
+        count++;
+    }
+    cache.clear(drain);
+    EXPECT_EQ(count + pool.size(), COUNT);
+}
@@ -23,6 +23,8 @@
 #include <math/mat3.h>
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <thread>
 #include <utils/Allocator.h>
 
@@ -342,5 +344,223 @@ TEST(JobSystem, JobSystemDelegates) {
     EXPECT_EQ(4, functor.result);
 
 
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemBackgroundJobs) {
+    JobSystem js;
+    js.adopt();
+
+    std::atomic_int calls = { 0 };
+
+    // waiting on a background job helps running background jobs
+    JobSystem::Job* root = js.createJob();
+    for (int i = 0; i < 64; i++) {
+        js.run(jobs::createJob(js, root, [&calls] { calls++; }),
+                JobSystem::JobPriority::BACKGROUND);
+    }
+    root = js.runAndRetain(root, JobSystem::JobPriority::BACKGROUND);
+    js.waitAndRelease(root);
+
+    EXPECT_EQ(64, calls.load());
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemBackgroundConcurrency) {
+    JobSystem js(4);
+    js.adopt();
+    js.setBackgroundConcurrency(1);
+    EXPECT_EQ(1, js.getBackgroundConcurrency());
+
+    std::atomic_int running = { 0 };
+    std::atomic_int maxRunning = { 0 };
+    std::atomic_int calls = { 0 };
+
+    // waiting on a critical job doesn't help with background jobs, so only the workers
+    // run them, and never more than one at a time
+    JobSystem::Job* root = js.createJob();
+    for (int i = 0; i < 8; i++) {
+        js.run(jobs::createJob(js, root, [&] {
+            int const n = ++running;
+            int m = maxRunning.load();
+            while (n > m && !maxRunning.compare_exchange_weak(m, n)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            --running;
+            calls++;
+        }), JobSystem::JobPriority::BACKGROUND);
+    }
+    js.runAndWait(root);
+
+    EXPECT_EQ(8, calls.load());
+    EXPECT_EQ(1, maxRunning.load());
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemCancellationToken) {
+    JobSystem js;
+    js.adopt();
+
+    CancellationToken token;
+    std::atomic_int work = { 0 };
+
+    auto submit = [&] {
+        JobSystem::Job* root = js.createJob();
+        for (int i = 0; i < 16; i++) {
+            js.run(jobs::createJob(js, root, [&] {
+                if (!token.isCancelled()) {
+                    work++;
+                }
+            }), JobSystem::JobPriority::BACKGROUND);
+        }
+        root = js.runAndRetain(root, JobSystem::JobPriority::BACKGROUND);
+        js.waitAndRelease(root);
+    };
+
+    token.cancel();
+    submit();
+    EXPECT_EQ(0, work.load());
+
+    token.reset();
+    submit();
+    EXPECT_EQ(16, work.load());
+
+    js.emancipate();
+}
+
+TEST(JobSystem, WorkStealingDequeueTryPush) {
+    struct MyJob {
+    };
+    WorkStealingDequeue<MyJob*, 4> queue;
+    MyJob jobs[5];
+
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.tryPush(&jobs[i]));
+    }
+    EXPECT_FALSE(queue.tryPush(&jobs[4]));
+    EXPECT_EQ(&jobs[0], queue.steal());
+    EXPECT_TRUE(queue.tryPush(&jobs[4]));
+    EXPECT_EQ(4, queue.getCount());
+}
+
+TEST(JobSystem, JobSystemGrowPool) {
+    JobSystem js;
+    js.adopt();
+
+    size_t const capacity = js.getStats().jobCapacity;
+    std::atomic_int calls = { 0 };
+
+    // keep more jobs alive than the pool initially holds, and than a work queue holds
+    JobSystem::Job* root = js.createJob();
+    std::vector<JobSystem::Job*> children(capacity * 2);
+    for (auto& child : children) {
+        child = jobs::createJob(js, root, [&calls] { calls++; });
+        ASSERT_NE(nullptr, child);
+    }
+    for (auto& child : children) {
+        js.run(child);
+    }
+    js.runAndWait(root);
+
+    EXPECT_EQ(int(children.size()), calls.load());
+    EXPECT_GT(js.getStats().jobCapacity, capacity);
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemSuccessors) {
+    JobSystem js;
+    js.adopt();
+
+    // a chain, run in reverse order
+    std::vector<int> order;
+    JobSystem::Job* root = js.createJob();
+    JobSystem::Job* decode = jobs::createJob(js, root, [&order] { order.push_back(0); });
+    JobSystem::Job* upload = jobs::createJob(js, root, [&order] { order.push_back(1); });
+    JobSystem::Job* build = jobs::createJob(js, root, [&order] { order.push_back(2); });
+    js.precede(decode, upload);
+    js.precede(upload, build);
+    js.run(build);
+    js.run(upload);
+    js.run(decode);
+    js.runAndWait(root);
+
+    EXPECT_EQ(std::vector<int>({ 0, 1, 2 }), order);
+
+    // a fan-out from one job, and a fan-in to another one
+    std::atomic_int before = { 0 };
+    std::atomic_int middle = { 0 };
+    int seen = -1;
+    root = js.createJob();
+    JobSystem::Job* source = jobs::createJob(js, root, [&before] { before++; });
+    JobSystem::Job* sink = jobs::createJob(js, root, [&middle, &seen] { seen = middle.load(); });
+    std::vector<JobSystem::Job*> middles(16);
+    for (auto& job : middles) {
+        job = jobs::createJob(js, root, [&before, &middle] {
+            EXPECT_EQ(1, before.load());
+            middle++;
+        });
+        js.precede(source, job);
+        js.precede(job, sink);
+    }
+    js.run(sink);
+    for (auto& job : middles) {
+        js.run(job, JobSystem::JobPriority::BACKGROUND);
+    }
+    js.run(source);
+    root = js.runAndRetain(root, JobSystem::JobPriority::BACKGROUND);
+    js.waitAndRelease(root);
+
+    EXPECT_EQ(16, seen);
+
+    js.emancipate();
+}
+
+TEST(JobSystem, ParallelForKeepsPriority) {
+    JobSystem js;
+    js.adopt();
+
+    std::atomic<uint32_t> sum = { 0 };
+    auto const work = [&sum](uint32_t const* data, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            sum += data[i];
+        }
+    };
+    std::vector<uint32_t> data(4096, 1);
+
+    // the splits of a background parallel_for are background jobs too
+    JobSystem::Stats const before = js.getStats();
+    JobSystem::Job* job = jobs::parallel_for(js, nullptr, data.data(), uint32_t(data.size()),
+            std::cref(work), jobs::CountSplitter<64, 8>());
+    job = js.runAndRetain(job, JobSystem::JobPriority::BACKGROUND);
+    js.waitAndRelease(job);
+    JobSystem::Stats const after = js.getStats();
+
+    EXPECT_EQ(4096, sum);
+    EXPECT_GT(after.jobsRun - before.jobsRun, 1);
+    EXPECT_EQ(after.jobsRun - before.jobsRun, after.backgroundJobsRun - before.backgroundJobsRun);
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemStats) {
+    JobSystem js;
+    js.adopt();
+
+    JobSystem::Stats const before = js.getStats();
+
+    JobSystem::Job* root = js.createJob();
+    for (int i = 0; i < 256; i++) {
+        js.run(js.createJob(root));
+    }
+    js.runAndWait(root);
+
+    // the root job, and its children
+    JobSystem::Stats const after = js.getStats();
+    EXPECT_EQ(257, after.jobsRun - before.jobsRun);
+    EXPECT_LE(after.jobsStolen, after.stealAttempts);
+
     js.emancipate();
 }
@@ -570,6 +570,32 @@ static void cgltf_write_mesh(cgltf_write_context* context, const cgltf_mesh* mes
 	cgltf_write_line(context, "}");
 }
 
+static void cgltf_write_unprocessed_extensions(cgltf_write_context* context, const cgltf_extension* extensions, cgltf_size count)
+{
+	for (cgltf_size i = 0; i < count; ++i)
+	{
+		cgltf_write_indent(context);
+		CGLTF_SPRINTF("\"%s\": %s", extensions[i].name, extensions[i].data);
+		context->needs_comma = 1;
+	}
+}
+
+static void cgltf_write_meshopt_compression(cgltf_write_context* context, const cgltf_meshopt_compression* compression)
+{
+	static const char* const modes[] = { NULL, "ATTRIBUTES", "TRIANGLES", "INDICES" };
+	static const char* const filters[] = { NULL, "OCTAHEDRAL", "QUATERNION", "EXPONENTIAL" };
+
+	cgltf_write_line(context, "\"EXT_meshopt_compression\": {");
+	CGLTF_WRITE_IDXPROP("buffer", compression->buffer, context->data->buffers);
+	cgltf_write_sizeprop(context, "byteOffset", compression->offset, 0);
+	cgltf_write_sizeprop(context, "byteLength", compression->size, (cgltf_size)-1);
+	cgltf_write_sizeprop(context, "byteStride", compression->stride, (cgltf_size)-1);
+	cgltf_write_sizeprop(context, "count", compression->count, (cgltf_size)-1);
+	cgltf_write_strprop(context, "mode", compression->mode < cgltf_meshopt_compression_mode_max_enum ? modes[compression->mode] : NULL);
+	cgltf_write_strprop(context, "filter", compression->filter < cgltf_meshopt_compression_filter_max_enum ? filters[compression->filter] : NULL);
+	cgltf_write_line(context, "}");
+}
+
 static void cgltf_write_buffer_view(cgltf_write_context* context, const cgltf_buffer_view* view)
 {
 	cgltf_write_line(context, "{");
@@ -579,6 +605,16 @@ static void cgltf_write_buffer_view(cgltf_write_context* context, const cgltf_bu
 	cgltf_write_sizeprop(context, "byteOffset", view->offset, 0);
 	cgltf_write_sizeprop(context, "byteStride", view->stride, 0);
 	// NOTE: We skip writing "target" because the spec says its usage can be inferred.
+	if (view->has_meshopt_compression || view->extensions_count > 0)
+	{
+		cgltf_write_line(context, "\"extensions\": {");
+		if (view->has_meshopt_compression)
+		{
+			cgltf_write_meshopt_compression(context, &view->meshopt_compression);
+		}
+		cgltf_write_unprocessed_extensions(context, view->extensions, view->extensions_count);
+		cgltf_write_line(context, "}");
+	}
 	cgltf_write_extras(context, &view->extras);
 	cgltf_write_line(context, "}");
 }
@@ -590,6 +626,12 @@ static void cgltf_write_buffer(cgltf_write_context* context, const cgltf_buffer*
 	cgltf_write_strprop(context, "name", buffer->name);
 	cgltf_write_strprop(context, "uri", buffer->uri);
 	cgltf_write_sizeprop(context, "byteLength", buffer->size, (cgltf_size)-1);
+	if (buffer->extensions_count > 0)
+	{
+		cgltf_write_line(context, "\"extensions\": {");
+		cgltf_write_unprocessed_extensions(context, buffer->extensions, buffer->extensions_count);
+		cgltf_write_line(context, "}");
+	}
 	cgltf_write_extras(context, &buffer->extras);
 	cgltf_write_line(context, "}");
 }
@@ -1239,61 +1281,57 @@ cgltf_result cgltf_write_file(const cgltf_options* options, const char* path, co
 	return cgltf_result_success;
 }
 
+// Indexed by the bit of the CGLTF_EXTENSION_FLAG_ values.
+static const char* const cgltf_extension_flag_names[] = {
+	"KHR_texture_transform",
+	"KHR_materials_unlit",
+	"KHR_materials_pbrSpecularGlossiness",
+	"KHR_lights_punctual",
+	"KHR_draco_mesh_compression",
+	"KHR_materials_clearcoat",
+	"KHR_materials_ior",
+	"KHR_materials_specular",
+	"KHR_materials_transmission",
+	"KHR_materials_sheen",
+	"KHR_materials_variants",
+	"KHR_materials_volume",
+	"KHR_texture_basisu",
+	"KHR_materials_emissive_strength",
+	"EXT_mesh_gpu_instancing",
+	"KHR_materials_iridescence",
+	"KHR_materials_anisotropy",
+	"KHR_materials_dispersion",
+};
+
 static void cgltf_write_extensions(cgltf_write_context* context, uint32_t extension_flags)
 {
-	if (extension_flags & CGLTF_EXTENSION_FLAG_TEXTURE_TRANSFORM) {
-		cgltf_write_stritem(context, "KHR_texture_transform");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_UNLIT) {
-		cgltf_write_stritem(context, "KHR_materials_unlit");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_SPECULAR_GLOSSINESS) {
-		cgltf_write_stritem(context, "KHR_materials_pbrSpecularGlossiness");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_LIGHTS_PUNCTUAL) {
-		cgltf_write_stritem(context, "KHR_lights_punctual");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_DRACO_MESH_COMPRESSION) {
-		cgltf_write_stritem(context, "KHR_draco_mesh_compression");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_CLEARCOAT) {
-		cgltf_write_stritem(context, "KHR_materials_clearcoat");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_IOR) {
-		cgltf_write_stritem(context, "KHR_materials_ior");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_SPECULAR) {
-		cgltf_write_stritem(context, "KHR_materials_specular");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_TRANSMISSION) {
-		cgltf_write_stritem(context, "KHR_materials_transmission");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_SHEEN) {
-		cgltf_write_stritem(context, "KHR_materials_sheen");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_VARIANTS) {
-		cgltf_write_stritem(context, "KHR_materials_variants");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_VOLUME) {
-		cgltf_write_stritem(context, "KHR_materials_volume");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_TEXTURE_BASISU) {
-		cgltf_write_stritem(context, "KHR_texture_basisu");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_EMISSIVE_STRENGTH) {
-		cgltf_write_stritem(context, "KHR_materials_emissive_strength");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_IRIDESCENCE) {
-		cgltf_write_stritem(context, "KHR_materials_iridescence");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_ANISOTROPY) {
-		cgltf_write_stritem(context, "KHR_materials_anisotropy");
-	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MESH_GPU_INSTANCING) {
-		cgltf_write_stritem(context, "EXT_mesh_gpu_instancing");
+	for (uint32_t bit = 0; bit < sizeof(cgltf_extension_flag_names) / sizeof(cgltf_extension_flag_names[0]); ++bit)
+	{
+		if (extension_flags & (1u << bit))
+		{
+			cgltf_write_stritem(context, cgltf_extension_flag_names[bit]);
+		}
 	}
-	if (extension_flags & CGLTF_EXTENSION_FLAG_MATERIALS_DISPERSION) {
-		cgltf_write_stritem(context, "KHR_materials_dispersion");
+}
+
+// Writes the names listed in cgltf_data that are neither written for extension_flags nor listed before.
+static void cgltf_write_extension_names(cgltf_write_context* context, uint32_t extension_flags, char* const* names, cgltf_size count)
+{
+	for (cgltf_size i = 0; i < count; ++i)
+	{
+		int written = 0;
+		for (uint32_t bit = 0; bit < sizeof(cgltf_extension_flag_names) / sizeof(cgltf_extension_flag_names[0]) && !written; ++bit)
+		{
+			written = (extension_flags & (1u << bit)) && strcmp(names[i], cgltf_extension_flag_names[bit]) == 0;
+		}
+		for (cgltf_size j = 0; j < i && !written; ++j)
+		{
+			written = strcmp(names[i], names[j]) == 0;
+		}
+		if (!written)
+		{
+			cgltf_write_stritem(context, names[i]);
+		}
 	}
 }
 
@@ -1482,17 +1520,19 @@ cgltf_size cgltf_write(const cgltf_options* options, char* buffer, cgltf_size si
 		cgltf_write_line(context, "}");
 	}
 
-	if (context->extension_flags != 0)
+	if (context->extension_flags != 0 || data->extensions_used_count > 0)
 	{
 		cgltf_write_line(context, "\"extensionsUsed\": [");
 		cgltf_write_extensions(context, context->extension_flags);
+		cgltf_write_extension_names(context, context->extension_flags, data->extensions_used, data->extensions_used_count);
 		cgltf_write_line(context, "]");
 	}
 
-	if (context->required_extension_flags != 0)
+	if (context->required_extension_flags != 0 || data->extensions_required_count > 0)
 	{
 		cgltf_write_line(context, "\"extensionsRequired\": [");
 		cgltf_write_extensions(context, context->required_extension_flags);
+		cgltf_write_extension_names(context, context->required_extension_flags, data->extensions_required, data->extensions_required_count);
 		cgltf_write_line(context, "]");
 	}
 
@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "private/backend/CommandStreamRecorder.h"
+#include "private/backend/CommandStreamReplay.h"
+#include "private/backend/Driver.h"
+#include "private/backend/PlatformFactory.h"
+
+#include <backend/DriverEnums.h>
+#include <backend/Platform.h>
+
+#include <utils/Path.h>
+
+#include <getopt/getopt.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace filament::backend;
+using namespace utils;
+
+static Backend g_backend = Backend::NOOP;
+static uint32_t g_iterations = 1;
+static bool g_perCommand = false;
+static uint32_t g_width = 1280;
+static uint32_t g_height = 720;
+
+static const char* USAGE = R"TXT(
+CMDREPLAY replays a driver command stream captured with Engine::Builder::commandCapture() and
+reports the CPU time spent in the driver, per frame and per command.
+
+Usage:
+    CMDREPLAY [options] <capture_file>
+
+Options:
+   --help, -h
+       Print this message
+   --license, -L
+       Print copyright and license information
+   --api, -a
+       Specify the backend API: noop (default), opengl, vulkan, or metal
+   --iterations=N, -i N
+       Replay the capture N times (default: 1)
+   --per-command, -c
+       Execute and time each command individually instead of once per frame
+   --size=WxH, -s WxH
+       Size of the headless swap chains replacing the captured ones (default: 1280x720)
+)TXT";
+
+static void printUsage(const char* name) {
+    std::string execName(Path(name).getName());
+    const std::string from("CMDREPLAY");
+    std::string usage(USAGE);
+    for (size_t pos = usage.find(from); pos != std::string::npos; pos = usage.find(from, pos)) {
+        usage.replace(pos, from.length(), execName);
+    }
+    puts(usage.c_str());
+}
+
+static void license() {
+    static const char *license[] = {
+        #include "licenses/licenses.inc"
+        nullptr
+    };
+
+    const char **p = &license[0];
+    while (*p)
+        std::cout << *p++ << std::endl;
+}
+
+static int handleArguments(int argc, char* argv[]) {
+    static constexpr const char* OPTSTR = "hLa:i:cs:";
+    static const struct option OPTIONS[] = {
+            { "help",        no_argument,       0, 'h' },
+            { "license",     no_argument,       0, 'L' },
+            { "api",         required_argument, 0, 'a' },
+            { "iterations",  required_argument, 0, 'i' },
+            { "per-command", no_argument,       0, 'c' },
+            { "size",        required_argument, 0, 's' },
+            { 0, 0, 0, 0 }  // termination of the option list
+    };
+
+    int opt;
+    int optionIndex = 0;
+
+    while ((opt = getopt_long(argc, argv, OPTSTR, OPTIONS, &optionIndex)) >= 0) {
+        std::string arg(optarg ? optarg : "");
+        switch (opt) {
+            default:
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            case 'L':
+                license();
+                exit(0);
+            case 'a':
+                if (arg == "noop") {
+                    g_backend = Backend::NOOP;
+                } else if (arg == "opengl") {
+                    g_backend = Backend::OPENGL;
+                } else if (arg == "vulkan") {
+                    g_backend = Backend::VULKAN;
+                } else if (arg == "metal") {
+                    g_backend = Backend::METAL;
+                } else {
+                    std::cerr << "Unrecognized backend. Must be 'noop', 'opengl', 'vulkan' or "
+                                 "'metal'." << std::endl;
+                    exit(1);
+                }
+                break;
+            case 'i':
+                g_iterations = std::max(1, atoi(arg.c_str()));
+                break;
+            case 'c':
+                g_perCommand = true;
+                break;
+            case 's':
+                if (sscanf(arg.c_str(), "%ux%u", &g_width, &g_height) != 2 ||
+                        !g_width || !g_height) {
+                    std::cerr << "Invalid size, must be WxH, e.g. 1920x1080." << std::endl;
+                    exit(1);
+                }
+                break;
+        }
+    }
+
+    return optind;
+}
+
+static void printStats(CommandStreamReplay::Stats const& stats) {
+    std::vector<uint64_t> frames(stats.frameNs);
+    std::sort(frames.begin(), frames.end());
+    if (!frames.empty()) {
+        printf("frames: %zu, median %.3f ms, max %.3f ms\n", frames.size(),
+                double(frames[frames.size() / 2]) * 1e-6, double(frames.back()) * 1e-6);
+    }
+    printf("total: %.3f ms\n", double(stats.totalNs) * 1e-6);
+
+    if (!g_perCommand) {
+        return;
+    }
+
+    // most expensive commands first
+    std::vector<size_t> order;
+    for (size_t i = 0; i < stats.commands.size(); i++) {
+        if (stats.commands[i].count) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&stats](size_t lhs, size_t rhs) {
+        return stats.commands[lhs].totalNs > stats.commands[rhs].totalNs;
+    });
+
+    printf("%-32s %10s %12s %12s %12s\n", "command", "count", "total (ms)", "avg (us)",
+            "max (us)");
+    for (size_t const i : order) {
+        CommandStreamReplay::CommandStats const& command = stats.commands[i];
+        printf("%-32s %10u %12.3f %12.3f %12.3f\n", getCapturedCommandName(CapturedCommand(i)),
+                command.count, double(command.totalNs) * 1e-6,
+                double(command.totalNs) * 1e-3 / command.count, double(command.maxNs) * 1e-3);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int const optionIndex = handleArguments(argc, argv);
+    if (argc - optionIndex < 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Backend backend = g_backend;
+    Platform* platform = PlatformFactory::create(&backend);
+    if (!platform) {
+        std::cerr << "Selected backend not supported in this build." << std::endl;
+        return 1;
+    }
+
+    Driver* const driver = platform->createDriver(nullptr, {});
+    if (!driver) {
+        std::cerr << "Unable to create the driver." << std::endl;
+        PlatformFactory::destroy(&platform);
+        return 1;
+    }
+
+    int result = 0;
+    {
+        CommandStreamReplay replay(*driver);
+        replay.setSwapChainSize(g_width, g_height);
+        if (replay.load(argv[optionIndex])) {
+            printf("%s: %u frames\n", argv[optionIndex], replay.getFrameCount());
+            for (uint32_t i = 0; i < g_iterations; i++) {
+                printStats(replay.replay(g_perCommand));
+            }
+        } else {
+            result = 1;
+        }
+    }
+
+    driver->terminate();
+    delete driver;
+    PlatformFactory::destroy(&platform);
+    return result;
+}
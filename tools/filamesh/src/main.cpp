@@ -18,6 +18,9 @@
 
 #include <fstream>
 #include <iostream>
+#include <iterator>
+
+#include <string.h>
 
 #include <math/half.h>
 #include <math/mat3.h>
@@ -48,6 +51,7 @@ bool g_interleaved = false;
 bool g_snormUVs = false;
 bool g_compression = false;
 bool g_ignore_uv1 = false;
+bool g_pack = false;
 
 Mesh g_mesh;
 float2 g_minUV = float2(std::numeric_limits<float>::max());
@@ -256,6 +260,7 @@ static void printUsage(const char* name) {
             "\n"
                     "Usage:\n"
                     "    FILAMESH [options] <source mesh> <destination file>\n"
+                    "    FILAMESH --pack <source filamesh>... <destination file>\n"
                     "\n"
                     "Supported mesh formats:\n"
                     "    FBX, OBJ\n"
@@ -273,6 +278,8 @@ static void printUsage(const char* name) {
                     "       enable compression\n\n"
                     "   --ignore-uv1, -g\n"
                     "       Ignore the second set of UV coordinates\n\n"
+                    "   --pack, -p\n"
+                    "       Pack several filamesh files into a single multi-mesh file\n\n"
 
     );
 
@@ -295,13 +302,14 @@ static void license() {
 }
 
 static int handleArguments(int argc, char* argv[]) {
-    static constexpr const char* OPTSTR = "hilcg";
+    static constexpr const char* OPTSTR = "hilcgp";
     static const struct option OPTIONS[] = {
             { "help",        no_argument, 0, 'h' },
             { "license",     no_argument, 0, 'l' },
             { "interleaved", no_argument, 0, 'i' },
             { "compress",    no_argument, 0, 'c' },
             { "ignore-uv1",  no_argument, 0, 'g' },
+            { "pack",        no_argument, 0, 'p' },
             { 0, 0, 0, 0 }  // termination of the option list
     };
 
@@ -329,12 +337,91 @@ static int handleArguments(int argc, char* argv[]) {
             case 'g':
                 g_ignore_uv1 = true;
                 break;
+            case 'p':
+                g_pack = true;
+                break;
         }
     }
 
     return optind;
 }
 
+static bool openDestination(const Path& dst, std::ofstream& out) {
+    const Path outputDir(dst.getParent());
+    if (!outputDir.exists()) {
+        outputDir.mkdirRecursive();
+    }
+
+    out.open(dst, std::ios::binary | std::ios::trunc);
+    if (!out.good()) {
+        std::cerr << "Could not write to " << dst << std::endl;
+        out.close();
+        return false;
+    }
+    return true;
+}
+
+static int pack(char* const* sources, int count, const Path& dst) {
+    std::vector<std::vector<char>> blobs(count);
+    std::vector<std::string> names(count);
+    for (int i = 0; i < count; i++) {
+        Path src(sources[i]);
+        std::ifstream in(src, std::ios::binary);
+        if (!in.good()) {
+            std::cerr << "The source mesh " << src << " does not exist." << std::endl;
+            return 1;
+        }
+        blobs[i].assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (blobs[i].size() < sizeof(MAGICID) + sizeof(Header) ||
+                strncmp(blobs[i].data(), MAGICID, sizeof(MAGICID))) {
+            std::cerr << src << " is not a filamesh file." << std::endl;
+            return 1;
+        }
+        names[i] = src.getNameWithoutExtension();
+    }
+
+    auto align = [](uint64_t offset) {
+        return (offset + PACK_ALIGNMENT - 1) & ~uint64_t(PACK_ALIGNMENT - 1);
+    };
+
+    uint64_t offset = sizeof(PACK_MAGICID) + sizeof(PackHeader) + count * sizeof(PackEntry);
+    for (const std::string& name : names) {
+        offset += sizeof(uint32_t) + name.size() + 1;
+    }
+
+    std::vector<PackEntry> entries(count);
+    for (int i = 0; i < count; i++) {
+        offset = align(offset);
+        entries[i] = { offset, blobs[i].size() };
+        offset += blobs[i].size();
+    }
+
+    std::ofstream out;
+    if (!openDestination(dst, out)) {
+        return 1;
+    }
+
+    const PackHeader header{ PACK_VERSION, uint32_t(count) };
+    out.write(PACK_MAGICID, sizeof(PACK_MAGICID));
+    out.write((const char*) &header, sizeof(header));
+    out.write((const char*) entries.data(), count * sizeof(PackEntry));
+    for (const std::string& name : names) {
+        const uint32_t length = uint32_t(name.size());
+        out.write((const char*) &length, sizeof(length));
+        out.write(name.c_str(), length + 1);
+    }
+    for (int i = 0; i < count; i++) {
+        const std::vector<char> padding(entries[i].offset - uint64_t(out.tellp()), 0);
+        out.write(padding.data(), padding.size());
+        out.write(blobs[i].data(), blobs[i].size());
+    }
+
+    out.flush();
+    out.close();
+
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     int optionIndex = handleArguments(argc, argv);
 
@@ -344,6 +431,10 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (g_pack) {
+        return pack(argv + optionIndex, numArgs - 1, Path(argv[argc - 1]));
+    }
+
     Path src(argv[optionIndex]);
     if (!src.exists()) {
         std::cerr << "The source mesh " << src << " does not exist." << std::endl;
@@ -419,15 +510,8 @@ int main(int argc, char* argv[]) {
 
     Path dst(argv[optionIndex + 1]);
 
-    const Path outputDir(dst.getParent());
-    if (!outputDir.exists()) {
-        outputDir.mkdirRecursive();
-    }
-
-    std::ofstream out(dst, std::ios::binary | std::ios::trunc);
-    if (!out.good()) {
-        std::cerr << "Could not write to " << dst << std::endl;
-        out.close();
+    std::ofstream out;
+    if (!openDestination(dst, out)) {
         return 1;
     }
 
@@ -172,11 +172,12 @@ int main(int argc, char* argv[]) {
 
     size_t existingMaterialsCount = 0;
     ReadableArchive* existingArchive = nullptr;
+    FixedCapacityVector<uint8_t> archiveBuffer;
 
     // In append mode, the first step is to consume the output file.
     if (g_appendMode) {
         const size_t archiveSize = getFileSize(g_outputFile.c_str());
-        FixedCapacityVector<uint8_t> archiveBuffer(archiveSize);
+        archiveBuffer = FixedCapacityVector<uint8_t>(archiveSize);
         uint8_t* archiveData = archiveBuffer.data();
         std::ifstream in(g_outputFile.c_str(), std::ifstream::in | std::ifstream::binary);
         if (!in.read((char*) archiveData, archiveSize)) {
@@ -188,9 +189,10 @@ int main(int argc, char* argv[]) {
             PANIC_POSTCONDITION("Decompression error.");
         }
         uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
-        ZSTD_decompress(basePointer, decompSize, archiveData, archiveSize);
+        const size_t headerSize = ZSTD_findFrameCompressedSize(archiveData, archiveSize);
+        ZSTD_decompress(basePointer, decompSize, archiveData, headerSize);
         existingArchive = (ReadableArchive*) basePointer;
-        convertOffsetsToPointers(existingArchive);
+        convertOffsetsToPointers(existingArchive, archiveData + headerSize);
         existingMaterialsCount = existingArchive->specsCount;
     }
 
@@ -203,7 +205,11 @@ int main(int argc, char* argv[]) {
             // a made-up string (it is only used for error messages).
             std::string materialName = "mat" + to_string(specIndex);
             const ArchiveSpec& spec = existingArchive->specs[specIndex];
-            outputArchive.addMaterial(materialName.c_str(), spec.package, spec.packageByteCount);
+            FixedCapacityVector<uint8_t> package(getPackageSize(*existingArchive, spec));
+            if (package.empty() || !readPackage(*existingArchive, spec, package.data())) {
+                PANIC_POSTCONDITION("Decompression error.");
+            }
+            outputArchive.addMaterial(materialName.c_str(), package.data(), package.size());
             outputArchive.setShadingModel(spec.shadingModel);
             outputArchive.setBlendingModel(spec.blendingMode);
             for (uint16_t flagIndex = 0; flagIndex < spec.flagsCount; ++flagIndex) {